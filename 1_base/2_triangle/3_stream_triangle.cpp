@@ -0,0 +1,172 @@
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+#include <shader_s.h>
+#include <gl_ext.h>
+#include <stream_ring.h>
+
+#include <iostream>
+#include <cmath>
+#include <cstring>
+
+/**
+ * 2_triangle.cpp的三角形用GL_STATIC_DRAW上传一次就不再改变。
+ * 这里每帧在CPU上重新生成一片随时间起伏的三角形，顶点写入StreamRing：
+ * 持久映射的三缓冲环形缓冲，每帧只是一次memcpy，不会像每帧glBufferData那样让驱动重新分配内存
+ * */
+
+void framebuffer_size_callback(GLFWwindow *window, int width, int height);
+
+void processInput(GLFWwindow *window);
+
+// settings
+const unsigned int SCR_WIDTH = 800;
+const unsigned int SCR_HEIGHT = 600;
+const unsigned int GRID_SIZE = 64;
+
+const char *vertexShaderSource = "#version 330 core\n"
+                                 "layout (location = 0) in vec3 aPos;\n"
+                                 "out float height;\n"
+                                 "void main()\n"
+                                 "{\n"
+                                 "   height = aPos.z;\n"
+                                 "   gl_Position = vec4(aPos.x, aPos.y, 0.0, 1.0);\n"
+                                 "}\0";
+const char *fragmentShaderSource = "#version 330 core\n"
+                                   "out vec4 FragColor;\n"
+                                   "in float height;\n"
+                                   "void main()\n"
+                                   "{\n"
+                                   "   FragColor = vec4(1.0f, 0.5f + 0.5f * height, 0.2f, 1.0f);\n"
+                                   "}\n\0";
+
+int main() {
+    // glfw: initialize and configure
+    // ------------------------------
+    glfwInit();
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+#ifdef __APPLE__
+    glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+#endif
+
+    // glfw window creation
+    // --------------------
+    GLFWwindow *window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, "LearnOpenGL", NULL, NULL);
+    if (window == NULL) {
+        std::cout << "Failed to create GLFW window" << std::endl;
+        glfwTerminate();
+        return -1;
+    }
+    glfwMakeContextCurrent(window);
+    glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
+
+    // glad: load all OpenGL function pointers
+    // ---------------------------------------
+    if (!gladLoadGLLoader((GLADloadproc) glfwGetProcAddress)) {
+        std::cout << "Failed to initialize GLAD" << std::endl;
+        return -1;
+    }
+    loadGLExtensions((GLADloadproc) glfwGetProcAddress);
+
+    // build and compile our 3_shader program
+    // ------------------------------------
+    Shader ourShader;
+    ourShader.build(vertexShaderSource, fragmentShaderSource);
+
+    // one VAO, the attribute pointer is re-pointed at each frame's allocation
+    // ------------------------------------------------------------------
+    const unsigned int vertexCount = GRID_SIZE * GRID_SIZE * 3;
+    const size_t frameBytes = vertexCount * 3 * sizeof(float);
+    StreamRing ring(frameBytes);
+    std::cout << "stream ring: " << (ring.persistent() ? "persistent mapping" : "unsynchronized map per frame") << std::endl;
+
+    unsigned int VAO;
+    glGenVertexArrays(1, &VAO);
+    glBindVertexArray(VAO);
+    glEnableVertexAttribArray(0);
+
+    // render loop
+    // -----------
+    while (!glfwWindowShouldClose(window)) {
+        // input
+        // -----
+        processInput(window);
+
+        // generate this frame's geometry straight into the ring
+        // ------------------------------------------------------
+        ring.beginFrame();
+        StreamRing::Allocation vertices = ring.allocate(frameBytes);
+        if (vertices.valid()) {
+            float *out = (float *) vertices.ptr;
+            float time = (float) glfwGetTime();
+            float cell = 2.0f / GRID_SIZE, h = cell * 0.45f;
+            for (unsigned int y = 0; y < GRID_SIZE; ++y) {
+                for (unsigned int x = 0; x < GRID_SIZE; ++x) {
+                    float cx = -1.0f + (x + 0.5f) * cell;
+                    float cy = -1.0f + (y + 0.5f) * cell;
+                    float wave = std::sin(time * 2.0f + cx * 4.0f + cy * 3.0f);
+                    float size = h * (0.6f + 0.4f * wave);
+                    float triangle[9] = {cx - size, cy - size, wave,
+                                         cx + size, cy - size, wave,
+                                         cx, cy + size, wave};
+                    std::memcpy(out, triangle, sizeof(triangle));
+                    out += 9;
+                }
+            }
+        }
+        ring.flush();
+
+        // render
+        // ------
+        glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT);
+
+        ourShader.use();
+        glBindVertexArray(VAO);
+        if (vertices.valid()) {
+            glBindBuffer(GL_ARRAY_BUFFER, ring.buffer());
+            glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void *) vertices.offset);
+            glDrawArrays(GL_TRIANGLES, 0, vertexCount);
+        }
+        // fence the segment after the last draw that reads it
+        ring.endFrame();
+
+        // glfw: swap buffers and poll IO events (keys pressed/released, mouse moved etc.)
+        // -------------------------------------------------------------------------------
+        glfwSwapBuffers(window);
+        glfwPollEvents();
+    }
+
+    const StreamRing::Stats &stats = ring.statistics();
+    std::cout << "stream ring: " << stats.frames << " frames, " << stats.bytes << " bytes, "
+              << stats.stalls << " stalls, " << stats.overflows << " overflows" << std::endl;
+
+    // optional: de-allocate all resources once they've outlived their purpose:
+    // ------------------------------------------------------------------------
+    glDeleteVertexArrays(1, &VAO);
+    ring.release();
+    glDeleteProgram(ourShader.ID);
+
+    // glfw: terminate, clearing all previously allocated GLFW resources.
+    // ------------------------------------------------------------------
+    glfwTerminate();
+    return 0;
+}
+
+// process all input: query GLFW whether relevant keys are pressed/released this frame and react accordingly
+// ---------------------------------------------------------------------------------------------------------
+void processInput(GLFWwindow *window) {
+    if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
+        glfwSetWindowShouldClose(window, true);
+}
+
+// glfw: whenever the window size changed (by OS or user resize) this callback function executes
+// ---------------------------------------------------------------------------------------------
+void framebuffer_size_callback(GLFWwindow *window, int width, int height) {
+    // make sure the viewport matches the new window dimensions; note that width and
+    // height will be significantly larger than specified on retina displays.
+    glViewport(0, 0, width, height);
+}
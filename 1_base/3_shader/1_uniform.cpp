@@ -134,6 +134,9 @@ int main()
     // just bind it beforehand before rendering the respective triangle; this is another approach.
     glBindVertexArray(VAO);
 
+    ///用glGetUniformLocation查询uniform ourColor的位置值，位置在链接后不会变化，所以只需在循环外查询一次
+    int vertexColorLocation = glGetUniformLocation(shaderProgram, "ourColor");
+
 
     // render loop
     // -----------
@@ -156,8 +159,6 @@ int main()
         double  timeValue = glfwGetTime();
         /// 通过sin函数让颜色在0.0到1.0之间变化
         float greenValue = static_cast<float>(sin(timeValue) / 2.0 + 0.5);
-        ///用glGetUniformLocation查询uniform ourColor的位置值
-        int vertexColorLocation = glGetUniformLocation(shaderProgram, "ourColor");
         /// 设置uniform值
         glUniform4f(vertexColorLocation, 0.0f, greenValue, 0.0f, 1.0f);
 
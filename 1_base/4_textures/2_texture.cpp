@@ -3,6 +3,7 @@
 #include <../depend/stb_image.h>
 
 #include <../depend/shader_s.h>
+#include <../depend/gl_state.h>
 
 #include <iostream>
 #include <filesystem>
@@ -156,6 +157,10 @@ int main()
 
 
 
+    // shadow the bindings from here on so unchanged ones are not re-issued every frame
+    // -------------------------------------------------------------------------------
+    GLStateCache glState;
+
     // render loop
     // -----------
     while (!glfwWindowShouldClose(window))
@@ -172,15 +177,14 @@ int main()
         // bind textures on corresponding texture units
         /// 纹理单元：一个纹理的位置的值，一个纹理的默认纹理单元是0，它是默认的激活纹理单元
         /// 纹理单元的主要目的是让我们在着色器中可以使用多于一个为纹理，通过把纹理单元赋值给采样器，我们可以一次绑定多个纹理
-        glActiveTexture(GL_TEXTURE0);///在绑定纹理前先激活纹理单元
-        /// 激活纹理单元后，glBindTexture就会绑定这个纹理到当前激活的纹理单元，GL_TEXTURE0默认一直被激活，所以可以省略
-        glBindTexture(GL_TEXTURE_2D, texture1);
-        glActiveTexture(GL_TEXTURE1);
-        glBindTexture(GL_TEXTURE_2D, texture2);
+        /// 在绑定纹理前先激活纹理单元(glActiveTexture)，激活纹理单元后，glBindTexture就会绑定这个纹理到当前激活的纹理单元
+        /// glState只在绑定确实变化时才调用glActiveTexture/glBindTexture，绑定没变的帧不会产生任何驱动调用
+        glState.bindTextureUnit(0, GL_TEXTURE_2D, texture1);
+        glState.bindTextureUnit(1, GL_TEXTURE_2D, texture2);
 
         // render container
-        ourShader.use();
-        glBindVertexArray(VAO);
+        glState.useProgram(ourShader.ID);
+        glState.bindVertexArray(VAO);
         glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
 
         // glfw: swap buffers and poll IO events (keys pressed/released, mouse moved etc.)
@@ -189,6 +193,8 @@ int main()
         glfwPollEvents();
     }
 
+    glState.printStats(std::cout);
+
     // optional: de-allocate all resources once they've outlived their purpose:
     // ------------------------------------------------------------------------
     glDeleteVertexArrays(1, &VAO);
@@ -0,0 +1,201 @@
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <../depend/stb_image.h>
+
+#include <../depend/shader_s.h>
+#include <../depend/gl_state.h>
+#include <../depend/gl_ext.h>
+#include <../depend/texture_loader.h>
+
+#include <iostream>
+#include <filesystem>
+
+void framebuffer_size_callback(GLFWwindow* window, int width, int height);
+void processInput(GLFWwindow *window);
+
+// settings
+const unsigned int SCR_WIDTH = 800;
+const unsigned int SCR_HEIGHT = 600;
+
+int main()
+{
+    // glfw: initialize and configure
+    // ------------------------------
+    glfwInit();
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+#ifdef __APPLE__
+    glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+#endif
+
+    // glfw window creation
+    // --------------------
+    GLFWwindow* window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, "LearnOpenGL", NULL, NULL);
+    if (window == NULL)
+    {
+        std::cout << "Failed to create GLFW window" << std::endl;
+        glfwTerminate();
+        return -1;
+    }
+    glfwMakeContextCurrent(window);
+    glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
+
+    // glad: load all OpenGL function pointers
+    // ---------------------------------------
+    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+    {
+        std::cout << "Failed to initialize GLAD" << std::endl;
+        return -1;
+    }
+    loadGLExtensions((GLADloadproc)glfwGetProcAddress);
+
+    // build and compile our shader zprogram
+    // ------------------------------------
+    Shader ourShader("../1_base/4_textures/helper/shader.vs", "../1_base/4_textures/helper/shader_texture2.fs");
+
+    // set up vertex data (and buffer(s)) and configure vertex attributes
+    // ------------------------------------------------------------------
+    float vertices[] = {
+            // positions          // colors           // texture coords
+            0.5f,  0.5f, 0.0f,   1.0f, 0.0f, 0.0f,   1.0f, 1.0f, // top right
+            0.5f, -0.5f, 0.0f,   0.0f, 1.0f, 0.0f,   1.0f, 0.0f, // bottom right
+            -0.5f, -0.5f, 0.0f,   0.0f, 0.0f, 1.0f,   0.0f, 0.0f, // bottom left
+            -0.5f,  0.5f, 0.0f,   1.0f, 1.0f, 0.0f,   0.0f, 1.0f  // top left
+    };
+    unsigned int indices[] = {
+            0, 1, 3, // first triangle
+            1, 2, 3  // second triangle
+    };
+    unsigned int VBO, VAO, EBO;
+    glGenVertexArrays(1, &VAO);
+    glGenBuffers(1, &VBO);
+    glGenBuffers(1, &EBO);
+
+    glBindVertexArray(VAO);
+
+    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
+
+    // position attribute
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);
+    glEnableVertexAttribArray(0);
+    // color attribute
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));
+    glEnableVertexAttribArray(1);
+    // texture coord attribute
+    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));
+    glEnableVertexAttribArray(2);
+
+
+    // load and create a texture
+    // -------------------------
+    /// 纹理在工作线程中解码，load()立即返回纹理对象(先是1x1的占位纹理)，窗口马上就可以交互
+    /// 解码完成后由渲染循环中的update()在每帧的时间预算内上传到GPU
+    /// 解码结果经过像素缓冲(PBO)环形缓冲上传：持久映射时工作线程直接写入PBO，glTexImage2D不再同步拷贝
+    PixelUploadRing uploadRing(16 * 1024 * 1024);
+    std::cout << "pixel upload ring: " << (uploadRing.persistent() ? "persistent mapped" : "mapped per upload") << std::endl;
+    TextureLoader loader(0, &uploadRing);
+    double loadStart = glfwGetTime();
+    unsigned int texture1 = loader.load("../res/container.jpeg");
+    unsigned int texture2 = loader.load("../res/awesomeface.png");
+    std::cout << "decoding on " << loader.threadCount() << " worker threads" << std::endl;
+
+    // tell opengl for each sampler to which texture unit it belongs to (only has to be done once)
+    // -------------------------------------------------------------------------------------------
+    /// 不要忘记在设置uniform变量之前激活着色器程序！
+    ourShader.use(); // don't forget to activate/use the shader before setting uniforms!
+    // either set it manually like so:
+    /// 手动设置
+    glUniform1i(glGetUniformLocation(ourShader.ID, "texture1"), 0);
+    // or set it via the texture class
+    /// 或者使用着色器类设置
+    ourShader.setInt("texture2", 1);
+
+
+
+    // shadow the bindings from here on so unchanged ones are not re-issued every frame
+    // -------------------------------------------------------------------------------
+    GLStateCache glState;
+
+    // render loop
+    // -----------
+    while (!glfwWindowShouldClose(window))
+    {
+        // input
+        // -----
+        processInput(window);
+
+        // upload textures that finished decoding, at most ~2ms per frame
+        // ---------------------------------------------------------------
+        if (loader.pending() > 0 && loader.update(2.0) > 0)
+        {
+            /// 上传时绑定了纹理，缓存的绑定状态已经失效
+            glState.invalidate();
+            if (loader.pending() == 0)
+                std::cout << "all textures loaded in " << (glfwGetTime() - loadStart) * 1000.0 << " ms" << std::endl;
+        }
+
+        // render
+        // ------
+        glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT);
+
+        // bind textures on corresponding texture units
+        /// 纹理单元：一个纹理的位置的值，一个纹理的默认纹理单元是0，它是默认的激活纹理单元
+        /// 纹理单元的主要目的是让我们在着色器中可以使用多于一个为纹理，通过把纹理单元赋值给采样器，我们可以一次绑定多个纹理
+        /// 在绑定纹理前先激活纹理单元(glActiveTexture)，激活纹理单元后，glBindTexture就会绑定这个纹理到当前激活的纹理单元
+        /// glState只在绑定确实变化时才调用glActiveTexture/glBindTexture，绑定没变的帧不会产生任何驱动调用
+        glState.bindTextureUnit(0, GL_TEXTURE_2D, texture1);
+        glState.bindTextureUnit(1, GL_TEXTURE_2D, texture2);
+
+        // render container
+        glState.useProgram(ourShader.ID);
+        glState.bindVertexArray(VAO);
+        glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+
+        // glfw: swap buffers and poll IO events (keys pressed/released, mouse moved etc.)
+        // -------------------------------------------------------------------------------
+        glfwSwapBuffers(window);
+        glfwPollEvents();
+    }
+
+    glState.printStats(std::cout);
+
+    // optional: de-allocate all resources once they've outlived their purpose:
+    // ------------------------------------------------------------------------
+    glDeleteVertexArrays(1, &VAO);
+    glDeleteBuffers(1, &VBO);
+    glDeleteBuffers(1, &EBO);
+    /// 先停下并回收工作线程，它们可能还在往映射的PBO里写，之后才能释放环形缓冲
+    loader.shutdown();
+    uploadRing.release();
+    glDeleteTextures(1, &texture1);
+    glDeleteTextures(1, &texture2);
+
+    // glfw: terminate, clearing all previously allocated GLFW resources.
+    // ------------------------------------------------------------------
+    glfwTerminate();
+    return 0;
+}
+
+// process all input: query GLFW whether relevant keys are pressed/released this frame and react accordingly
+// ---------------------------------------------------------------------------------------------------------
+void processInput(GLFWwindow *window)
+{
+    if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
+        glfwSetWindowShouldClose(window, true);
+}
+
+// glfw: whenever the window size changed (by OS or user resize) this callback function executes
+// ---------------------------------------------------------------------------------------------
+void framebuffer_size_callback(GLFWwindow* window, int width, int height)
+{
+    // make sure the viewport matches the new window dimensions; note that width and 
+    // height will be significantly larger than specified on retina displays.
+    glViewport(0, 0, width, height);
+}
\ No newline at end of file
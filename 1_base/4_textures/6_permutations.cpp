@@ -0,0 +1,272 @@
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <../depend/stb_image.h>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include <../depend/shader_s.h>
+#include <../depend/shader_permutations.h>
+#include <../depend/gl_state.h>
+
+#include <iostream>
+
+void framebuffer_size_callback(GLFWwindow* window, int width, int height);
+void processInput(GLFWwindow *window);
+
+// settings
+const unsigned int SCR_WIDTH = 800;
+const unsigned int SCR_HEIGHT = 600;
+
+/// 每个象限一个变体，掩码是编译期常量，非法组合(例如TEXTURE2不带TEXTURE)无法通过编译
+typedef BasicShaderFeatures F;
+constexpr uint32_t COLORED = F::VERTEX_COLOR | F::TRANSFORM;
+constexpr uint32_t TEXTURED = F::TEXTURE | F::TRANSFORM;
+constexpr uint32_t TEXTURED2 = F::TEXTURE | F::TEXTURE2 | F::TRANSFORM;
+constexpr uint32_t TEXTURED2_COLORED = F::VERTEX_COLOR | F::TEXTURE | F::TEXTURE2 | F::TRANSFORM;
+
+int main()
+{
+    // glfw: initialize and configure
+    // ------------------------------
+    glfwInit();
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+#ifdef __APPLE__
+    glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+#endif
+
+    // glfw window creation
+    // --------------------
+    GLFWwindow* window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, "LearnOpenGL", NULL, NULL);
+    if (window == NULL)
+    {
+        std::cout << "Failed to create GLFW window" << std::endl;
+        glfwTerminate();
+        return -1;
+    }
+    glfwMakeContextCurrent(window);
+    glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
+
+    // glad: load all OpenGL function pointers
+    // ---------------------------------------
+    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+    {
+        std::cout << "Failed to initialize GLAD" << std::endl;
+        return -1;
+    }
+
+    // one source pair for all variants; submit all four so the driver can compile them
+    // while we set up geometry and textures
+    // ------------------------------------
+    ShaderPermutations<BasicShaderFeatures> basic("../1_base/helper/basic.vs", "../1_base/helper/basic.fs");
+    basic.prefetch<COLORED>();
+    basic.prefetch<TEXTURED>();
+    basic.prefetch<TEXTURED2>();
+    basic.prefetch<TEXTURED2_COLORED>();
+
+    // set up vertex data (and buffer(s)) and configure vertex attributes
+    // ------------------------------------------------------------------
+    float vertices[] = {
+            // positions          // colors           // texture coords
+            0.5f,  0.5f, 0.0f,   1.0f, 0.0f, 0.0f,   1.0f, 1.0f, // top right
+            0.5f, -0.5f, 0.0f,   0.0f, 1.0f, 0.0f,   1.0f, 0.0f, // bottom right
+            -0.5f, -0.5f, 0.0f,   0.0f, 0.0f, 1.0f,   0.0f, 0.0f, // bottom left
+            -0.5f,  0.5f, 0.0f,   1.0f, 1.0f, 0.0f,   0.0f, 1.0f  // top left
+    };
+    unsigned int indices[] = {
+            0, 1, 3, // first triangle
+            1, 2, 3  // second triangle
+    };
+    unsigned int VBO, VAO, EBO, texturedVAO;
+    glGenVertexArrays(1, &VAO);
+    glGenVertexArrays(1, &texturedVAO);
+    glGenBuffers(1, &VBO);
+    glGenBuffers(1, &EBO);
+
+    glBindVertexArray(VAO);
+
+    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
+
+    // position attribute
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);
+    glEnableVertexAttribArray(0);
+    // color attribute
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));
+    glEnableVertexAttribArray(1);
+    // texture coord attribute
+    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));
+    glEnableVertexAttribArray(2);
+
+    /// 没有VERTEX_COLOR的变体在location 1读取纹理坐标，同一个VBO再配一个VAO
+    glBindVertexArray(texturedVAO);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));
+    glEnableVertexAttribArray(1);
+
+
+    // load and create a texture 
+    // -------------------------
+    unsigned int texture1, texture2;
+    // texture 1
+    // ---------
+    glGenTextures(1, &texture1);
+    glBindTexture(GL_TEXTURE_2D, texture1);
+    // set the texture wrapping parameters
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);	// set texture wrapping to GL_REPEAT (default wrapping method)
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    // set texture filtering parameters
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    // load image, create texture and generate mipmaps
+    int width, height, nrChannels;
+
+    /// 这是因为OpenGL要求y轴0.0坐标是在图片的底部的，但是图片的y轴0.0坐标通常在顶部。
+    /// 很幸运，stb_image.h能够在图像加载时帮助我们翻转y轴，只需要在加载任何图像前加入以下语句即可
+    stbi_set_flip_vertically_on_load(true); // tell stb_image.h to flip loaded texture's on the y-axis.
+    // The FileSystem::getPath(...) is part of the GitHub repository so we can find files on any IDE/platform; replace it with your own image path.
+    unsigned char *data = stbi_load("../res/container.jpeg", &width, &height, &nrChannels, 0);
+    if (data)
+    {
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, data);
+        glGenerateMipmap(GL_TEXTURE_2D);
+    }
+    else
+    {
+        std::cout << "Failed to load texture" << std::endl;
+    }
+    stbi_image_free(data);
+    // texture 2
+    // ---------
+    glGenTextures(1, &texture2);
+    glBindTexture(GL_TEXTURE_2D, texture2);
+    // set the texture wrapping parameters
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);	// set texture wrapping to GL_REPEAT (default wrapping method)
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    // set texture filtering parameters
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    // load image, create texture and generate mipmaps
+    data = stbi_load("../res/awesomeface.png", &width, &height, &nrChannels, 0);
+    if (data)
+    {
+        // note that the awesomeface.png has transparency and thus an alpha channel, so make sure to tell OpenGL the data type is of GL_RGBA
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
+        glGenerateMipmap(GL_TEXTURE_2D);
+    }
+    else
+    {
+        std::cout << "Failed to load texture" << std::endl;
+    }
+    stbi_image_free(data);
+
+    // first use of each variant: only now its status is read
+    // tell opengl for each sampler to which texture unit it belongs to (only has to be done once)
+    // -------------------------------------------------------------------------------------------
+    struct Quadrant
+    {
+        Shader* shader;
+        unsigned int vao;
+        UniformHandle transformLoc;
+        float x, y;
+    };
+    Quadrant quadrants[4] = {
+            { &basic.get<COLORED>(), VAO, UniformHandle(), -0.5f, 0.5f },
+            { &basic.get<TEXTURED>(), texturedVAO, UniformHandle(), 0.5f, 0.5f },
+            { &basic.get<TEXTURED2>(), texturedVAO, UniformHandle(), -0.5f, -0.5f },
+            { &basic.get<TEXTURED2_COLORED>(), VAO, UniformHandle(), 0.5f, -0.5f },
+    };
+    for (int i = 0; i < 4; ++i)
+    {
+        Shader& shader = *quadrants[i].shader;
+        shader.use();
+        // samplers a variant does not declare are not in its uniform table, the handle maps to -1
+        shader.setInt("texture1", 0);
+        shader.setInt("texture2", 1);
+        quadrants[i].transformLoc = shader.uniform("transform");
+    }
+    std::cout << "basic shader: " << basic.variantCount() << " variants built" << std::endl;
+
+    // shadow the bindings from here on so unchanged ones are not re-issued every frame
+    // -------------------------------------------------------------------------------
+    GLStateCache glState;
+
+    // render loop
+    // -----------
+    while (!glfwWindowShouldClose(window))
+    {
+        // input
+        // -----
+        processInput(window);
+
+        // render
+        // ------
+        glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT);
+
+        // bind textures on corresponding texture units
+        /// 纹理单元：一个纹理的位置的值，一个纹理的默认纹理单元是0，它是默认的激活纹理单元
+        /// 纹理单元的主要目的是让我们在着色器中可以使用多于一个为纹理，通过把纹理单元赋值给采样器，我们可以一次绑定多个纹理
+        /// 在绑定纹理前先激活纹理单元(glActiveTexture)，激活纹理单元后，glBindTexture就会绑定这个纹理到当前激活的纹理单元
+        /// glState只在绑定确实变化时才调用glActiveTexture/glBindTexture，绑定没变的帧不会产生任何驱动调用
+        glState.bindTextureUnit(0, GL_TEXTURE_2D, texture1);
+        glState.bindTextureUnit(1, GL_TEXTURE_2D, texture2);
+
+        // render containers, one variant per quadrant
+        for (int i = 0; i < 4; ++i)
+        {
+            glm::mat4 transform = glm::translate(glm::mat4(1.0f), glm::vec3(quadrants[i].x, quadrants[i].y, 0.0f));
+            transform = glm::scale(transform, glm::vec3(0.9f, 0.9f, 1.0f));
+            glState.useProgram(quadrants[i].shader->ID);
+            quadrants[i].shader->setMat4(quadrants[i].transformLoc, glm::value_ptr(transform));
+            glState.bindVertexArray(quadrants[i].vao);
+            glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+        }
+
+        // glfw: swap buffers and poll IO events (keys pressed/released, mouse moved etc.)
+        // -------------------------------------------------------------------------------
+        glfwSwapBuffers(window);
+        glfwPollEvents();
+    }
+
+    glState.printStats(std::cout);
+
+    // optional: de-allocate all resources once they've outlived their purpose:
+    // ------------------------------------------------------------------------
+    basic.release();
+    glDeleteVertexArrays(1, &VAO);
+    glDeleteVertexArrays(1, &texturedVAO);
+    glDeleteBuffers(1, &VBO);
+    glDeleteBuffers(1, &EBO);
+
+    // glfw: terminate, clearing all previously allocated GLFW resources.
+    // ------------------------------------------------------------------
+    glfwTerminate();
+    return 0;
+}
+
+// process all input: query GLFW whether relevant keys are pressed/released this frame and react accordingly
+// ---------------------------------------------------------------------------------------------------------
+void processInput(GLFWwindow *window)
+{
+    if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
+        glfwSetWindowShouldClose(window, true);
+}
+
+// glfw: whenever the window size changed (by OS or user resize) this callback function executes
+// ---------------------------------------------------------------------------------------------
+void framebuffer_size_callback(GLFWwindow* window, int width, int height)
+{
+    // make sure the viewport matches the new window dimensions; note that width and 
+    // height will be significantly larger than specified on retina displays.
+    glViewport(0, 0, width, height);
+}
\ No newline at end of file
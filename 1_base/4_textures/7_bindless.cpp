@@ -0,0 +1,242 @@
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <stb_image.h>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+
+#include <shader_s.h>
+#include <gl_state.h>
+#include <instanced_renderer.h>
+#include <batch_transform.h>
+#include <gl_ext.h>
+#include <bindless_textures.h>
+
+#include <iostream>
+#include <vector>
+
+void framebuffer_size_callback(GLFWwindow* window, int width, int height);
+void processInput(GLFWwindow *window);
+
+// settings
+const unsigned int SCR_WIDTH = 800;
+const unsigned int SCR_HEIGHT = 600;
+// GRID_SIZE * GRID_SIZE sprites
+const unsigned int GRID_SIZE = 128;
+// false always takes the array texture path, to compare the two
+const bool ALLOW_BINDLESS = true;
+
+int main()
+{
+    // glfw: initialize and configure
+    // ------------------------------
+    glfwInit();
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+#ifdef __APPLE__
+    glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+#endif
+
+    // glfw window creation
+    // --------------------
+    GLFWwindow* window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, "LearnOpenGL", NULL, NULL);
+    if (window == NULL)
+    {
+        std::cout << "Failed to create GLFW window" << std::endl;
+        glfwTerminate();
+        return -1;
+    }
+    glfwMakeContextCurrent(window);
+    glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
+
+    // glad: load all OpenGL function pointers
+    // ---------------------------------------
+    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+    {
+        std::cout << "Failed to initialize GLAD" << std::endl;
+        return -1;
+    }
+    loadGLExtensions((GLADloadproc)glfwGetProcAddress);
+
+    // set up vertex data (and buffer(s)) and configure vertex attributes
+    // ------------------------------------------------------------------
+    float vertices[] = {
+            // positions          // texture coords
+            0.5f,  0.5f, 0.0f,   1.0f, 1.0f, // top right
+            0.5f, -0.5f, 0.0f,   1.0f, 0.0f, // bottom right
+            -0.5f, -0.5f, 0.0f,   0.0f, 0.0f, // bottom left
+            -0.5f,  0.5f, 0.0f,   0.0f, 1.0f  // top left
+    };
+    unsigned int indices[] = {
+            0, 1, 3, // first triangle
+            1, 2, 3  // second triangle
+    };
+    unsigned int VBO, VAO, EBO;
+    glGenVertexArrays(1, &VAO);
+    glGenBuffers(1, &VBO);
+    glGenBuffers(1, &EBO);
+
+    glBindVertexArray(VAO);
+
+    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
+
+    // position attribute
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)0);
+    glEnableVertexAttribArray(0);
+
+    // texture coord attribute
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)(3 * sizeof(float)));
+    glEnableVertexAttribArray(1);
+
+    // per-instance transforms: one mat4 per quad in a second VBO on the same VAO
+    // --------------------------------------------------------------------------
+    InstancedRenderer quads(VAO, 6);
+
+    /// 每个实例的位置、初始角度、缩放以SoA数组保存，每帧由批量构建器写入映射的实例缓冲
+    const unsigned int instanceCount = GRID_SIZE * GRID_SIZE;
+    std::vector<float> posX(instanceCount), posY(instanceCount), posZ(instanceCount, 0.0f);
+    std::vector<float> angles(instanceCount), scales(instanceCount, 0.8f * 2.0f / GRID_SIZE);
+    float cell = 2.0f / GRID_SIZE;
+    for (unsigned int y = 0; y < GRID_SIZE; ++y)
+    {
+        for (unsigned int x = 0; x < GRID_SIZE; ++x)
+        {
+            posX[y * GRID_SIZE + x] = -1.0f + (x + 0.5f) * cell;
+            posY[y * GRID_SIZE + x] = -1.0f + (y + 0.5f) * cell;
+            angles[y * GRID_SIZE + x] = 0.01f * (x + y);
+        }
+    }
+    TransformBatchInput batch;
+    batch.x = &posX[0];
+    batch.y = &posY[0];
+    batch.z = &posZ[0];
+    batch.angle = &angles[0];
+    batch.scaleX = batch.scaleY = batch.scaleZ = &scales[0];
+    std::cout << "batch transform kernel: " << batchTransformKernel() << std::endl;
+
+    // every image gets a resident bindless handle, or a region of an array texture
+    // ----------------------------------------------------------------------------
+    /// 支持GL_ARB_bindless_texture时，每张图片是独立的纹理，它的64位句柄写进uniform块
+    /// 着色器按实例属性里的下标取句柄构造采样器，不再需要glActiveTexture/glBindTexture
+    /// 不支持时退回到数组纹理，实例数据的格式不变
+    BindlessTextureSet textures(1024, 1024);
+    textures.addFile("../res/container.jpeg");
+    textures.addFile("../res/awesomeface.png");
+    // a handful of small generated tiles, standing in for a real sprite set
+    for (int i = 0; i < 14; ++i)
+    {
+        int size = 32 + 16 * (i % 5);
+        std::vector<unsigned char> tile((size_t)size * size * 4);
+        for (int p = 0; p < size * size; ++p)
+        {
+            bool checker = ((p % size) / 8 + (p / size) / 8) % 2 == 0;
+            tile[p * 4 + 0] = (unsigned char)(checker ? 255 : 40 + 12 * i);
+            tile[p * 4 + 1] = (unsigned char)(checker ? 60 + 10 * i : 255);
+            tile[p * 4 + 2] = (unsigned char)(checker ? 200 : 0);
+            tile[p * 4 + 3] = 255;
+        }
+        textures.add(&tile[0], size, size);
+    }
+    if (textures.build(ALLOW_BINDLESS))
+        std::cout << textures.imageCount() << " bindless textures resident" << std::endl;
+    else
+        std::cout << textures.imageCount() << " images packed into " << textures.layerCount() << " layers" << std::endl;
+
+    // build and compile our shader zprogram
+    // ------------------------------------
+    /// 两条路径使用相同的实例属性，只有着色器不同
+    Shader ourShader(textures.bindless() ? "../1_base/4_textures/helper/shader_bindless.vs" : "../1_base/4_textures/helper/shader_array.vs",
+                     textures.bindless() ? "../1_base/4_textures/helper/shader_bindless.fs" : "../1_base/4_textures/helper/shader_array.fs");
+
+    std::vector<SpriteRegion> sprites(instanceCount);
+    for (unsigned int i = 0; i < instanceCount; ++i)
+        sprites[i] = textures.region((int)(i % textures.imageCount()));
+    quads.setSprites(&sprites[0], instanceCount);
+
+    if (!textures.bindless())
+    {
+        ourShader.use();
+        ourShader.setInt("sprites", 0);
+    }
+
+    // shadow the bindings from here on so unchanged ones are not re-issued every frame
+    // -------------------------------------------------------------------------------
+    GLStateCache glState;
+
+    // render loop
+    // -----------
+    while (!glfwWindowShouldClose(window))
+    {
+        // input
+        // -----
+        processInput(window);
+
+        // render
+        // ------
+        glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT);
+
+        // the handle block, or the array texture on unit 0
+        textures.bind(glState);
+
+        // create transformations
+        /// 每个实例：位移到网格中的位置，随时间旋转，再缩放到格子大小
+        /// 与glm::translate/rotate/scale链结果相同，直接写入映射的实例缓冲，不经过中间数组
+        batch.angleOffset = (float)glfwGetTime();
+        float* instanceData = quads.mapInstances(instanceCount);
+        if (instanceData)
+        {
+            buildTransforms(batch, instanceCount, instanceData);
+            quads.unmapInstances();
+        }
+
+        // render all sprites: no per-texture binds, one draw call
+        glState.useProgram(ourShader.ID);
+        quads.draw(glState);
+
+        // glfw: swap buffers and poll IO events (keys pressed/released, mouse moved etc.)
+        // -------------------------------------------------------------------------------
+        glfwSwapBuffers(window);
+        glfwPollEvents();
+    }
+
+    glState.printStats(std::cout);
+
+    // optional: de-allocate all resources once they've outlived their purpose:
+    // ------------------------------------------------------------------------
+    quads.release();
+    textures.release(&glState);
+    glDeleteVertexArrays(1, &VAO);
+    glDeleteBuffers(1, &VBO);
+    glDeleteBuffers(1, &EBO);
+
+    // glfw: terminate, clearing all previously allocated GLFW resources.
+    // ------------------------------------------------------------------
+    glfwTerminate();
+    return 0;
+}
+
+// process all input: query GLFW whether relevant keys are pressed/released this frame and react accordingly
+// ---------------------------------------------------------------------------------------------------------
+void processInput(GLFWwindow *window)
+{
+    if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
+        glfwSetWindowShouldClose(window, true);
+}
+
+// glfw: whenever the window size changed (by OS or user resize) this callback function executes
+// ---------------------------------------------------------------------------------------------
+void framebuffer_size_callback(GLFWwindow* window, int width, int height)
+{
+    // make sure the viewport matches the new window dimensions; note that width and 
+    // height will be significantly larger than specified on retina displays.
+    glViewport(0, 0, width, height);
+}
\ No newline at end of file
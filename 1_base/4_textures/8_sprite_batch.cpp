@@ -0,0 +1,250 @@
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <stb_image.h>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include <shader_s.h>
+#include <gl_ext.h>
+#include <gl_state.h>
+#include <stream_ring.h>
+#include <sprite_batch.h>
+
+#include <iostream>
+#include <vector>
+#include <cstdlib>
+
+/**
+ * 2D界面里成千上万个带纹理的四边形，不再每个四边形一个VAO、一次绘制：
+ * SpriteBatch把四边形的顶点先写进CPU上的暂存数组，纹理或着色器切换、数组写满或end()时
+ * 才把整批顶点拷进StreamRing并用一次glDrawElementsBaseVertex画出来，
+ * 所有批次共用同一个预先生成好的静态索引缓冲。
+ * 按纹理排序提交时一帧只需要几次绘制；INTERLEAVE_TEXTURES为true时每个精灵都换纹理，
+ * 可以对比每帧的批次数。
+ */
+
+void framebuffer_size_callback(GLFWwindow* window, int width, int height);
+void processInput(GLFWwindow *window);
+unsigned int loadTexture(const char* path);
+
+// settings
+const unsigned int SCR_WIDTH = 800;
+const unsigned int SCR_HEIGHT = 600;
+const unsigned int SPRITE_COUNT = 40000;
+// alternate the two textures sprite by sprite: every quad becomes its own batch
+const bool INTERLEAVE_TEXTURES = false;
+
+struct Sprite
+{
+    float x, y;
+    float vx, vy;
+    float size;
+    uint32_t color;
+};
+
+int main()
+{
+    // glfw: initialize and configure
+    // ------------------------------
+    glfwInit();
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+#ifdef __APPLE__
+    glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+#endif
+
+    // glfw window creation
+    // --------------------
+    GLFWwindow* window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, "LearnOpenGL", NULL, NULL);
+    if (window == NULL)
+    {
+        std::cout << "Failed to create GLFW window" << std::endl;
+        glfwTerminate();
+        return -1;
+    }
+    glfwMakeContextCurrent(window);
+    glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
+    // vsync off, so the frame time shows what the batching costs
+    glfwSwapInterval(0);
+
+    // glad: load all OpenGL function pointers
+    // ---------------------------------------
+    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+    {
+        std::cout << "Failed to initialize GLAD" << std::endl;
+        return -1;
+    }
+    loadGLExtensions((GLADloadproc)glfwGetProcAddress);
+
+    // build and compile our shader zprogram
+    // ------------------------------------
+    Shader spriteShader("../1_base/4_textures/helper/sprite_batch.vs", "../1_base/4_textures/helper/sprite_batch.fs");
+
+    // textures
+    // --------
+    unsigned int textures[2];
+    textures[0] = loadTexture("../res/container.jpeg");
+    textures[1] = loadTexture("../res/awesomeface.png");
+
+    // sprites bouncing around the window, in pixels
+    // ---------------------------------------------
+    std::vector<Sprite> sprites(SPRITE_COUNT);
+    srand(1);
+    for (unsigned int i = 0; i < SPRITE_COUNT; ++i)
+    {
+        Sprite& sprite = sprites[i];
+        sprite.size = 6.0f + (float)(rand() % 20);
+        sprite.x = (float)(rand() % (int)(SCR_WIDTH - sprite.size));
+        sprite.y = (float)(rand() % (int)(SCR_HEIGHT - sprite.size));
+        sprite.vx = (float)(rand() % 200 - 100);
+        sprite.vy = (float)(rand() % 200 - 100);
+        sprite.color = SpriteBatch::rgba((unsigned char)(128 + rand() % 128), (unsigned char)(128 + rand() % 128),
+                                         (unsigned char)(128 + rand() % 128), 255);
+    }
+
+    // one ring segment holds a frame of vertices: 4 per quad, plus one vertex of
+    // alignment per flush, which is every quad when the textures are interleaved
+    // -----------------------------------------------------------------------------
+    StreamRing ring(SPRITE_COUNT * 5 * sizeof(SpriteVertex));
+    std::cout << "stream ring: " << (ring.persistent() ? "persistent mapping" : "unsynchronized map per flush") << std::endl;
+    SpriteBatch batch(ring);
+
+    spriteShader.use();
+    spriteShader.setInt("ourTexture", 0);
+    glm::mat4 projection = glm::ortho(0.0f, (float)SCR_WIDTH, 0.0f, (float)SCR_HEIGHT, -1.0f, 1.0f);
+    glUniformMatrix4fv(glGetUniformLocation(spriteShader.ID, "projection"), 1, GL_FALSE, glm::value_ptr(projection));
+
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+    // shadow the bindings from here on so unchanged ones are not re-issued every frame
+    // -------------------------------------------------------------------------------
+    GLStateCache glState;
+
+    double lastTime = glfwGetTime(), lastReport = lastTime;
+    // render loop
+    // -----------
+    while (!glfwWindowShouldClose(window))
+    {
+        // input
+        // -----
+        processInput(window);
+
+        double now = glfwGetTime();
+        float dt = (float)(now - lastTime);
+        lastTime = now;
+        for (unsigned int i = 0; i < SPRITE_COUNT; ++i)
+        {
+            Sprite& sprite = sprites[i];
+            sprite.x += sprite.vx * dt;
+            sprite.y += sprite.vy * dt;
+            if (sprite.x < 0.0f || sprite.x + sprite.size > SCR_WIDTH)
+                sprite.vx = -sprite.vx;
+            if (sprite.y < 0.0f || sprite.y + sprite.size > SCR_HEIGHT)
+                sprite.vy = -sprite.vy;
+        }
+
+        // render
+        // ------
+        glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT);
+
+        /// 先画完一种纹理的所有精灵再画另一种，每种纹理只有SPRITE_COUNT / MAX_QUADS个批次
+        ring.beginFrame();
+        batch.begin(glState, spriteShader.ID);
+        for (unsigned int pass = 0; pass < (INTERLEAVE_TEXTURES ? 1u : 2u); ++pass)
+        {
+            for (unsigned int i = 0; i < SPRITE_COUNT; ++i)
+            {
+                unsigned int texture = textures[i % 2];
+                if (!INTERLEAVE_TEXTURES && i % 2 != pass)
+                    continue;
+                const Sprite& sprite = sprites[i];
+                batch.draw(texture, sprite.x, sprite.y, sprite.size, sprite.size, 0.0f, 0.0f, 1.0f, 1.0f, sprite.color);
+            }
+        }
+        batch.end();
+        // fence the segment after the last draw that reads it
+        ring.endFrame();
+
+        if (now - lastReport >= 1.0)
+        {
+            const SpriteBatch::Stats& stats = batch.frameStats();
+            std::cout << stats.quads << " quads, " << stats.batches << " batches (texture " << stats.textureFlushes
+                      << ", program " << stats.programFlushes << ", capacity " << stats.capacityFlushes << "), "
+                      << stats.dropped << " dropped" << std::endl;
+            lastReport = now;
+        }
+
+        // glfw: swap buffers and poll IO events (keys pressed/released, mouse moved etc.)
+        // -------------------------------------------------------------------------------
+        glfwSwapBuffers(window);
+        glfwPollEvents();
+    }
+
+    batch.printStats(std::cout);
+    const StreamRing::Stats& ringStats = ring.statistics();
+    std::cout << "stream ring: " << ringStats.frames << " frames, " << ringStats.bytes << " bytes, "
+              << ringStats.stalls << " stalls, " << ringStats.overflows << " overflows" << std::endl;
+    glState.printStats(std::cout);
+
+    // optional: de-allocate all resources once they've outlived their purpose:
+    // ------------------------------------------------------------------------
+    batch.release(&glState);
+    ring.release();
+    glDeleteTextures(2, textures);
+    glDeleteProgram(spriteShader.ID);
+
+    // glfw: terminate, clearing all previously allocated GLFW resources.
+    // ------------------------------------------------------------------
+    glfwTerminate();
+    return 0;
+}
+
+// load an image into a new RGBA texture with mipmaps
+// ---------------------------------------------------
+unsigned int loadTexture(const char* path)
+{
+    unsigned int texture;
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    int width, height, nrChannels;
+    stbi_set_flip_vertically_on_load(true);
+    unsigned char *data = stbi_load(path, &width, &height, &nrChannels, 4);
+    if (data)
+    {
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
+        glGenerateMipmap(GL_TEXTURE_2D);
+    }
+    else
+    {
+        std::cout << "Failed to load texture " << path << std::endl;
+    }
+    stbi_image_free(data);
+    return texture;
+}
+
+// process all input: query GLFW whether relevant keys are pressed/released this frame and react accordingly
+// ---------------------------------------------------------------------------------------------------------
+void processInput(GLFWwindow *window)
+{
+    if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
+        glfwSetWindowShouldClose(window, true);
+}
+
+// glfw: whenever the window size changed (by OS or user resize) this callback function executes
+// ---------------------------------------------------------------------------------------------
+void framebuffer_size_callback(GLFWwindow* window, int width, int height)
+{
+    // make sure the viewport matches the new window dimensions; note that width and
+    // height will be significantly larger than specified on retina displays.
+    glViewport(0, 0, width, height);
+}
@@ -0,0 +1,240 @@
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <stb_image.h>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include <shader_s.h>
+#include <gl_ext.h>
+#include <gl_state.h>
+#include <mapped_file.h>
+#include <stream_ring.h>
+#include <sprite_batch.h>
+#include <profiler.h>
+#include <texture_residency.h>
+
+#include <iostream>
+#include <vector>
+#include <cmath>
+
+/**
+ * 一大片纹理不能全部常驻显存：TextureResidency按预算管理每张纹理占用的显存。
+ * 添加时只上传32x32以下的小mip，保证马上就能画；之后每帧给这一帧用到的纹理从模糊到清晰
+ * 逐级补上更大的mip（GL_TEXTURE_BASE_LEVEL随之下移），放不下时把最久没用过的纹理的最大一级丢掉。
+ * 镜头在8x8的纹理网格上来回平移，只有看得见的格子算“用到”，离开视野的格子慢慢变回模糊。
+ * 烘焙好的纹理一直映射着，作为换入时的数据来源；驻留情况作为计数器交给Profiler。
+ */
+
+void framebuffer_size_callback(GLFWwindow* window, int width, int height);
+void processInput(GLFWwindow *window);
+
+// settings
+const unsigned int SCR_WIDTH = 800;
+const unsigned int SCR_HEIGHT = 600;
+const unsigned int GRID = 8;
+const float TILE = 256.0f;
+// about a screen of complete textures, less than the 64 of them need
+const uint64_t TEXTURE_BUDGET = 12u << 20;
+// per frame, so streaming never costs a long frame
+const uint64_t UPLOAD_BUDGET = 2u << 20;
+
+int main()
+{
+    // glfw: initialize and configure
+    // ------------------------------
+    glfwInit();
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+#ifdef __APPLE__
+    glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+#endif
+
+    // glfw window creation
+    // --------------------
+    GLFWwindow* window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, "LearnOpenGL", NULL, NULL);
+    if (window == NULL)
+    {
+        std::cout << "Failed to create GLFW window" << std::endl;
+        glfwTerminate();
+        return -1;
+    }
+    glfwMakeContextCurrent(window);
+    glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
+
+    // glad: load all OpenGL function pointers
+    // ---------------------------------------
+    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+    {
+        std::cout << "Failed to initialize GLAD" << std::endl;
+        return -1;
+    }
+    loadGLExtensions((GLADloadproc)glfwGetProcAddress);
+
+    // build and compile our shader zprogram
+    // ------------------------------------
+    Shader spriteShader("../1_base/4_textures/helper/sprite_batch.vs", "../1_base/4_textures/helper/sprite_batch.fs");
+
+    // the cooked textures stay mapped, levels are streamed from them (cook_textures target)
+    // -------------------------------------------------------------------------------------
+    MappedFile sources[2];
+    if (!sources[0].open("cooked/container.oritex") || !sources[1].open("cooked/awesomeface.oritex"))
+    {
+        std::cout << "ERROR::TEXTURE_RESIDENCY::COOKED_TEXTURES_MISSING build the cook_textures target" << std::endl;
+        glfwTerminate();
+        return -1;
+    }
+    TextureResidency textures(TEXTURE_BUDGET, UPLOAD_BUDGET);
+    std::vector<TextureResidency::Handle> tiles(GRID * GRID);
+    for (unsigned int i = 0; i < GRID * GRID; ++i)
+    {
+        const MappedFile& source = sources[(i + i / GRID) % 2];
+        tiles[i] = textures.add(source.data(), source.size(), GL_CLAMP_TO_EDGE);
+        if (tiles[i] == TextureResidency::INVALID)
+        {
+            glfwTerminate();
+            return -1;
+        }
+    }
+
+    // a texture built the usual way, handed over so its whole mip chain is accounted
+    // ------------------------------------------------------------------------------
+    unsigned int marker;
+    glGenTextures(1, &marker);
+    glBindTexture(GL_TEXTURE_2D, marker);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    int width = 1, height = 1, nrChannels;
+    stbi_set_flip_vertically_on_load(true);
+    unsigned char *data = stbi_load("../res/awesomeface.png", &width, &height, &nrChannels, 4);
+    if (data)
+    {
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
+        glGenerateMipmap(GL_TEXTURE_2D);
+    }
+    else
+    {
+        std::cout << "Failed to load texture" << std::endl;
+    }
+    stbi_image_free(data);
+    TextureResidency::Handle markerHandle = textures.track(marker, width, height, 4, true);
+    std::cout << "texture residency: " << textures.size() << " textures, " << (textures.residentBytes() >> 10)
+              << " KB resident after adding, budget " << (TEXTURE_BUDGET >> 10) << " KB" << std::endl;
+
+    StreamRing ring((GRID * GRID + 1) * 5 * sizeof(SpriteVertex));
+    SpriteBatch batch(ring);
+    spriteShader.use();
+    spriteShader.setInt("ourTexture", 0);
+    int projectionLoc = glGetUniformLocation(spriteShader.ID, "projection");
+
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+    // shadow the bindings from here on so unchanged ones are not re-issued every frame
+    // -------------------------------------------------------------------------------
+    GLStateCache glState;
+    Profiler profiler;
+
+    double lastReport = glfwGetTime();
+    // render loop
+    // -----------
+    while (!glfwWindowShouldClose(window))
+    {
+        // input
+        // -----
+        processInput(window);
+        profiler.beginFrame();
+
+        // render
+        // ------
+        glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT);
+
+        /// 镜头在整个网格上慢慢平移
+        float time = (float)glfwGetTime();
+        float world = GRID * TILE;
+        float left = (world - SCR_WIDTH) * 0.5f * (1.0f + std::sin(time * 0.3f));
+        float bottom = (world - SCR_HEIGHT) * 0.5f * (1.0f + std::sin(time * 0.23f));
+        glm::mat4 projection = glm::ortho(left, left + SCR_WIDTH, bottom, bottom + SCR_HEIGHT, -1.0f, 1.0f);
+        glState.useProgram(spriteShader.ID);
+        glUniformMatrix4fv(projectionLoc, 1, GL_FALSE, glm::value_ptr(projection));
+
+        ring.beginFrame();
+        batch.begin(glState, spriteShader.ID);
+        {
+            ProfileScope scope(profiler, "tiles");
+            for (unsigned int i = 0; i < GRID * GRID; ++i)
+            {
+                float x = (i % GRID) * TILE, y = (i / GRID) * TILE;
+                // only what is on screen counts as used; the rest is left to be evicted
+                if (x + TILE < left || x > left + SCR_WIDTH || y + TILE < bottom || y > bottom + SCR_HEIGHT)
+                    continue;
+                batch.draw(textures.use(tiles[i]), x, y, TILE, TILE);
+            }
+            batch.draw(textures.use(markerHandle), left + 8.0f, bottom + 8.0f, 64.0f, 64.0f);
+            batch.end();
+        }
+        ring.endFrame();
+
+        // stream and evict for what this frame used
+        // -----------------------------------------
+        {
+            ProfileScope scope(profiler, "residency");
+            textures.update(glState);
+        }
+        textures.report(profiler);
+
+        double now = glfwGetTime();
+        if (now - lastReport >= 1.0)
+        {
+            const TextureResidency::Stats& stats = textures.statistics();
+            std::cout << (stats.residentBytes >> 10) << " / " << (stats.budgetBytes >> 10) << " KB, "
+                      << stats.fullyResident << " of " << stats.textures << " complete"
+                      << (stats.overBudget ? ", over budget" : "") << std::endl;
+            lastReport = now;
+        }
+
+        profiler.endFrame();
+        // glfw: swap buffers and poll IO events (keys pressed/released, mouse moved etc.)
+        // -------------------------------------------------------------------------------
+        glfwSwapBuffers(window);
+        glfwPollEvents();
+    }
+
+    textures.printStats(std::cout);
+    profiler.printHistogram(std::cout);
+    glState.printStats(std::cout);
+
+    // optional: de-allocate all resources once they've outlived their purpose:
+    // ------------------------------------------------------------------------
+    textures.release(&glState);
+    batch.release(&glState);
+    ring.release();
+    profiler.release();
+    glDeleteProgram(spriteShader.ID);
+
+    // glfw: terminate, clearing all previously allocated GLFW resources.
+    // ------------------------------------------------------------------
+    glfwTerminate();
+    return 0;
+}
+
+// process all input: query GLFW whether relevant keys are pressed/released this frame and react accordingly
+// ---------------------------------------------------------------------------------------------------------
+void processInput(GLFWwindow *window)
+{
+    if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
+        glfwSetWindowShouldClose(window, true);
+}
+
+// glfw: whenever the window size changed (by OS or user resize) this callback function executes
+// ---------------------------------------------------------------------------------------------
+void framebuffer_size_callback(GLFWwindow* window, int width, int height)
+{
+    // make sure the viewport matches the new window dimensions; note that width and
+    // height will be significantly larger than specified on retina displays.
+    glViewport(0, 0, width, height);
+}
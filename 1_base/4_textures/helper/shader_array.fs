@@ -0,0 +1,11 @@
+#version 330 core
+out vec4 FragColor;
+
+in vec3 TexCoord;
+// 数组纹理：所有图块都在同一个纹理对象里，一次绑定即可
+uniform sampler2DArray sprites;
+
+void main()
+{
+    FragColor = texture(sprites, TexCoord);
+}
\ No newline at end of file
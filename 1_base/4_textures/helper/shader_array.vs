@@ -0,0 +1,16 @@
+#version 330 core
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec2 aTexCoord;
+// 每个实例的变换矩阵(location 2~5)和它在数组纹理中的区域
+layout (location = 2) in mat4 aTransform;
+layout (location = 6) in vec4 aUVRect;
+layout (location = 7) in float aLayer;
+
+out vec3 TexCoord;
+
+void main()
+{
+    gl_Position = aTransform * vec4(aPos, 1.0f);
+    // 把四边形的0~1纹理坐标映射到图块所在的区域，z是数组纹理的层
+    TexCoord = vec3(aUVRect.xy + aTexCoord * aUVRect.zw, aLayer);
+}
\ No newline at end of file
@@ -0,0 +1,22 @@
+#version 330 core
+#extension GL_ARB_bindless_texture : require
+// 同一次绘制中不同实例使用不同的句柄，需要NV_gpu_shader5
+#extension GL_NV_gpu_shader5 : enable
+out vec4 FragColor;
+
+in vec2 TexCoord;
+flat in uint TextureIndex;
+
+// 常驻的纹理句柄，每个uvec4存两个64位句柄(std140数组元素按16字节对齐)
+layout (std140) uniform TextureHandleBlock
+{
+    uvec4 handles[1024];
+};
+
+void main()
+{
+    // 直接从句柄构造采样器，不需要纹理单元和glBindTexture
+    uvec4 pair = handles[TextureIndex >> 1u];
+    uvec2 handle = (TextureIndex & 1u) == 0u ? pair.xy : pair.zw;
+    FragColor = texture(sampler2D(handle), TexCoord);
+}
@@ -0,0 +1,18 @@
+#version 330 core
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec2 aTexCoord;
+// 与shader_array.vs相同的实例属性，但aLayer在这里是纹理句柄的下标
+layout (location = 2) in mat4 aTransform;
+layout (location = 6) in vec4 aUVRect;
+layout (location = 7) in float aLayer;
+
+out vec2 TexCoord;
+// 整数不能插值，必须是flat
+flat out uint TextureIndex;
+
+void main()
+{
+    gl_Position = aTransform * vec4(aPos, 1.0f);
+    TexCoord = aUVRect.xy + aTexCoord * aUVRect.zw;
+    TextureIndex = uint(aLayer + 0.5f);
+}
@@ -8,6 +8,13 @@
 
 
 #include <shader_s.h>
+#include <shader_batch.h>
+#include <shader_reloader.h>
+#include <gl_ext.h>
+#include <gl_state.h>
+#include <profiler.h>
+#include <render_target.h>
+#include <frame_pacer.h>
 
 #include <iostream>
 
@@ -17,6 +24,14 @@ void processInput(GLFWwindow *window);
 // settings
 const unsigned int SCR_WIDTH = 800;
 const unsigned int SCR_HEIGHT = 600;
+// the scene is drawn offscreen, multisampled and at a scale of the window resolution
+// that follows the GPU frame time
+const int MSAA_SAMPLES = 4;
+const float GPU_BUDGET_MS = 14.0f;
+const float MIN_RENDER_SCALE = 0.5f;
+// vsync, adaptive, uncapped or a fixed cap; the CPU runs at most 2 frames ahead
+const FramePacer::Mode PACING_MODE = FramePacer::VSYNC;
+const double FRAME_CAP_HZ = 120.0;
 
 int main()
 {
@@ -50,10 +65,14 @@ int main()
         std::cout << "Failed to initialize GLAD" << std::endl;
         return -1;
     }
+    loadGLExtensions((GLADloadproc)glfwGetProcAddress);
 
-    // build and compile our shader zprogram
+    // submit our shader zprogram, linked binaries are kept in shader_cache/ so the second
+    // run skips compiling. the driver compiles while we set up geometry and textures
     // ------------------------------------
-    Shader ourShader("../1_base/5_transformations/helper/shader.vs", "../1_base/5_transformations/helper/shader_texture2.fs");
+    ProgramCache programCache("shader_cache");
+    ShaderBatch shaders(&programCache);
+    int ourShaderIndex = shaders.add("../1_base/5_transformations/helper/shader.vs", "../1_base/5_transformations/helper/shader_texture2.fs");
 
     // set up vertex data (and buffer(s)) and configure vertex attributes
     // ------------------------------------------------------------------
@@ -141,31 +160,81 @@ int main()
     }
     stbi_image_free(data);
 
+    // first use of the program: only now its status is read
+    // ------------------------------------------------------
+    Shader& ourShader = shaders.get(ourShaderIndex);
+    std::cout << "shaders: blocked " << shaders.blockedMs() << " ms waiting for the driver" << std::endl;
+
     // tell opengl for each sampler to which texture unit it belongs to (only has to be done once)
     // -------------------------------------------------------------------------------------------
     ourShader.use();
     ourShader.setInt("texture1", 0);
     ourShader.setInt("texture2", 1);
-
+    ///在渲染循环外查询一次uniform，循环内只使用句柄
+    UniformHandle transformLoc = ourShader.uniform("transform");
+
+    // shadow the bindings from here on so unchanged ones are not re-issued every frame
+    // -------------------------------------------------------------------------------
+    GLStateCache glState;
+
+    // edit helper/shader.vs or shader_texture2.fs while running: the program is rebuilt
+    // in the background and swapped in at the start of a frame, errors keep the old one
+    // ---------------------------------------------------------------------------------
+    ShaderReloader reloader(&glState);
+    /// 重新链接后uniform的值会丢失，只设置一次的采样器单元要在回调里重新设置
+    reloader.add(ourShader, "../1_base/5_transformations/helper/shader.vs", "../1_base/5_transformations/helper/shader_texture2.fs",
+                 [](Shader& shader) {
+                     shader.use();
+                     shader.setInt("texture1", 0);
+                     shader.setInt("texture2", 1);
+                 });
+    std::cout << "shader hot reload: " << reloader.backend() << std::endl;
+
+    // cpu/gpu timings per pass, the overlay shows the frame times in the bottom left corner
+    // -------------------------------------------------------------------------------------
+    Profiler profiler;
+    profiler.setTracing(true);
+
+    // offscreen scene target, allocated on the first frame and after resizes
+    // ----------------------------------------------------------------------
+    /// 高分屏上填充率是瓶颈：场景先画到较小的离屏帧缓冲里，再用glBlitFramebuffer放大到窗口
+    RenderTarget sceneTarget(MSAA_SAMPLES, false);
+    DynamicResolution resolution(GPU_BUDGET_MS, MIN_RENDER_SCALE, 1.0f);
+    unsigned int resolvedFrames = 0;
+
+    // swap interval, frame cap, frames in flight and input to GPU latency
+    // -------------------------------------------------------------------
+    FramePacer pacer(window, PACING_MODE, FRAME_CAP_HZ, 2);
 
     // render loop
     // -----------
     while (!glfwWindowShouldClose(window))
     {
-        // input
-        // -----
+        // wait and sleep first, then read the input as late as possible
+        // ---------------------------------------------------------------
+        /// 先等待GPU、睡到下一帧的时间点，再读取输入，这样输入到画面的延迟最短
+        pacer.beginFrame();
+        pacer.pollInput();
         processInput(window);
+        reloader.update();
+        profiler.beginFrame();
+
+        int framebufferWidth, framebufferHeight;
+        glfwGetFramebufferSize(window, &framebufferWidth, &framebufferHeight);
+        sceneTarget.begin(glState, framebufferWidth, framebufferHeight);
 
         // render
         // ------
+        int pass = profiler.begin("clear");
         glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
         glClear(GL_COLOR_BUFFER_BIT);
+        profiler.end(pass);
 
         // bind textures on corresponding texture units
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, texture1);
-        glActiveTexture(GL_TEXTURE1);
-        glBindTexture(GL_TEXTURE_2D, texture2);
+        pass = profiler.begin("bind textures");
+        glState.bindTextureUnit(0, GL_TEXTURE_2D, texture1);
+        glState.bindTextureUnit(1, GL_TEXTURE_2D, texture2);
+        profiler.end(pass);
 
         // create transformations
 
@@ -183,26 +252,55 @@ int main()
         trans = glm::scale(trans, glm::vec3(0.5, 0.5, 0.5));
 
         // get matrix's uniform location and set matrix
-        ourShader.use();
+        glState.useProgram(ourShader.ID);
         ///在把位置向量传给gl_Position之前，我们先添加一个uniform，并且将其与变换矩阵相乘
-        unsigned int transformLoc = glGetUniformLocation(ourShader.ID, "transform");
         /// 用有Matrix4fv后缀的glUniform函数把矩阵数据发送给着色器
         /// 第一个参数你现在应该很熟悉了，它是uniform的位置值
         /// 第二个参数告诉OpenGL我们将要发送多少个矩阵，这里是1
         /// 第三个参数询问我们是否希望对我们的矩阵进行转置(Transpose)，也就是说交换我们矩阵的行和列
         /// 最后一个参数是真正的矩阵数据。但GLM并不是把它们的矩阵储存为OpenGL所希望接受的那种，因此我们要先用GLM的自带的函数value_ptr来变换这些数据
-        glUniformMatrix4fv(transformLoc, 1, GL_FALSE, glm::value_ptr(transform));
+        ourShader.setMat4(transformLoc, glm::value_ptr(transform));
 
         // render container
-        glBindVertexArray(VAO);
+        pass = profiler.begin("draw");
+        glState.bindVertexArray(VAO);
         glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
-
-        // glfw: swap buffers and poll IO events (keys pressed/released, mouse moved etc.)
-        // -------------------------------------------------------------------------------
-        glfwSwapBuffers(window);
-        glfwPollEvents();
+        profiler.end(pass);
+
+        // resolve the samples and scale up into the window, the overlay stays sharp
+        pass = profiler.begin("present");
+        sceneTarget.present(framebufferWidth, framebufferHeight);
+        profiler.end(pass);
+
+        profiler.drawOverlay(framebufferWidth, framebufferHeight);
+        profiler.endFrame();
+
+        // a new GPU frame time arrives a few frames late, the next frames use its scale
+        const Profiler::ScopeHistory* frameScope = profiler.scope("frame");
+        if (frameScope && frameScope->count != resolvedFrames)
+        {
+            resolvedFrames = frameScope->count;
+            sceneTarget.setScale(resolution.update(frameScope->gpuMs[(resolvedFrames - 1) % Profiler::HISTORY]));
+        }
+
+        // glfw: swap buffers; IO events are polled at the top of the next frame
+        // ---------------------------------------------------------------------
+        pacer.present();
     }
 
+    pacer.printStats(std::cout);
+    pacer.release();
+    glState.printStats(std::cout);
+    programCache.printStats(std::cout);
+    profiler.printHistogram(std::cout);
+    profiler.writeChromeTrace("profile_trace.json");
+    profiler.release();
+    const RenderTarget::Stats& targetStats = sceneTarget.statistics();
+    std::cout << "render target: " << sceneTarget.sampleCount() << "x MSAA, final scale " << sceneTarget.scale() << ", "
+              << targetStats.scaledFrames << " of " << targetStats.frames << " frames scaled, " << targetStats.reallocations
+              << " allocations" << std::endl;
+    sceneTarget.release();
+
     // optional: de-allocate all resources once they've outlived their purpose:
     // ------------------------------------------------------------------------
     glDeleteVertexArrays(1, &VAO);
@@ -229,5 +327,6 @@ void framebuffer_size_callback(GLFWwindow* window, int width, int height)
 {
     // make sure the viewport matches the new window dimensions; note that width and 
     // height will be significantly larger than specified on retina displays.
+    // the scene target picks the new size up on its next begin()
     glViewport(0, 0, width, height);
 }
\ No newline at end of file
@@ -0,0 +1,273 @@
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <stb_image.h>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+
+#include <shader_s.h>
+#include <gl_ext.h>
+#include <gl_state.h>
+#include <stream_ring.h>
+#include <uniform_block.h>
+#include <render_queue.h>
+#include <alloc_counter.h>
+
+#include <iostream>
+#include <vector>
+#include <cstring>
+#include <cmath>
+
+void framebuffer_size_callback(GLFWwindow* window, int width, int height);
+void processInput(GLFWwindow *window);
+
+// settings
+const unsigned int SCR_WIDTH = 800;
+const unsigned int SCR_HEIGHT = 600;
+const unsigned int GRID_SIZE = 16;
+// frames before the per-frame containers reached their final size
+const unsigned long WARMUP_FRAMES = 3;
+
+int main()
+{
+    // glfw: initialize and configure
+    // ------------------------------
+    glfwInit();
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+#ifdef __APPLE__
+    glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+#endif
+
+    // glfw window creation
+    // --------------------
+    GLFWwindow* window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, "LearnOpenGL", NULL, NULL);
+    if (window == NULL)
+    {
+        std::cout << "Failed to create GLFW window" << std::endl;
+        glfwTerminate();
+        return -1;
+    }
+    glfwMakeContextCurrent(window);
+    glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
+
+    // glad: load all OpenGL function pointers
+    // ---------------------------------------
+    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+    {
+        std::cout << "Failed to initialize GLAD" << std::endl;
+        return -1;
+    }
+    loadGLExtensions((GLADloadproc)glfwGetProcAddress);
+
+    // two programs, both read FrameBlock (binding 0) and ObjectBlock (binding 1):
+    // the blocks are bound to their binding points when the programs are linked
+    // ------------------------------------
+    Shader textured("../1_base/5_transformations/helper/shader_blocks.vs", "../1_base/5_transformations/helper/shader_blocks.fs");
+    Shader pulsing("../1_base/5_transformations/helper/shader_blocks.vs", "../1_base/5_transformations/helper/shader_blocks_pulse.fs");
+
+    // set up vertex data (and buffer(s)) and configure vertex attributes
+    // ------------------------------------------------------------------
+    float vertices[] = {
+            // positions          // texture coords
+            0.5f,  0.5f, 0.0f,   1.0f, 1.0f, // top right
+            0.5f, -0.5f, 0.0f,   1.0f, 0.0f, // bottom right
+            -0.5f, -0.5f, 0.0f,   0.0f, 0.0f, // bottom left
+            -0.5f,  0.5f, 0.0f,   0.0f, 1.0f  // top left
+    };
+    unsigned int indices[] = {
+            0, 1, 3, // first triangle
+            1, 2, 3  // second triangle
+    };
+    unsigned int VBO, VAO, EBO;
+    glGenVertexArrays(1, &VAO);
+    glGenBuffers(1, &VBO);
+    glGenBuffers(1, &EBO);
+
+    glBindVertexArray(VAO);
+
+    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
+
+    // position attribute
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)0);
+    glEnableVertexAttribArray(0);
+
+    // texture coord attribute
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)(3 * sizeof(float)));
+    glEnableVertexAttribArray(1);
+
+    // load and create a texture
+    // -------------------------
+    unsigned int texture1;
+    glGenTextures(1, &texture1);
+    glBindTexture(GL_TEXTURE_2D, texture1);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    int width, height, nrChannels;
+    stbi_set_flip_vertically_on_load(true); // tell stb_image.h to flip loaded texture's on the y-axis.
+    unsigned char *data = stbi_load("../res/container.jpeg", &width, &height, &nrChannels, 0);
+    if (data)
+    {
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, data);
+        glGenerateMipmap(GL_TEXTURE_2D);
+    }
+    else
+    {
+        std::cout << "Failed to load texture" << std::endl;
+    }
+    stbi_image_free(data);
+
+    textured.use();
+    textured.setInt("texture1", 0);
+
+    // per-object data: one ObjectBlock per quad, spaced so every block starts on a
+    // valid glBindBufferRange offset
+    // ---------------------------------------------------------------------------
+    const unsigned int objectCount = GRID_SIZE * GRID_SIZE;
+    const size_t uniformAlignment = StreamRing::uniformAlignment();
+    const size_t objectStride = uniformBlockStride(sizeof(ObjectBlock), uniformAlignment);
+    StreamRing ring(uniformBlockStride(sizeof(FrameBlock), uniformAlignment) + objectStride * objectCount);
+    std::vector<ObjectBlock> objects(objectCount);
+    float cell = 2.0f / GRID_SIZE;
+    for (unsigned int i = 0; i < objectCount; ++i)
+    {
+        float x = -1.0f + (i % GRID_SIZE + 0.5f) * cell;
+        float y = -1.0f + (i / GRID_SIZE + 0.5f) * cell;
+        objects[i].model = glm::scale(glm::translate(glm::mat4(1.0f), glm::vec3(x, y, 0.0f)), glm::vec3(cell * 0.8f));
+        objects[i].color = glm::vec4((float)(i % GRID_SIZE) / GRID_SIZE, (float)(i / GRID_SIZE) / GRID_SIZE, 1.0f, 1.0f);
+    }
+
+    // shadow the bindings from here on so unchanged ones are not re-issued every frame
+    // -------------------------------------------------------------------------------
+    GLStateCache glState;
+    RenderQueue queue;
+    unsigned long steadyFrames = 0, framesWithAllocations = 0, steadyAllocations = 0;
+    float lastTime = (float)glfwGetTime();
+    unsigned long frameIndex = 0;
+
+    // render loop
+    // -----------
+    while (!glfwWindowShouldClose(window))
+    {
+        unsigned long allocationsBefore = heapAllocations();
+
+        // input
+        // -----
+        processInput(window);
+
+        // upload: one FrameBlock for all programs, all ObjectBlocks in one allocation
+        // ---------------------------------------------------------------------------
+        ring.beginFrame();
+        float time = (float)glfwGetTime();
+        int framebufferWidth, framebufferHeight;
+        glfwGetFramebufferSize(window, &framebufferWidth, &framebufferHeight);
+        float aspect = framebufferHeight > 0 ? (float)framebufferWidth / framebufferHeight : 1.0f;
+        FrameBlock frame;
+        frame.view = glm::rotate(glm::mat4(1.0f), 0.1f * time, glm::vec3(0.0f, 0.0f, 1.0f));
+        frame.projection = glm::ortho(-aspect, aspect, -1.0f, 1.0f, -1.0f, 1.0f);
+        frame.time = glm::vec4(time, time - lastTime, (float)frameIndex, 0.0f);
+        lastTime = time;
+        StreamRing::Allocation frameData = ring.push(&frame, sizeof(frame), uniformAlignment);
+        // this frame's blocks: the colors fade with the time, written straight into the
+        // ring at the binding stride, no scratch copy in between
+        /// 直接写进环形缓冲，不再先算到临时内存里再拷贝一遍
+        StreamRing::Allocation objectData = ring.allocate(objectStride * objectCount, uniformAlignment);
+        if (objectData.valid())
+        {
+            for (unsigned int i = 0; i < objectCount; ++i)
+            {
+                ObjectBlock* block = (ObjectBlock*)(objectData.ptr + i * objectStride);
+                *block = objects[i];
+                block->color.z = 0.75f + 0.25f * std::sin(time + 0.1f * i);
+            }
+        }
+        ring.flush();
+
+        // render
+        // ------
+        glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT);
+
+        if (frameData.valid() && objectData.valid())
+        {
+            glState.bindUniformRange(FRAME_BLOCK_BINDING, ring.buffer(), (GLintptr)frameData.offset, sizeof(FrameBlock));
+            for (unsigned int i = 0; i < objectCount; ++i)
+            {
+                // checkerboard of the two programs, neither needs a single glUniform call.
+                // recorded in grid order, the queue sorts by program so each is bound once
+                bool pulse = ((i % GRID_SIZE + i / GRID_SIZE) & 1) != 0;
+                queue.begin(pulse ? pulsing.ID : textured.ID, VAO, 6);
+                if (!pulse)
+                    queue.texture(0, GL_TEXTURE_2D, texture1);
+                queue.uniformBlock(OBJECT_BLOCK_BINDING, ring.buffer(), objectData.offset + i * objectStride, sizeof(ObjectBlock));
+            }
+            queue.submit(glState);
+        }
+        ring.endFrame();
+        ++frameIndex;
+
+        // glfw: swap buffers and poll IO events (keys pressed/released, mouse moved etc.)
+        // -------------------------------------------------------------------------------
+        glfwSwapBuffers(window);
+        glfwPollEvents();
+
+        // after the warm-up no frame may allocate: the queue's arrays have their final
+        // size and the blocks are written in place
+        unsigned long allocations = heapAllocations() - allocationsBefore;
+        if (frameIndex > WARMUP_FRAMES)
+        {
+            ++steadyFrames;
+            steadyAllocations += allocations;
+            if (allocations > 0)
+                ++framesWithAllocations;
+        }
+    }
+
+    glState.printStats(std::cout);
+    queue.printStats(std::cout);
+    if (heapAllocationsCounted())
+        std::cout << "heap allocations: " << steadyAllocations << " in " << framesWithAllocations << " of "
+                  << steadyFrames << " steady-state frames" << std::endl;
+    else
+        std::cout << "heap allocations: not counted, configure with -DORI_COUNT_ALLOCATIONS=ON" << std::endl;
+
+    // optional: de-allocate all resources once they've outlived their purpose:
+    // ------------------------------------------------------------------------
+    ring.release();
+    glDeleteVertexArrays(1, &VAO);
+    glDeleteBuffers(1, &VBO);
+    glDeleteBuffers(1, &EBO);
+    glDeleteTextures(1, &texture1);
+
+    // glfw: terminate, clearing all previously allocated GLFW resources.
+    // ------------------------------------------------------------------
+    glfwTerminate();
+    return 0;
+}
+
+// process all input: query GLFW whether relevant keys are pressed/released this frame and react accordingly
+// ---------------------------------------------------------------------------------------------------------
+void processInput(GLFWwindow *window)
+{
+    if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
+        glfwSetWindowShouldClose(window, true);
+}
+
+// glfw: whenever the window size changed (by OS or user resize) this callback function executes
+// ---------------------------------------------------------------------------------------------
+void framebuffer_size_callback(GLFWwindow* window, int width, int height)
+{
+    // make sure the viewport matches the new window dimensions; note that width and
+    // height will be significantly larger than specified on retina displays.
+    glViewport(0, 0, width, height);
+}
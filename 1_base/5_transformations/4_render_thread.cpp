@@ -0,0 +1,283 @@
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <stb_image.h>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+
+#include <shader_s.h>
+#include <gl_ext.h>
+#include <gl_state.h>
+#include <instanced_renderer.h>
+#include <batch_transform.h>
+#include <render_thread.h>
+
+#include <iostream>
+#include <vector>
+#include <cstring>
+
+void processInput(GLFWwindow *window);
+
+// settings
+const unsigned int SCR_WIDTH = 800;
+const unsigned int SCR_HEIGHT = 600;
+// GRID_SIZE * GRID_SIZE quads, ~50k
+const unsigned int GRID_SIZE = 224;
+
+/// 主线程每帧填写的帧数据包：提交后只读，渲染线程只看数据包，不碰模拟状态
+struct FramePacket
+{
+    // one mat4 per quad, written by buildTransforms
+    std::vector<float> transforms;
+    unsigned int instanceCount;
+    // the framebuffer size seen by the main thread, the render thread owns glViewport
+    int framebufferWidth, framebufferHeight;
+};
+
+int main()
+{
+    // glfw: initialize and configure
+    // ------------------------------
+    glfwInit();
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+#ifdef __APPLE__
+    glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+#endif
+
+    // glfw window creation
+    // --------------------
+    GLFWwindow* window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, "LearnOpenGL", NULL, NULL);
+    if (window == NULL)
+    {
+        std::cout << "Failed to create GLFW window" << std::endl;
+        glfwTerminate();
+        return -1;
+    }
+    glfwMakeContextCurrent(window);
+
+    // glad: load all OpenGL function pointers
+    // ---------------------------------------
+    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+    {
+        std::cout << "Failed to initialize GLAD" << std::endl;
+        return -1;
+    }
+    loadGLExtensions((GLADloadproc)glfwGetProcAddress);
+
+    // build and compile our shader zprogram
+    // ------------------------------------
+    /// 变换矩阵不再是uniform，而是从实例属性中读取
+    Shader ourShader("../1_base/5_transformations/helper/shader_instanced.vs", "../1_base/5_transformations/helper/shader_texture2.fs");
+
+    // set up vertex data (and buffer(s)) and configure vertex attributes
+    // ------------------------------------------------------------------
+    float vertices[] = {
+            // positions          // texture coords
+            0.5f,  0.5f, 0.0f,   1.0f, 1.0f, // top right
+            0.5f, -0.5f, 0.0f,   1.0f, 0.0f, // bottom right
+            -0.5f, -0.5f, 0.0f,   0.0f, 0.0f, // bottom left
+            -0.5f,  0.5f, 0.0f,   0.0f, 1.0f  // top left
+    };
+    unsigned int indices[] = {
+            0, 1, 3, // first triangle
+            1, 2, 3  // second triangle
+    };
+    unsigned int VBO, VAO, EBO;
+    glGenVertexArrays(1, &VAO);
+    glGenBuffers(1, &VBO);
+    glGenBuffers(1, &EBO);
+
+    glBindVertexArray(VAO);
+
+    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
+
+    // position attribute
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)0);
+    glEnableVertexAttribArray(0);
+
+    // texture coord attribute
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)(3 * sizeof(float)));
+    glEnableVertexAttribArray(1);
+
+    // per-instance transforms: one mat4 per quad in a second VBO on the same VAO
+    // --------------------------------------------------------------------------
+    InstancedRenderer quads(VAO, 6);
+
+    /// 每个实例的位置、初始角度、缩放以SoA数组保存，每帧由批量构建器写入映射的实例缓冲
+    const unsigned int instanceCount = GRID_SIZE * GRID_SIZE;
+    std::vector<float> posX(instanceCount), posY(instanceCount), posZ(instanceCount, 0.0f);
+    std::vector<float> angles(instanceCount), scales(instanceCount, 0.8f * 2.0f / GRID_SIZE);
+    float cell = 2.0f / GRID_SIZE;
+    for (unsigned int y = 0; y < GRID_SIZE; ++y)
+    {
+        for (unsigned int x = 0; x < GRID_SIZE; ++x)
+        {
+            posX[y * GRID_SIZE + x] = -1.0f + (x + 0.5f) * cell;
+            posY[y * GRID_SIZE + x] = -1.0f + (y + 0.5f) * cell;
+            angles[y * GRID_SIZE + x] = 0.01f * (x + y);
+        }
+    }
+    TransformBatchInput batch;
+    batch.x = &posX[0];
+    batch.y = &posY[0];
+    batch.z = &posZ[0];
+    batch.angle = &angles[0];
+    batch.scaleX = batch.scaleY = batch.scaleZ = &scales[0];
+    std::cout << "batch transform kernel: " << batchTransformKernel() << std::endl;
+
+    // load and create a texture 
+    // -------------------------
+    unsigned int texture1, texture2;
+    // texture 1
+    // ---------
+    glGenTextures(1, &texture1);
+    glBindTexture(GL_TEXTURE_2D, texture1);
+    // set the texture wrapping parameters
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    // set texture filtering parameters
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    // load image, create texture and generate mipmaps
+    int width, height, nrChannels;
+    stbi_set_flip_vertically_on_load(true); // tell stb_image.h to flip loaded texture's on the y-axis.
+    unsigned char *data = stbi_load("../res/container.jpeg", &width, &height, &nrChannels, 0);
+    if (data)
+    {
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, data);
+        glGenerateMipmap(GL_TEXTURE_2D);
+    }
+    else
+    {
+        std::cout << "Failed to load texture" << std::endl;
+    }
+    stbi_image_free(data);
+    // texture 2
+    // ---------
+    glGenTextures(1, &texture2);
+    glBindTexture(GL_TEXTURE_2D, texture2);
+    // set the texture wrapping parameters
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    // set texture filtering parameters
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    // load image, create texture and generate mipmaps
+    data = stbi_load("../res/awesomeface.png", &width, &height, &nrChannels, 0);
+    if (data)
+    {
+        // note that the awesomeface.png has transparency and thus an alpha channel, so make sure to tell OpenGL the data type is of GL_RGBA
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
+        glGenerateMipmap(GL_TEXTURE_2D);
+    }
+    else
+    {
+        std::cout << "Failed to load texture" << std::endl;
+    }
+    stbi_image_free(data);
+
+    ourShader.use();
+    ourShader.setInt("texture1", 0);
+    ourShader.setInt("texture2", 1);
+
+    // everything below the GL calls so far runs on the render thread: it owns the
+    // context from here until renderer.stop()
+    // -------------------------------------------------------------------------
+    GLStateCache glState;
+    int viewportWidth = 0, viewportHeight = 0;
+    RenderThread<FramePacket>::RenderFunction render = [&](const FramePacket& packet)
+    {
+        /// glfw的尺寸回调在主线程触发，没有上下文，所以视口在这里按数据包更新
+        if (packet.framebufferWidth != viewportWidth || packet.framebufferHeight != viewportHeight)
+        {
+            viewportWidth = packet.framebufferWidth;
+            viewportHeight = packet.framebufferHeight;
+            glViewport(0, 0, viewportWidth, viewportHeight);
+        }
+
+        // render
+        // ------
+        glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT);
+
+        // bind textures on corresponding texture units
+        glState.bindTextureUnit(0, GL_TEXTURE_2D, texture1);
+        glState.bindTextureUnit(1, GL_TEXTURE_2D, texture2);
+
+        // copy the packet's transforms into the mapped instance buffer
+        float* instanceData = quads.mapInstances(packet.instanceCount);
+        if (instanceData)
+        {
+            std::memcpy(instanceData, &packet.transforms[0], packet.instanceCount * sizeof(glm::mat4));
+            quads.unmapInstances();
+        }
+
+        // render containers
+        glState.useProgram(ourShader.ID);
+        quads.draw(glState);
+    };
+    RenderThread<FramePacket> renderer(window, render);
+
+    // main loop: input and simulation only, the render thread draws the previous packet
+    // and swaps while this one is being built
+    // -----------
+    while (!glfwWindowShouldClose(window))
+    {
+        // input
+        // -----
+        processInput(window);
+
+        // simulate into a free packet, waits only if the render thread is a full frame behind
+        // ---------------------------------------------------------------------------------
+        FramePacket* packet = renderer.acquire();
+        packet->instanceCount = instanceCount;
+        packet->transforms.resize(instanceCount * 16);
+        glfwGetFramebufferSize(window, &packet->framebufferWidth, &packet->framebufferHeight);
+
+        // create transformations
+        /// 每个实例：位移到网格中的位置，随时间旋转，再缩放到格子大小
+        batch.angleOffset = (float)glfwGetTime();
+        buildTransforms(batch, instanceCount, &packet->transforms[0]);
+        renderer.submit(packet);
+
+        // glfw: poll IO events (keys pressed/released, mouse moved etc.), must stay on the main thread
+        // ------------------------------------------------------------------------------------------
+        glfwPollEvents();
+    }
+
+    // drains the queued packets, joins and makes the context current here again
+    renderer.stop();
+    renderer.printStats(std::cout);
+    glState.printStats(std::cout);
+
+    // optional: de-allocate all resources once they've outlived their purpose:
+    // ------------------------------------------------------------------------
+    quads.release();
+    glDeleteVertexArrays(1, &VAO);
+    glDeleteBuffers(1, &VBO);
+    glDeleteBuffers(1, &EBO);
+    glDeleteTextures(1, &texture1);
+    glDeleteTextures(1, &texture2);
+
+    // glfw: terminate, clearing all previously allocated GLFW resources.
+    // ------------------------------------------------------------------
+    glfwTerminate();
+    return 0;
+}
+
+// process all input: query GLFW whether relevant keys are pressed/released this frame and react accordingly
+// ---------------------------------------------------------------------------------------------------------
+void processInput(GLFWwindow *window)
+{
+    if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
+        glfwSetWindowShouldClose(window, true);
+}
@@ -0,0 +1,326 @@
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <stb_image.h>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+
+#include <shader_s.h>
+#include <gl_state.h>
+#include <instanced_renderer.h>
+#include <batch_transform.h>
+#include <bvh.h>
+#include <frame_arena.h>
+
+#include <iostream>
+#include <vector>
+#include <cmath>
+
+void framebuffer_size_callback(GLFWwindow* window, int width, int height);
+void processInput(GLFWwindow *window);
+Aabb quadBounds(float x, float y, float z, float scale);
+
+// settings
+const unsigned int SCR_WIDTH = 800;
+const unsigned int SCR_HEIGHT = 600;
+// GRID_SIZE * GRID_SIZE quads, ~50k, spread over a WORLD_SIZE square
+const unsigned int GRID_SIZE = 224;
+const float WORLD_SIZE = 200.0f;
+// every MOVER_STRIDE-th quad bobs along z and is refit into the BVH each frame
+const unsigned int MOVER_STRIDE = 16;
+
+int main()
+{
+    // glfw: initialize and configure
+    // ------------------------------
+    glfwInit();
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+#ifdef __APPLE__
+    glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+#endif
+
+    // glfw window creation
+    // --------------------
+    GLFWwindow* window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, "LearnOpenGL", NULL, NULL);
+    if (window == NULL)
+    {
+        std::cout << "Failed to create GLFW window" << std::endl;
+        glfwTerminate();
+        return -1;
+    }
+    glfwMakeContextCurrent(window);
+    glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
+
+    // glad: load all OpenGL function pointers
+    // ---------------------------------------
+    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+    {
+        std::cout << "Failed to initialize GLAD" << std::endl;
+        return -1;
+    }
+
+    // build and compile our shader zprogram
+    // ------------------------------------
+    /// 变换矩阵不再是uniform，而是从实例属性中读取
+    /// 顶点着色器多乘一个viewProjection，场景在透视相机下远大于屏幕
+    Shader ourShader("../1_base/5_transformations/helper/shader_instanced_vp.vs", "../1_base/5_transformations/helper/shader_texture2.fs");
+
+    // set up vertex data (and buffer(s)) and configure vertex attributes
+    // ------------------------------------------------------------------
+    float vertices[] = {
+            // positions          // texture coords
+            0.5f,  0.5f, 0.0f,   1.0f, 1.0f, // top right
+            0.5f, -0.5f, 0.0f,   1.0f, 0.0f, // bottom right
+            -0.5f, -0.5f, 0.0f,   0.0f, 0.0f, // bottom left
+            -0.5f,  0.5f, 0.0f,   0.0f, 1.0f  // top left
+    };
+    unsigned int indices[] = {
+            0, 1, 3, // first triangle
+            1, 2, 3  // second triangle
+    };
+    unsigned int VBO, VAO, EBO;
+    glGenVertexArrays(1, &VAO);
+    glGenBuffers(1, &VBO);
+    glGenBuffers(1, &EBO);
+
+    glBindVertexArray(VAO);
+
+    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
+
+    // position attribute
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)0);
+    glEnableVertexAttribArray(0);
+
+    // texture coord attribute
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)(3 * sizeof(float)));
+    glEnableVertexAttribArray(1);
+
+    // per-instance transforms: one mat4 per quad in a second VBO on the same VAO
+    // --------------------------------------------------------------------------
+    InstancedRenderer quads(VAO, 6);
+
+    /// 每个实例的位置、初始角度、缩放以SoA数组保存，整个场景的变换每帧由批量构建器写入CPU数组
+    const unsigned int instanceCount = GRID_SIZE * GRID_SIZE;
+    std::vector<float> posX(instanceCount), posY(instanceCount), posZ(instanceCount, 0.0f);
+    std::vector<float> angles(instanceCount), scales(instanceCount, 0.8f * WORLD_SIZE / GRID_SIZE);
+    float cell = WORLD_SIZE / GRID_SIZE;
+    for (unsigned int y = 0; y < GRID_SIZE; ++y)
+    {
+        for (unsigned int x = 0; x < GRID_SIZE; ++x)
+        {
+            posX[y * GRID_SIZE + x] = -0.5f * WORLD_SIZE + (x + 0.5f) * cell;
+            posY[y * GRID_SIZE + x] = -0.5f * WORLD_SIZE + (y + 0.5f) * cell;
+            angles[y * GRID_SIZE + x] = 0.01f * (x + y);
+        }
+    }
+    /// 剔除后的实例输入每帧从帧内存池里分配，交换缓冲后整体重置，不经过堆
+    FrameArena frameArena(5 * instanceCount * sizeof(float) + 5 * 16);
+    std::cout << "batch transform kernel: " << batchTransformKernel() << std::endl;
+
+    /// 包围盒取旋转后仍能包住四边形的正方形(半边长为对角线的一半)，只旋转时不用更新
+    std::vector<Aabb> bounds(instanceCount);
+    for (unsigned int i = 0; i < instanceCount; ++i)
+        bounds[i] = quadBounds(posX[i], posY[i], posZ[i], scales[i]);
+    BoundingVolumeHierarchy bvh;
+    bvh.build(&bounds[0], instanceCount);
+    std::vector<unsigned int> visible;
+    visible.reserve(instanceCount);
+
+    // load and create a texture 
+    // -------------------------
+    unsigned int texture1, texture2;
+    // texture 1
+    // ---------
+    glGenTextures(1, &texture1);
+    glBindTexture(GL_TEXTURE_2D, texture1);
+    // set the texture wrapping parameters
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    // set texture filtering parameters
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    // load image, create texture and generate mipmaps
+    int width, height, nrChannels;
+    stbi_set_flip_vertically_on_load(true); // tell stb_image.h to flip loaded texture's on the y-axis.
+    unsigned char *data = stbi_load("../res/container.jpeg", &width, &height, &nrChannels, 0);
+    if (data)
+    {
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, data);
+        glGenerateMipmap(GL_TEXTURE_2D);
+    }
+    else
+    {
+        std::cout << "Failed to load texture" << std::endl;
+    }
+    stbi_image_free(data);
+    // texture 2
+    // ---------
+    glGenTextures(1, &texture2);
+    glBindTexture(GL_TEXTURE_2D, texture2);
+    // set the texture wrapping parameters
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    // set texture filtering parameters
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    // load image, create texture and generate mipmaps
+    data = stbi_load("../res/awesomeface.png", &width, &height, &nrChannels, 0);
+    if (data)
+    {
+        // note that the awesomeface.png has transparency and thus an alpha channel, so make sure to tell OpenGL the data type is of GL_RGBA
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
+        glGenerateMipmap(GL_TEXTURE_2D);
+    }
+    else
+    {
+        std::cout << "Failed to load texture" << std::endl;
+    }
+    stbi_image_free(data);
+
+    // tell opengl for each sampler to which texture unit it belongs to (only has to be done once)
+    // -------------------------------------------------------------------------------------------
+    ourShader.use();
+    ourShader.setInt("texture1", 0);
+    ourShader.setInt("texture2", 1);
+    UniformHandle viewProjectionLoc = ourShader.uniform("viewProjection");
+
+    // shadow the bindings from here on so unchanged ones are not re-issued every frame
+    // -------------------------------------------------------------------------------
+    GLStateCache glState;
+    unsigned long frame = 0;
+
+    // render loop
+    // -----------
+    while (!glfwWindowShouldClose(window))
+    {
+        // input
+        // -----
+        processInput(window);
+
+        // render
+        // ------
+        glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT);
+
+        // bind textures on corresponding texture units
+        glState.bindTextureUnit(0, GL_TEXTURE_2D, texture1);
+        glState.bindTextureUnit(1, GL_TEXTURE_2D, texture2);
+
+        // move the bobbing quads and refit only their paths to the root
+        // ------------------------------------------------------------------------
+        float time = (float)glfwGetTime();
+        for (unsigned int i = 0; i < instanceCount; i += MOVER_STRIDE)
+        {
+            posZ[i] = 4.0f * std::sin(time + 0.1f * i);
+            bvh.update(i, quadBounds(posX[i], posY[i], posZ[i], scales[i]));
+        }
+        bvh.refit();
+
+        // camera circling over the field, most of it off screen at any time
+        int fbWidth, fbHeight;
+        glfwGetFramebufferSize(window, &fbWidth, &fbHeight);
+        float aspect = fbHeight > 0 ? (float)fbWidth / (float)fbHeight : 1.0f;
+        glm::vec3 eye(0.4f * WORLD_SIZE * std::cos(0.2f * time), 0.4f * WORLD_SIZE * std::sin(0.2f * time), 12.0f);
+        glm::vec3 target(0.4f * WORLD_SIZE * std::cos(0.2f * time + 0.5f), 0.4f * WORLD_SIZE * std::sin(0.2f * time + 0.5f), 0.0f);
+        glm::mat4 viewProjection = glm::perspective(glm::radians(45.0f), aspect, 0.1f, 100.0f) *
+                                   glm::lookAt(eye, target, glm::vec3(0.0f, 0.0f, 1.0f));
+
+        // create transformations
+        /// 先对BVH做视锥剔除，再只为可见实例构建矩阵，直接写进映射的实例缓冲
+        unsigned int visibleCount = (unsigned int)bvh.cull(Frustum::fromMatrix(glm::value_ptr(viewProjection)), visible);
+        // the survivors' inputs gathered into this frame's scratch, packed for the kernel
+        float* visibleX = frameArena.allocate<float>(visibleCount);
+        float* visibleY = frameArena.allocate<float>(visibleCount);
+        float* visibleZ = frameArena.allocate<float>(visibleCount);
+        float* visibleAngles = frameArena.allocate<float>(visibleCount);
+        float* visibleScales = frameArena.allocate<float>(visibleCount);
+        if (!visibleX || !visibleY || !visibleZ || !visibleAngles || !visibleScales)
+            visibleCount = 0;
+        float* instanceData = quads.mapInstances(visibleCount);
+        if (instanceData)
+        {
+            for (unsigned int i = 0; i < visibleCount; ++i)
+            {
+                unsigned int instance = visible[i];
+                visibleX[i] = posX[instance];
+                visibleY[i] = posY[instance];
+                visibleZ[i] = posZ[instance];
+                visibleAngles[i] = angles[instance];
+                visibleScales[i] = scales[instance];
+            }
+            TransformBatchInput batch;
+            batch.x = visibleX;
+            batch.y = visibleY;
+            batch.z = visibleZ;
+            batch.angle = visibleAngles;
+            batch.scaleX = batch.scaleY = batch.scaleZ = visibleScales;
+            batch.angleOffset = time;
+            buildTransforms(batch, visibleCount, instanceData);
+            quads.unmapInstances();
+        }
+        if (++frame % 300 == 0)
+            bvh.printStats(std::cout);
+
+        // render containers
+        glState.useProgram(ourShader.ID);
+        ourShader.setMat4(viewProjectionLoc, glm::value_ptr(viewProjection));
+        quads.draw(glState);
+
+        // glfw: swap buffers and poll IO events (keys pressed/released, mouse moved etc.)
+        // -------------------------------------------------------------------------------
+        glfwSwapBuffers(window);
+        glfwPollEvents();
+        frameArena.reset();
+    }
+
+    glState.printStats(std::cout);
+    bvh.printStats(std::cout);
+    frameArena.printStats(std::cout);
+
+    // optional: de-allocate all resources once they've outlived their purpose:
+    // ------------------------------------------------------------------------
+    quads.release();
+    glDeleteVertexArrays(1, &VAO);
+    glDeleteBuffers(1, &VBO);
+    glDeleteBuffers(1, &EBO);
+
+    // glfw: terminate, clearing all previously allocated GLFW resources.
+    // ------------------------------------------------------------------
+    glfwTerminate();
+    return 0;
+}
+
+// process all input: query GLFW whether relevant keys are pressed/released this frame and react accordingly
+// ---------------------------------------------------------------------------------------------------------
+void processInput(GLFWwindow *window)
+{
+    if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
+        glfwSetWindowShouldClose(window, true);
+}
+
+// glfw: whenever the window size changed (by OS or user resize) this callback function executes
+// ---------------------------------------------------------------------------------------------
+void framebuffer_size_callback(GLFWwindow* window, int width, int height)
+{
+    // make sure the viewport matches the new window dimensions; note that width and 
+    // height will be significantly larger than specified on retina displays.
+    glViewport(0, 0, width, height);
+}
+
+// bounds of a unit quad scaled by scale and spun around z by any angle
+// ---------------------------------------------------------------------
+Aabb quadBounds(float x, float y, float z, float scale)
+{
+    float r = 0.7072f * scale;
+    Aabb box = { { x - r, y - r, z - 0.01f }, { x + r, y + r, z + 0.01f } };
+    return box;
+}
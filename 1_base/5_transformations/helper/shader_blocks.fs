@@ -0,0 +1,17 @@
+#version 330 core
+out vec4 FragColor;
+
+in vec2 TexCoord;
+
+layout (std140) uniform ObjectBlock
+{
+    mat4 model;
+    vec4 color;
+};
+
+uniform sampler2D texture1;
+
+void main()
+{
+    FragColor = texture(texture1, TexCoord) * color;
+}
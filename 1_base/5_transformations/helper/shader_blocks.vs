@@ -0,0 +1,25 @@
+#version 330 core
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec2 aTexCoord;
+
+// 每帧一次，所有程序共享，绑定点0（见uniform_block.h）
+layout (std140) uniform FrameBlock
+{
+    mat4 view;
+    mat4 projection;
+    vec4 time;
+};
+// 每个物体一份，所有物体一次性上传，用glBindBufferRange选择，绑定点1
+layout (std140) uniform ObjectBlock
+{
+    mat4 model;
+    vec4 color;
+};
+
+out vec2 TexCoord;
+
+void main()
+{
+    gl_Position = projection * view * model * vec4(aPos, 1.0f);
+    TexCoord = vec2(aTexCoord.x, 1.0 - aTexCoord.y);
+}
@@ -0,0 +1,22 @@
+#version 330 core
+out vec4 FragColor;
+
+in vec2 TexCoord;
+
+layout (std140) uniform FrameBlock
+{
+    mat4 view;
+    mat4 projection;
+    vec4 time;
+};
+layout (std140) uniform ObjectBlock
+{
+    mat4 model;
+    vec4 color;
+};
+
+void main()
+{
+    float pulse = 0.5 + 0.5 * sin(time.x * 4.0 + TexCoord.x * 6.0);
+    FragColor = vec4(color.rgb * pulse, 1.0);
+}
@@ -0,0 +1,16 @@
+#version 330 core
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec2 aTexCoord;
+// 每个实例的模型矩阵，占用location 2~5，由实例VBO提供(属性除数为1)
+layout (location = 2) in mat4 aTransform;
+
+out vec2 TexCoord;
+
+// projection * view，所有实例共用
+uniform mat4 viewProjection;
+
+void main()
+{
+    gl_Position = viewProjection * aTransform * vec4(aPos, 1.0f);
+    TexCoord = vec2(aTexCoord.x, 1.0 - aTexCoord.y);
+}
\ No newline at end of file
@@ -0,0 +1,186 @@
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <stb_image.h>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+
+#include <shader_s.h>
+#include <gl_ext.h>
+#include <gl_state.h>
+#include <mesh.h>
+#include <mesh_loader.h>
+
+#include <iostream>
+
+void framebuffer_size_callback(GLFWwindow* window, int width, int height);
+void processInput(GLFWwindow *window);
+
+// settings
+const unsigned int SCR_WIDTH = 800;
+const unsigned int SCR_HEIGHT = 600;
+
+int main()
+{
+    // glfw: initialize and configure
+    // ------------------------------
+    glfwInit();
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+#ifdef __APPLE__
+    glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+#endif
+
+    // glfw window creation
+    // --------------------
+    GLFWwindow* window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, "LearnOpenGL", NULL, NULL);
+    if (window == NULL)
+    {
+        std::cout << "Failed to create GLFW window" << std::endl;
+        glfwTerminate();
+        return -1;
+    }
+    glfwMakeContextCurrent(window);
+    glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
+
+    // glad: load all OpenGL function pointers
+    // ---------------------------------------
+    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+    {
+        std::cout << "Failed to initialize GLAD" << std::endl;
+        return -1;
+    }
+    loadGLExtensions((GLADloadproc)glfwGetProcAddress);
+
+    // build and compile our shader zprogram
+    // ------------------------------------
+    Shader ourShader("../1_base/6_mesh/helper/mesh.vs", "../1_base/6_mesh/helper/mesh.fs");
+
+    // load the mesh: the first run parses the OBJ, welds, reorders for the vertex cache
+    // and overdraw and writes mesh_cache/; later runs only read the cached result
+    // --------------------------------------------------------------------------------
+    MeshData meshData;
+    if (!loadMesh("../res/torus.obj", meshData, "mesh_cache"))
+    {
+        glfwTerminate();
+        return -1;
+    }
+    /// 紧凑顶点格式：半精度位置、16位归一化纹理坐标、2_10_10_10法线，每个顶点16字节而不是32字节
+    Mesh mesh;
+    mesh.upload(meshData, VertexLayout::compact());
+    mesh.printMemory(std::cout, "torus");
+    std::cout << "mesh: " << meshData.vertices.size() << " vertices, " << mesh.count() / 3 << " triangles, "
+              << (mesh.type() == GL_UNSIGNED_SHORT ? "16" : "32") << "-bit indices" << std::endl;
+
+    // load and create a texture
+    // -------------------------
+    unsigned int texture1;
+    glGenTextures(1, &texture1);
+    glBindTexture(GL_TEXTURE_2D, texture1);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    int width, height, nrChannels;
+    stbi_set_flip_vertically_on_load(true); // tell stb_image.h to flip loaded texture's on the y-axis.
+    unsigned char *data = stbi_load("../res/container.jpeg", &width, &height, &nrChannels, 0);
+    if (data)
+    {
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, data);
+        glGenerateMipmap(GL_TEXTURE_2D);
+    }
+    else
+    {
+        std::cout << "Failed to load texture" << std::endl;
+    }
+    stbi_image_free(data);
+
+    ourShader.use();
+    ourShader.setInt("texture1", 0);
+    glm::vec3 lightDirection = glm::normalize(glm::vec3(-0.3f, -0.5f, -1.0f));
+    glUniform3f(ourShader.location(ourShader.uniform("lightDirection")), lightDirection.x, lightDirection.y, lightDirection.z);
+    // undo the texcoord quantization of the compact layout
+    const float* texCoordTransform = mesh.texCoordTransform();
+    ourShader.setVec4("texCoordTransform", texCoordTransform[0], texCoordTransform[1], texCoordTransform[2], texCoordTransform[3]);
+    ///在渲染循环外查询一次uniform，循环内只使用句柄
+    UniformHandle modelLoc = ourShader.uniform("model");
+    UniformHandle viewLoc = ourShader.uniform("view");
+    UniformHandle projectionLoc = ourShader.uniform("projection");
+
+    /// 开启深度测试，外侧的簇先画，被遮挡的内侧片段在深度测试中被丢弃
+    glEnable(GL_DEPTH_TEST);
+
+    // shadow the bindings from here on so unchanged ones are not re-issued every frame
+    // -------------------------------------------------------------------------------
+    GLStateCache glState;
+
+    // render loop
+    // -----------
+    while (!glfwWindowShouldClose(window))
+    {
+        // input
+        // -----
+        processInput(window);
+
+        // render
+        // ------
+        glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+        glState.bindTextureUnit(0, GL_TEXTURE_2D, texture1);
+        glState.useProgram(ourShader.ID);
+
+        // create transformations
+        int framebufferWidth, framebufferHeight;
+        glfwGetFramebufferSize(window, &framebufferWidth, &framebufferHeight);
+        float aspect = framebufferHeight > 0 ? (float)framebufferWidth / framebufferHeight : 1.0f;
+        float time = (float)glfwGetTime();
+        glm::mat4 model = glm::rotate(glm::mat4(1.0f), time, glm::vec3(0.5f, 1.0f, 0.0f));
+        glm::mat4 view = glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 0.0f, -2.5f));
+        glm::mat4 projection = glm::perspective(glm::radians(45.0f), aspect, 0.1f, 100.0f);
+        ourShader.setMat4(modelLoc, glm::value_ptr(model));
+        ourShader.setMat4(viewLoc, glm::value_ptr(view));
+        ourShader.setMat4(projectionLoc, glm::value_ptr(projection));
+
+        // render the mesh
+        mesh.draw(glState);
+
+        // glfw: swap buffers and poll IO events (keys pressed/released, mouse moved etc.)
+        // -------------------------------------------------------------------------------
+        glfwSwapBuffers(window);
+        glfwPollEvents();
+    }
+
+    glState.printStats(std::cout);
+
+    // optional: de-allocate all resources once they've outlived their purpose:
+    // ------------------------------------------------------------------------
+    mesh.release();
+    glDeleteTextures(1, &texture1);
+
+    // glfw: terminate, clearing all previously allocated GLFW resources.
+    // ------------------------------------------------------------------
+    glfwTerminate();
+    return 0;
+}
+
+// process all input: query GLFW whether relevant keys are pressed/released this frame and react accordingly
+// ---------------------------------------------------------------------------------------------------------
+void processInput(GLFWwindow *window)
+{
+    if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
+        glfwSetWindowShouldClose(window, true);
+}
+
+// glfw: whenever the window size changed (by OS or user resize) this callback function executes
+// ---------------------------------------------------------------------------------------------
+void framebuffer_size_callback(GLFWwindow* window, int width, int height)
+{
+    // make sure the viewport matches the new window dimensions; note that width and
+    // height will be significantly larger than specified on retina displays.
+    glViewport(0, 0, width, height);
+}
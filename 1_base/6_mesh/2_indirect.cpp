@@ -0,0 +1,277 @@
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <stb_image.h>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+
+#include <shader_s.h>
+#include <gl_ext.h>
+#include <gl_state.h>
+#include <mesh_loader.h>
+#include <indirect_renderer.h>
+#include <bvh.h>
+
+#include <iostream>
+#include <cmath>
+
+void framebuffer_size_callback(GLFWwindow* window, int width, int height);
+void processInput(GLFWwindow *window);
+void makeCube(MeshData& mesh);
+void makeSphere(MeshData& mesh, unsigned int rings, unsigned int segments);
+
+// settings
+const unsigned int SCR_WIDTH = 800;
+const unsigned int SCR_HEIGHT = 600;
+// GRID_SIZE * GRID_SIZE objects, three different meshes
+const unsigned int GRID_SIZE = 48;
+const float SPACING = 3.0f;
+
+int main()
+{
+    // glfw: initialize and configure
+    // ------------------------------
+    glfwInit();
+    /// 多重间接绘制和计算着色器需要4.3，macOS最高4.1，创建失败时退回4.1走逐命令绘制
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 6);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+#ifdef __APPLE__
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 1);
+    glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+#endif
+
+    // glfw window creation
+    // --------------------
+    GLFWwindow* window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, "LearnOpenGL", NULL, NULL);
+    if (window == NULL)
+    {
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 1);
+        window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, "LearnOpenGL", NULL, NULL);
+    }
+    if (window == NULL)
+    {
+        std::cout << "Failed to create GLFW window" << std::endl;
+        glfwTerminate();
+        return -1;
+    }
+    glfwMakeContextCurrent(window);
+    glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
+
+    // glad: load all OpenGL function pointers
+    // ---------------------------------------
+    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+    {
+        std::cout << "Failed to initialize GLAD" << std::endl;
+        return -1;
+    }
+    loadGLExtensions((GLADloadproc)glfwGetProcAddress);
+
+    // build and compile our shader zprogram
+    // ------------------------------------
+    Shader ourShader("../1_base/6_mesh/helper/mesh_indirect.vs", "../1_base/6_mesh/helper/mesh.fs");
+
+    // all meshes go into one VBO/EBO, a draw only selects an index range
+    // ------------------------------------------------------------------
+    MeshData meshData;
+    if (!loadMesh("../res/torus.obj", meshData, "mesh_cache"))
+    {
+        glfwTerminate();
+        return -1;
+    }
+    IndirectRenderer scene;
+    unsigned int meshes[3];
+    meshes[0] = scene.addMesh(meshData);
+    makeCube(meshData);
+    meshes[1] = scene.addMesh(meshData);
+    makeSphere(meshData, 16, 32);
+    meshes[2] = scene.addMesh(meshData);
+    scene.upload();
+    /// 视锥剔除优先在GPU上做，不支持计算着色器时在CPU上逐个测试包围球
+    scene.enableGpuCulling("../1_base/6_mesh/helper/cull.comp");
+
+    // load and create a texture
+    // -------------------------
+    unsigned int texture1;
+    glGenTextures(1, &texture1);
+    glBindTexture(GL_TEXTURE_2D, texture1);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    int width, height, nrChannels;
+    stbi_set_flip_vertically_on_load(true); // tell stb_image.h to flip loaded texture's on the y-axis.
+    unsigned char *data = stbi_load("../res/container.jpeg", &width, &height, &nrChannels, 0);
+    if (data)
+    {
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, data);
+        glGenerateMipmap(GL_TEXTURE_2D);
+    }
+    else
+    {
+        std::cout << "Failed to load texture" << std::endl;
+    }
+    stbi_image_free(data);
+
+    ourShader.use();
+    ourShader.setInt("texture1", 0);
+    glm::vec3 lightDirection = glm::normalize(glm::vec3(-0.3f, -0.5f, -1.0f));
+    glUniform3f(ourShader.location(ourShader.uniform("lightDirection")), lightDirection.x, lightDirection.y, lightDirection.z);
+    ///在渲染循环外查询一次uniform，循环内只使用句柄
+    UniformHandle viewLoc = ourShader.uniform("view");
+    UniformHandle projectionLoc = ourShader.uniform("projection");
+
+    glEnable(GL_DEPTH_TEST);
+
+    // shadow the bindings from here on so unchanged ones are not re-issued every frame
+    // -------------------------------------------------------------------------------
+    GLStateCache glState;
+    unsigned long frame = 0;
+
+    // render loop
+    // -----------
+    while (!glfwWindowShouldClose(window))
+    {
+        // input
+        // -----
+        processInput(window);
+
+        // render
+        // ------
+        glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+        glState.bindTextureUnit(0, GL_TEXTURE_2D, texture1);
+        glState.useProgram(ourShader.ID);
+
+        // create transformations
+        int framebufferWidth, framebufferHeight;
+        glfwGetFramebufferSize(window, &framebufferWidth, &framebufferHeight);
+        float aspect = framebufferHeight > 0 ? (float)framebufferWidth / framebufferHeight : 1.0f;
+        float time = (float)glfwGetTime();
+        glm::vec3 eye(20.0f * std::cos(0.1f * time), 6.0f, 20.0f * std::sin(0.1f * time));
+        glm::mat4 view = glm::lookAt(eye, glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+        glm::mat4 projection = glm::perspective(glm::radians(45.0f), aspect, 0.1f, 100.0f);
+        ourShader.setMat4(viewLoc, glm::value_ptr(view));
+        ourShader.setMat4(projectionLoc, glm::value_ptr(projection));
+
+        /// 每个物体一条绘制记录，整个场景由一次glMultiDrawElementsIndirect提交
+        scene.begin();
+        float half = 0.5f * SPACING * (GRID_SIZE - 1);
+        for (unsigned int z = 0; z < GRID_SIZE; ++z)
+        {
+            for (unsigned int x = 0; x < GRID_SIZE; ++x)
+            {
+                glm::mat4 model = glm::translate(glm::mat4(1.0f), glm::vec3(x * SPACING - half, 0.0f, z * SPACING - half));
+                model = glm::rotate(model, time + 0.1f * (x + z), glm::vec3(0.5f, 1.0f, 0.0f));
+                scene.add(meshes[(x / 4 + z) % 3], model);
+            }
+        }
+        Frustum frustum = Frustum::fromMatrix(glm::value_ptr(projection * view));
+        scene.submit(glState, ourShader.ID, &frustum);
+        if (++frame % 300 == 0)
+            scene.printStats(std::cout);
+
+        // glfw: swap buffers and poll IO events (keys pressed/released, mouse moved etc.)
+        // -------------------------------------------------------------------------------
+        glfwSwapBuffers(window);
+        glfwPollEvents();
+    }
+
+    glState.printStats(std::cout);
+    scene.printStats(std::cout);
+
+    // optional: de-allocate all resources once they've outlived their purpose:
+    // ------------------------------------------------------------------------
+    scene.release();
+    glDeleteTextures(1, &texture1);
+
+    // glfw: terminate, clearing all previously allocated GLFW resources.
+    // ------------------------------------------------------------------
+    glfwTerminate();
+    return 0;
+}
+
+// process all input: query GLFW whether relevant keys are pressed/released this frame and react accordingly
+// ---------------------------------------------------------------------------------------------------------
+void processInput(GLFWwindow *window)
+{
+    if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
+        glfwSetWindowShouldClose(window, true);
+}
+
+// glfw: whenever the window size changed (by OS or user resize) this callback function executes
+// ---------------------------------------------------------------------------------------------
+void framebuffer_size_callback(GLFWwindow* window, int width, int height)
+{
+    // make sure the viewport matches the new window dimensions; note that width and
+    // height will be significantly larger than specified on retina displays.
+    glViewport(0, 0, width, height);
+}
+
+// unit cube centered on the origin, 4 vertices per face for flat normals
+// ----------------------------------------------------------------------
+void makeCube(MeshData& mesh)
+{
+    mesh.clear();
+    for (int face = 0; face < 6; ++face)
+    {
+        int axis = face / 2;
+        float sign = (face & 1) ? -1.0f : 1.0f;
+        int u = (axis + 1) % 3, v = (axis + 2) % 3;
+        uint32_t base = (uint32_t)mesh.vertices.size();
+        for (int corner = 0; corner < 4; ++corner)
+        {
+            MeshVertex vertex;
+            float cu = (corner == 1 || corner == 2) ? 0.5f : -0.5f;
+            float cv = corner >= 2 ? 0.5f : -0.5f;
+            vertex.position[axis] = 0.5f * sign;
+            vertex.position[u] = cu * sign;
+            vertex.position[v] = cv;
+            vertex.texCoord[0] = cu + 0.5f;
+            vertex.texCoord[1] = cv + 0.5f;
+            vertex.normal[0] = vertex.normal[1] = vertex.normal[2] = 0.0f;
+            vertex.normal[axis] = sign;
+            mesh.vertices.push_back(vertex);
+        }
+        uint32_t quad[6] = { base, base + 1, base + 2, base, base + 2, base + 3 };
+        mesh.indices.insert(mesh.indices.end(), quad, quad + 6);
+    }
+}
+
+// sphere of radius 0.6 from rings x segments quads
+// ------------------------------------------------
+void makeSphere(MeshData& mesh, unsigned int rings, unsigned int segments)
+{
+    mesh.clear();
+    const float pi = 3.14159265f;
+    for (unsigned int r = 0; r <= rings; ++r)
+    {
+        float theta = pi * r / rings;
+        for (unsigned int s = 0; s <= segments; ++s)
+        {
+            float phi = 2.0f * pi * s / segments;
+            MeshVertex vertex;
+            vertex.normal[0] = std::sin(theta) * std::cos(phi);
+            vertex.normal[1] = std::cos(theta);
+            vertex.normal[2] = -std::sin(theta) * std::sin(phi);
+            for (int k = 0; k < 3; ++k)
+                vertex.position[k] = 0.6f * vertex.normal[k];
+            vertex.texCoord[0] = (float)s / segments;
+            vertex.texCoord[1] = 1.0f - (float)r / rings;
+            mesh.vertices.push_back(vertex);
+        }
+    }
+    for (unsigned int r = 0; r < rings; ++r)
+    {
+        for (unsigned int s = 0; s < segments; ++s)
+        {
+            uint32_t a = r * (segments + 1) + s, b = a + segments + 1;
+            uint32_t quad[6] = { a, b, a + 1, a + 1, b, b + 1 };
+            mesh.indices.insert(mesh.indices.end(), quad, quad + 6);
+        }
+    }
+}
@@ -0,0 +1,199 @@
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <stb_image.h>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+
+#include <shader_s.h>
+#include <gl_ext.h>
+#include <gl_state.h>
+#include <mesh.h>
+#include <mesh_loader.h>
+#include <cooked_texture.h>
+#include <asset_archive.h>
+
+#include <iostream>
+#include <string>
+
+/**
+ * 1_mesh的资源不再是一个个松散的文件：着色器、纹理和网格由pack_assets目标打包进
+ * assets.oripack，启动时只打开并映射这一个文件。着色器源码直接从映射交给glShaderSource，
+ * 烘焙好的纹理直接从映射上传，网格在打包时就已经导入并优化好了，中间都没有再读进我们自己的缓冲。
+ * 一开始就用prefetchAll()让系统在后台预读整个归档，编译着色器的时候纹理和网格的页已经在路上了。
+ * 没有归档时退回到1_mesh的松散文件。
+ */
+
+void framebuffer_size_callback(GLFWwindow* window, int width, int height);
+void processInput(GLFWwindow *window);
+
+// settings
+const unsigned int SCR_WIDTH = 800;
+const unsigned int SCR_HEIGHT = 600;
+// written by the pack_assets target, next to the executables
+const char* ASSET_ARCHIVE_PATH = "assets.oripack";
+
+int main()
+{
+    // glfw: initialize and configure
+    // ------------------------------
+    glfwInit();
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+#ifdef __APPLE__
+    glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+#endif
+
+    // glfw window creation
+    // --------------------
+    GLFWwindow* window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, "LearnOpenGL", NULL, NULL);
+    if (window == NULL)
+    {
+        std::cout << "Failed to create GLFW window" << std::endl;
+        glfwTerminate();
+        return -1;
+    }
+    glfwMakeContextCurrent(window);
+    glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
+
+    // glad: load all OpenGL function pointers
+    // ---------------------------------------
+    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+    {
+        std::cout << "Failed to initialize GLAD" << std::endl;
+        return -1;
+    }
+    loadGLExtensions((GLADloadproc)glfwGetProcAddress);
+
+    // shader, texture and mesh out of the archive, or the loose files without one
+    // --------------------------------------------------------------------------
+    double loadStart = glfwGetTime();
+    AssetArchive assets;
+    Shader ourShader;
+    MeshData meshData;
+    unsigned int texture1 = 0;
+    if (assets.open(ASSET_ARCHIVE_PATH))
+    {
+        /// 只是提示，立刻返回；后面第一次访问这些页时多半已经不用再等磁盘了
+        assets.prefetchAll();
+        loadShader(assets, "shaders/mesh.vs", "shaders/mesh.fs", ourShader);
+        texture1 = loadTexture(assets, "textures/container.oritex");
+        if (!loadMesh(assets, "meshes/torus.orimesh", meshData))
+        {
+            glfwTerminate();
+            return -1;
+        }
+        std::cout << "assets: " << assets.count() << " entries mapped from " << ASSET_ARCHIVE_PATH << std::endl;
+    }
+    else
+    {
+        std::cout << "no " << ASSET_ARCHIVE_PATH << ", build the pack_assets target; loading loose files" << std::endl;
+        std::string vertexCode, fragmentCode;
+        if (!Shader::readFile("../1_base/6_mesh/helper/mesh.vs", vertexCode) ||
+            !Shader::readFile("../1_base/6_mesh/helper/mesh.fs", fragmentCode))
+            std::cout << "ERROR::SHADER::FILE_NOT_SUCCESFULLY_READ" << std::endl;
+        ourShader.build(vertexCode, fragmentCode);
+        texture1 = loadCookedTexture("cooked/container.oritex");
+        if (!loadMesh("../res/torus.obj", meshData, "mesh_cache"))
+        {
+            glfwTerminate();
+            return -1;
+        }
+    }
+    std::cout << "assets loaded in " << (glfwGetTime() - loadStart) * 1000.0 << " ms" << std::endl;
+
+    /// 紧凑顶点格式：半精度位置、16位归一化纹理坐标、2_10_10_10法线，每个顶点16字节而不是32字节
+    Mesh mesh;
+    mesh.upload(meshData, VertexLayout::compact());
+    mesh.printMemory(std::cout, "torus");
+    // everything is on the GPU now, the mapping is not needed anymore
+    assets.close();
+
+    ourShader.use();
+    ourShader.setInt("texture1", 0);
+    glm::vec3 lightDirection = glm::normalize(glm::vec3(-0.3f, -0.5f, -1.0f));
+    glUniform3f(ourShader.location(ourShader.uniform("lightDirection")), lightDirection.x, lightDirection.y, lightDirection.z);
+    // undo the texcoord quantization of the compact layout
+    const float* texCoordTransform = mesh.texCoordTransform();
+    ourShader.setVec4("texCoordTransform", texCoordTransform[0], texCoordTransform[1], texCoordTransform[2], texCoordTransform[3]);
+    UniformHandle modelLoc = ourShader.uniform("model");
+    UniformHandle viewLoc = ourShader.uniform("view");
+    UniformHandle projectionLoc = ourShader.uniform("projection");
+
+    glEnable(GL_DEPTH_TEST);
+
+    // shadow the bindings from here on so unchanged ones are not re-issued every frame
+    // -------------------------------------------------------------------------------
+    GLStateCache glState;
+
+    // render loop
+    // -----------
+    while (!glfwWindowShouldClose(window))
+    {
+        // input
+        // -----
+        processInput(window);
+
+        // render
+        // ------
+        glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+        glState.bindTextureUnit(0, GL_TEXTURE_2D, texture1);
+        glState.useProgram(ourShader.ID);
+
+        // create transformations
+        int framebufferWidth, framebufferHeight;
+        glfwGetFramebufferSize(window, &framebufferWidth, &framebufferHeight);
+        float aspect = framebufferHeight > 0 ? (float)framebufferWidth / framebufferHeight : 1.0f;
+        float time = (float)glfwGetTime();
+        glm::mat4 model = glm::rotate(glm::mat4(1.0f), time, glm::vec3(0.5f, 1.0f, 0.0f));
+        glm::mat4 view = glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 0.0f, -2.5f));
+        glm::mat4 projection = glm::perspective(glm::radians(45.0f), aspect, 0.1f, 100.0f);
+        ourShader.setMat4(modelLoc, glm::value_ptr(model));
+        ourShader.setMat4(viewLoc, glm::value_ptr(view));
+        ourShader.setMat4(projectionLoc, glm::value_ptr(projection));
+
+        // render the mesh
+        mesh.draw(glState);
+
+        // glfw: swap buffers and poll IO events (keys pressed/released, mouse moved etc.)
+        // -------------------------------------------------------------------------------
+        glfwSwapBuffers(window);
+        glfwPollEvents();
+    }
+
+    glState.printStats(std::cout);
+
+    // optional: de-allocate all resources once they've outlived their purpose:
+    // ------------------------------------------------------------------------
+    mesh.release();
+    glDeleteTextures(1, &texture1);
+    glDeleteProgram(ourShader.ID);
+
+    // glfw: terminate, clearing all previously allocated GLFW resources.
+    // ------------------------------------------------------------------
+    glfwTerminate();
+    return 0;
+}
+
+// process all input: query GLFW whether relevant keys are pressed/released this frame and react accordingly
+// ---------------------------------------------------------------------------------------------------------
+void processInput(GLFWwindow *window)
+{
+    if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
+        glfwSetWindowShouldClose(window, true);
+}
+
+// glfw: whenever the window size changed (by OS or user resize) this callback function executes
+// ---------------------------------------------------------------------------------------------
+void framebuffer_size_callback(GLFWwindow* window, int width, int height)
+{
+    // make sure the viewport matches the new window dimensions; note that width and
+    // height will be significantly larger than specified on retina displays.
+    glViewport(0, 0, width, height);
+}
@@ -0,0 +1,15 @@
+#version 330 core
+out vec4 FragColor;
+
+in vec2 TexCoord;
+in vec3 Normal;
+
+uniform sampler2D texture1;
+uniform vec3 lightDirection;
+
+void main()
+{
+    // 漫反射光照加一点环境光
+    float diffuse = max(dot(normalize(Normal), -lightDirection), 0.0);
+    FragColor = texture(texture1, TexCoord) * (0.2 + 0.8 * diffuse);
+}
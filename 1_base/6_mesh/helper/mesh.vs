@@ -0,0 +1,21 @@
+#version 330 core
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec2 aTexCoord;
+layout (location = 8) in vec3 aNormal;
+
+out vec2 TexCoord;
+out vec3 Normal;
+
+uniform mat4 model;
+uniform mat4 view;
+uniform mat4 projection;
+// quantized texcoords are stored relative to the mesh's texcoord bounds: scale, offset
+uniform vec4 texCoordTransform;
+
+void main()
+{
+    gl_Position = projection * view * model * vec4(aPos, 1.0f);
+    TexCoord = aTexCoord * texCoordTransform.xy + texCoordTransform.zw;
+    // model only rotates, no inverse transpose needed
+    Normal = mat3(model) * aNormal;
+}
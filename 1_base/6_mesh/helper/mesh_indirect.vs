@@ -0,0 +1,20 @@
+#version 330 core
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec2 aTexCoord;
+// 每个绘制的模型矩阵，占用location 2~5，由间接命令的baseInstance索引
+layout (location = 2) in mat4 aTransform;
+layout (location = 8) in vec3 aNormal;
+
+out vec2 TexCoord;
+out vec3 Normal;
+
+uniform mat4 view;
+uniform mat4 projection;
+
+void main()
+{
+    gl_Position = projection * view * aTransform * vec4(aPos, 1.0f);
+    TexCoord = aTexCoord;
+    // models only rotate and scale uniformly, no inverse transpose needed
+    Normal = mat3(aTransform) * aNormal;
+}
\ No newline at end of file
@@ -0,0 +1,28 @@
+#version 330 core
+out vec4 FragColor;
+
+#ifdef VERTEX_COLOR
+in vec3 ourColor;
+#endif
+#ifdef TEXTURE
+in vec2 TexCoord;
+uniform sampler2D texture1;
+#endif
+#ifdef TEXTURE2
+uniform sampler2D texture2;
+#endif
+
+void main()
+{
+    // 特性在编译期选定，片段着色器里没有运行时分支
+    vec4 color = vec4(1.0);
+#ifdef TEXTURE2
+    color = mix(texture(texture1, TexCoord), texture(texture2, TexCoord), 0.2);
+#elif defined(TEXTURE)
+    color = texture(texture1, TexCoord);
+#endif
+#ifdef VERTEX_COLOR
+    color *= vec4(ourColor, 1.0);
+#endif
+    FragColor = color;
+}
\ No newline at end of file
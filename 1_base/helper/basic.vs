@@ -0,0 +1,42 @@
+#version 330 core
+// 一份源码、多个变体：ShaderPermutations在#version之后插入启用特性的#define
+layout (location = 0) in vec3 aPos;
+#ifdef VERTEX_COLOR
+layout (location = 1) in vec3 aColor;
+#define TEXCOORD_LOCATION 2
+#else
+#define TEXCOORD_LOCATION 1
+#endif
+#ifdef TEXTURE
+layout (location = TEXCOORD_LOCATION) in vec2 aTexCoord;
+#endif
+
+#ifdef VERTEX_COLOR
+out vec3 ourColor;
+#endif
+#ifdef TEXTURE
+out vec2 TexCoord;
+#endif
+
+#ifdef TRANSFORM
+uniform mat4 transform;
+#endif
+
+void main()
+{
+#ifdef TRANSFORM
+    gl_Position = transform * vec4(aPos, 1.0);
+#else
+    gl_Position = vec4(aPos, 1.0);
+#endif
+#ifdef VERTEX_COLOR
+    ourColor = aColor;
+#endif
+#ifdef TEXTURE
+#ifdef FLIP_Y
+    TexCoord = vec2(aTexCoord.x, 1.0 - aTexCoord.y);
+#else
+    TexCoord = aTexCoord;
+#endif
+#endif
+}
\ No newline at end of file
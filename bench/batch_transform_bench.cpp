@@ -0,0 +1,102 @@
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include <batch_transform.h>
+
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+
+// microbenchmark: the per-object glm::translate -> glm::rotate -> glm::scale chain from
+// 1_transformation.cpp against the scalar and SIMD batch builders, plus an accuracy check
+// ---------------------------------------------------------------------------------------
+const size_t INSTANCE_COUNT = 1 << 16;
+const int ITERATIONS = 200;
+
+typedef std::chrono::high_resolution_clock Clock;
+
+static double millisecondsSince(Clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+int main(int argc, char** argv)
+{
+    size_t count = argc > 1 ? (size_t)std::atol(argv[1]) : INSTANCE_COUNT;
+
+    std::vector<float> x(count), y(count), z(count), angle(count), sx(count), sy(count), sz(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        x[i] = (float)(i % 256) / 128.0f - 1.0f;
+        y[i] = (float)(i / 256 % 256) / 128.0f - 1.0f;
+        z[i] = 0.0f;
+        // cover several turns in both directions
+        angle[i] = ((float)i / (float)count - 0.5f) * 100.0f;
+        sx[i] = sy[i] = sz[i] = 0.5f + (float)(i % 7) * 0.1f;
+    }
+    TransformBatchInput in;
+    in.x = &x[0];
+    in.y = &y[0];
+    in.z = &z[0];
+    in.angle = &angle[0];
+    in.scaleX = &sx[0];
+    in.scaleY = &sy[0];
+    in.scaleZ = &sz[0];
+
+    std::vector<glm::mat4> reference(count);
+    std::vector<float> scalar(count * 16), simd(count * 16);
+    float time = 0.0f;
+
+    Clock::time_point start = Clock::now();
+    for (int it = 0; it < ITERATIONS; ++it)
+    {
+        time = it * 0.016f;
+        for (size_t i = 0; i < count; ++i)
+        {
+            glm::mat4 transform = glm::mat4(1.0f);
+            transform = glm::translate(transform, glm::vec3(x[i], y[i], z[i]));
+            transform = glm::rotate(transform, angle[i] + time, glm::vec3(0.0f, 0.0f, 1.0f));
+            transform = glm::scale(transform, glm::vec3(sx[i], sy[i], sz[i]));
+            reference[i] = transform;
+        }
+    }
+    double glmMs = millisecondsSince(start) / ITERATIONS;
+
+    start = Clock::now();
+    for (int it = 0; it < ITERATIONS; ++it)
+    {
+        in.angleOffset = it * 0.016f;
+        buildTransformsScalar(in, count, &scalar[0]);
+    }
+    double scalarMs = millisecondsSince(start) / ITERATIONS;
+
+    start = Clock::now();
+    for (int it = 0; it < ITERATIONS; ++it)
+    {
+        in.angleOffset = it * 0.016f;
+        buildTransforms(in, count, &simd[0]);
+    }
+    double simdMs = millisecondsSince(start) / ITERATIONS;
+
+    // all three ran the last iteration with the same time offset
+    double scalarError = 0.0, simdError = 0.0;
+    for (size_t i = 0; i < count; ++i)
+    {
+        const float* expected = glm::value_ptr(reference[i]);
+        for (int k = 0; k < 16; ++k)
+        {
+            scalarError = std::fmax(scalarError, std::fabs(scalar[i * 16 + k] - expected[k]));
+            simdError = std::fmax(simdError, std::fabs(simd[i * 16 + k] - expected[k]));
+        }
+    }
+
+    std::cout << "instances: " << count << ", iterations: " << ITERATIONS << std::endl;
+    std::cout << "glm chain: " << glmMs << " ms" << std::endl;
+    std::cout << "scalar:    " << scalarMs << " ms (" << glmMs / scalarMs << "x)" << std::endl;
+    std::cout << batchTransformKernel() << ":      " << simdMs << " ms (" << glmMs / simdMs << "x)" << std::endl;
+    std::cout << "max abs error vs glm: scalar " << scalarError << ", " << batchTransformKernel() << " " << simdError << std::endl;
+    return simdError < 1e-5 ? 0 : 1;
+}
@@ -0,0 +1,665 @@
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <stb_image.h>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include <shader_s.h>
+#include <gl_ext.h>
+#include <gl_state.h>
+#include <profiler.h>
+#include <instanced_renderer.h>
+#include <batch_transform.h>
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <algorithm>
+#include <cstring>
+#include <cstdlib>
+#include <cmath>
+
+// fixed-workload benchmark: every scene of the samples (triangle, uniform, textures,
+// transformations, plus the instanced path) is rendered into a hidden window with vsync
+// off for a fixed number of frames at each object count of the sweep. the results go to
+// stdout (or --out) as one JSON document so two builds can be diffed by a script.
+//
+//     ori_bench [--frames N] [--warmup N] [--scene name] [--counts 1,1000,...] [--out file]
+//
+// run from the build directory like the samples, shaders and textures are found at ../
+// ---------------------------------------------------------------------------------------
+const unsigned int SCR_WIDTH = 800;
+const unsigned int SCR_HEIGHT = 600;
+
+typedef std::chrono::high_resolution_clock Clock;
+
+// what a scene did in one frame, summed over the measured frames
+struct FrameCounters
+{
+    unsigned long drawCalls;
+    unsigned long bytesUploaded;
+};
+
+const char* triangleVertexSource = "#version 330 core\n"
+                                   "layout (location = 0) in vec3 aPos;\n"
+                                   "void main()\n"
+                                   "{\n"
+                                   "   gl_Position = vec4(aPos, 1.0);\n"
+                                   "}\n";
+const char* triangleFragmentSource = "#version 330 core\n"
+                                     "out vec4 FragColor;\n"
+                                     "void main()\n"
+                                     "{\n"
+                                     "   FragColor = vec4(1.0f, 0.5f, 0.2f, 1.0f);\n"
+                                     "}\n";
+const char* uniformVertexSource = "#version 330 core\n"
+                                  "layout (location = 0) in vec3 aPos;\n"
+                                  "uniform vec2 offset;\n"
+                                  "uniform float scale;\n"
+                                  "void main()\n"
+                                  "{\n"
+                                  "   gl_Position = vec4(aPos.xy * scale + offset, aPos.z, 1.0);\n"
+                                  "}\n";
+const char* uniformFragmentSource = "#version 330 core\n"
+                                    "out vec4 FragColor;\n"
+                                    "uniform vec4 ourColor;\n"
+                                    "void main()\n"
+                                    "{\n"
+                                    "   FragColor = ourColor;\n"
+                                    "}\n";
+
+// objects are laid out on the smallest square grid that holds them
+// ------------------------------------------------------------------------
+struct Grid
+{
+    unsigned int side;
+    float cell;
+
+    explicit Grid(unsigned int count)
+    {
+        side = (unsigned int)std::ceil(std::sqrt((double)count));
+        if (side == 0)
+            side = 1;
+        cell = 2.0f / side;
+    }
+    float x(unsigned int i) const { return -1.0f + (i % side + 0.5f) * cell; }
+    float y(unsigned int i) const { return -1.0f + (i / side + 0.5f) * cell; }
+};
+
+class Scene
+{
+public:
+    virtual ~Scene() {}
+    virtual const char* name() const = 0;
+    // create everything for count objects, false if the scene cannot run
+    virtual bool setup(unsigned int count) = 0;
+    virtual void frame(float time, GLStateCache& state, FrameCounters& counters) = 0;
+    virtual void teardown() = 0;
+};
+
+// shared quad for the textured scenes, the same data as 1_transformation.cpp
+// ------------------------------------------------------------------------
+struct Quad
+{
+    unsigned int VAO, VBO, EBO;
+
+    void create()
+    {
+        float vertices[] = {
+                // positions          // texture coords
+                0.5f,  0.5f, 0.0f,   1.0f, 1.0f, // top right
+                0.5f, -0.5f, 0.0f,   1.0f, 0.0f, // bottom right
+                -0.5f, -0.5f, 0.0f,   0.0f, 0.0f, // bottom left
+                -0.5f,  0.5f, 0.0f,   0.0f, 1.0f  // top left
+        };
+        unsigned int indices[] = {
+                0, 1, 3, // first triangle
+                1, 2, 3  // second triangle
+        };
+        glGenVertexArrays(1, &VAO);
+        glGenBuffers(1, &VBO);
+        glGenBuffers(1, &EBO);
+        glBindVertexArray(VAO);
+        glBindBuffer(GL_ARRAY_BUFFER, VBO);
+        glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)0);
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)(3 * sizeof(float)));
+        glEnableVertexAttribArray(1);
+    }
+    void destroy()
+    {
+        glDeleteVertexArrays(1, &VAO);
+        glDeleteBuffers(1, &VBO);
+        glDeleteBuffers(1, &EBO);
+    }
+};
+
+static unsigned int loadTexture(const char* path)
+{
+    unsigned int texture;
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    stbi_set_flip_vertically_on_load(true);
+    int width, height, nrChannels;
+    unsigned char* data = stbi_load(path, &width, &height, &nrChannels, 4);
+    if (data)
+    {
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
+        glGenerateMipmap(GL_TEXTURE_2D);
+    }
+    else
+    {
+        std::cerr << "Failed to load texture " << path << std::endl;
+    }
+    stbi_image_free(data);
+    return texture;
+}
+
+// 2_triangle: all triangles in one static VBO, a single glDrawArrays
+// ------------------------------------------------------------------------
+class TriangleScene : public Scene
+{
+public:
+    const char* name() const { return "triangle"; }
+    bool setup(unsigned int n)
+    {
+        count = n;
+        shader.build(triangleVertexSource, triangleFragmentSource);
+        Grid grid(count);
+        std::vector<float> vertices((size_t)count * 9);
+        float h = grid.cell * 0.4f;
+        for (unsigned int i = 0; i < count; ++i)
+        {
+            float x = grid.x(i), y = grid.y(i);
+            float tri[9] = { x - h, y - h, 0.0f, x + h, y - h, 0.0f, x, y + h, 0.0f };
+            std::memcpy(&vertices[(size_t)i * 9], tri, sizeof(tri));
+        }
+        glGenVertexArrays(1, &VAO);
+        glGenBuffers(1, &VBO);
+        glBindVertexArray(VAO);
+        glBindBuffer(GL_ARRAY_BUFFER, VBO);
+        glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), &vertices[0], GL_STATIC_DRAW);
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
+        glEnableVertexAttribArray(0);
+        return shader.finish();
+    }
+    void frame(float, GLStateCache& state, FrameCounters& counters)
+    {
+        state.useProgram(shader.ID);
+        state.bindVertexArray(VAO);
+        glDrawArrays(GL_TRIANGLES, 0, count * 3);
+        ++counters.drawCalls;
+    }
+    void teardown()
+    {
+        glDeleteVertexArrays(1, &VAO);
+        glDeleteBuffers(1, &VBO);
+        glDeleteProgram(shader.ID);
+        shader.ID = 0;
+    }
+
+private:
+    unsigned int count, VAO, VBO;
+    Shader shader;
+};
+
+// 1_uniform: one draw per object, color and offset set through uniforms
+// ------------------------------------------------------------------------
+class UniformScene : public Scene
+{
+public:
+    UniformScene() : grid(1) {}
+    const char* name() const { return "uniform"; }
+    bool setup(unsigned int n)
+    {
+        count = n;
+        grid = Grid(count);
+        shader.build(uniformVertexSource, uniformFragmentSource);
+        offsetLoc = shader.uniform("offset");
+        scaleLoc = shader.uniform("scale");
+        colorLoc = shader.uniform("ourColor");
+        float h = 0.4f;
+        float vertices[] = { -h, -h, 0.0f, h, -h, 0.0f, 0.0f, h, 0.0f };
+        glGenVertexArrays(1, &VAO);
+        glGenBuffers(1, &VBO);
+        glBindVertexArray(VAO);
+        glBindBuffer(GL_ARRAY_BUFFER, VBO);
+        glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
+        glEnableVertexAttribArray(0);
+        return shader.finish();
+    }
+    void frame(float time, GLStateCache& state, FrameCounters& counters)
+    {
+        state.useProgram(shader.ID);
+        state.bindVertexArray(VAO);
+        glUniform1f(shader.location(scaleLoc), grid.cell);
+        counters.bytesUploaded += sizeof(float);
+        float green = std::sin(time) / 2.0f + 0.5f;
+        for (unsigned int i = 0; i < count; ++i)
+        {
+            glUniform2f(shader.location(offsetLoc), grid.x(i), grid.y(i));
+            glUniform4f(shader.location(colorLoc), 0.0f, green, (float)(i & 255) / 255.0f, 1.0f);
+            glDrawArrays(GL_TRIANGLES, 0, 3);
+        }
+        counters.drawCalls += count;
+        counters.bytesUploaded += (unsigned long)count * 6 * sizeof(float);
+    }
+    void teardown()
+    {
+        glDeleteVertexArrays(1, &VAO);
+        glDeleteBuffers(1, &VBO);
+        glDeleteProgram(shader.ID);
+        shader.ID = 0;
+    }
+
+private:
+    unsigned int count, VAO, VBO;
+    Grid grid;
+    Shader shader;
+    UniformHandle offsetLoc, scaleLoc, colorLoc;
+};
+
+// 2_texture: two textures per object, swapped between neighbours so the binds
+// really change, static transforms
+// ------------------------------------------------------------------------
+class TextureScene : public Scene
+{
+public:
+    const char* name() const { return "textures"; }
+    bool setup(unsigned int n)
+    {
+        count = n;
+        Shader::readFile("../1_base/5_transformations/helper/shader.vs", vertexCode);
+        Shader::readFile("../1_base/5_transformations/helper/shader_texture2.fs", fragmentCode);
+        if (!shader.build(vertexCode, fragmentCode))
+            return false;
+        shader.use();
+        shader.setInt("texture1", 0);
+        shader.setInt("texture2", 1);
+        transformLoc = shader.uniform("transform");
+        quad.create();
+        textures[0] = loadTexture("../res/container.jpeg");
+        textures[1] = loadTexture("../res/awesomeface.png");
+        Grid grid(count);
+        transforms.resize(count);
+        for (unsigned int i = 0; i < count; ++i)
+        {
+            glm::mat4 transform = glm::translate(glm::mat4(1.0f), glm::vec3(grid.x(i), grid.y(i), 0.0f));
+            transforms[i] = glm::scale(transform, glm::vec3(grid.cell * 0.8f));
+        }
+        return true;
+    }
+    void frame(float, GLStateCache& state, FrameCounters& counters)
+    {
+        state.useProgram(shader.ID);
+        state.bindVertexArray(quad.VAO);
+        for (unsigned int i = 0; i < count; ++i)
+        {
+            state.bindTextureUnit(0, GL_TEXTURE_2D, textures[i & 1]);
+            state.bindTextureUnit(1, GL_TEXTURE_2D, textures[(i + 1) & 1]);
+            shader.setMat4(transformLoc, glm::value_ptr(transforms[i]));
+            glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+        }
+        counters.drawCalls += count;
+        counters.bytesUploaded += (unsigned long)count * sizeof(glm::mat4);
+    }
+    void teardown()
+    {
+        quad.destroy();
+        glDeleteTextures(2, textures);
+        glDeleteProgram(shader.ID);
+        shader.ID = 0;
+    }
+
+protected:
+    unsigned int count;
+    std::string vertexCode, fragmentCode;
+    Shader shader;
+    UniformHandle transformLoc;
+    Quad quad;
+    unsigned int textures[2];
+    std::vector<glm::mat4> transforms;
+};
+
+// 1_transformation: the glm translate -> rotate -> scale chain and a glUniformMatrix4fv
+// per object every frame, textures bound once
+// ------------------------------------------------------------------------
+class TransformationScene : public TextureScene
+{
+public:
+    const char* name() const { return "transformations"; }
+    bool setup(unsigned int n)
+    {
+        if (!TextureScene::setup(n))
+            return false;
+        Grid grid(count);
+        positions.resize(count);
+        for (unsigned int i = 0; i < count; ++i)
+            positions[i] = glm::vec3(grid.x(i), grid.y(i), 0.0f);
+        scale = grid.cell * 0.8f;
+        return true;
+    }
+    void frame(float time, GLStateCache& state, FrameCounters& counters)
+    {
+        state.useProgram(shader.ID);
+        state.bindVertexArray(quad.VAO);
+        state.bindTextureUnit(0, GL_TEXTURE_2D, textures[0]);
+        state.bindTextureUnit(1, GL_TEXTURE_2D, textures[1]);
+        for (unsigned int i = 0; i < count; ++i)
+        {
+            glm::mat4 transform = glm::mat4(1.0f);
+            transform = glm::translate(transform, positions[i]);
+            transform = glm::rotate(transform, time + 0.01f * i, glm::vec3(0.0f, 0.0f, 1.0f));
+            transform = glm::scale(transform, glm::vec3(scale));
+            shader.setMat4(transformLoc, glm::value_ptr(transform));
+            glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+        }
+        counters.drawCalls += count;
+        counters.bytesUploaded += (unsigned long)count * sizeof(glm::mat4);
+    }
+
+private:
+    std::vector<glm::vec3> positions;
+    float scale;
+};
+
+// 2_instancing: the same rotating quads built by the batch builder into the mapped
+// instance buffer and drawn with one glDrawElementsInstanced
+// ------------------------------------------------------------------------
+class InstancedScene : public Scene
+{
+public:
+    InstancedScene() : quads(NULL) {}
+    const char* name() const { return "instanced"; }
+    bool setup(unsigned int n)
+    {
+        count = n;
+        std::string vertexCode, fragmentCode;
+        Shader::readFile("../1_base/5_transformations/helper/shader_instanced.vs", vertexCode);
+        Shader::readFile("../1_base/5_transformations/helper/shader_texture2.fs", fragmentCode);
+        if (!shader.build(vertexCode, fragmentCode))
+            return false;
+        shader.use();
+        shader.setInt("texture1", 0);
+        shader.setInt("texture2", 1);
+        quad.create();
+        textures[0] = loadTexture("../res/container.jpeg");
+        textures[1] = loadTexture("../res/awesomeface.png");
+        quads = new InstancedRenderer(quad.VAO, 6);
+        Grid grid(count);
+        posX.resize(count);
+        posY.resize(count);
+        posZ.assign(count, 0.0f);
+        angles.resize(count);
+        scales.assign(count, grid.cell * 0.8f);
+        for (unsigned int i = 0; i < count; ++i)
+        {
+            posX[i] = grid.x(i);
+            posY[i] = grid.y(i);
+            angles[i] = 0.01f * i;
+        }
+        batch.x = &posX[0];
+        batch.y = &posY[0];
+        batch.z = &posZ[0];
+        batch.angle = &angles[0];
+        batch.scaleX = batch.scaleY = batch.scaleZ = &scales[0];
+        return true;
+    }
+    void frame(float time, GLStateCache& state, FrameCounters& counters)
+    {
+        batch.angleOffset = time;
+        buildTransforms(batch, count, quads->mapInstances(count));
+        quads->unmapInstances();
+        state.useProgram(shader.ID);
+        state.bindTextureUnit(0, GL_TEXTURE_2D, textures[0]);
+        state.bindTextureUnit(1, GL_TEXTURE_2D, textures[1]);
+        quads->draw(state);
+        ++counters.drawCalls;
+        counters.bytesUploaded += (unsigned long)count * sizeof(glm::mat4);
+    }
+    void teardown()
+    {
+        quads->release();
+        delete quads;
+        quads = NULL;
+        quad.destroy();
+        glDeleteTextures(2, textures);
+        glDeleteProgram(shader.ID);
+        shader.ID = 0;
+    }
+
+private:
+    unsigned int count;
+    Shader shader;
+    Quad quad;
+    unsigned int textures[2];
+    InstancedRenderer* quads;
+    std::vector<float> posX, posY, posZ, angles, scales;
+    TransformBatchInput batch;
+};
+
+struct Result
+{
+    std::string scene;
+    unsigned int objects;
+    int frames;
+    float cpuP50, cpuP99, gpuP50, gpuP99;
+    double drawCallsPerFrame, bytesPerFrame;
+};
+
+static float percentile(std::vector<float> samples, float p)
+{
+    if (samples.empty())
+        return 0.0f;
+    std::sort(samples.begin(), samples.end());
+    size_t k = (size_t)(p * (samples.size() - 1) + 0.5f);
+    return samples[std::min(k, samples.size() - 1)];
+}
+
+static Result run(GLFWwindow* window, Scene& scene, unsigned int count, int warmup, int frames)
+{
+    Result result;
+    result.scene = scene.name();
+    result.objects = count;
+    result.frames = 0;
+    result.cpuP50 = result.cpuP99 = result.gpuP50 = result.gpuP99 = 0.0f;
+    result.drawCallsPerFrame = result.bytesPerFrame = 0.0;
+    if (!scene.setup(count))
+    {
+        std::cerr << "ERROR::BENCH::SETUP_FAILED " << scene.name() << std::endl;
+        return result;
+    }
+
+    GLStateCache state;
+    // the scene's GPU time comes from the profiler's frame scope, so the history has
+    // to hold every measured frame
+    Profiler profiler;
+    std::vector<float> cpuMs, gpuMs;
+    FrameCounters counters = { 0, 0 };
+    unsigned int resolvedFrames = 0;
+    for (int i = 0; i < warmup + frames + Profiler::FRAMES_IN_FLIGHT; ++i)
+    {
+        bool measured = i >= warmup && i < warmup + frames;
+        Clock::time_point start = Clock::now();
+        profiler.beginFrame();
+        glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT);
+        FrameCounters frame = { 0, 0 };
+        scene.frame(i * (1.0f / 60.0f), state, frame);
+        profiler.endFrame();
+        glfwSwapBuffers(window);
+        glfwPollEvents();
+        if (measured)
+        {
+            cpuMs.push_back((float)std::chrono::duration<double, std::milli>(Clock::now() - start).count());
+            counters.drawCalls += frame.drawCalls;
+            counters.bytesUploaded += frame.bytesUploaded;
+            ++result.frames;
+        }
+        // results of frame i arrive FRAMES_IN_FLIGHT frames later, dropped ones never
+        int resolved = i - Profiler::FRAMES_IN_FLIGHT;
+        const Profiler::ScopeHistory* history = profiler.scope("frame");
+        if (history && history->count != resolvedFrames)
+        {
+            resolvedFrames = history->count;
+            if (resolved >= warmup && resolved < warmup + frames)
+                gpuMs.push_back(history->gpuMs[(history->count - 1) % Profiler::HISTORY]);
+        }
+    }
+    glFinish();
+    profiler.release();
+    scene.teardown();
+
+    result.cpuP50 = percentile(cpuMs, 0.5f);
+    result.cpuP99 = percentile(cpuMs, 0.99f);
+    result.gpuP50 = percentile(gpuMs, 0.5f);
+    result.gpuP99 = percentile(gpuMs, 0.99f);
+    if (result.frames > 0)
+    {
+        result.drawCallsPerFrame = (double)counters.drawCalls / result.frames;
+        result.bytesPerFrame = (double)counters.bytesUploaded / result.frames;
+    }
+    return result;
+}
+
+static void writeResults(std::ostream& out, const std::vector<Result>& results)
+{
+    const GLubyte* renderer = glGetString(GL_RENDERER);
+    const GLubyte* version = glGetString(GL_VERSION);
+    out << "{\n  \"renderer\": ";
+    writeJsonString(out, (const char*)renderer);
+    out << ",\n  \"version\": ";
+    writeJsonString(out, (const char*)version);
+    out << ",\n";
+    out << "  \"results\": [\n";
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+        const Result& r = results[i];
+        out << "    {\"scene\": ";
+        writeJsonString(out, r.scene.c_str());
+        out << ", \"objects\": " << r.objects << ", \"frames\": " << r.frames
+            << ", \"cpu_p50_ms\": " << r.cpuP50 << ", \"cpu_p99_ms\": " << r.cpuP99
+            << ", \"gpu_p50_ms\": " << r.gpuP50 << ", \"gpu_p99_ms\": " << r.gpuP99
+            << ", \"draw_calls\": " << r.drawCallsPerFrame << ", \"bytes_uploaded\": " << r.bytesPerFrame << "}"
+            << (i + 1 < results.size() ? ",\n" : "\n");
+    }
+    out << "  ]\n}\n";
+}
+
+int main(int argc, char** argv)
+{
+    int frames = 300, warmup = 30;
+    const char* only = NULL;
+    const char* outPath = NULL;
+    std::vector<unsigned int> counts;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "--frames") == 0 && i + 1 < argc)
+            frames = std::atoi(argv[++i]);
+        else if (std::strcmp(argv[i], "--warmup") == 0 && i + 1 < argc)
+            warmup = std::atoi(argv[++i]);
+        else if (std::strcmp(argv[i], "--scene") == 0 && i + 1 < argc)
+            only = argv[++i];
+        else if (std::strcmp(argv[i], "--out") == 0 && i + 1 < argc)
+            outPath = argv[++i];
+        else if (std::strcmp(argv[i], "--counts") == 0 && i + 1 < argc)
+        {
+            std::stringstream list(argv[++i]);
+            std::string item;
+            while (std::getline(list, item, ','))
+                counts.push_back((unsigned int)std::atol(item.c_str()));
+        }
+        else
+        {
+            std::cerr << "usage: ori_bench [--frames N] [--warmup N] [--scene name] [--counts 1,1000,...] [--out file]" << std::endl;
+            return 1;
+        }
+    }
+    if (counts.empty())
+    {
+        unsigned int sweep[] = { 1, 1000, 10000, 100000 };
+        counts.assign(sweep, sweep + 4);
+    }
+    // the scenes index their first object and the statistics need at least one frame
+    if (frames < 1 || warmup < 0 || std::find(counts.begin(), counts.end(), 0u) != counts.end())
+    {
+        std::cerr << "ERROR::BENCH::INVALID_ARGUMENTS frames and object counts must be at least 1, warmup at least 0"
+                  << std::endl;
+        return 1;
+    }
+
+    // glfw: hidden window, the default framebuffer is still rendered to
+    // ------------------------------------------------------------------
+    glfwInit();
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+#ifdef __APPLE__
+    glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+#endif
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+    GLFWwindow* window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, "ori_bench", NULL, NULL);
+    if (window == NULL)
+    {
+        std::cerr << "Failed to create GLFW window" << std::endl;
+        glfwTerminate();
+        return -1;
+    }
+    glfwMakeContextCurrent(window);
+    // vsync off, we want to measure our own frame time
+    glfwSwapInterval(0);
+    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+    {
+        std::cerr << "Failed to initialize GLAD" << std::endl;
+        return -1;
+    }
+    loadGLExtensions((GLADloadproc)glfwGetProcAddress);
+    int framebufferWidth, framebufferHeight;
+    glfwGetFramebufferSize(window, &framebufferWidth, &framebufferHeight);
+    glViewport(0, 0, framebufferWidth, framebufferHeight);
+
+    TriangleScene triangle;
+    UniformScene uniform;
+    TextureScene textures;
+    TransformationScene transformations;
+    InstancedScene instanced;
+    Scene* scenes[] = { &triangle, &uniform, &textures, &transformations, &instanced };
+
+    std::vector<Result> results;
+    for (size_t s = 0; s < sizeof(scenes) / sizeof(scenes[0]); ++s)
+    {
+        if (only && std::strcmp(only, scenes[s]->name()) != 0)
+            continue;
+        for (size_t c = 0; c < counts.size(); ++c)
+        {
+            Result r = run(window, *scenes[s], counts[c], warmup, frames);
+            std::cerr << r.scene << " x" << r.objects << ": cpu p50 " << r.cpuP50 << " ms, p99 " << r.cpuP99
+                      << " ms, gpu p50 " << r.gpuP50 << " ms" << std::endl;
+            results.push_back(r);
+        }
+    }
+
+    if (outPath)
+    {
+        std::ofstream file(outPath, std::ios::trunc);
+        writeResults(file, results);
+    }
+    else
+        writeResults(std::cout, results);
+
+    glfwTerminate();
+    return 0;
+}
@@ -0,0 +1,71 @@
+#include "alloc_counter.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#ifdef ORI_COUNT_ALLOCATIONS
+namespace
+{
+std::atomic<unsigned long> allocationCount(0);
+}
+
+// replaceable global allocation functions: plain, array and their nothrow forms.
+// C++11 has no sized or aligned forms to replace
+// ------------------------------------------------------------------------
+void* operator new(std::size_t size)
+{
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    void* p = std::malloc(size ? size : 1);
+    if (!p)
+        throw std::bad_alloc();
+    return p;
+}
+void* operator new[](std::size_t size)
+{
+    return operator new(size);
+}
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    return std::malloc(size ? size : 1);
+}
+void* operator new[](std::size_t size, const std::nothrow_t& tag) noexcept
+{
+    return operator new(size, tag);
+}
+void operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+void operator delete[](void* p) noexcept
+{
+    std::free(p);
+}
+void operator delete(void* p, const std::nothrow_t&) noexcept
+{
+    std::free(p);
+}
+void operator delete[](void* p, const std::nothrow_t&) noexcept
+{
+    std::free(p);
+}
+
+unsigned long heapAllocations()
+{
+    return allocationCount.load(std::memory_order_relaxed);
+}
+bool heapAllocationsCounted()
+{
+    return true;
+}
+#else
+unsigned long heapAllocations()
+{
+    return 0;
+}
+bool heapAllocationsCounted()
+{
+    return false;
+}
+#endif
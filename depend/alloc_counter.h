@@ -0,0 +1,18 @@
+#ifndef ALLOC_COUNTER_H
+#define ALLOC_COUNTER_H
+
+// counts calls to the global operator new / new[] of this program, to check that a
+// steady-state frame does not touch the heap:
+//
+//     unsigned long before = heapAllocations();
+//     ... one frame ...
+//     if (heapAllocations() != before) ...
+//
+// the replacement operators live in alloc_counter.cpp and are only compiled with
+// ORI_COUNT_ALLOCATIONS (cmake -DORI_COUNT_ALLOCATIONS=ON); without it the count stays 0.
+// malloc calls made by C libraries (GLFW, the GL driver) are not seen.
+unsigned long heapAllocations();
+// false when the counters are compiled out
+bool heapAllocationsCounted();
+
+#endif
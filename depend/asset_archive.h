@@ -0,0 +1,283 @@
+#ifndef ASSET_ARCHIVE_H
+#define ASSET_ARCHIVE_H
+
+#include <glad/glad.h>
+#include <stb_image.h>
+
+#include <mapped_file.h>
+#include <string_ref.h>
+#include <shader_s.h>
+#include <cooked_texture.h>
+#include <mesh_loader.h>
+
+#include <cstring>
+#include <cstdint>
+#include <cstddef>
+#include <iostream>
+
+// .oripack: the assets of a sample packed into one file by tools/asset_packer.cpp (the
+// pack_assets target), so startup is one open and one memory map instead of an open
+// plus a read into our own buffer per texture and shader. entries are spans of the
+// mapping: shader sources go to glShaderSource, images to stbi_load_from_memory and
+// cooked textures straight to glTexImage2D without being copied first.
+//
+//     AssetArchive assets;
+//     if (assets.open("assets.oripack"))
+//     {
+//         assets.prefetchAll();                                    // reads ahead in the background
+//         loadShader(assets, "shaders/mesh.vs", "shaders/mesh.fs", shader);
+//         unsigned int texture = loadTexture(assets, "textures/container.oritex");
+//         loadMesh(assets, "meshes/torus.orimesh", meshData);
+//     }
+//
+// layout (little endian):
+//     AssetArchiveHeader
+//     AssetArchiveEntry[entryCount]     sorted by name, for a binary search
+//     names, not zero terminated
+//     blobs, each starting on an ASSET_ARCHIVE_ALIGNMENT boundary and followed by at
+//     least one zero byte, so text entries are also C strings
+//
+// the alignment is a page: a prefetch or the first touch of one entry does not read
+// the neighbouring ones, and cooked texture levels keep their own 16 byte alignment.
+
+const uint32_t ASSET_ARCHIVE_VERSION = 1;
+const uint32_t ASSET_ARCHIVE_ALIGNMENT = 4096;
+
+enum AssetType
+{
+    ASSET_RAW = 0,
+    // .oritex, cooked_texture.h
+    ASSET_COOKED_TEXTURE = 1,
+    // an encoded image stb_image can decode: png, jpeg, ...
+    ASSET_IMAGE = 2,
+    // GLSL source
+    ASSET_SHADER = 3,
+    // .orimesh, mesh_loader.h
+    ASSET_MESH = 4
+};
+
+struct AssetArchiveHeader
+{
+    char magic[4];              // "ORPK"
+    uint32_t version;
+    uint32_t entryCount;
+    uint32_t namesSize;
+    // from the start of the file
+    uint64_t namesOffset;
+    uint64_t reserved;
+};
+
+struct AssetArchiveEntry
+{
+    // into the names
+    uint32_t nameOffset;
+    uint32_t nameLength;
+    uint32_t type;
+    uint32_t reserved;
+    // from the start of the file
+    uint64_t offset;
+    uint64_t size;
+};
+
+// the bytes of one entry, inside the archive's mapping
+// ------------------------------------------------------------------------
+struct AssetSpan
+{
+    const unsigned char* data;
+    size_t size;
+    uint32_t type;
+
+    AssetSpan() : data(NULL), size(0), type(ASSET_RAW) {}
+    bool valid() const { return data != NULL; }
+    StringRef text() const { return StringRef((const char*)data, size); }
+};
+
+class AssetArchive
+{
+public:
+    AssetArchive() : header(NULL), entries(NULL), names(NULL) {}
+
+    // map the archive and validate the header and the table of contents
+    // ------------------------------------------------------------------------
+    bool open(const char* path)
+    {
+        close();
+        if (!file.open(path))
+        {
+            std::cout << "ERROR::ASSET_ARCHIVE::FILE_NOT_SUCCESFULLY_READ " << path << std::endl;
+            return false;
+        }
+        if (!parse())
+        {
+            std::cout << "ERROR::ASSET_ARCHIVE::INVALID " << path << std::endl;
+            close();
+            return false;
+        }
+        return true;
+    }
+    void close()
+    {
+        file.close();
+        header = NULL;
+        entries = NULL;
+        names = NULL;
+    }
+
+    bool isOpen() const { return header != NULL; }
+    size_t count() const { return header ? header->entryCount : 0; }
+    StringRef name(size_t i) const { return StringRef(names + entries[i].nameOffset, entries[i].nameLength); }
+    AssetSpan entry(size_t i) const
+    {
+        AssetSpan span;
+        span.data = file.data() + entries[i].offset;
+        span.size = (size_t)entries[i].size;
+        span.type = entries[i].type;
+        return span;
+    }
+
+    // binary search of the table of contents, an invalid span if there is no such entry
+    // ------------------------------------------------------------------------
+    AssetSpan find(StringRef key) const
+    {
+        size_t i = lowerBound(key);
+        if (i < count() && name(i) == key)
+            return entry(i);
+        return AssetSpan();
+    }
+
+    // start reading entries in the background (madvise(MADV_WILLNEED) /
+    // PrefetchVirtualMemory), e.g. the textures while the shaders compile
+    // ------------------------------------------------------------------------
+    void prefetch(StringRef key) const
+    {
+        size_t i = lowerBound(key);
+        if (i < count() && name(i) == key)
+            file.prefetch((size_t)entries[i].offset, (size_t)entries[i].size);
+    }
+    void prefetchAll() const
+    {
+        if (count() > 0)
+            file.prefetch((size_t)entries[0].offset, file.size() - (size_t)entries[0].offset);
+    }
+
+private:
+    MappedFile file;
+    const AssetArchiveHeader* header;
+    const AssetArchiveEntry* entries;
+    const char* names;
+
+    bool parse()
+    {
+        size_t size = file.size();
+        if (size < sizeof(AssetArchiveHeader))
+            return false;
+        const AssetArchiveHeader* h = (const AssetArchiveHeader*)file.data();
+        if (std::memcmp(h->magic, "ORPK", 4) != 0 || h->version != ASSET_ARCHIVE_VERSION)
+            return false;
+        if ((size - sizeof(AssetArchiveHeader)) / sizeof(AssetArchiveEntry) < h->entryCount)
+            return false;
+        if (h->namesOffset > size || h->namesSize > size - h->namesOffset)
+            return false;
+        const AssetArchiveEntry* e = (const AssetArchiveEntry*)(h + 1);
+        for (uint32_t i = 0; i < h->entryCount; ++i)
+        {
+            if (e[i].offset > size || e[i].size > size - e[i].offset ||
+                e[i].nameOffset > h->namesSize || e[i].nameLength > h->namesSize - e[i].nameOffset)
+                return false;
+        }
+        header = h;
+        entries = e;
+        names = (const char*)file.data() + h->namesOffset;
+        return true;
+    }
+
+    // first entry whose name is not less than key, byte-wise like the packer sorts
+    size_t lowerBound(StringRef key) const
+    {
+        size_t first = 0, n = count();
+        while (n > 0)
+        {
+            size_t half = n / 2;
+            if (less(name(first + half), key))
+            {
+                first += half + 1;
+                n -= half + 1;
+            }
+            else
+                n = half;
+        }
+        return first;
+    }
+    static bool less(StringRef a, StringRef b)
+    {
+        int order = std::memcmp(a.data, b.data, a.length < b.length ? a.length : b.length);
+        return order < 0 || (order == 0 && a.length < b.length);
+    }
+
+    AssetArchive(const AssetArchive&);
+    AssetArchive& operator=(const AssetArchive&);
+};
+
+// compile and link the two sources straight from the mapping
+// ------------------------------------------------------------------------
+inline bool loadShader(const AssetArchive& archive, StringRef vertexName, StringRef fragmentName, Shader& shader,
+                       ProgramCache* cache = NULL)
+{
+    AssetSpan vertex = archive.find(vertexName);
+    AssetSpan fragment = archive.find(fragmentName);
+    if (!vertex.valid() || !fragment.valid())
+    {
+        std::cout << "ERROR::ASSET_ARCHIVE::SHADER_NOT_FOUND " << vertexName << " " << fragmentName << std::endl;
+        return false;
+    }
+    return shader.build(vertex.text(), fragment.text(), cache);
+}
+
+// a new GL_TEXTURE_2D from a cooked texture, uploaded from the mapping level by level,
+// or from an image decoded with stbi_load_from_memory (flipped, RGBA, mipmapped).
+// returns 0 on failure
+// ------------------------------------------------------------------------
+inline unsigned int loadTexture(const AssetArchive& archive, StringRef name, GLenum wrap = GL_REPEAT)
+{
+    AssetSpan span = archive.find(name);
+    if (span.type == ASSET_COOKED_TEXTURE)
+    {
+        CookedTextureView view;
+        if (view.parse(span.data, span.size))
+            return uploadCookedTexture(view, wrap);
+    }
+    else if (span.type == ASSET_IMAGE)
+    {
+        int width, height, channels;
+        stbi_set_flip_vertically_on_load(true);
+        unsigned char* pixels = stbi_load_from_memory(span.data, (int)span.size, &width, &height, &channels, 4);
+        if (pixels)
+        {
+            unsigned int texture;
+            glGenTextures(1, &texture);
+            glBindTexture(GL_TEXTURE_2D, texture);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, wrap);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, wrap);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+            glGenerateMipmap(GL_TEXTURE_2D);
+            stbi_image_free(pixels);
+            return texture;
+        }
+    }
+    std::cout << "ERROR::ASSET_ARCHIVE::TEXTURE_NOT_SUCCESFULLY_READ " << name << std::endl;
+    return 0;
+}
+
+// a mesh cooked (imported and optimized) by the packer
+// ------------------------------------------------------------------------
+inline bool loadMesh(const AssetArchive& archive, StringRef name, MeshData& mesh)
+{
+    AssetSpan span = archive.find(name);
+    if (span.type == ASSET_MESH && parseCookedMesh(span.data, span.size, mesh))
+        return true;
+    std::cout << "ERROR::ASSET_ARCHIVE::MESH_NOT_SUCCESFULLY_READ " << name << std::endl;
+    return false;
+}
+#endif
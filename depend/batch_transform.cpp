@@ -0,0 +1,308 @@
+#include "batch_transform.h"
+
+#include <cmath>
+#include <cstring>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define BATCH_TRANSFORM_AVX2 1
+#define BATCH_TRANSFORM_SSE2 1
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define BATCH_TRANSFORM_SSE2 1
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define BATCH_TRANSFORM_NEON 1
+#endif
+
+// sincos with the cephes single precision scheme: reduce to [-pi/4, pi/4] with an
+// extended precision pi/4, evaluate both minimax polynomials and pick/negate per octant
+// ------------------------------------------------------------------------
+namespace
+{
+const float FOUR_OVER_PI = 1.27323954473516f;
+const float DP1 = 0.78515625f;
+const float DP2 = 2.4187564849853515625e-4f;
+const float DP3 = 3.77489497744594108e-8f;
+const float SIN_C0 = -1.9515295891e-4f;
+const float SIN_C1 = 8.3321608736e-3f;
+const float SIN_C2 = -1.6666654611e-1f;
+const float COS_C0 = 2.443315711809948e-5f;
+const float COS_C1 = -1.388731625493765e-3f;
+const float COS_C2 = 4.166664568298827e-2f;
+
+// translate * rotateZ * scale, column-major
+inline void storeMatrix(float* m, float c, float s, float x, float y, float z, float sx, float sy, float sz)
+{
+    m[0] = c * sx;  m[1] = s * sx; m[2] = 0.0f;  m[3] = 0.0f;
+    m[4] = -s * sy; m[5] = c * sy; m[6] = 0.0f;  m[7] = 0.0f;
+    m[8] = 0.0f;    m[9] = 0.0f;   m[10] = sz;   m[11] = 0.0f;
+    m[12] = x;      m[13] = y;     m[14] = z;    m[15] = 1.0f;
+}
+
+#if BATCH_TRANSFORM_SSE2
+inline void sincos4(__m128 x, __m128& s, __m128& c)
+{
+    const __m128 signMask = _mm_castsi128_ps(_mm_set1_epi32((int)0x80000000u));
+    __m128 sinSign = _mm_and_ps(x, signMask);
+    x = _mm_andnot_ps(signMask, x);
+
+    // octant j, rounded up to even so the remainder lands in [-pi/4, pi/4]
+    __m128i j = _mm_cvttps_epi32(_mm_mul_ps(x, _mm_set1_ps(FOUR_OVER_PI)));
+    j = _mm_and_si128(_mm_add_epi32(j, _mm_set1_epi32(1)), _mm_set1_epi32(~1));
+    __m128 y = _mm_cvtepi32_ps(j);
+
+    __m128 sinFlip = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(j, _mm_set1_epi32(4)), 29));
+    __m128 cosFlip = _mm_castsi128_ps(_mm_slli_epi32(_mm_andnot_si128(_mm_sub_epi32(j, _mm_set1_epi32(2)), _mm_set1_epi32(4)), 29));
+    __m128 polyMask = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(j, _mm_set1_epi32(2)), _mm_setzero_si128()));
+
+    x = _mm_sub_ps(x, _mm_mul_ps(y, _mm_set1_ps(DP1)));
+    x = _mm_sub_ps(x, _mm_mul_ps(y, _mm_set1_ps(DP2)));
+    x = _mm_sub_ps(x, _mm_mul_ps(y, _mm_set1_ps(DP3)));
+    __m128 z2 = _mm_mul_ps(x, x);
+
+    __m128 yc = _mm_set1_ps(COS_C0);
+    yc = _mm_add_ps(_mm_mul_ps(yc, z2), _mm_set1_ps(COS_C1));
+    yc = _mm_add_ps(_mm_mul_ps(yc, z2), _mm_set1_ps(COS_C2));
+    yc = _mm_mul_ps(_mm_mul_ps(yc, z2), z2);
+    yc = _mm_sub_ps(yc, _mm_mul_ps(z2, _mm_set1_ps(0.5f)));
+    yc = _mm_add_ps(yc, _mm_set1_ps(1.0f));
+
+    __m128 ys = _mm_set1_ps(SIN_C0);
+    ys = _mm_add_ps(_mm_mul_ps(ys, z2), _mm_set1_ps(SIN_C1));
+    ys = _mm_add_ps(_mm_mul_ps(ys, z2), _mm_set1_ps(SIN_C2));
+    ys = _mm_add_ps(_mm_mul_ps(_mm_mul_ps(ys, z2), x), x);
+
+    s = _mm_or_ps(_mm_and_ps(polyMask, ys), _mm_andnot_ps(polyMask, yc));
+    c = _mm_or_ps(_mm_and_ps(polyMask, yc), _mm_andnot_ps(polyMask, ys));
+    s = _mm_xor_ps(s, _mm_xor_ps(sinSign, sinFlip));
+    c = _mm_xor_ps(c, cosFlip);
+}
+
+// transpose four lanes of SoA results into four column-major matrices
+inline void store4(float* out, __m128 c, __m128 s, __m128 px, __m128 py, __m128 pz, __m128 sx, __m128 sy, __m128 sz)
+{
+    const __m128 zero = _mm_setzero_ps();
+    __m128 col0x = _mm_mul_ps(c, sx);
+    __m128 col0y = _mm_mul_ps(s, sx);
+    __m128 col1x = _mm_sub_ps(zero, _mm_mul_ps(s, sy));
+    __m128 col1y = _mm_mul_ps(c, sy);
+    __m128 col0Lo = _mm_unpacklo_ps(col0x, col0y);
+    __m128 col0Hi = _mm_unpackhi_ps(col0x, col0y);
+    __m128 col1Lo = _mm_unpacklo_ps(col1x, col1y);
+    __m128 col1Hi = _mm_unpackhi_ps(col1x, col1y);
+    __m128 col2Lo = _mm_unpacklo_ps(sz, zero);
+    __m128 col2Hi = _mm_unpackhi_ps(sz, zero);
+    __m128 w = _mm_set1_ps(1.0f);
+    _MM_TRANSPOSE4_PS(px, py, pz, w);
+
+    _mm_storeu_ps(out + 0,  _mm_movelh_ps(col0Lo, zero));
+    _mm_storeu_ps(out + 4,  _mm_movelh_ps(col1Lo, zero));
+    _mm_storeu_ps(out + 8,  _mm_movelh_ps(zero, col2Lo));
+    _mm_storeu_ps(out + 12, px);
+    _mm_storeu_ps(out + 16, _mm_movehl_ps(zero, col0Lo));
+    _mm_storeu_ps(out + 20, _mm_movehl_ps(zero, col1Lo));
+    _mm_storeu_ps(out + 24, _mm_movelh_ps(zero, _mm_movehl_ps(col2Lo, col2Lo)));
+    _mm_storeu_ps(out + 28, py);
+    _mm_storeu_ps(out + 32, _mm_movelh_ps(col0Hi, zero));
+    _mm_storeu_ps(out + 36, _mm_movelh_ps(col1Hi, zero));
+    _mm_storeu_ps(out + 40, _mm_movelh_ps(zero, col2Hi));
+    _mm_storeu_ps(out + 44, pz);
+    _mm_storeu_ps(out + 48, _mm_movehl_ps(zero, col0Hi));
+    _mm_storeu_ps(out + 52, _mm_movehl_ps(zero, col1Hi));
+    _mm_storeu_ps(out + 56, _mm_movelh_ps(zero, _mm_movehl_ps(col2Hi, col2Hi)));
+    _mm_storeu_ps(out + 60, w);
+}
+
+inline void build4(const float* x, const float* y, const float* z, const float* angle,
+                   const float* sx, const float* sy, const float* sz, float angleOffset, float* out)
+{
+    __m128 s, c;
+    sincos4(_mm_add_ps(_mm_loadu_ps(angle), _mm_set1_ps(angleOffset)), s, c);
+    store4(out, c, s, _mm_loadu_ps(x), _mm_loadu_ps(y), _mm_loadu_ps(z),
+           _mm_loadu_ps(sx), _mm_loadu_ps(sy), _mm_loadu_ps(sz));
+}
+#endif
+
+#if BATCH_TRANSFORM_AVX2
+inline void sincos8(__m256 x, __m256& s, __m256& c)
+{
+    const __m256 signMask = _mm256_castsi256_ps(_mm256_set1_epi32((int)0x80000000u));
+    __m256 sinSign = _mm256_and_ps(x, signMask);
+    x = _mm256_andnot_ps(signMask, x);
+
+    __m256i j = _mm256_cvttps_epi32(_mm256_mul_ps(x, _mm256_set1_ps(FOUR_OVER_PI)));
+    j = _mm256_and_si256(_mm256_add_epi32(j, _mm256_set1_epi32(1)), _mm256_set1_epi32(~1));
+    __m256 y = _mm256_cvtepi32_ps(j);
+
+    __m256 sinFlip = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_and_si256(j, _mm256_set1_epi32(4)), 29));
+    __m256 cosFlip = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_andnot_si256(_mm256_sub_epi32(j, _mm256_set1_epi32(2)), _mm256_set1_epi32(4)), 29));
+    __m256 polyMask = _mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_and_si256(j, _mm256_set1_epi32(2)), _mm256_setzero_si256()));
+
+    x = _mm256_sub_ps(x, _mm256_mul_ps(y, _mm256_set1_ps(DP1)));
+    x = _mm256_sub_ps(x, _mm256_mul_ps(y, _mm256_set1_ps(DP2)));
+    x = _mm256_sub_ps(x, _mm256_mul_ps(y, _mm256_set1_ps(DP3)));
+    __m256 z2 = _mm256_mul_ps(x, x);
+
+    __m256 yc = _mm256_set1_ps(COS_C0);
+    yc = _mm256_add_ps(_mm256_mul_ps(yc, z2), _mm256_set1_ps(COS_C1));
+    yc = _mm256_add_ps(_mm256_mul_ps(yc, z2), _mm256_set1_ps(COS_C2));
+    yc = _mm256_mul_ps(_mm256_mul_ps(yc, z2), z2);
+    yc = _mm256_sub_ps(yc, _mm256_mul_ps(z2, _mm256_set1_ps(0.5f)));
+    yc = _mm256_add_ps(yc, _mm256_set1_ps(1.0f));
+
+    __m256 ys = _mm256_set1_ps(SIN_C0);
+    ys = _mm256_add_ps(_mm256_mul_ps(ys, z2), _mm256_set1_ps(SIN_C1));
+    ys = _mm256_add_ps(_mm256_mul_ps(ys, z2), _mm256_set1_ps(SIN_C2));
+    ys = _mm256_add_ps(_mm256_mul_ps(_mm256_mul_ps(ys, z2), x), x);
+
+    s = _mm256_blendv_ps(yc, ys, polyMask);
+    c = _mm256_blendv_ps(ys, yc, polyMask);
+    s = _mm256_xor_ps(s, _mm256_xor_ps(sinSign, sinFlip));
+    c = _mm256_xor_ps(c, cosFlip);
+}
+
+inline void build8(const float* x, const float* y, const float* z, const float* angle,
+                   const float* sx, const float* sy, const float* sz, float angleOffset, float* out)
+{
+    __m256 s, c;
+    sincos8(_mm256_add_ps(_mm256_loadu_ps(angle), _mm256_set1_ps(angleOffset)), s, c);
+    // the transpose/store is pure shuffling, the 128 bit version is as fast here
+    store4(out, _mm256_castps256_ps128(c), _mm256_castps256_ps128(s),
+           _mm_loadu_ps(x), _mm_loadu_ps(y), _mm_loadu_ps(z),
+           _mm_loadu_ps(sx), _mm_loadu_ps(sy), _mm_loadu_ps(sz));
+    store4(out + 64, _mm256_extractf128_ps(c, 1), _mm256_extractf128_ps(s, 1),
+           _mm_loadu_ps(x + 4), _mm_loadu_ps(y + 4), _mm_loadu_ps(z + 4),
+           _mm_loadu_ps(sx + 4), _mm_loadu_ps(sy + 4), _mm_loadu_ps(sz + 4));
+}
+#endif
+
+#if BATCH_TRANSFORM_NEON
+inline void sincos4(float32x4_t x, float32x4_t& s, float32x4_t& c)
+{
+    uint32x4_t sinSign = vandq_u32(vreinterpretq_u32_f32(x), vdupq_n_u32(0x80000000u));
+    x = vabsq_f32(x);
+
+    int32x4_t j = vcvtq_s32_f32(vmulq_n_f32(x, FOUR_OVER_PI));
+    j = vandq_s32(vaddq_s32(j, vdupq_n_s32(1)), vdupq_n_s32(~1));
+    float32x4_t y = vcvtq_f32_s32(j);
+
+    uint32x4_t sinFlip = vshlq_n_u32(vreinterpretq_u32_s32(vandq_s32(j, vdupq_n_s32(4))), 29);
+    uint32x4_t cosFlip = vshlq_n_u32(vreinterpretq_u32_s32(vbicq_s32(vdupq_n_s32(4), vsubq_s32(j, vdupq_n_s32(2)))), 29);
+    uint32x4_t polyMask = vceqq_s32(vandq_s32(j, vdupq_n_s32(2)), vdupq_n_s32(0));
+
+    x = vmlsq_f32(x, y, vdupq_n_f32(DP1));
+    x = vmlsq_f32(x, y, vdupq_n_f32(DP2));
+    x = vmlsq_f32(x, y, vdupq_n_f32(DP3));
+    float32x4_t z2 = vmulq_f32(x, x);
+
+    float32x4_t yc = vdupq_n_f32(COS_C0);
+    yc = vmlaq_f32(vdupq_n_f32(COS_C1), yc, z2);
+    yc = vmlaq_f32(vdupq_n_f32(COS_C2), yc, z2);
+    yc = vmulq_f32(vmulq_f32(yc, z2), z2);
+    yc = vmlsq_f32(yc, z2, vdupq_n_f32(0.5f));
+    yc = vaddq_f32(yc, vdupq_n_f32(1.0f));
+
+    float32x4_t ys = vdupq_n_f32(SIN_C0);
+    ys = vmlaq_f32(vdupq_n_f32(SIN_C1), ys, z2);
+    ys = vmlaq_f32(vdupq_n_f32(SIN_C2), ys, z2);
+    ys = vmlaq_f32(x, vmulq_f32(ys, z2), x);
+
+    float32x4_t sv = vbslq_f32(polyMask, ys, yc);
+    float32x4_t cv = vbslq_f32(polyMask, yc, ys);
+    s = vreinterpretq_f32_u32(veorq_u32(vreinterpretq_u32_f32(sv), veorq_u32(sinSign, sinFlip)));
+    c = vreinterpretq_f32_u32(veorq_u32(vreinterpretq_u32_f32(cv), cosFlip));
+}
+
+inline void storeMatrix(float* m, float32x2_t col0, float32x2_t col1, float32x2_t col2, float32x2_t posXY, float32x2_t posZW)
+{
+    const float32x2_t zero = vdup_n_f32(0.0f);
+    vst1q_f32(m + 0,  vcombine_f32(col0, zero));
+    vst1q_f32(m + 4,  vcombine_f32(col1, zero));
+    vst1q_f32(m + 8,  vcombine_f32(zero, col2));
+    vst1q_f32(m + 12, vcombine_f32(posXY, posZW));
+}
+
+inline void build4(const float* x, const float* y, const float* z, const float* angle,
+                   const float* sx, const float* sy, const float* sz, float angleOffset, float* out)
+{
+    float32x4_t s, c;
+    sincos4(vaddq_f32(vld1q_f32(angle), vdupq_n_f32(angleOffset)), s, c);
+    float32x4_t scaleX = vld1q_f32(sx);
+    float32x4_t scaleY = vld1q_f32(sy);
+    float32x4x2_t col0 = vzipq_f32(vmulq_f32(c, scaleX), vmulq_f32(s, scaleX));
+    float32x4x2_t col1 = vzipq_f32(vnegq_f32(vmulq_f32(s, scaleY)), vmulq_f32(c, scaleY));
+    float32x4x2_t col2 = vzipq_f32(vld1q_f32(sz), vdupq_n_f32(0.0f));
+    float32x4x2_t posXY = vzipq_f32(vld1q_f32(x), vld1q_f32(y));
+    float32x4x2_t posZW = vzipq_f32(vld1q_f32(z), vdupq_n_f32(1.0f));
+
+    storeMatrix(out + 0,  vget_low_f32(col0.val[0]),  vget_low_f32(col1.val[0]),  vget_low_f32(col2.val[0]),
+                vget_low_f32(posXY.val[0]),  vget_low_f32(posZW.val[0]));
+    storeMatrix(out + 16, vget_high_f32(col0.val[0]), vget_high_f32(col1.val[0]), vget_high_f32(col2.val[0]),
+                vget_high_f32(posXY.val[0]), vget_high_f32(posZW.val[0]));
+    storeMatrix(out + 32, vget_low_f32(col0.val[1]),  vget_low_f32(col1.val[1]),  vget_low_f32(col2.val[1]),
+                vget_low_f32(posXY.val[1]),  vget_low_f32(posZW.val[1]));
+    storeMatrix(out + 48, vget_high_f32(col0.val[1]), vget_high_f32(col1.val[1]), vget_high_f32(col2.val[1]),
+                vget_high_f32(posXY.val[1]), vget_high_f32(posZW.val[1]));
+}
+#endif
+}
+
+void buildTransformsScalar(const TransformBatchInput& in, size_t count, float* out)
+{
+    for (size_t i = 0; i < count; ++i)
+    {
+        float a = in.angle[i] + in.angleOffset;
+        storeMatrix(out + 16 * i, std::cos(a), std::sin(a), in.x[i], in.y[i], in.z[i],
+                    in.scaleX[i], in.scaleY[i], in.scaleZ[i]);
+    }
+}
+
+void buildTransforms(const TransformBatchInput& in, size_t count, float* out)
+{
+#if BATCH_TRANSFORM_SSE2 || BATCH_TRANSFORM_NEON
+    size_t i = 0;
+#if BATCH_TRANSFORM_AVX2
+    for (; i + 8 <= count; i += 8)
+        build8(in.x + i, in.y + i, in.z + i, in.angle + i, in.scaleX + i, in.scaleY + i, in.scaleZ + i,
+               in.angleOffset, out + 16 * i);
+#endif
+    for (; i + 4 <= count; i += 4)
+        build4(in.x + i, in.y + i, in.z + i, in.angle + i, in.scaleX + i, in.scaleY + i, in.scaleZ + i,
+               in.angleOffset, out + 16 * i);
+    // pad the last 1-3 instances so they go through the same kernel as the rest
+    if (i < count)
+    {
+        size_t rest = count - i;
+        float x[4] = {0}, y[4] = {0}, z[4] = {0}, angle[4] = {0}, sx[4] = {0}, sy[4] = {0}, sz[4] = {0};
+        float matrices[64];
+        for (size_t k = 0; k < rest; ++k)
+        {
+            x[k] = in.x[i + k];
+            y[k] = in.y[i + k];
+            z[k] = in.z[i + k];
+            angle[k] = in.angle[i + k];
+            sx[k] = in.scaleX[i + k];
+            sy[k] = in.scaleY[i + k];
+            sz[k] = in.scaleZ[i + k];
+        }
+        build4(x, y, z, angle, sx, sy, sz, in.angleOffset, matrices);
+        std::memcpy(out + 16 * i, matrices, rest * 16 * sizeof(float));
+    }
+#else
+    buildTransformsScalar(in, count, out);
+#endif
+}
+
+const char* batchTransformKernel()
+{
+#if BATCH_TRANSFORM_AVX2
+    return "avx2";
+#elif BATCH_TRANSFORM_SSE2
+    return "sse2";
+#elif BATCH_TRANSFORM_NEON
+    return "neon";
+#else
+    return "scalar";
+#endif
+}
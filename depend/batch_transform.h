@@ -0,0 +1,38 @@
+#ifndef BATCH_TRANSFORM_H
+#define BATCH_TRANSFORM_H
+
+#include <cstddef>
+
+// batch version of the per-object chain used in the transformation samples:
+//     transform = glm::translate(glm::mat4(1.0f), position);
+//     transform = glm::rotate(transform, angle, glm::vec3(0.0f, 0.0f, 1.0f));
+//     transform = glm::scale(transform, scale);
+// inputs are SoA arrays, output is count contiguous column-major mat4 (16 floats
+// each, the same layout as glm::mat4) and may point straight into a mapped buffer.
+// the kernel is picked at compile time: AVX2 (-mavx2), SSE2, NEON, or scalar.
+struct TransformBatchInput
+{
+    const float* x;
+    const float* y;
+    const float* z;
+    // rotation around +z in radians, the SIMD kernels are accurate for |angle| < 8192
+    const float* angle;
+    const float* scaleX;
+    const float* scaleY;
+    const float* scaleZ;
+    // added to every angle, e.g. (float)glfwGetTime() to spin everything at once
+    float angleOffset;
+
+    TransformBatchInput()
+        : x(NULL), y(NULL), z(NULL), angle(NULL), scaleX(NULL), scaleY(NULL), scaleZ(NULL), angleOffset(0.0f)
+    {}
+};
+
+// out must hold 16 * count floats, no alignment requirement
+void buildTransforms(const TransformBatchInput& in, size_t count, float* out);
+// reference implementation with std::sin/std::cos, always available
+void buildTransformsScalar(const TransformBatchInput& in, size_t count, float* out);
+// name of the kernel buildTransforms() uses: "avx2", "sse2", "neon" or "scalar"
+const char* batchTransformKernel();
+
+#endif
@@ -0,0 +1,199 @@
+#ifndef BINDLESS_TEXTURES_H
+#define BINDLESS_TEXTURES_H
+
+#include <glad/glad.h>
+#include <stb_image.h>
+
+#include <gl_ext.h>
+#include <gl_state.h>
+#include <uniform_block.h>
+#include <texture_array_packer.h>
+
+#include <vector>
+#include <iostream>
+
+// a set of RGBA images that one draw can sample from without binding anything per image.
+// with GL_ARB_bindless_texture every image becomes its own GL_TEXTURE_2D whose resident
+// 64-bit handle goes into the shared TextureHandleBlock; the shader picks the handle by
+// index and turns it into a sampler2D. without it, or when more images are added than
+// the block holds, the images are packed into a TextureArrayPacker array texture instead.
+//
+// either way region(i) is the SpriteRegion to put in the instance data: on the array path
+// the packed uv rect and layer, on the bindless path the full rect and the handle index in
+// place of the layer. so the sample keeps one instance layout and only swaps the shader
+// and bind() call:
+//     bindless     ../1_base/4_textures/helper/shader_bindless.vs / .fs
+//     array        ../1_base/4_textures/helper/shader_array.vs / .fs
+//
+// instances of one draw use different handles, which ARB_bindless_texture only allows
+// with GL_NV_gpu_shader5 (glExt().bindlessDivergent); without it the array path is used.
+class BindlessTextureSet
+{
+public:
+    BindlessTextureSet(int layerWidth = 1024, int layerHeight = 1024, int padding = 2)
+        : handleUBO(0), useBindless(false), packer(layerWidth, layerHeight, padding)
+    {}
+
+    // copy RGBA8 pixels (bottom row first, like a flipped stbi_load), returns the image index
+    // ------------------------------------------------------------------------
+    int add(const unsigned char* rgba, int width, int height)
+    {
+        Image image;
+        image.width = width;
+        image.height = height;
+        image.pixels.assign(rgba, rgba + (size_t)width * height * 4);
+        images.push_back(image);
+        return (int)images.size() - 1;
+    }
+    // returns -1 if the file could not be decoded
+    // ------------------------------------------------------------------------
+    int addFile(const char* path)
+    {
+        stbi_set_flip_vertically_on_load(true);
+        int width, height, channels;
+        unsigned char* data = stbi_load(path, &width, &height, &channels, 4);
+        if (!data)
+        {
+            std::cout << "Failed to load texture " << path << std::endl;
+            return -1;
+        }
+        int index = add(data, width, height);
+        stbi_image_free(data);
+        return index;
+    }
+
+    // create the textures of everything added so far and drop the CPU copies.
+    // allowBindless false forces the array path, e.g. to compare the two.
+    // returns true if the set is bindless
+    // ------------------------------------------------------------------------
+    bool build(bool allowBindless = true, bool mipmaps = true)
+    {
+        const GLExtensions& ext = glExt();
+        useBindless = allowBindless && ext.bindlessDivergent && !images.empty() && images.size() <= TEXTURE_HANDLE_CAPACITY;
+        regions.assign(images.size(), SpriteRegion());
+        if (useBindless)
+            buildBindless(mipmaps);
+        else
+            buildArray(mipmaps);
+        images.clear();
+        return useBindless;
+    }
+
+    // make the set visible to the next draws: one UBO range for every handle, or the
+    // array texture on unit
+    // ------------------------------------------------------------------------
+    void bind(GLStateCache& state, unsigned int unit = 0) const
+    {
+        if (useBindless)
+            state.bindUniformRange(TEXTURE_HANDLE_BLOCK_BINDING, handleUBO, 0, sizeof(TextureHandleBlock));
+        else
+            state.bindTextureUnit(unit, GL_TEXTURE_2D_ARRAY, packer.ID);
+    }
+
+    // make the handles non-resident and delete the textures, must run while the context
+    // is still alive
+    // ------------------------------------------------------------------------
+    void release(GLStateCache* state = NULL)
+    {
+        const GLExtensions& ext = glExt();
+        for (size_t i = 0; i < handles.size(); ++i)
+            ext.MakeTextureHandleNonResident(handles[i]);
+        for (size_t i = 0; i < textures.size(); ++i)
+        {
+            if (state)
+                state->onDeleteTexture(textures[i]);
+        }
+        if (!textures.empty())
+            glDeleteTextures((GLsizei)textures.size(), &textures[0]);
+        if (handleUBO)
+        {
+            if (state)
+                state->onDeleteBuffer(handleUBO);
+            glDeleteBuffers(1, &handleUBO);
+        }
+        if (packer.ID)
+        {
+            if (state)
+                state->onDeleteTexture(packer.ID);
+            packer.release();
+        }
+        handles.clear();
+        textures.clear();
+        handleUBO = 0;
+    }
+
+    bool bindless() const { return useBindless; }
+    const SpriteRegion& region(int index) const { return regions[index]; }
+    int imageCount() const { return (int)regions.size(); }
+    // array layers on the array path, 0 when bindless
+    int layerCount() const { return packer.layerCount(); }
+
+private:
+    struct Image
+    {
+        int width, height;
+        std::vector<unsigned char> pixels;
+    };
+
+    std::vector<Image> images;
+    std::vector<SpriteRegion> regions;
+    // bindless path
+    std::vector<unsigned int> textures;
+    std::vector<GLuint64> handles;
+    unsigned int handleUBO;
+    bool useBindless;
+    // array path
+    TextureArrayPacker packer;
+
+    // ------------------------------------------------------------------------
+    void buildBindless(bool mipmaps)
+    {
+        const GLExtensions& ext = glExt();
+        textures.resize(images.size());
+        handles.resize(images.size());
+        glGenTextures((GLsizei)textures.size(), &textures[0]);
+        TextureHandleBlock* block = new TextureHandleBlock();
+        for (size_t i = 0; i < images.size(); ++i)
+        {
+            const Image& image = images[i];
+            glBindTexture(GL_TEXTURE_2D, textures[i]);
+            // the handle freezes the texture's parameters, so everything is set before
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, mipmaps ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, image.width, image.height, 0, GL_RGBA, GL_UNSIGNED_BYTE, &image.pixels[0]);
+            if (mipmaps)
+                glGenerateMipmap(GL_TEXTURE_2D);
+            handles[i] = ext.GetTextureHandle(textures[i]);
+            ext.MakeTextureHandleResident(handles[i]);
+            block->handles[i] = handles[i];
+
+            SpriteRegion& region = regions[i];
+            region.uvRect[0] = region.uvRect[1] = 0.0f;
+            region.uvRect[2] = region.uvRect[3] = 1.0f;
+            region.layer = (float)i;
+        }
+        glBindTexture(GL_TEXTURE_2D, 0);
+
+        // the unused tail is uploaded too, the block size must match the GLSL one
+        glGenBuffers(1, &handleUBO);
+        glBindBuffer(GL_UNIFORM_BUFFER, handleUBO);
+        glBufferData(GL_UNIFORM_BUFFER, sizeof(TextureHandleBlock), block, GL_STATIC_DRAW);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+        delete block;
+    }
+    // ------------------------------------------------------------------------
+    void buildArray(bool mipmaps)
+    {
+        for (size_t i = 0; i < images.size(); ++i)
+            packer.add(&images[i].pixels[0], images[i].width, images[i].height);
+        packer.build(mipmaps);
+        for (size_t i = 0; i < images.size(); ++i)
+            regions[i] = packer.region((int)i);
+    }
+
+    BindlessTextureSet(const BindlessTextureSet&);
+    BindlessTextureSet& operator=(const BindlessTextureSet&);
+};
+#endif
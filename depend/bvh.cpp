@@ -0,0 +1,342 @@
+#include "bvh.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define FRUSTUM_CULL_SSE2 1
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define FRUSTUM_CULL_NEON 1
+#endif
+
+// ------------------------------------------------------------------------
+Frustum Frustum::fromMatrix(const float* m)
+{
+    // row i of the column-major matrix is m[i], m[4 + i], m[8 + i], m[12 + i]
+    Frustum f;
+    for (int p = 0; p < 6; ++p)
+    {
+        int row = p / 2;
+        float sign = (p & 1) ? -1.0f : 1.0f;
+        for (int k = 0; k < 4; ++k)
+            f.planes[p][k] = m[k * 4 + 3] + sign * m[k * 4 + row];
+        float length = std::sqrt(f.planes[p][0] * f.planes[p][0] + f.planes[p][1] * f.planes[p][1] +
+                                 f.planes[p][2] * f.planes[p][2]);
+        if (length > 0.0f)
+            for (int k = 0; k < 4; ++k)
+                f.planes[p][k] /= length;
+    }
+    return f;
+}
+
+namespace
+{
+// planes in SoA order, padded to 8 with copies of plane 0 so two 4-wide steps cover them
+struct FrustumSoA
+{
+    float x[8], y[8], z[8], w[8];
+
+    explicit FrustumSoA(const Frustum& f)
+    {
+        for (int i = 0; i < 8; ++i)
+        {
+            const float* p = f.planes[i < 6 ? i : 0];
+            x[i] = p[0];
+            y[i] = p[1];
+            z[i] = p[2];
+            w[i] = p[3];
+        }
+    }
+};
+
+// center/extent form: the box is outside a plane if even its most positive corner is
+// behind it, dot(n, c) + dot(|n|, e) < 0, and fully in front if dot(n, c) - dot(|n|, e) >= 0
+// the SIMD kernels below compute the same; the scalar form is only built without them
+#if !FRUSTUM_CULL_SSE2 && !FRUSTUM_CULL_NEON
+CullResult testScalar(const FrustumSoA& f, const Aabb& box)
+{
+    float c[3], e[3];
+    for (int k = 0; k < 3; ++k)
+    {
+        c[k] = 0.5f * (box.min[k] + box.max[k]);
+        e[k] = 0.5f * (box.max[k] - box.min[k]);
+    }
+    bool inside = true;
+    for (int i = 0; i < 6; ++i)
+    {
+        float d = f.x[i] * c[0] + f.y[i] * c[1] + f.z[i] * c[2] + f.w[i];
+        float r = std::fabs(f.x[i]) * e[0] + std::fabs(f.y[i]) * e[1] + std::fabs(f.z[i]) * e[2];
+        if (d + r < 0.0f)
+            return CULL_OUTSIDE;
+        inside = inside && d - r >= 0.0f;
+    }
+    return inside ? CULL_INSIDE : CULL_INTERSECTS;
+}
+#endif
+
+#if FRUSTUM_CULL_SSE2
+CullResult testSse2(const FrustumSoA& f, const Aabb& box)
+{
+    const __m128 half = _mm_set1_ps(0.5f);
+    const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+    __m128 cx = _mm_set1_ps(0.5f * (box.min[0] + box.max[0]));
+    __m128 cy = _mm_set1_ps(0.5f * (box.min[1] + box.max[1]));
+    __m128 cz = _mm_set1_ps(0.5f * (box.min[2] + box.max[2]));
+    __m128 ex = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(box.max[0]), _mm_set1_ps(box.min[0])), half);
+    __m128 ey = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(box.max[1]), _mm_set1_ps(box.min[1])), half);
+    __m128 ez = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(box.max[2]), _mm_set1_ps(box.min[2])), half);
+    int outside = 0, intersects = 0;
+    for (int i = 0; i < 8; i += 4)
+    {
+        __m128 px = _mm_loadu_ps(f.x + i), py = _mm_loadu_ps(f.y + i), pz = _mm_loadu_ps(f.z + i);
+        __m128 d = _mm_add_ps(_mm_add_ps(_mm_mul_ps(px, cx), _mm_mul_ps(py, cy)),
+                              _mm_add_ps(_mm_mul_ps(pz, cz), _mm_loadu_ps(f.w + i)));
+        __m128 r = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_and_ps(px, absMask), ex), _mm_mul_ps(_mm_and_ps(py, absMask), ey)),
+                              _mm_mul_ps(_mm_and_ps(pz, absMask), ez));
+        outside |= _mm_movemask_ps(_mm_cmplt_ps(_mm_add_ps(d, r), _mm_setzero_ps()));
+        intersects |= _mm_movemask_ps(_mm_cmplt_ps(_mm_sub_ps(d, r), _mm_setzero_ps()));
+    }
+    if (outside)
+        return CULL_OUTSIDE;
+    return intersects ? CULL_INTERSECTS : CULL_INSIDE;
+}
+#endif
+
+#if FRUSTUM_CULL_NEON
+CullResult testNeon(const FrustumSoA& f, const Aabb& box)
+{
+    float32x4_t cx = vdupq_n_f32(0.5f * (box.min[0] + box.max[0]));
+    float32x4_t cy = vdupq_n_f32(0.5f * (box.min[1] + box.max[1]));
+    float32x4_t cz = vdupq_n_f32(0.5f * (box.min[2] + box.max[2]));
+    float32x4_t ex = vdupq_n_f32(0.5f * (box.max[0] - box.min[0]));
+    float32x4_t ey = vdupq_n_f32(0.5f * (box.max[1] - box.min[1]));
+    float32x4_t ez = vdupq_n_f32(0.5f * (box.max[2] - box.min[2]));
+    uint32x4_t outside = vdupq_n_u32(0), intersects = vdupq_n_u32(0);
+    for (int i = 0; i < 8; i += 4)
+    {
+        float32x4_t px = vld1q_f32(f.x + i), py = vld1q_f32(f.y + i), pz = vld1q_f32(f.z + i);
+        float32x4_t d = vmlaq_f32(vmlaq_f32(vmlaq_f32(vld1q_f32(f.w + i), px, cx), py, cy), pz, cz);
+        float32x4_t r = vmlaq_f32(vmlaq_f32(vmulq_f32(vabsq_f32(px), ex), vabsq_f32(py), ey), vabsq_f32(pz), ez);
+        outside = vorrq_u32(outside, vcltq_f32(vaddq_f32(d, r), vdupq_n_f32(0.0f)));
+        intersects = vorrq_u32(intersects, vcltq_f32(vsubq_f32(d, r), vdupq_n_f32(0.0f)));
+    }
+    uint32x2_t o = vorr_u32(vget_low_u32(outside), vget_high_u32(outside));
+    uint32x2_t n = vorr_u32(vget_low_u32(intersects), vget_high_u32(intersects));
+    if (vget_lane_u32(vpmax_u32(o, o), 0))
+        return CULL_OUTSIDE;
+    return vget_lane_u32(vpmax_u32(n, n), 0) ? CULL_INTERSECTS : CULL_INSIDE;
+}
+#endif
+
+inline CullResult test(const FrustumSoA& f, const Aabb& box)
+{
+#if FRUSTUM_CULL_SSE2
+    return testSse2(f, box);
+#elif FRUSTUM_CULL_NEON
+    return testNeon(f, box);
+#else
+    return testScalar(f, box);
+#endif
+}
+
+void grow(Aabb& box, const Aabb& other)
+{
+    for (int k = 0; k < 3; ++k)
+    {
+        box.min[k] = std::min(box.min[k], other.min[k]);
+        box.max[k] = std::max(box.max[k], other.max[k]);
+    }
+}
+float centroid(const Aabb& box, int axis)
+{
+    return box.min[axis] + box.max[axis];
+}
+}
+
+// ------------------------------------------------------------------------
+CullResult testAabb(const Frustum& frustum, const Aabb& box)
+{
+    return test(FrustumSoA(frustum), box);
+}
+
+const char* frustumCullKernel()
+{
+#if FRUSTUM_CULL_SSE2
+    return "sse2";
+#elif FRUSTUM_CULL_NEON
+    return "neon";
+#else
+    return "scalar";
+#endif
+}
+
+// ------------------------------------------------------------------------
+BoundingVolumeHierarchy::BoundingVolumeHierarchy()
+{
+    std::memset(&stats, 0, sizeof(stats));
+}
+
+void BoundingVolumeHierarchy::build(const Aabb* bounds, size_t count)
+{
+    objectBounds.assign(bounds, bounds + count);
+    objectOrder.resize(count);
+    for (size_t i = 0; i < count; ++i)
+        objectOrder[i] = (uint32_t)i;
+    objectLeaf.assign(count, 0);
+    nodes.clear();
+    // a binary tree with leaves of up to LEAF_SIZE objects has fewer than 2 * count nodes
+    nodes.reserve(count / LEAF_SIZE * 2 + 2);
+    dirtyNodes.clear();
+    if (count > 0)
+        buildNode(0, (uint32_t)count, 0);
+    dirty.assign(nodes.size(), 0);
+}
+
+// median split along the longest axis of the centroids, depth first so that every
+// child has a larger index than its parent (refit relies on that)
+// ------------------------------------------------------------------------
+uint32_t BoundingVolumeHierarchy::buildNode(uint32_t first, uint32_t count, uint32_t parent)
+{
+    uint32_t index = (uint32_t)nodes.size();
+    nodes.push_back(Node());
+    Node node;
+    node.left = node.right = 0;
+    node.first = first;
+    node.count = count;
+    node.parent = parent;
+    computeBounds(node);
+    if (count <= LEAF_SIZE)
+    {
+        for (uint32_t i = first; i < first + count; ++i)
+            objectLeaf[objectOrder[i]] = index;
+        nodes[index] = node;
+        return index;
+    }
+
+    float low[3], high[3];
+    for (int k = 0; k < 3; ++k)
+        low[k] = high[k] = centroid(objectBounds[objectOrder[first]], k);
+    for (uint32_t i = first + 1; i < first + count; ++i)
+    {
+        for (int k = 0; k < 3; ++k)
+        {
+            float c = centroid(objectBounds[objectOrder[i]], k);
+            low[k] = std::min(low[k], c);
+            high[k] = std::max(high[k], c);
+        }
+    }
+    int axis = 0;
+    for (int k = 1; k < 3; ++k)
+    {
+        if (high[k] - low[k] > high[axis] - low[axis])
+            axis = k;
+    }
+    uint32_t half = count / 2;
+    const std::vector<Aabb>& boxes = objectBounds;
+    std::nth_element(objectOrder.begin() + first, objectOrder.begin() + first + half, objectOrder.begin() + first + count,
+                     [&boxes, axis](uint32_t a, uint32_t b) { return centroid(boxes[a], axis) < centroid(boxes[b], axis); });
+
+    node.left = buildNode(first, half, index);
+    node.right = buildNode(first + half, count - half, index);
+    nodes[index] = node;
+    return index;
+}
+
+void BoundingVolumeHierarchy::computeBounds(Node& node) const
+{
+    if (node.left)
+    {
+        node.bounds = nodes[node.left].bounds;
+        grow(node.bounds, nodes[node.right].bounds);
+        return;
+    }
+    node.bounds = objectBounds[objectOrder[node.first]];
+    for (uint32_t i = node.first + 1; i < node.first + node.count; ++i)
+        grow(node.bounds, objectBounds[objectOrder[i]]);
+}
+
+// ------------------------------------------------------------------------
+void BoundingVolumeHierarchy::update(unsigned int object, const Aabb& bounds)
+{
+    objectBounds[object] = bounds;
+    // mark the leaf and its ancestors once, stop at the first one already marked
+    for (uint32_t n = objectLeaf[object];; n = nodes[n].parent)
+    {
+        if (dirty[n])
+            break;
+        dirty[n] = 1;
+        dirtyNodes.push_back(n);
+        if (n == 0)
+            break;
+    }
+}
+
+void BoundingVolumeHierarchy::refit()
+{
+    // children before parents: they have the larger indices
+    std::sort(dirtyNodes.begin(), dirtyNodes.end(), std::greater<uint32_t>());
+    for (size_t i = 0; i < dirtyNodes.size(); ++i)
+    {
+        computeBounds(nodes[dirtyNodes[i]]);
+        dirty[dirtyNodes[i]] = 0;
+    }
+    stats.refitNodes = dirtyNodes.size();
+    dirtyNodes.clear();
+}
+
+// ------------------------------------------------------------------------
+size_t BoundingVolumeHierarchy::cull(const Frustum& frustum, std::vector<unsigned int>& visible)
+{
+    visible.clear();
+    stats.nodesTested = stats.objectsTested = stats.acceptedInside = 0;
+    if (nodes.empty())
+    {
+        stats.visible = stats.culled = 0;
+        return 0;
+    }
+    FrustumSoA planes(frustum);
+    stack.clear();
+    stack.push_back(0);
+    while (!stack.empty())
+    {
+        const Node& node = nodes[stack.back()];
+        stack.pop_back();
+        ++stats.nodesTested;
+        CullResult result = test(planes, node.bounds);
+        if (result == CULL_OUTSIDE)
+            continue;
+        if (result == CULL_INSIDE)
+        {
+            visible.insert(visible.end(), objectOrder.begin() + node.first, objectOrder.begin() + node.first + node.count);
+            stats.acceptedInside += node.count;
+            continue;
+        }
+        if (node.left)
+        {
+            stack.push_back(node.right);
+            stack.push_back(node.left);
+            continue;
+        }
+        for (uint32_t i = node.first; i < node.first + node.count; ++i)
+        {
+            uint32_t object = objectOrder[i];
+            ++stats.objectsTested;
+            if (test(planes, objectBounds[object]) != CULL_OUTSIDE)
+                visible.push_back(object);
+        }
+    }
+    stats.visible = visible.size();
+    stats.culled = objectBounds.size() - visible.size();
+    return visible.size();
+}
+
+void BoundingVolumeHierarchy::printStats(std::ostream& out) const
+{
+    out << "bvh (" << frustumCullKernel() << "): " << objectBounds.size() << " objects, " << nodes.size() << " nodes; last frame "
+        << stats.nodesTested << " nodes and " << stats.objectsTested << " objects tested, " << stats.visible << " visible ("
+        << stats.acceptedInside << " accepted inside), " << stats.culled << " culled, " << stats.refitNodes << " nodes refit"
+        << std::endl;
+}
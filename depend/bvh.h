@@ -0,0 +1,110 @@
+#ifndef BVH_H
+#define BVH_H
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+
+// frustum culling over a bounding-volume hierarchy of object AABBs.
+//
+//     bvh.build(&bounds[0], count);                 // once, median splits
+//     ...
+//     bvh.update(i, movedBounds);                   // per frame, for objects that moved
+//     bvh.refit();                                  // only the dirty paths to the root
+//     bvh.cull(Frustum::fromMatrix(glm::value_ptr(projection * view)), visible);
+//
+// cull() tests a node's box against all six planes at once (SSE2 / NEON, scalar
+// otherwise): outside skips the subtree, inside takes the whole subtree without further
+// tests (its objects are contiguous), intersecting descends. refit keeps the topology,
+// so bounds grow looser when objects wander far; build() again after large changes.
+
+struct Aabb
+{
+    float min[3];
+    float max[3];
+};
+
+// six planes ax + by + cz + d >= 0 inside, normalized
+struct Frustum
+{
+    float planes[6][4];
+
+    // Gribb/Hartmann extraction from a column-major clip matrix (glm::value_ptr of
+    // projection * view, or projection * view * model for object-space bounds)
+    static Frustum fromMatrix(const float* m);
+};
+
+enum CullResult
+{
+    CULL_OUTSIDE = 0,
+    CULL_INTERSECTS,
+    CULL_INSIDE,
+};
+
+// one box against the frustum with the compiled-in kernel
+CullResult testAabb(const Frustum& frustum, const Aabb& box);
+// "sse2", "neon" or "scalar"
+const char* frustumCullKernel();
+
+class BoundingVolumeHierarchy
+{
+public:
+    // objects per leaf at most
+    static const unsigned int LEAF_SIZE = 4;
+
+    // of the last cull()
+    struct Stats
+    {
+        unsigned long nodesTested;
+        unsigned long objectsTested;
+        unsigned long visible;
+        unsigned long culled;
+        // objects accepted with their whole subtree, without a test of their own
+        unsigned long acceptedInside;
+        // nodes recomputed by the last refit()
+        unsigned long refitNodes;
+    };
+
+    BoundingVolumeHierarchy();
+
+    // ------------------------------------------------------------------------
+    void build(const Aabb* bounds, size_t count);
+    // new bounds for object, applied to the tree by the next refit()
+    void update(unsigned int object, const Aabb& bounds);
+    void refit();
+    // append the indices of the objects that intersect the frustum to visible (after
+    // clearing it), returns how many
+    size_t cull(const Frustum& frustum, std::vector<unsigned int>& visible);
+
+    size_t size() const { return objectBounds.size(); }
+    size_t nodeCount() const { return nodes.size(); }
+    const Stats& statistics() const { return stats; }
+    void printStats(std::ostream& out) const;
+
+private:
+    struct Node
+    {
+        Aabb bounds;
+        // children of an inner node, 0 for leaves (the root is never a child)
+        uint32_t left, right;
+        // objects of the subtree: objectOrder[first, first + count)
+        uint32_t first, count;
+        uint32_t parent;
+    };
+
+    std::vector<Node> nodes;
+    std::vector<Aabb> objectBounds;
+    // objects sorted so that every subtree covers a contiguous range
+    std::vector<uint32_t> objectOrder;
+    std::vector<uint32_t> objectLeaf;
+    std::vector<uint8_t> dirty;
+    std::vector<uint32_t> dirtyNodes;
+    std::vector<uint32_t> stack;
+    Stats stats;
+
+    uint32_t buildNode(uint32_t first, uint32_t count, uint32_t parent);
+    void computeBounds(Node& node) const;
+};
+
+#endif
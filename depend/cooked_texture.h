@@ -0,0 +1,181 @@
+#ifndef COOKED_TEXTURE_H
+#define COOKED_TEXTURE_H
+
+#include <glad/glad.h>
+
+#include <gl_ext.h>
+#include <mapped_file.h>
+
+#include <cstring>
+#include <cstdint>
+#include <iostream>
+
+// .oritex: a texture that was decoded, flipped for OpenGL, mip-mapped and optionally
+// BC compressed offline by tools/texture_cooker.cpp, so loading is a memory map
+// followed by one glTexImage2D / glCompressedTexImage2D per level.
+//
+// layout (little endian), KTX2 style: header, mip level index, then the levels
+//     CookedTextureHeader
+//     CookedTextureLevel[mipCount]      level 0 (largest) first
+//     level data, each level starting on a COOKED_TEXTURE_ALIGNMENT boundary
+
+#ifndef GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT 0x83F0
+#endif
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT5_EXT
+#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT 0x83F3
+#endif
+
+const uint32_t COOKED_TEXTURE_VERSION = 1;
+const uint32_t COOKED_TEXTURE_ALIGNMENT = 16;
+// the rows were flipped so the first row is the bottom of the image
+const uint32_t COOKED_TEXTURE_FLIPPED = 1u << 0;
+
+struct CookedTextureHeader
+{
+    char magic[4];              // "ORTX"
+    uint32_t version;
+    uint32_t width;
+    uint32_t height;
+    // GL enums: internal format is e.g. GL_RGBA8 or GL_COMPRESSED_RGB_S3TC_DXT1_EXT,
+    // format/type are the glTexImage2D pair for uncompressed data and 0 otherwise
+    uint32_t internalFormat;
+    uint32_t format;
+    uint32_t type;
+    uint32_t mipCount;
+    uint32_t flags;
+    uint32_t reserved;
+};
+
+struct CookedTextureLevel
+{
+    uint32_t width;
+    uint32_t height;
+    // from the start of the file
+    uint64_t offset;
+    uint64_t size;
+};
+
+// points into the bytes of a cooked texture, usually a MappedFile
+// ------------------------------------------------------------------------
+struct CookedTextureView
+{
+    const CookedTextureHeader* header;
+    const CookedTextureLevel* levels;
+    const unsigned char* base;
+
+    CookedTextureView() : header(NULL), levels(NULL), base(NULL) {}
+
+    bool compressed() const { return header->format == 0; }
+
+    // validate the header and level table against the size of the data
+    bool parse(const void* data, size_t size)
+    {
+        header = NULL;
+        levels = NULL;
+        base = (const unsigned char*)data;
+        if (size < sizeof(CookedTextureHeader))
+            return false;
+        const CookedTextureHeader* h = (const CookedTextureHeader*)data;
+        // a full chain of a 2^31 texture has 32 levels
+        if (std::memcmp(h->magic, "ORTX", 4) != 0 || h->version != COOKED_TEXTURE_VERSION || h->mipCount == 0 ||
+            h->mipCount > 32 || h->width == 0 || h->height == 0)
+            return false;
+        if (size < sizeof(CookedTextureHeader) + h->mipCount * sizeof(CookedTextureLevel))
+            return false;
+        const CookedTextureLevel* l = (const CookedTextureLevel*)(h + 1);
+        uint32_t width = h->width, height = h->height;
+        for (uint32_t i = 0; i < h->mipCount; ++i)
+        {
+            // every level halves the previous one, and holds exactly what glTexImage2D /
+            // glCompressedTexImage2D will read from the mapping for that size
+            uint64_t expected = levelSize(*h, width, height);
+            if (expected == 0 || l[i].width != width || l[i].height != height || l[i].size != expected)
+                return false;
+            if (l[i].offset > size || l[i].size > size - l[i].offset)
+                return false;
+            width = width > 1 ? width / 2 : 1;
+            height = height > 1 ? height / 2 : 1;
+        }
+        header = h;
+        levels = l;
+        return true;
+    }
+
+    // bytes of a w x h level in the header's format, tightly packed like the cooker
+    // writes them (uploads use GL_UNPACK_ALIGNMENT 1). 0 for formats we do not know,
+    // which parse() rejects
+    static uint64_t levelSize(const CookedTextureHeader& h, uint32_t width, uint32_t height)
+    {
+        if (h.format == 0)
+        {
+            uint64_t blocks = (uint64_t)((width + 3) / 4) * ((height + 3) / 4);
+            if (h.internalFormat == GL_COMPRESSED_RGB_S3TC_DXT1_EXT)
+                return blocks * 8;
+            if (h.internalFormat == GL_COMPRESSED_RGBA_S3TC_DXT5_EXT)
+                return blocks * 16;
+            return 0;
+        }
+        if (h.type != GL_UNSIGNED_BYTE)
+            return 0;
+        uint64_t channels = 0;
+        switch (h.format)
+        {
+            case GL_RED: channels = 1; break;
+            case GL_RG: channels = 2; break;
+            case GL_RGB: channels = 3; break;
+            case GL_RGBA: channels = 4; break;
+            default: break;
+        }
+        return (uint64_t)width * height * channels;
+    }
+};
+
+// upload all levels into a new GL_TEXTURE_2D, returns 0 if the format is not supported
+// ------------------------------------------------------------------------
+inline unsigned int uploadCookedTexture(const CookedTextureView& view, GLenum wrap = GL_REPEAT)
+{
+    const CookedTextureHeader& h = *view.header;
+    if (view.compressed() && !glExt().textureCompressionS3TC)
+    {
+        std::cout << "ERROR::COOKED_TEXTURE::S3TC_NOT_SUPPORTED" << std::endl;
+        return 0;
+    }
+    unsigned int texture;
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, wrap);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, wrap);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, h.mipCount > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, (GLint)h.mipCount - 1);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    for (uint32_t i = 0; i < h.mipCount; ++i)
+    {
+        const CookedTextureLevel& level = view.levels[i];
+        const unsigned char* pixels = view.base + level.offset;
+        if (view.compressed())
+            glCompressedTexImage2D(GL_TEXTURE_2D, (GLint)i, h.internalFormat, level.width, level.height, 0,
+                                   (GLsizei)level.size, pixels);
+        else
+            glTexImage2D(GL_TEXTURE_2D, (GLint)i, (GLint)h.internalFormat, level.width, level.height, 0,
+                         h.format, h.type, pixels);
+    }
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    return texture;
+}
+
+// map the file, upload, unmap. returns 0 on failure so callers can fall back to stbi_load
+// ------------------------------------------------------------------------
+inline unsigned int loadCookedTexture(const char* path, GLenum wrap = GL_REPEAT)
+{
+    MappedFile file;
+    CookedTextureView view;
+    if (!file.open(path) || !view.parse(file.data(), file.size()))
+    {
+        std::cout << "ERROR::COOKED_TEXTURE::NOT_SUCCESFULLY_READ " << path << std::endl;
+        return 0;
+    }
+    return uploadCookedTexture(view, wrap);
+}
+#endif
@@ -0,0 +1,323 @@
+#include "file_watcher.h"
+
+#include <cstring>
+#include <cstdint>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#if defined(__linux__)
+#include <sys/inotify.h>
+#include <unistd.h>
+#define FILE_WATCHER_INOTIFY 1
+#elif defined(__APPLE__)
+#include <sys/event.h>
+#include <fcntl.h>
+#include <unistd.h>
+#define FILE_WATCHER_KQUEUE 1
+#elif defined(_WIN32)
+#define FILE_WATCHER_WIN32 1
+#endif
+
+namespace
+{
+void splitPath(const std::string& path, std::string& directory, std::string& name)
+{
+    size_t slash = path.find_last_of("/\\");
+    if (slash == std::string::npos)
+    {
+        directory = ".";
+        name = path;
+        return;
+    }
+    directory = slash == 0 ? path.substr(0, 1) : path.substr(0, slash);
+    name = path.substr(slash + 1);
+}
+
+long long elapsedMs(std::chrono::steady_clock::time_point since, std::chrono::steady_clock::time_point now)
+{
+    return std::chrono::duration_cast<std::chrono::milliseconds>(now - since).count();
+}
+}
+
+// ------------------------------------------------------------------------
+FileWatcher::FileWatcher()
+    : lastStat(Clock::now())
+#ifndef _WIN32
+    , queue(-1)
+#endif
+{
+#if FILE_WATCHER_INOTIFY
+    queue = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+#elif FILE_WATCHER_KQUEUE
+    queue = kqueue();
+#endif
+}
+
+FileWatcher::~FileWatcher()
+{
+#if FILE_WATCHER_INOTIFY
+    if (queue >= 0)
+        close(queue);
+#elif FILE_WATCHER_KQUEUE
+    for (size_t i = 0; i < entries.size(); ++i)
+    {
+        if (entries[i].handle >= 0)
+            close(entries[i].handle);
+    }
+    if (queue >= 0)
+        close(queue);
+#elif FILE_WATCHER_WIN32
+    for (size_t i = 0; i < directories.size(); ++i)
+    {
+        CancelIo(directories[i]->handle);
+        CloseHandle(directories[i]->handle);
+        CloseHandle(directories[i]->overlapped.hEvent);
+        delete directories[i];
+    }
+#endif
+}
+
+const char* FileWatcher::backend() const
+{
+#if FILE_WATCHER_INOTIFY
+    return queue >= 0 ? "inotify" : "stat";
+#elif FILE_WATCHER_KQUEUE
+    return queue >= 0 ? "kqueue" : "stat";
+#elif FILE_WATCHER_WIN32
+    return "ReadDirectoryChangesW";
+#else
+    return "stat";
+#endif
+}
+
+// ------------------------------------------------------------------------
+bool FileWatcher::watch(const std::string& path)
+{
+    Entry entry;
+    entry.path = path;
+    splitPath(path, entry.directory, entry.name);
+    entry.handle = -1;
+    entry.modified = entry.size = 0;
+    entry.pending = false;
+    statFile(path, entry.modified, entry.size);
+
+#if FILE_WATCHER_INOTIFY
+    // the directory, not the file: a save by rename replaces the watched inode.
+    // inotify returns the same watch for a directory that is already watched
+    if (queue >= 0)
+        entry.handle = inotify_add_watch(queue, entry.directory.c_str(), IN_CLOSE_WRITE | IN_MODIFY | IN_MOVED_TO | IN_CREATE);
+#elif FILE_WATCHER_KQUEUE
+    if (queue >= 0)
+    {
+        entry.handle = open(path.c_str(), O_EVTONLY);
+        if (entry.handle >= 0)
+        {
+            struct kevent change;
+            EV_SET(&change, entry.handle, EVFILT_VNODE, EV_ADD | EV_CLEAR,
+                   NOTE_WRITE | NOTE_EXTEND | NOTE_ATTRIB | NOTE_DELETE | NOTE_RENAME, 0, (void*)(uintptr_t)entries.size());
+            if (kevent(queue, &change, 1, NULL, 0, NULL) < 0)
+            {
+                close(entry.handle);
+                entry.handle = -1;
+            }
+        }
+    }
+#elif FILE_WATCHER_WIN32
+    for (size_t i = 0; i < directories.size() && entry.handle < 0; ++i)
+    {
+        if (directories[i]->path == entry.directory)
+            entry.handle = (int)i;
+    }
+    if (entry.handle < 0)
+    {
+        HANDLE handle = CreateFileA(entry.directory.c_str(), FILE_LIST_DIRECTORY, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                                    NULL, OPEN_EXISTING, FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED, NULL);
+        if (handle != INVALID_HANDLE_VALUE)
+        {
+            Directory* directory = new Directory;
+            directory->path = entry.directory;
+            directory->handle = handle;
+            std::memset(&directory->overlapped, 0, sizeof(directory->overlapped));
+            directory->overlapped.hEvent = CreateEventA(NULL, TRUE, FALSE, NULL);
+            directories.push_back(directory);
+            issueRead(*directory);
+            entry.handle = (int)directories.size() - 1;
+        }
+    }
+#endif
+    entries.push_back(entry);
+    return entry.handle >= 0;
+}
+
+// ------------------------------------------------------------------------
+void FileWatcher::poll(std::vector<std::string>& changed)
+{
+    changed.clear();
+    Clock::time_point now = Clock::now();
+    readEvents();
+
+    // files without an OS watch: compare time and size now and then
+    if (elapsedMs(lastStat, now) >= POLL_INTERVAL_MS)
+    {
+        lastStat = now;
+        for (size_t i = 0; i < entries.size(); ++i)
+        {
+            Entry& entry = entries[i];
+            if (entry.handle >= 0)
+                continue;
+            long long modified = 0, size = 0;
+            if (statFile(entry.path, modified, size) && (modified != entry.modified || size != entry.size))
+                markChanged(i);
+#if FILE_WATCHER_KQUEUE
+            // replaced or deleted earlier, watch the new file once it is there
+            if (queue >= 0 && modified != 0)
+            {
+                entry.handle = open(entry.path.c_str(), O_EVTONLY);
+                if (entry.handle >= 0)
+                {
+                    struct kevent change;
+                    EV_SET(&change, entry.handle, EVFILT_VNODE, EV_ADD | EV_CLEAR,
+                           NOTE_WRITE | NOTE_EXTEND | NOTE_ATTRIB | NOTE_DELETE | NOTE_RENAME, 0, (void*)(uintptr_t)i);
+                    // no watch, keep polling the path and try again next time
+                    if (kevent(queue, &change, 1, NULL, 0, NULL) < 0)
+                    {
+                        close(entry.handle);
+                        entry.handle = -1;
+                    }
+                }
+            }
+#endif
+        }
+    }
+
+    for (size_t i = 0; i < entries.size(); ++i)
+    {
+        Entry& entry = entries[i];
+        if (!entry.pending || elapsedMs(entry.lastEvent, now) < SETTLE_MS)
+            continue;
+        entry.pending = false;
+        statFile(entry.path, entry.modified, entry.size);
+        changed.push_back(entry.path);
+    }
+}
+
+void FileWatcher::markChanged(size_t entry)
+{
+    entries[entry].pending = true;
+    entries[entry].lastEvent = Clock::now();
+}
+
+bool FileWatcher::statFile(const std::string& path, long long& modified, long long& size) const
+{
+#ifdef _WIN32
+    struct _stat64 info;
+    if (_stat64(path.c_str(), &info) != 0)
+        return false;
+#else
+    struct stat info;
+    if (stat(path.c_str(), &info) != 0)
+        return false;
+#endif
+    modified = (long long)info.st_mtime;
+    size = (long long)info.st_size;
+    return true;
+}
+
+// drain the OS queue without waiting
+// ------------------------------------------------------------------------
+void FileWatcher::readEvents()
+{
+#if FILE_WATCHER_INOTIFY
+    if (queue < 0)
+        return;
+    // aligned for struct inotify_event
+    long long buffer[512];
+    for (;;)
+    {
+        ssize_t length = read(queue, buffer, sizeof(buffer));
+        if (length <= 0)
+            break;
+        const char* p = (const char*)buffer;
+        while (p < (const char*)buffer + length)
+        {
+            const inotify_event* event = (const inotify_event*)p;
+            for (size_t i = 0; i < entries.size(); ++i)
+            {
+                if (entries[i].handle == event->wd && event->len > 0 && entries[i].name == event->name)
+                    markChanged(i);
+            }
+            p += sizeof(inotify_event) + event->len;
+        }
+    }
+#elif FILE_WATCHER_KQUEUE
+    if (queue < 0)
+        return;
+    struct timespec zero = { 0, 0 };
+    struct kevent events[16];
+    for (;;)
+    {
+        int count = kevent(queue, NULL, 0, events, 16, &zero);
+        if (count <= 0)
+            break;
+        for (int e = 0; e < count; ++e)
+        {
+            size_t i = (size_t)(uintptr_t)events[e].udata;
+            if (i >= entries.size())
+                continue;
+            markChanged(i);
+            // the descriptor now refers to the old file, the stat pass re-opens the path
+            if (events[e].fflags & (NOTE_DELETE | NOTE_RENAME))
+            {
+                close(entries[i].handle);
+                entries[i].handle = -1;
+                entries[i].modified = 0;
+            }
+        }
+    }
+#elif FILE_WATCHER_WIN32
+    for (size_t d = 0; d < directories.size(); ++d)
+    {
+        Directory& directory = *directories[d];
+        DWORD bytes = 0;
+        if (!GetOverlappedResult(directory.handle, &directory.overlapped, &bytes, FALSE))
+            continue;
+        if (bytes == 0)
+        {
+            // the buffer overflowed, every file of the directory may have changed
+            for (size_t i = 0; i < entries.size(); ++i)
+            {
+                if (entries[i].handle == (int)d)
+                    markChanged(i);
+            }
+        }
+        const char* p = (const char*)directory.buffer;
+        while (bytes > 0)
+        {
+            const FILE_NOTIFY_INFORMATION* info = (const FILE_NOTIFY_INFORMATION*)p;
+            char name[MAX_PATH * 3];
+            int length = WideCharToMultiByte(CP_UTF8, 0, info->FileName, (int)(info->FileNameLength / sizeof(WCHAR)), name,
+                                             sizeof(name) - 1, NULL, NULL);
+            name[length > 0 ? length : 0] = 0;
+            for (size_t i = 0; i < entries.size(); ++i)
+            {
+                if (entries[i].handle == (int)d && _stricmp(entries[i].name.c_str(), name) == 0)
+                    markChanged(i);
+            }
+            if (info->NextEntryOffset == 0)
+                break;
+            p += info->NextEntryOffset;
+        }
+        issueRead(directory);
+    }
+#endif
+}
+
+#ifdef _WIN32
+void FileWatcher::issueRead(Directory& directory)
+{
+    ResetEvent(directory.overlapped.hEvent);
+    ReadDirectoryChangesW(directory.handle, directory.buffer, sizeof(directory.buffer), FALSE,
+                          FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_SIZE, NULL,
+                          &directory.overlapped, NULL);
+}
+#endif
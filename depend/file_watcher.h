@@ -0,0 +1,84 @@
+#ifndef FILE_WATCHER_H
+#define FILE_WATCHER_H
+
+#include <string>
+#include <vector>
+#include <chrono>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#endif
+
+// reports edits to a set of files without blocking: poll() once per frame costs one
+// non-blocking read of the OS change queue.
+//     Linux    inotify on the parent directories (catches editors that save by rename)
+//     macOS    kqueue EVFILT_VNODE per file, re-opened after a rename or delete
+//     Windows  overlapped ReadDirectoryChangesW on the parent directories
+//     other    stat() of every file, at most every POLL_INTERVAL_MS
+// a file is reported once it has been quiet for SETTLE_MS, so a save in several writes
+// is seen as one change and never half written.
+//
+//     FileWatcher watcher;
+//     watcher.watch("../1_base/5_transformations/helper/shader.vs");
+//     ...
+//     watcher.poll(changed);                 // every frame
+class FileWatcher
+{
+public:
+    static const int SETTLE_MS = 50;
+    static const int POLL_INTERVAL_MS = 250;
+
+    FileWatcher();
+    ~FileWatcher();
+
+    // false if the file's directory cannot be watched, it is polled by stat() then
+    bool watch(const std::string& path);
+    // clears changed, then appends every watched path whose change has settled
+    void poll(std::vector<std::string>& changed);
+    // "inotify", "kqueue", "ReadDirectoryChangesW" or "stat"
+    const char* backend() const;
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    struct Entry
+    {
+        std::string path;
+        std::string directory;
+        std::string name;
+        // inotify watch / kqueue descriptor / directory index, -1 when only polled
+        int handle;
+        long long modified;
+        long long size;
+        bool pending;
+        Clock::time_point lastEvent;
+    };
+
+    std::vector<Entry> entries;
+    Clock::time_point lastStat;
+#ifdef _WIN32
+    struct Directory
+    {
+        std::string path;
+        HANDLE handle;
+        OVERLAPPED overlapped;
+        DWORD buffer[4096];
+    };
+    std::vector<Directory*> directories;
+    void issueRead(Directory& directory);
+#else
+    // inotify instance or kqueue
+    int queue;
+#endif
+
+    void readEvents();
+    void markChanged(size_t entry);
+    bool statFile(const std::string& path, long long& modified, long long& size) const;
+
+    FileWatcher(const FileWatcher&);
+    FileWatcher& operator=(const FileWatcher&);
+};
+#endif
@@ -0,0 +1,130 @@
+#ifndef FRAME_ARENA_H
+#define FRAME_ARENA_H
+
+#include <string_ref.h>
+
+#include <vector>
+#include <cstdio>
+#include <cstdarg>
+#include <cstring>
+#include <cstdint>
+#include <iostream>
+#include <type_traits>
+
+// linear allocator for scratch data that lives exactly one frame: draw lists, temporary
+// transforms, names built for a lookup. allocate() bumps an offset into one block that
+// is reserved up front, reset() after glfwSwapBuffers makes all of it free again, so
+// per-frame scratch never touches the heap. nothing is destructed, only trivially
+// destructible types can be allocated.
+//
+//     FrameArena arena(1 << 20);
+//     while (...) {
+//         ObjectBlock* blocks = arena.allocate<ObjectBlock>(count);
+//         StringRef name = arena.format("lights[%d].color", i);
+//         ...
+//         glfwSwapBuffers(window);
+//         arena.reset();
+//     }
+//
+// a full arena returns NULL and counts an overflow instead of falling back to the heap;
+// highWater() tells how big the block should have been.
+class FrameArena
+{
+public:
+    struct Stats
+    {
+        unsigned long frames;
+        unsigned long allocations;
+        // largest number of bytes used by one frame
+        size_t highWater;
+        // allocations that did not fit
+        unsigned long overflows;
+    };
+
+    explicit FrameArena(size_t capacity) : memory(capacity), head(0)
+    {
+        std::memset(&stats, 0, sizeof(stats));
+    }
+
+    // size bytes aligned to alignment (a power of two), NULL if the frame is full
+    // ------------------------------------------------------------------------
+    void* allocate(size_t size, size_t alignment = 16)
+    {
+        uintptr_t base = (uintptr_t)memory.data();
+        size_t offset = (size_t)(((base + head + alignment - 1) & ~(uintptr_t)(alignment - 1)) - base);
+        if (offset + size > memory.size())
+        {
+            ++stats.overflows;
+            return NULL;
+        }
+        head = offset + size;
+        ++stats.allocations;
+        return memory.data() + offset;
+    }
+    // count uninitialized T, NULL if the frame is full
+    template <typename T>
+    T* allocate(size_t count)
+    {
+        static_assert(std::is_trivially_destructible<T>::value, "FrameArena never runs destructors");
+        return (T*)allocate(count * sizeof(T), alignof(T));
+    }
+
+    // zero terminated copy that lives until reset(); an empty ref if the frame is full
+    // ------------------------------------------------------------------------
+    StringRef copy(StringRef s)
+    {
+        char* out = (char*)allocate(s.length + 1, 1);
+        if (!out)
+            return StringRef();
+        std::memcpy(out, s.data, s.length);
+        out[s.length] = '\0';
+        return StringRef(out, s.length);
+    }
+    // printf into the arena, e.g. a uniform name with an array index
+    StringRef format(const char* fmt, ...)
+    {
+        // format into the free tail directly, then claim what was written
+        size_t available = memory.size() - head;
+        char* out = (char*)memory.data() + head;
+        va_list args;
+        va_start(args, fmt);
+        int length = available > 0 ? std::vsnprintf(out, available, fmt, args) : -1;
+        va_end(args);
+        if (length < 0 || (size_t)length + 1 > available)
+        {
+            ++stats.overflows;
+            return StringRef();
+        }
+        head += (size_t)length + 1;
+        ++stats.allocations;
+        return StringRef(out, (size_t)length);
+    }
+
+    // once per frame, after the swap: everything allocated so far is invalid
+    // ------------------------------------------------------------------------
+    void reset()
+    {
+        if (head > stats.highWater)
+            stats.highWater = head;
+        head = 0;
+        ++stats.frames;
+    }
+
+    size_t capacity() const { return memory.size(); }
+    size_t used() const { return head; }
+    const Stats& statistics() const { return stats; }
+    void printStats(std::ostream& out) const
+    {
+        out << "frame arena: " << stats.frames << " frames, " << stats.allocations << " allocations, high water "
+            << stats.highWater << " / " << memory.size() << " bytes, " << stats.overflows << " overflows" << std::endl;
+    }
+
+private:
+    std::vector<unsigned char> memory;
+    size_t head;
+    Stats stats;
+
+    FrameArena(const FrameArena&);
+    FrameArena& operator=(const FrameArena&);
+};
+#endif
@@ -0,0 +1,346 @@
+#ifndef FRAME_PACER_H
+#define FRAME_PACER_H
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <cstdint>
+#include <algorithm>
+#include <iostream>
+
+// owns the end of the render loop: swap interval, frame rate cap, how many frames the
+// CPU may run ahead of the GPU, and when input is read.
+//
+//     FramePacer pacer(window, FramePacer::FIXED_CAP, 120.0);
+//     while (!glfwWindowShouldClose(window))
+//     {
+//         pacer.beginFrame();          // throttle and sleep first...
+//         pacer.pollInput();           // ...so the input is as fresh as possible
+//         processInput(window);
+//         simulate, draw...
+//         pacer.present();             // glfwSwapBuffers + fence + timestamp
+//     }
+//     pacer.printStats(std::cout);
+//
+// modes:
+//     VSYNC      swap interval 1
+//     ADAPTIVE   swap interval -1 (tears instead of waiting a whole interval when a
+//                frame is late), needs WGL/GLX_EXT_swap_control_tear, else like VSYNC
+//     UNCAPPED   swap interval 0
+//     FIXED_CAP  swap interval 0, beginFrame() sleeps until the next 1 / capHz tick.
+//                sleep_for wakes late by up to a scheduler tick, so the last stretch is
+//                spun; the spin margin follows the oversleep that was measured
+//
+// with maxFramesInFlight > 0, beginFrame() waits on the glFenceSync of the frame that
+// many presents ago, so the driver cannot queue more frames (each one adding a frame of
+// latency). latency is measured from pollInput() to the GPU timestamp written after the
+// frame's swap: the time until the frame is rendered, scan-out comes on top.
+class FramePacer
+{
+public:
+    enum Mode
+    {
+        VSYNC,
+        ADAPTIVE,
+        UNCAPPED,
+        FIXED_CAP
+    };
+
+    static const int HISTORY = 240;
+    // fences and queries in flight, one more than the deepest throttle
+    static const int SLOTS = 4;
+
+    struct Stats
+    {
+        unsigned long frames;
+        // beginFrame() calls that had to wait for the GPU
+        unsigned long throttled;
+        // latency samples whose query was still not there when the slot was reused
+        unsigned long dropped;
+        double sleptMs;
+    };
+
+    // maxFramesInFlight 0 leaves queueing to the driver, at most SLOTS - 1
+    // ------------------------------------------------------------------------
+    FramePacer(GLFWwindow* window, Mode mode = VSYNC, double capHz = 60.0, int maxFramesInFlight = 2)
+        : window(window), mode(VSYNC), capHz(capHz), maxFramesInFlight(std::min(std::max(maxFramesInFlight, 0), SLOTS - 1)),
+          adaptiveSupported(false), frame(0), inputNs(0), lastPresentNs(0), deadlineNs(0), spinNs(2000000),
+          frameCount(0), latencyCount(0)
+    {
+        std::memset(&stats, 0, sizeof(stats));
+        epoch = std::chrono::steady_clock::now();
+        // line the GPU clock up with ours once, like Profiler
+        GLint64 gpuNow = 0;
+        glGetInteger64v(GL_TIMESTAMP, &gpuNow);
+        gpuToCpuNs = nowNs() - (int64_t)gpuNow;
+        for (int i = 0; i < SLOTS; ++i)
+        {
+            slots[i].fence = NULL;
+            slots[i].pending = false;
+            slots[i].inputNs = 0;
+        }
+        unsigned int queries[SLOTS];
+        glGenQueries(SLOTS, queries);
+        for (int i = 0; i < SLOTS; ++i)
+            slots[i].query = queries[i];
+        adaptiveSupported = glfwExtensionSupported("WGL_EXT_swap_control_tear") || glfwExtensionSupported("GLX_EXT_swap_control_tear");
+        setMode(mode, capHz);
+    }
+    // ------------------------------------------------------------------------
+    void release()
+    {
+        for (int i = 0; i < SLOTS; ++i)
+        {
+            if (slots[i].fence)
+                glDeleteSync(slots[i].fence);
+            slots[i].fence = NULL;
+            slots[i].pending = false;
+            glDeleteQueries(1, &slots[i].query);
+            slots[i].query = 0;
+        }
+    }
+
+    // ------------------------------------------------------------------------
+    void setMode(Mode newMode, double newCapHz = 0.0)
+    {
+        mode = newMode;
+        if (newCapHz > 0.0)
+            capHz = newCapHz;
+        int interval = 1;
+        if (mode == ADAPTIVE)
+            interval = adaptiveSupported ? -1 : 1;
+        else if (mode == UNCAPPED || mode == FIXED_CAP)
+            interval = 0;
+        glfwSwapInterval(interval);
+        deadlineNs = 0;
+        // the old frame times describe the old mode
+        frameCount = latencyCount = 0;
+    }
+    Mode currentMode() const { return mode; }
+    const char* modeName() const
+    {
+        switch (mode)
+        {
+            case VSYNC:     return "vsync";
+            case ADAPTIVE:  return adaptiveSupported ? "adaptive vsync" : "adaptive vsync (unsupported, vsync)";
+            case UNCAPPED:  return "uncapped";
+            case FIXED_CAP: return "fixed cap";
+        }
+        return "";
+    }
+
+    // collect finished measurements, wait for the frame slot and sleep to the cap
+    // ------------------------------------------------------------------------
+    void beginFrame()
+    {
+        for (int i = 0; i < SLOTS; ++i)
+            resolve(slots[i], false);
+
+        if (maxFramesInFlight > 0 && frame >= (uint64_t)maxFramesInFlight)
+        {
+            Slot& oldest = slots[(frame - maxFramesInFlight) % SLOTS];
+            if (oldest.fence)
+            {
+                // a zero timeout poll first so a wait can be counted
+                GLenum result = glClientWaitSync(oldest.fence, 0, 0);
+                if (result == GL_TIMEOUT_EXPIRED)
+                {
+                    ++stats.throttled;
+                    do
+                        result = glClientWaitSync(oldest.fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000);
+                    while (result == GL_TIMEOUT_EXPIRED);
+                }
+                glDeleteSync(oldest.fence);
+                oldest.fence = NULL;
+            }
+        }
+        // this frame's slot held the frame SLOTS presents ago
+        Slot& slot = slots[frame % SLOTS];
+        resolve(slot, true);
+        if (slot.fence)
+        {
+            glDeleteSync(slot.fence);
+            slot.fence = NULL;
+        }
+
+        if (mode == FIXED_CAP && capHz > 0.0)
+        {
+            int64_t period = (int64_t)(1e9 / capHz);
+            int64_t now = nowNs();
+            // a frame that overran starts the schedule again instead of rushing to catch up
+            deadlineNs = deadlineNs == 0 || deadlineNs + period < now ? now : deadlineNs + period;
+            sleepUntil(deadlineNs);
+        }
+    }
+    // glfwPollEvents as late as possible, returns the sample time in seconds
+    // ------------------------------------------------------------------------
+    double pollInput()
+    {
+        glfwPollEvents();
+        inputNs = nowNs();
+        return inputNs / 1e9;
+    }
+    // ------------------------------------------------------------------------
+    void present()
+    {
+        glfwSwapBuffers(window);
+        Slot& slot = slots[frame % SLOTS];
+        // after the swap: the timestamp is written once the frame's commands are done
+        glQueryCounter(slot.query, GL_TIMESTAMP);
+        slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        slot.inputNs = inputNs ? inputNs : nowNs();
+        slot.pending = true;
+        inputNs = 0;
+
+        int64_t now = nowNs();
+        if (lastPresentNs)
+            frameMs[frameCount++ % HISTORY] = (float)((now - lastPresentNs) / 1e6);
+        lastPresentNs = now;
+        ++frame;
+        ++stats.frames;
+    }
+
+    // rolling statistics over the last HISTORY frames
+    // ------------------------------------------------------------------------
+    float frameTimePercentile(float p) const { return percentile(frameMs, frameCount, p); }
+    float latencyPercentile(float p) const { return percentile(latencyMs, latencyCount, p); }
+    float meanFrameTime() const
+    {
+        unsigned int n = std::min(frameCount, (unsigned int)HISTORY);
+        double sum = 0.0;
+        for (unsigned int i = 0; i < n; ++i)
+            sum += frameMs[i];
+        return n ? (float)(sum / n) : 0.0f;
+    }
+    // standard deviation of the frame times
+    float jitter() const
+    {
+        unsigned int n = std::min(frameCount, (unsigned int)HISTORY);
+        if (n < 2)
+            return 0.0f;
+        double mean = meanFrameTime(), sum = 0.0;
+        for (unsigned int i = 0; i < n; ++i)
+            sum += (frameMs[i] - mean) * (frameMs[i] - mean);
+        return (float)std::sqrt(sum / (n - 1));
+    }
+    const Stats& statistics() const { return stats; }
+
+    void printStats(std::ostream& out) const
+    {
+        char line[160];
+        out << "frame pacer: " << modeName();
+        if (mode == FIXED_CAP)
+            out << " " << capHz << " Hz";
+        out << ", " << maxFramesInFlight << " frames in flight max, " << stats.frames << " frames, " << stats.throttled
+            << " throttled, " << stats.dropped << " latency samples dropped, " << stats.sleptMs << " ms slept" << std::endl;
+        std::snprintf(line, sizeof(line), "  frame time mean %7.3f p50 %7.3f p99 %7.3f ms, jitter %6.3f ms",
+                      meanFrameTime(), frameTimePercentile(0.5f), frameTimePercentile(0.99f), jitter());
+        out << line << std::endl;
+        std::snprintf(line, sizeof(line), "  input to GPU done p50 %7.3f p99 %7.3f ms", latencyPercentile(0.5f),
+                      latencyPercentile(0.99f));
+        out << line << std::endl;
+    }
+
+private:
+    struct Slot
+    {
+        GLsync fence;
+        unsigned int query;
+        int64_t inputNs;
+        bool pending;
+    };
+
+    GLFWwindow* window;
+    Mode mode;
+    double capHz;
+    int maxFramesInFlight;
+    bool adaptiveSupported;
+    uint64_t frame;
+    std::chrono::steady_clock::time_point epoch;
+    int64_t gpuToCpuNs;
+    int64_t inputNs;
+    int64_t lastPresentNs;
+    int64_t deadlineNs;
+    // sleep_for is trusted up to this far before the deadline
+    int64_t spinNs;
+    Slot slots[SLOTS];
+    float frameMs[HISTORY];
+    float latencyMs[HISTORY];
+    unsigned int frameCount, latencyCount;
+    Stats stats;
+
+    int64_t nowNs() const
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - epoch).count();
+    }
+
+    // read the slot's timestamp if it is there; force drops it if it is not
+    void resolve(Slot& slot, bool force)
+    {
+        if (!slot.pending)
+            return;
+        GLint available = 0;
+        glGetQueryObjectiv(slot.query, GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available)
+        {
+            if (force)
+            {
+                slot.pending = false;
+                ++stats.dropped;
+            }
+            return;
+        }
+        GLuint64 gpuDone = 0;
+        glGetQueryObjectui64v(slot.query, GL_QUERY_RESULT, &gpuDone);
+        latencyMs[latencyCount++ % HISTORY] = (float)(((int64_t)gpuDone + gpuToCpuNs - slot.inputNs) / 1e6);
+        slot.pending = false;
+    }
+
+    // ------------------------------------------------------------------------
+    void sleepUntil(int64_t deadline)
+    {
+        int64_t start = nowNs();
+        for (;;)
+        {
+            int64_t now = nowNs();
+            int64_t remaining = deadline - now;
+            if (remaining <= 0)
+                break;
+            if (remaining > spinNs)
+            {
+                int64_t requested = remaining - spinNs;
+                std::this_thread::sleep_for(std::chrono::nanoseconds(requested));
+                int64_t oversleep = nowNs() - now - requested;
+                // grow at once to the worst wake-up seen, shrink slowly
+                if (oversleep + 250000 > spinNs)
+                    spinNs = std::min(oversleep + (int64_t)250000, (int64_t)20000000);
+                else
+                    spinNs = std::max(spinNs - (spinNs - oversleep) / 16, (int64_t)250000);
+            }
+            else
+                std::this_thread::yield();
+        }
+        stats.sleptMs += (nowNs() - start) / 1e6;
+    }
+
+    static float percentile(const float* samples, unsigned int count, float p)
+    {
+        unsigned int n = std::min(count, (unsigned int)HISTORY);
+        if (n == 0)
+            return 0.0f;
+        std::vector<float> sorted(samples, samples + n);
+        std::sort(sorted.begin(), sorted.end());
+        size_t k = (size_t)(p * (n - 1) + 0.5f);
+        return sorted[std::min(k, (size_t)n - 1)];
+    }
+
+    FramePacer(const FramePacer&);
+    FramePacer& operator=(const FramePacer&);
+};
+#endif
@@ -0,0 +1,188 @@
+#ifndef GL_EXT_H
+#define GL_EXT_H
+
+#include <glad/glad.h>
+
+#include <cstring>
+
+// depend/glad.c is generated for core 4.1 without extensions so the samples run on macOS.
+// entry points from newer core versions and from extensions are loaded here at runtime,
+// every one of them comes with a flag that must be checked before use.
+// call loadGLExtensions() right after gladLoadGLLoader() with the same loader.
+
+#ifndef GL_MAP_PERSISTENT_BIT
+#define GL_MAP_PERSISTENT_BIT 0x0040
+#endif
+#ifndef GL_MAP_COHERENT_BIT
+#define GL_MAP_COHERENT_BIT 0x0080
+#endif
+#ifndef GL_DYNAMIC_STORAGE_BIT
+#define GL_DYNAMIC_STORAGE_BIT 0x0100
+#endif
+#ifndef GL_CLIENT_STORAGE_BIT
+#define GL_CLIENT_STORAGE_BIT 0x0200
+#endif
+#ifndef GL_MAX_SHADER_COMPILER_THREADS_KHR
+#define GL_MAX_SHADER_COMPILER_THREADS_KHR 0x91B0
+#endif
+#ifndef GL_COMPLETION_STATUS_KHR
+#define GL_COMPLETION_STATUS_KHR 0x91B1
+#endif
+#ifndef GL_COMPUTE_SHADER
+#define GL_COMPUTE_SHADER 0x91B9
+#endif
+#ifndef GL_SHADER_STORAGE_BUFFER
+#define GL_SHADER_STORAGE_BUFFER 0x90D2
+#endif
+#ifndef GL_COMMAND_BARRIER_BIT
+#define GL_COMMAND_BARRIER_BIT 0x00000040
+#endif
+#ifndef GL_SHADER_STORAGE_BARRIER_BIT
+#define GL_SHADER_STORAGE_BARRIER_BIT 0x00002000
+#endif
+#ifndef GL_PARAMETER_BUFFER
+#define GL_PARAMETER_BUFFER 0x80EE
+#endif
+
+struct GLExtensions
+{
+    typedef void (APIENTRYP BufferStorageProc)(GLenum target, GLsizeiptr size, const void* data, GLbitfield flags);
+    typedef void (APIENTRYP MaxShaderCompilerThreadsProc)(GLuint count);
+    typedef void (APIENTRYP MultiDrawElementsIndirectProc)(GLenum mode, GLenum type, const void* indirect, GLsizei drawCount,
+                                                          GLsizei stride);
+    typedef void (APIENTRYP MultiDrawElementsIndirectCountProc)(GLenum mode, GLenum type, const void* indirect,
+                                                               GLintptr drawCount, GLsizei maxDrawCount, GLsizei stride);
+    typedef void (APIENTRYP DispatchComputeProc)(GLuint x, GLuint y, GLuint z);
+    typedef void (APIENTRYP MemoryBarrierProc)(GLbitfield barriers);
+    typedef GLuint64 (APIENTRYP GetTextureHandleProc)(GLuint texture);
+    typedef void (APIENTRYP MakeTextureHandleResidentProc)(GLuint64 handle);
+    typedef void (APIENTRYP MakeTextureHandleNonResidentProc)(GLuint64 handle);
+
+    bool loaded;
+    int major, minor;
+
+    // GL 4.4 / GL_ARB_buffer_storage
+    bool bufferStorage;
+    BufferStorageProc BufferStorage;
+
+    // GL_EXT_texture_compression_s3tc, BC1-3 through glCompressedTexImage2D
+    bool textureCompressionS3TC;
+
+    // GL_KHR_parallel_shader_compile (or the ARB flavour): GL_COMPLETION_STATUS_KHR can be
+    // polled without stalling and the driver may compile on its own threads
+    bool parallelShaderCompile;
+    MaxShaderCompilerThreadsProc MaxShaderCompilerThreads;
+
+    // GL 4.3 / GL_ARB_multi_draw_indirect: a whole GL_DRAW_INDIRECT_BUFFER in one call,
+    // baseInstance of the commands is honoured (GL_ARB_base_instance is part of it)
+    bool multiDrawIndirect;
+    MultiDrawElementsIndirectProc MultiDrawElementsIndirect;
+
+    // GL 4.6 / GL_ARB_indirect_parameters: the draw count is read from GL_PARAMETER_BUFFER
+    bool indirectParameters;
+    MultiDrawElementsIndirectCountProc MultiDrawElementsIndirectCount;
+
+    // GL 4.3 / GL_ARB_compute_shader with GL_ARB_shader_storage_buffer_object
+    bool computeShader;
+    DispatchComputeProc DispatchCompute;
+    // not MemoryBarrier, winnt.h defines that as a macro
+    MemoryBarrierProc MemoryBarrierGL;
+
+    // GL_ARB_bindless_texture: 64-bit texture handles that a shader turns into a sampler,
+    // no texture unit involved. the spec wants the handle dynamically uniform per draw;
+    // bindlessDivergent (GL_NV_gpu_shader5) lifts that, so handles may differ per instance
+    bool bindlessTexture;
+    bool bindlessDivergent;
+    GetTextureHandleProc GetTextureHandle;
+    MakeTextureHandleResidentProc MakeTextureHandleResident;
+    MakeTextureHandleNonResidentProc MakeTextureHandleNonResident;
+};
+
+// the one instance, zero initialised until loadGLExtensions() runs
+// ------------------------------------------------------------------------
+inline GLExtensions& glExt()
+{
+    static GLExtensions ext;
+    return ext;
+}
+
+// ------------------------------------------------------------------------
+inline bool hasGLExtension(const char* name)
+{
+    int count = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+    for (int i = 0; i < count; ++i)
+    {
+        const char* ext = (const char*)glGetStringi(GL_EXTENSIONS, (GLuint)i);
+        if (ext && std::strcmp(ext, name) == 0)
+            return true;
+    }
+    return false;
+}
+
+// ------------------------------------------------------------------------
+inline bool glVersionAtLeast(int major, int minor)
+{
+    const GLExtensions& ext = glExt();
+    return ext.major > major || (ext.major == major && ext.minor >= minor);
+}
+
+// ------------------------------------------------------------------------
+inline void loadGLExtensions(GLADloadproc load)
+{
+    GLExtensions& ext = glExt();
+    glGetIntegerv(GL_MAJOR_VERSION, &ext.major);
+    glGetIntegerv(GL_MINOR_VERSION, &ext.minor);
+
+    ext.BufferStorage = NULL;
+    if (glVersionAtLeast(4, 4) || hasGLExtension("GL_ARB_buffer_storage"))
+        ext.BufferStorage = (GLExtensions::BufferStorageProc)load("glBufferStorage");
+    ext.bufferStorage = ext.BufferStorage != NULL;
+
+    ext.textureCompressionS3TC = hasGLExtension("GL_EXT_texture_compression_s3tc");
+
+    ext.MaxShaderCompilerThreads = NULL;
+    if (hasGLExtension("GL_KHR_parallel_shader_compile"))
+        ext.MaxShaderCompilerThreads = (GLExtensions::MaxShaderCompilerThreadsProc)load("glMaxShaderCompilerThreadsKHR");
+    else if (hasGLExtension("GL_ARB_parallel_shader_compile"))
+        ext.MaxShaderCompilerThreads = (GLExtensions::MaxShaderCompilerThreadsProc)load("glMaxShaderCompilerThreadsARB");
+    ext.parallelShaderCompile = ext.MaxShaderCompilerThreads != NULL;
+
+    ext.MultiDrawElementsIndirect = NULL;
+    if (glVersionAtLeast(4, 3) || hasGLExtension("GL_ARB_multi_draw_indirect"))
+        ext.MultiDrawElementsIndirect = (GLExtensions::MultiDrawElementsIndirectProc)load("glMultiDrawElementsIndirect");
+    ext.multiDrawIndirect = ext.MultiDrawElementsIndirect != NULL;
+
+    ext.MultiDrawElementsIndirectCount = NULL;
+    if (glVersionAtLeast(4, 6))
+        ext.MultiDrawElementsIndirectCount = (GLExtensions::MultiDrawElementsIndirectCountProc)load("glMultiDrawElementsIndirectCount");
+    else if (hasGLExtension("GL_ARB_indirect_parameters"))
+        ext.MultiDrawElementsIndirectCount = (GLExtensions::MultiDrawElementsIndirectCountProc)load("glMultiDrawElementsIndirectCountARB");
+    ext.indirectParameters = ext.multiDrawIndirect && ext.MultiDrawElementsIndirectCount != NULL;
+
+    ext.DispatchCompute = NULL;
+    ext.MemoryBarrierGL = NULL;
+    if (glVersionAtLeast(4, 3) ||
+        (hasGLExtension("GL_ARB_compute_shader") && hasGLExtension("GL_ARB_shader_storage_buffer_object")))
+    {
+        ext.DispatchCompute = (GLExtensions::DispatchComputeProc)load("glDispatchCompute");
+        ext.MemoryBarrierGL = (GLExtensions::MemoryBarrierProc)load("glMemoryBarrier");
+    }
+    ext.computeShader = ext.DispatchCompute != NULL && ext.MemoryBarrierGL != NULL;
+
+    ext.GetTextureHandle = NULL;
+    ext.MakeTextureHandleResident = NULL;
+    ext.MakeTextureHandleNonResident = NULL;
+    if (hasGLExtension("GL_ARB_bindless_texture"))
+    {
+        ext.GetTextureHandle = (GLExtensions::GetTextureHandleProc)load("glGetTextureHandleARB");
+        ext.MakeTextureHandleResident = (GLExtensions::MakeTextureHandleResidentProc)load("glMakeTextureHandleResidentARB");
+        ext.MakeTextureHandleNonResident = (GLExtensions::MakeTextureHandleNonResidentProc)load("glMakeTextureHandleNonResidentARB");
+    }
+    ext.bindlessTexture = ext.GetTextureHandle != NULL && ext.MakeTextureHandleResident != NULL &&
+                          ext.MakeTextureHandleNonResident != NULL;
+    ext.bindlessDivergent = ext.bindlessTexture && hasGLExtension("GL_NV_gpu_shader5");
+
+    ext.loaded = true;
+}
+#endif
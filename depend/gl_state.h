@@ -0,0 +1,290 @@
+#ifndef GL_STATE_H
+#define GL_STATE_H
+
+#include <glad/glad.h>
+
+#include <iostream>
+
+// shadows the bindings of one GL context and drops calls that would not change anything.
+// every real call and every skipped call is counted so the saving can be measured.
+// if code outside the cache touches the same bindings, call invalidate() afterwards.
+class GLStateCache
+{
+public:
+    enum Kind
+    {
+        PROGRAM = 0,
+        VERTEX_ARRAY,
+        ACTIVE_TEXTURE,
+        TEXTURE,
+        BUFFER,
+        BUFFER_RANGE,
+        KIND_COUNT
+    };
+    static const int MAX_TEXTURE_UNITS = 32;
+    static const int TEXTURE_TARGET_COUNT = 6;
+    static const int BUFFER_TARGET_COUNT = 9;
+    static const int MAX_UNIFORM_BINDINGS = 16;
+
+    GLStateCache()
+    {
+        invalidate();
+        resetCounters();
+    }
+    // forget everything we know, the next request of every binding reaches the driver
+    // ------------------------------------------------------------------------
+    void invalidate()
+    {
+        program = UNKNOWN;
+        vertexArray = UNKNOWN;
+        activeUnit = UNKNOWN;
+        for (int u = 0; u < MAX_TEXTURE_UNITS; ++u)
+            for (int t = 0; t < TEXTURE_TARGET_COUNT; ++t)
+                textures[u][t] = UNKNOWN;
+        for (int b = 0; b < BUFFER_TARGET_COUNT; ++b)
+            buffers[b] = UNKNOWN;
+        for (int i = 0; i < MAX_UNIFORM_BINDINGS; ++i)
+            uniformRanges[i].buffer = UNKNOWN;
+    }
+    // ------------------------------------------------------------------------
+    void useProgram(unsigned int id)
+    {
+        if (program == id)
+        {
+            ++elided[PROGRAM];
+            return;
+        }
+        glUseProgram(id);
+        program = id;
+        ++issued[PROGRAM];
+    }
+    // ------------------------------------------------------------------------
+    void bindVertexArray(unsigned int vao)
+    {
+        if (vertexArray == vao)
+        {
+            ++elided[VERTEX_ARRAY];
+            return;
+        }
+        glBindVertexArray(vao);
+        vertexArray = vao;
+        // GL_ELEMENT_ARRAY_BUFFER is part of the VAO state, the new VAO brings its own
+        buffers[bufferIndex(GL_ELEMENT_ARRAY_BUFFER)] = UNKNOWN;
+        ++issued[VERTEX_ARRAY];
+    }
+    // unit is the enum passed to glActiveTexture, e.g. GL_TEXTURE0
+    // ------------------------------------------------------------------------
+    void activeTexture(GLenum unit)
+    {
+        if (activeUnit == unit)
+        {
+            ++elided[ACTIVE_TEXTURE];
+            return;
+        }
+        glActiveTexture(unit);
+        activeUnit = unit;
+        ++issued[ACTIVE_TEXTURE];
+    }
+    // binds to the currently active unit, like glBindTexture
+    // ------------------------------------------------------------------------
+    void bindTexture(GLenum target, unsigned int texture)
+    {
+        int t = textureIndex(target);
+        int u = (int)(activeUnit - GL_TEXTURE0);
+        if (t < 0 || activeUnit == UNKNOWN || u < 0 || u >= MAX_TEXTURE_UNITS)
+        {
+            glBindTexture(target, texture);
+            ++issued[TEXTURE];
+            return;
+        }
+        if (textures[u][t] == texture)
+        {
+            ++elided[TEXTURE];
+            return;
+        }
+        glBindTexture(target, texture);
+        textures[u][t] = texture;
+        ++issued[TEXTURE];
+    }
+    // binds a texture to a unit given by index (0, 1, ...) and only switches the
+    // active unit when a bind is really needed. prefer this in render loops: the
+    // glActiveTexture/glBindTexture pairs of consecutive frames collapse to nothing.
+    // ------------------------------------------------------------------------
+    void bindTextureUnit(unsigned int unit, GLenum target, unsigned int texture)
+    {
+        int t = textureIndex(target);
+        if (t >= 0 && unit < (unsigned int)MAX_TEXTURE_UNITS && textures[unit][t] == texture)
+        {
+            ++elided[TEXTURE];
+            return;
+        }
+        activeTexture(GL_TEXTURE0 + unit);
+        bindTexture(target, texture);
+    }
+    // ------------------------------------------------------------------------
+    void bindBuffer(GLenum target, unsigned int buffer)
+    {
+        int b = bufferIndex(target);
+        if (b < 0)
+        {
+            glBindBuffer(target, buffer);
+            ++issued[BUFFER];
+            return;
+        }
+        if (buffers[b] == buffer)
+        {
+            ++elided[BUFFER];
+            return;
+        }
+        glBindBuffer(target, buffer);
+        buffers[b] = buffer;
+        ++issued[BUFFER];
+    }
+
+    // indexed uniform buffer binding, like glBindBufferRange(GL_UNIFORM_BUFFER, ...).
+    // it also binds the generic GL_UNIFORM_BUFFER target, the shadow follows
+    // ------------------------------------------------------------------------
+    void bindUniformRange(unsigned int index, unsigned int buffer, GLintptr offset, GLsizeiptr size)
+    {
+        if (index >= (unsigned int)MAX_UNIFORM_BINDINGS)
+        {
+            glBindBufferRange(GL_UNIFORM_BUFFER, index, buffer, offset, size);
+            buffers[bufferIndex(GL_UNIFORM_BUFFER)] = buffer;
+            ++issued[BUFFER_RANGE];
+            return;
+        }
+        UniformRange& range = uniformRanges[index];
+        if (range.buffer == buffer && range.offset == offset && range.size == size)
+        {
+            ++elided[BUFFER_RANGE];
+            return;
+        }
+        glBindBufferRange(GL_UNIFORM_BUFFER, index, buffer, offset, size);
+        range.buffer = buffer;
+        range.offset = offset;
+        range.size = size;
+        buffers[bufferIndex(GL_UNIFORM_BUFFER)] = buffer;
+        ++issued[BUFFER_RANGE];
+    }
+
+    // deleting an object unbinds it from the context, keep the shadow in sync
+    // ------------------------------------------------------------------------
+    void onDeleteProgram(unsigned int id)
+    {
+        if (program == id)
+            program = UNKNOWN;
+    }
+    void onDeleteVertexArray(unsigned int vao)
+    {
+        if (vertexArray == vao)
+        {
+            vertexArray = 0;
+            buffers[bufferIndex(GL_ELEMENT_ARRAY_BUFFER)] = UNKNOWN;
+        }
+    }
+    void onDeleteTexture(unsigned int texture)
+    {
+        for (int u = 0; u < MAX_TEXTURE_UNITS; ++u)
+            for (int t = 0; t < TEXTURE_TARGET_COUNT; ++t)
+                if (textures[u][t] == texture)
+                    textures[u][t] = 0;
+    }
+    void onDeleteBuffer(unsigned int buffer)
+    {
+        for (int b = 0; b < BUFFER_TARGET_COUNT; ++b)
+            if (buffers[b] == buffer)
+                buffers[b] = 0;
+        for (int i = 0; i < MAX_UNIFORM_BINDINGS; ++i)
+            if (uniformRanges[i].buffer == buffer)
+                uniformRanges[i].buffer = 0;
+    }
+
+    // counters
+    // ------------------------------------------------------------------------
+    void resetCounters()
+    {
+        for (int k = 0; k < KIND_COUNT; ++k)
+        {
+            issued[k] = 0;
+            elided[k] = 0;
+        }
+    }
+    unsigned long issuedCount(Kind kind) const { return issued[kind]; }
+    unsigned long elidedCount(Kind kind) const { return elided[kind]; }
+    unsigned long issuedTotal() const
+    {
+        unsigned long total = 0;
+        for (int k = 0; k < KIND_COUNT; ++k)
+            total += issued[k];
+        return total;
+    }
+    unsigned long elidedTotal() const
+    {
+        unsigned long total = 0;
+        for (int k = 0; k < KIND_COUNT; ++k)
+            total += elided[k];
+        return total;
+    }
+    void printStats(std::ostream& out) const
+    {
+        static const char* names[KIND_COUNT] = {
+                "glUseProgram", "glBindVertexArray", "glActiveTexture", "glBindTexture", "glBindBuffer",
+                "glBindBufferRange"
+        };
+        out << "GL state cache: issued / elided" << std::endl;
+        for (int k = 0; k < KIND_COUNT; ++k)
+            out << "  " << names[k] << ": " << issued[k] << " / " << elided[k] << std::endl;
+        out << "  total: " << issuedTotal() << " / " << elidedTotal() << std::endl;
+    }
+
+private:
+    static const unsigned int UNKNOWN = 0xFFFFFFFFu;
+
+    unsigned int program;
+    unsigned int vertexArray;
+    unsigned int activeUnit;
+    unsigned int textures[MAX_TEXTURE_UNITS][TEXTURE_TARGET_COUNT];
+    unsigned int buffers[BUFFER_TARGET_COUNT];
+    struct UniformRange
+    {
+        unsigned int buffer;
+        GLintptr offset;
+        GLsizeiptr size;
+    };
+    UniformRange uniformRanges[MAX_UNIFORM_BINDINGS];
+    unsigned long issued[KIND_COUNT];
+    unsigned long elided[KIND_COUNT];
+
+    // targets we shadow, anything else is passed straight through
+    // ------------------------------------------------------------------------
+    static int textureIndex(GLenum target)
+    {
+        switch (target)
+        {
+            case GL_TEXTURE_2D:             return 0;
+            case GL_TEXTURE_2D_ARRAY:       return 1;
+            case GL_TEXTURE_3D:             return 2;
+            case GL_TEXTURE_CUBE_MAP:       return 3;
+            case GL_TEXTURE_2D_MULTISAMPLE: return 4;
+            case GL_TEXTURE_BUFFER:         return 5;
+            default:                        return -1;
+        }
+    }
+    static int bufferIndex(GLenum target)
+    {
+        switch (target)
+        {
+            case GL_ARRAY_BUFFER:         return 0;
+            case GL_ELEMENT_ARRAY_BUFFER: return 1;
+            case GL_UNIFORM_BUFFER:       return 2;
+            case GL_PIXEL_UNPACK_BUFFER:  return 3;
+            case GL_PIXEL_PACK_BUFFER:    return 4;
+            case GL_COPY_READ_BUFFER:     return 5;
+            case GL_COPY_WRITE_BUFFER:    return 6;
+            case GL_DRAW_INDIRECT_BUFFER: return 7;
+            case GL_TEXTURE_BUFFER:       return 8;
+            default:                      return -1;
+        }
+    }
+};
+#endif
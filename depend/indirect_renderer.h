@@ -0,0 +1,484 @@
+#ifndef INDIRECT_RENDERER_H
+#define INDIRECT_RENDERER_H
+
+#include <glad/glad.h>
+
+#include <glm/glm.hpp>
+
+#include <gl_ext.h>
+#include <gl_state.h>
+#include <shader_s.h>
+#include <mesh_data.h>
+#include <vertex_layout.h>
+#include <bvh.h>
+
+#include <vector>
+#include <string>
+#include <cmath>
+#include <cstring>
+#include <cstdint>
+#include <iostream>
+
+// the layout glMultiDrawElementsIndirect reads from GL_DRAW_INDIRECT_BUFFER, and the
+// std430 layout of the compute shader's Command struct
+struct DrawElementsIndirectCommand
+{
+    GLuint count;
+    GLuint instanceCount;
+    GLuint firstIndex;
+    GLint baseVertex;
+    GLuint baseInstance;
+};
+
+// draws a scene of different meshes with a handful of calls. every mesh is appended to
+// one shared VBO/EBO at upload(), so a draw is just an index range and a base vertex:
+//
+//     IndirectRenderer scene;
+//     unsigned int torus = scene.addMesh(torusData), cube = scene.addMesh(cubeData);
+//     scene.upload();
+//     scene.enableGpuCulling("../1_base/6_mesh/helper/cull.comp");   // optional
+//     ...
+//     scene.begin();
+//     scene.add(torus, model);                  // per object, every frame
+//     scene.submit(glState, shader.ID, &frustum);
+//
+// the model matrices go to an instance VBO (location 2, like InstancedRenderer) that the
+// commands index with baseInstance. paths, picked from what the context offers:
+//     GL 4.3 multi draw indirect    one glMultiDrawElementsIndirect for the whole scene;
+//                                   consecutive visible draws of the same mesh are merged
+//                                   into one instanced command
+//     + compute culling             a compute pass tests each command's bounding sphere
+//                                   and, with GL_ARB_indirect_parameters, compacts the
+//                                   visible commands and their count on the GPU (count
+//                                   read via GL_PARAMETER_BUFFER); without it culled
+//                                   commands get instanceCount 0 in place
+//     GL 4.1 fallback               one glDrawElementsInstancedBaseVertex per command,
+//                                   the instance attributes are re-pointed at the
+//                                   command's transforms since there is no baseInstance
+// vertices are stored as VertexLayout::floats(), indices 16-bit when every mesh fits.
+class IndirectRenderer
+{
+public:
+    // first of the four locations used by the instance matrix
+    static const unsigned int TRANSFORM_LOCATION = 2;
+    // compute work group size, must match local_size_x in the cull shader
+    static const unsigned int CULL_GROUP_SIZE = 64;
+
+    enum Path
+    {
+        PATH_MULTI_DRAW_INDIRECT = 0,
+        PATH_DRAW_LOOP,
+    };
+
+    // of the last submit()
+    struct Stats
+    {
+        unsigned long draws;
+        // after CPU culling and merging
+        unsigned long commands;
+        unsigned long drawCalls;
+        unsigned long cpuCulled;
+        // commands culled on the GPU are not read back, only counted as submitted
+        bool gpuCulling;
+    };
+
+    unsigned int VAO, VBO, EBO;
+    unsigned int instanceVBO;
+    unsigned int commandBuffer;
+
+    IndirectRenderer()
+        : VAO(0), VBO(0), EBO(0), instanceVBO(0), commandBuffer(0), shortIndices(true), sphereBuffer(0), culledCommandBuffer(0),
+          countBuffer(0), indexType(GL_UNSIGNED_INT), commandCapacity(0), culledCapacity(0), instanceCapacity(0)
+    {
+        std::memset(&stats, 0, sizeof(stats));
+    }
+
+    // append a mesh to the shared buffers, returns its id for add(). call before upload()
+    // ------------------------------------------------------------------------
+    unsigned int addMesh(const MeshData& mesh)
+    {
+        MeshRange range;
+        range.firstIndex = (unsigned int)indices.size();
+        range.indexCount = (unsigned int)mesh.indices.size();
+        range.baseVertex = (int)vertices.vertices.size();
+        boundingSphere(mesh, range.sphere);
+        vertices.vertices.insert(vertices.vertices.end(), mesh.vertices.begin(), mesh.vertices.end());
+        indices.insert(indices.end(), mesh.indices.begin(), mesh.indices.end());
+        // indices stay relative to the mesh, baseVertex adds the offset at draw time
+        shortIndices = shortIndices && mesh.fitsUnsignedShort();
+        meshes.push_back(range);
+        return (unsigned int)meshes.size() - 1;
+    }
+
+    // create the VAO and the mega buffers, CPU copies of the meshes are dropped.
+    // leaves the VAO bound
+    // ------------------------------------------------------------------------
+    void upload()
+    {
+        glGenVertexArrays(1, &VAO);
+        glGenBuffers(1, &VBO);
+        glGenBuffers(1, &EBO);
+        glGenBuffers(1, &instanceVBO);
+        glGenBuffers(1, &commandBuffer);
+        glBindVertexArray(VAO);
+
+        glBindBuffer(GL_ARRAY_BUFFER, VBO);
+        glBufferData(GL_ARRAY_BUFFER, vertices.vertices.size() * sizeof(MeshVertex),
+                     vertices.vertices.empty() ? NULL : &vertices.vertices[0], GL_STATIC_DRAW);
+        VertexLayout::floats().apply();
+
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+        if (shortIndices)
+        {
+            std::vector<uint16_t> packed(indices.begin(), indices.end());
+            indexType = GL_UNSIGNED_SHORT;
+            glBufferData(GL_ELEMENT_ARRAY_BUFFER, packed.size() * sizeof(uint16_t), packed.empty() ? NULL : &packed[0],
+                         GL_STATIC_DRAW);
+        }
+        else
+        {
+            indexType = GL_UNSIGNED_INT;
+            glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(uint32_t), indices.empty() ? NULL : &indices[0],
+                         GL_STATIC_DRAW);
+        }
+
+        glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+        pointInstanceAttributes(0);
+        for (unsigned int i = 0; i < 4; ++i)
+        {
+            glEnableVertexAttribArray(TRANSFORM_LOCATION + i);
+            glVertexAttribDivisor(TRANSFORM_LOCATION + i, 1);
+        }
+
+        std::cout << "indirect renderer: " << meshes.size() << " meshes, " << vertices.vertices.size() << " vertices, "
+                  << indices.size() << (shortIndices ? " 16" : " 32") << "-bit indices, "
+                  << (path() == PATH_MULTI_DRAW_INDIRECT ? "multi draw indirect" : "draw loop (no GL 4.3)") << std::endl;
+        vertices.clear();
+        std::vector<uint32_t>().swap(indices);
+    }
+
+    // compile the culling compute shader; false (and CPU culling stays in use) when the
+    // context has no compute shaders or multi draw indirect, or the shader fails
+    // ------------------------------------------------------------------------
+    bool enableGpuCulling(const char* computePath)
+    {
+        if (!glExt().computeShader || !glExt().multiDrawIndirect)
+        {
+            std::cout << "indirect renderer: no compute culling on this context" << std::endl;
+            return false;
+        }
+        std::string code;
+        if (!Shader::readFile(computePath, code))
+        {
+            std::cout << "ERROR::SHADER::FILE_NOT_SUCCESFULLY_READ " << computePath << std::endl;
+            return false;
+        }
+        if (!cull.buildCompute(code))
+        {
+            glDeleteProgram(cull.ID);
+            cull.ID = 0;
+            return false;
+        }
+        planesLoc = cull.uniform("planes");
+        commandCountLoc = cull.uniform("commandCount");
+        compactLoc = cull.uniform("compact");
+        glGenBuffers(1, &sphereBuffer);
+        glGenBuffers(1, &culledCommandBuffer);
+        glGenBuffers(1, &countBuffer);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, countBuffer);
+        glBufferData(GL_COPY_WRITE_BUFFER, sizeof(GLuint), NULL, GL_DYNAMIC_DRAW);
+        return true;
+    }
+    bool gpuCulling() const { return cull.ID != 0; }
+    Path path() const { return glExt().multiDrawIndirect ? PATH_MULTI_DRAW_INDIRECT : PATH_DRAW_LOOP; }
+
+    // ------------------------------------------------------------------------
+    void begin()
+    {
+        drawMeshes.clear();
+        drawTransforms.clear();
+    }
+    void add(unsigned int mesh, const glm::mat4& transform)
+    {
+        drawMeshes.push_back(mesh);
+        drawTransforms.push_back(transform);
+    }
+
+    // build and upload this frame's commands and transforms, cull (on the GPU when
+    // enabled, else on the CPU if a frustum is given) and draw them with program.
+    // textures and other uniforms of program must already be set
+    // ------------------------------------------------------------------------
+    void submit(GLStateCache& state, unsigned int program, const Frustum* frustum = NULL)
+    {
+        stats.draws = drawMeshes.size();
+        stats.cpuCulled = 0;
+        stats.drawCalls = 0;
+        stats.gpuCulling = gpuCulling() && frustum != NULL;
+        buildCommands(stats.gpuCulling ? NULL : frustum);
+        stats.commands = commands.size();
+        if (commands.empty())
+            return;
+
+        // orphan every frame, last frame's draws may still read the old storage
+        state.bindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+        if (transforms.size() > instanceCapacity)
+            instanceCapacity = grow(instanceCapacity, transforms.size());
+        glBufferData(GL_ARRAY_BUFFER, instanceCapacity * sizeof(glm::mat4), NULL, GL_STREAM_DRAW);
+        glBufferSubData(GL_ARRAY_BUFFER, 0, transforms.size() * sizeof(glm::mat4), &transforms[0]);
+
+        if (path() == PATH_DRAW_LOOP)
+        {
+            drawLoop(state, program);
+            return;
+        }
+
+        state.bindBuffer(GL_DRAW_INDIRECT_BUFFER, commandBuffer);
+        if (commands.size() > commandCapacity)
+            commandCapacity = grow(commandCapacity, commands.size());
+        glBufferData(GL_DRAW_INDIRECT_BUFFER, commandCapacity * sizeof(DrawElementsIndirectCommand), NULL, GL_STREAM_DRAW);
+        glBufferSubData(GL_DRAW_INDIRECT_BUFFER, 0, commands.size() * sizeof(DrawElementsIndirectCommand), &commands[0]);
+
+        GLsizei count = (GLsizei)commands.size();
+        bool compact = false;
+        if (stats.gpuCulling)
+        {
+            compact = glExt().indirectParameters;
+            dispatchCull(state, *frustum, compact);
+            state.bindBuffer(GL_DRAW_INDIRECT_BUFFER, culledCommandBuffer);
+        }
+
+        state.useProgram(program);
+        state.bindVertexArray(VAO);
+        if (compact)
+        {
+            glBindBuffer(GL_PARAMETER_BUFFER, countBuffer);
+            glExt().MultiDrawElementsIndirectCount(GL_TRIANGLES, indexType, 0, 0, count, 0);
+        }
+        else
+        {
+            glExt().MultiDrawElementsIndirect(GL_TRIANGLES, indexType, 0, count, 0);
+        }
+        stats.drawCalls = 1;
+    }
+
+    // must run while the context is still alive
+    // ------------------------------------------------------------------------
+    void release()
+    {
+        if (VAO)
+        {
+            glDeleteVertexArrays(1, &VAO);
+            glDeleteBuffers(1, &VBO);
+            glDeleteBuffers(1, &EBO);
+            glDeleteBuffers(1, &instanceVBO);
+            glDeleteBuffers(1, &commandBuffer);
+        }
+        if (cull.ID)
+        {
+            glDeleteProgram(cull.ID);
+            glDeleteBuffers(1, &sphereBuffer);
+            glDeleteBuffers(1, &culledCommandBuffer);
+            glDeleteBuffers(1, &countBuffer);
+            cull.ID = 0;
+        }
+        VAO = VBO = EBO = instanceVBO = commandBuffer = 0;
+        sphereBuffer = culledCommandBuffer = countBuffer = 0;
+        commandCapacity = culledCapacity = instanceCapacity = 0;
+    }
+
+    size_t meshCount() const { return meshes.size(); }
+    const Stats& statistics() const { return stats; }
+    void printStats(std::ostream& out) const
+    {
+        out << "indirect renderer: " << stats.draws << " draws, " << stats.cpuCulled << " culled on the CPU, "
+            << stats.commands << " commands" << (stats.gpuCulling ? " culled on the GPU" : "") << " in "
+            << stats.drawCalls << " draw calls" << std::endl;
+    }
+
+private:
+    struct MeshRange
+    {
+        unsigned int firstIndex;
+        unsigned int indexCount;
+        int baseVertex;
+        // object space center and radius
+        float sphere[4];
+    };
+
+    std::vector<MeshRange> meshes;
+    // gathered by addMesh() until upload()
+    MeshData vertices;
+    std::vector<uint32_t> indices;
+    bool shortIndices;
+
+    // this frame
+    std::vector<unsigned int> drawMeshes;
+    std::vector<glm::mat4> drawTransforms;
+    std::vector<DrawElementsIndirectCommand> commands;
+    std::vector<glm::mat4> transforms;
+    std::vector<glm::vec4> spheres;
+
+    Shader cull;
+    unsigned int sphereBuffer, culledCommandBuffer, countBuffer;
+    GLenum indexType;
+    size_t commandCapacity, culledCapacity, instanceCapacity;
+    UniformHandle planesLoc, commandCountLoc, compactLoc;
+    Stats stats;
+
+    // ------------------------------------------------------------------------
+    void buildCommands(const Frustum* frustum)
+    {
+        commands.clear();
+        transforms.clear();
+        spheres.clear();
+        bool merge = !stats.gpuCulling;
+        for (size_t i = 0; i < drawMeshes.size(); ++i)
+        {
+            const MeshRange& mesh = meshes[drawMeshes[i]];
+            if (frustum && !sphereVisible(*frustum, drawTransforms[i], mesh.sphere))
+            {
+                ++stats.cpuCulled;
+                continue;
+            }
+            unsigned int instance = (unsigned int)transforms.size();
+            transforms.push_back(drawTransforms[i]);
+            // same mesh as the previous command and its transforms follow directly:
+            // one more instance instead of one more command
+            if (merge && !commands.empty() && commands.back().firstIndex == mesh.firstIndex &&
+                commands.back().baseVertex == mesh.baseVertex &&
+                commands.back().baseInstance + commands.back().instanceCount == instance)
+            {
+                ++commands.back().instanceCount;
+                continue;
+            }
+            DrawElementsIndirectCommand command;
+            command.count = mesh.indexCount;
+            command.instanceCount = 1;
+            command.firstIndex = mesh.firstIndex;
+            command.baseVertex = mesh.baseVertex;
+            command.baseInstance = instance;
+            commands.push_back(command);
+            spheres.push_back(glm::vec4(mesh.sphere[0], mesh.sphere[1], mesh.sphere[2], mesh.sphere[3]));
+        }
+    }
+
+    // one compute invocation per command, see cull.comp
+    // ------------------------------------------------------------------------
+    void dispatchCull(GLStateCache& state, const Frustum& frustum, bool compact)
+    {
+        // written and read only by the GPU, allocated once per capacity
+        state.bindBuffer(GL_COPY_WRITE_BUFFER, culledCommandBuffer);
+        if (culledCapacity != commandCapacity)
+        {
+            culledCapacity = commandCapacity;
+            glBufferData(GL_COPY_WRITE_BUFFER, (GLsizeiptr)(culledCapacity * sizeof(DrawElementsIndirectCommand)), NULL,
+                         GL_DYNAMIC_COPY);
+        }
+        state.bindBuffer(GL_COPY_WRITE_BUFFER, sphereBuffer);
+        glBufferData(GL_COPY_WRITE_BUFFER, (GLsizeiptr)(commandCapacity * sizeof(glm::vec4)), NULL, GL_STREAM_DRAW);
+        glBufferSubData(GL_COPY_WRITE_BUFFER, 0, (GLsizeiptr)(spheres.size() * sizeof(glm::vec4)), &spheres[0]);
+        GLuint zero = 0;
+        state.bindBuffer(GL_COPY_WRITE_BUFFER, countBuffer);
+        glBufferSubData(GL_COPY_WRITE_BUFFER, 0, sizeof(GLuint), &zero);
+
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, instanceVBO);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, sphereBuffer);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, commandBuffer);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, culledCommandBuffer);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 4, countBuffer);
+
+        state.useProgram(cull.ID);
+        glUniform4fv(cull.location(planesLoc), 6, &frustum.planes[0][0]);
+        glUniform1ui(cull.location(commandCountLoc), (GLuint)commands.size());
+        cull.setBool(compactLoc, compact);
+        glExt().DispatchCompute((GLuint)((commands.size() + CULL_GROUP_SIZE - 1) / CULL_GROUP_SIZE), 1, 1);
+        /// 间接绘制命令和绘制数量由计算着色器写入，绘制读取之前需要屏障
+        glExt().MemoryBarrierGL(GL_COMMAND_BARRIER_BIT);
+    }
+
+    // GL 4.1: no baseInstance, so the instance attributes are moved to the command's
+    // first transform before each draw
+    // ------------------------------------------------------------------------
+    void drawLoop(GLStateCache& state, unsigned int program)
+    {
+        state.useProgram(program);
+        state.bindVertexArray(VAO);
+        state.bindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+        size_t indexSize = indexType == GL_UNSIGNED_SHORT ? sizeof(uint16_t) : sizeof(uint32_t);
+        for (size_t i = 0; i < commands.size(); ++i)
+        {
+            const DrawElementsIndirectCommand& command = commands[i];
+            pointInstanceAttributes(command.baseInstance);
+            glDrawElementsInstancedBaseVertex(GL_TRIANGLES, (GLsizei)command.count, indexType,
+                                              (void*)(uintptr_t)(command.firstIndex * indexSize),
+                                              (GLsizei)command.instanceCount, command.baseVertex);
+        }
+        stats.drawCalls = commands.size();
+        // back to instance 0 for the next frame's first command
+        pointInstanceAttributes(0);
+    }
+    void pointInstanceAttributes(unsigned int firstInstance)
+    {
+        for (unsigned int i = 0; i < 4; ++i)
+            glVertexAttribPointer(TRANSFORM_LOCATION + i, 4, GL_FLOAT, GL_FALSE, sizeof(glm::mat4),
+                                  (void*)(uintptr_t)(firstInstance * sizeof(glm::mat4) + i * sizeof(glm::vec4)));
+    }
+
+    static size_t grow(size_t capacity, size_t count)
+    {
+        size_t grown = capacity < 64 ? 64 : capacity;
+        while (grown < count)
+            grown *= 2;
+        return grown;
+    }
+
+    // center of the bounds and the farthest vertex from it
+    static void boundingSphere(const MeshData& mesh, float sphere[4])
+    {
+        sphere[0] = sphere[1] = sphere[2] = sphere[3] = 0.0f;
+        if (mesh.vertices.empty())
+            return;
+        float low[3], high[3];
+        for (int k = 0; k < 3; ++k)
+            low[k] = high[k] = mesh.vertices[0].position[k];
+        for (size_t v = 1; v < mesh.vertices.size(); ++v)
+        {
+            for (int k = 0; k < 3; ++k)
+            {
+                low[k] = std::min(low[k], mesh.vertices[v].position[k]);
+                high[k] = std::max(high[k], mesh.vertices[v].position[k]);
+            }
+        }
+        for (int k = 0; k < 3; ++k)
+            sphere[k] = 0.5f * (low[k] + high[k]);
+        float radius2 = 0.0f;
+        for (size_t v = 0; v < mesh.vertices.size(); ++v)
+        {
+            const float* p = mesh.vertices[v].position;
+            float d2 = (p[0] - sphere[0]) * (p[0] - sphere[0]) + (p[1] - sphere[1]) * (p[1] - sphere[1]) +
+                       (p[2] - sphere[2]) * (p[2] - sphere[2]);
+            radius2 = std::max(radius2, d2);
+        }
+        sphere[3] = std::sqrt(radius2);
+    }
+    // the same test as cull.comp: world center, radius scaled by the largest axis scale
+    static bool sphereVisible(const Frustum& frustum, const glm::mat4& m, const float sphere[4])
+    {
+        glm::vec4 center = m * glm::vec4(sphere[0], sphere[1], sphere[2], 1.0f);
+        float scale2 = 0.0f;
+        for (int c = 0; c < 3; ++c)
+            scale2 = std::max(scale2, m[c].x * m[c].x + m[c].y * m[c].y + m[c].z * m[c].z);
+        float radius = sphere[3] * std::sqrt(scale2);
+        for (int p = 0; p < 6; ++p)
+        {
+            const float* plane = frustum.planes[p];
+            if (plane[0] * center.x + plane[1] * center.y + plane[2] * center.z + plane[3] < -radius)
+                return false;
+        }
+        return true;
+    }
+
+    IndirectRenderer(const IndirectRenderer&);
+    IndirectRenderer& operator=(const IndirectRenderer&);
+};
+#endif
@@ -0,0 +1,160 @@
+#ifndef INSTANCED_RENDERER_H
+#define INSTANCED_RENDERER_H
+
+#include <glad/glad.h>
+
+#include <glm/glm.hpp>
+
+#include <gl_state.h>
+#include <texture_array_packer.h>
+
+// draws many copies of one indexed mesh with a single glDrawElementsInstanced.
+// the per-instance glm::mat4 lives in its own VBO that is attached to the mesh's
+// existing VAO as four vec4 attributes (a mat4 attribute takes 4 locations) with
+// divisor 1, so the vertex shader reads it as `layout (location = 2) in mat4 aTransform`.
+// optionally a second instance VBO carries a SpriteRegion (uv rect + array layer)
+// per instance at locations 6 and 7, for sprites sampling a TextureArrayPacker texture.
+class InstancedRenderer
+{
+public:
+    // first of the four locations used by the instance matrix
+    static const unsigned int TRANSFORM_LOCATION = 2;
+    // vec4 uv rect, then float layer
+    static const unsigned int SPRITE_LOCATION = 6;
+
+    unsigned int instanceVBO;
+    unsigned int spriteVBO;
+
+    // vao must already hold the mesh's vertex attributes and its EBO.
+    // leaves the instance VBO bound to GL_ARRAY_BUFFER and the VAO bound.
+    // ------------------------------------------------------------------------
+    InstancedRenderer(unsigned int vao, unsigned int indexCount, GLenum indexType = GL_UNSIGNED_INT)
+        : instanceVBO(0), spriteVBO(0), VAO(vao), indexCount(indexCount), indexType(indexType), instanceCount(0), capacity(0)
+    {
+        glGenBuffers(1, &instanceVBO);
+        glBindVertexArray(VAO);
+        glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+        for (unsigned int i = 0; i < 4; ++i)
+        {
+            glEnableVertexAttribArray(TRANSFORM_LOCATION + i);
+            glVertexAttribPointer(TRANSFORM_LOCATION + i, 4, GL_FLOAT, GL_FALSE, sizeof(glm::mat4), (void*)(i * sizeof(glm::vec4)));
+            /// 属性除数为1：每绘制一个实例才前进一个mat4，而不是每个顶点
+            glVertexAttribDivisor(TRANSFORM_LOCATION + i, 1);
+        }
+    }
+    // de-allocate the instance VBO, must run while the context is still alive
+    // ------------------------------------------------------------------------
+    void release()
+    {
+        glDeleteBuffers(1, &instanceVBO);
+        if (spriteVBO)
+            glDeleteBuffers(1, &spriteVBO);
+        instanceVBO = 0;
+        spriteVBO = 0;
+        instanceCount = 0;
+        capacity = 0;
+    }
+
+    // replace all instance transforms. the buffer grows geometrically and is
+    // orphaned before every upload so we never wait for last frame's draw.
+    // ------------------------------------------------------------------------
+    void setInstances(const glm::mat4* transforms, unsigned int count)
+    {
+        glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+        reserve(count);
+        glBufferData(GL_ARRAY_BUFFER, capacity * sizeof(glm::mat4), NULL, GL_STREAM_DRAW);
+        glBufferSubData(GL_ARRAY_BUFFER, 0, count * sizeof(glm::mat4), transforms);
+        instanceCount = count;
+    }
+    // overwrite instances [first, first + count) in place, the instance count is unchanged
+    // ------------------------------------------------------------------------
+    void updateInstances(unsigned int first, const glm::mat4* transforms, unsigned int count)
+    {
+        glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+        glBufferSubData(GL_ARRAY_BUFFER, first * sizeof(glm::mat4), count * sizeof(glm::mat4), transforms);
+    }
+    // map storage for count transforms (16 column-major floats each) so they can be
+    // written in place; call unmapInstances() before drawing
+    // ------------------------------------------------------------------------
+    float* mapInstances(unsigned int count)
+    {
+        glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+        if (count > capacity)
+        {
+            reserve(count);
+            glBufferData(GL_ARRAY_BUFFER, capacity * sizeof(glm::mat4), NULL, GL_STREAM_DRAW);
+        }
+        instanceCount = count;
+        if (count == 0)
+            return NULL;
+        return (float*)glMapBufferRange(GL_ARRAY_BUFFER, 0, count * sizeof(glm::mat4),
+                                        GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+    }
+    void unmapInstances()
+    {
+        glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+        glUnmapBuffer(GL_ARRAY_BUFFER);
+    }
+
+    // per-instance sprite regions: attach the second instance VBO on first use, then
+    // upload count regions (normally the same count as the transforms)
+    // ------------------------------------------------------------------------
+    void setSprites(const SpriteRegion* sprites, unsigned int count)
+    {
+        if (!spriteVBO)
+        {
+            glGenBuffers(1, &spriteVBO);
+            glBindVertexArray(VAO);
+            glBindBuffer(GL_ARRAY_BUFFER, spriteVBO);
+            glEnableVertexAttribArray(SPRITE_LOCATION);
+            glVertexAttribPointer(SPRITE_LOCATION, 4, GL_FLOAT, GL_FALSE, sizeof(SpriteRegion), (void*)0);
+            glVertexAttribDivisor(SPRITE_LOCATION, 1);
+            glEnableVertexAttribArray(SPRITE_LOCATION + 1);
+            glVertexAttribPointer(SPRITE_LOCATION + 1, 1, GL_FLOAT, GL_FALSE, sizeof(SpriteRegion), (void*)(4 * sizeof(float)));
+            glVertexAttribDivisor(SPRITE_LOCATION + 1, 1);
+        }
+        glBindBuffer(GL_ARRAY_BUFFER, spriteVBO);
+        glBufferData(GL_ARRAY_BUFFER, count * sizeof(SpriteRegion), sprites, GL_STATIC_DRAW);
+    }
+
+    // the shader program must be in use and textures bound
+    // ------------------------------------------------------------------------
+    void draw() const
+    {
+        if (instanceCount == 0)
+            return;
+        glBindVertexArray(VAO);
+        glDrawElementsInstanced(GL_TRIANGLES, indexCount, indexType, 0, instanceCount);
+    }
+    void draw(GLStateCache& state) const
+    {
+        if (instanceCount == 0)
+            return;
+        state.bindVertexArray(VAO);
+        glDrawElementsInstanced(GL_TRIANGLES, indexCount, indexType, 0, instanceCount);
+    }
+
+    unsigned int count() const { return instanceCount; }
+    unsigned int vertexArray() const { return VAO; }
+
+private:
+    unsigned int VAO;
+    unsigned int indexCount;
+    GLenum indexType;
+    unsigned int instanceCount;
+    unsigned int capacity;
+
+    void reserve(unsigned int count)
+    {
+        if (count <= capacity)
+            return;
+        unsigned int grown = capacity < 64 ? 64 : capacity;
+        while (grown < count)
+            grown *= 2;
+        capacity = grown;
+    }
+
+    InstancedRenderer(const InstancedRenderer&);
+    InstancedRenderer& operator=(const InstancedRenderer&);
+};
+#endif
@@ -0,0 +1,141 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <cstddef>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+// read-only memory mapping of a whole file. pages are faulted in by the OS on first
+// touch, so opening is cheap and nothing is copied into our own buffers.
+class MappedFile
+{
+public:
+    MappedFile()
+        : ptr(NULL), length(0)
+#ifdef _WIN32
+        , file(INVALID_HANDLE_VALUE), mapping(NULL)
+#endif
+    {}
+    ~MappedFile()
+    {
+        close();
+    }
+
+    // ------------------------------------------------------------------------
+    bool open(const char* path)
+    {
+        close();
+#ifdef _WIN32
+        file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+        if (file == INVALID_HANDLE_VALUE)
+            return false;
+        LARGE_INTEGER fileSize;
+        if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0)
+        {
+            close();
+            return false;
+        }
+        mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+        if (!mapping)
+        {
+            close();
+            return false;
+        }
+        ptr = (const unsigned char*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        if (!ptr)
+        {
+            close();
+            return false;
+        }
+        length = (size_t)fileSize.QuadPart;
+#else
+        int fd = ::open(path, O_RDONLY);
+        if (fd < 0)
+            return false;
+        struct stat info;
+        if (fstat(fd, &info) != 0 || info.st_size == 0)
+        {
+            ::close(fd);
+            return false;
+        }
+        void* address = mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        // the mapping keeps the file alive, the descriptor is not needed anymore
+        ::close(fd);
+        if (address == MAP_FAILED)
+            return false;
+        ptr = (const unsigned char*)address;
+        length = (size_t)info.st_size;
+#endif
+        return true;
+    }
+    // ------------------------------------------------------------------------
+    void close()
+    {
+#ifdef _WIN32
+        if (ptr)
+            UnmapViewOfFile(ptr);
+        if (mapping)
+            CloseHandle(mapping);
+        if (file != INVALID_HANDLE_VALUE)
+            CloseHandle(file);
+        mapping = NULL;
+        file = INVALID_HANDLE_VALUE;
+#else
+        if (ptr)
+            munmap((void*)ptr, length);
+#endif
+        ptr = NULL;
+        length = 0;
+    }
+
+    // ------------------------------------------------------------------------
+    // ask the OS to start reading [offset, offset + size) in the background, so the
+    // first touch of those pages does not block on the disk. only a hint: returns at
+    // once, and does nothing where it is not supported
+    void prefetch(size_t offset, size_t size) const
+    {
+        if (!ptr || offset >= length)
+            return;
+        if (size > length - offset)
+            size = length - offset;
+#ifdef _WIN32
+#if defined(_WIN32_WINNT) && _WIN32_WINNT >= 0x0602
+        WIN32_MEMORY_RANGE_ENTRY range;
+        range.VirtualAddress = (PVOID)(ptr + offset);
+        range.NumberOfBytes = size;
+        PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+#endif
+#else
+        // madvise wants a page aligned start
+        size_t page = (size_t)sysconf(_SC_PAGESIZE);
+        size_t start = offset & ~(page - 1);
+        madvise((void*)(ptr + start), size + (offset - start), MADV_WILLNEED);
+#endif
+    }
+
+    bool isOpen() const { return ptr != NULL; }
+    const unsigned char* data() const { return ptr; }
+    size_t size() const { return length; }
+
+private:
+    const unsigned char* ptr;
+    size_t length;
+#ifdef _WIN32
+    HANDLE file;
+    HANDLE mapping;
+#endif
+
+    MappedFile(const MappedFile&);
+    MappedFile& operator=(const MappedFile&);
+};
+#endif
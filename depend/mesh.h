@@ -0,0 +1,120 @@
+#ifndef MESH_H
+#define MESH_H
+
+#include <glad/glad.h>
+
+#include <gl_state.h>
+#include <mesh_data.h>
+#include <vertex_layout.h>
+
+#include <vector>
+#include <cstring>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+
+// a MeshData uploaded to a VAO with its own VBO/EBO, in the vertex layout given to
+// upload(): VertexLayout::floats() is MeshVertex as is, VertexLayout::compact() halves it
+class Mesh
+{
+public:
+    static const unsigned int POSITION_LOCATION = MESH_POSITION_LOCATION;
+    static const unsigned int TEXCOORD_LOCATION = MESH_TEXCOORD_LOCATION;
+    static const unsigned int NORMAL_LOCATION = MESH_NORMAL_LOCATION;
+
+    // bytes in the buffers against all floats and 32-bit indices
+    struct MemoryStats
+    {
+        size_t vertexBytes, floatVertexBytes;
+        size_t indexBytes, fullIndexBytes;
+    };
+
+    unsigned int VAO, VBO, EBO;
+
+    Mesh() : VAO(0), VBO(0), EBO(0), indexCount(0), indexType(GL_UNSIGNED_INT)
+    {
+        std::memset(&memory, 0, sizeof(memory));
+        texCoordScaleOffset[0] = texCoordScaleOffset[1] = 1.0f;
+        texCoordScaleOffset[2] = texCoordScaleOffset[3] = 0.0f;
+    }
+
+    // GL_UNSIGNED_SHORT indices when they fit, halving the index buffer and the
+    // index fetch bandwidth. leaves the VAO bound
+    // ------------------------------------------------------------------------
+    void upload(const MeshData& mesh, const VertexLayout& layout = VertexLayout::floats())
+    {
+        if (!VAO)
+        {
+            glGenVertexArrays(1, &VAO);
+            glGenBuffers(1, &VBO);
+            glGenBuffers(1, &EBO);
+        }
+        std::vector<unsigned char> vertices;
+        layout.pack(mesh, vertices, texCoordScaleOffset);
+        glBindVertexArray(VAO);
+        glBindBuffer(GL_ARRAY_BUFFER, VBO);
+        glBufferData(GL_ARRAY_BUFFER, vertices.size(), vertices.empty() ? NULL : &vertices[0], GL_STATIC_DRAW);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+        indexCount = (unsigned int)mesh.indices.size();
+        if (mesh.fitsUnsignedShort())
+        {
+            std::vector<uint16_t> shortIndices(mesh.indices.begin(), mesh.indices.end());
+            indexType = GL_UNSIGNED_SHORT;
+            glBufferData(GL_ELEMENT_ARRAY_BUFFER, shortIndices.size() * sizeof(uint16_t),
+                         shortIndices.empty() ? NULL : &shortIndices[0], GL_STATIC_DRAW);
+        }
+        else
+        {
+            indexType = GL_UNSIGNED_INT;
+            glBufferData(GL_ELEMENT_ARRAY_BUFFER, mesh.indices.size() * sizeof(uint32_t),
+                         mesh.indices.empty() ? NULL : &mesh.indices[0], GL_STATIC_DRAW);
+        }
+        /// 按布局描述符设置顶点属性指针
+        layout.apply();
+
+        memory.vertexBytes = vertices.size();
+        memory.floatVertexBytes = mesh.vertices.size() * sizeof(MeshVertex);
+        memory.indexBytes = indexCount * (indexType == GL_UNSIGNED_SHORT ? sizeof(uint16_t) : sizeof(uint32_t));
+        memory.fullIndexBytes = indexCount * sizeof(uint32_t);
+    }
+    // ------------------------------------------------------------------------
+    void draw(GLStateCache& state) const
+    {
+        state.bindVertexArray(VAO);
+        glDrawElements(GL_TRIANGLES, (GLsizei)indexCount, indexType, 0);
+    }
+    // must run while the context is still alive
+    // ------------------------------------------------------------------------
+    void release()
+    {
+        if (VAO)
+        {
+            glDeleteVertexArrays(1, &VAO);
+            glDeleteBuffers(1, &VBO);
+            glDeleteBuffers(1, &EBO);
+        }
+        VAO = VBO = EBO = 0;
+        indexCount = 0;
+    }
+
+    unsigned int count() const { return indexCount; }
+    GLenum type() const { return indexType; }
+    // vec4 for the vertex shader: TexCoord = aTexCoord * t.xy + t.zw
+    const float* texCoordTransform() const { return texCoordScaleOffset; }
+    const MemoryStats& memoryStats() const { return memory; }
+    void printMemory(std::ostream& out, const char* name) const
+    {
+        size_t full = memory.floatVertexBytes + memory.fullIndexBytes;
+        size_t used = memory.vertexBytes + memory.indexBytes;
+        out << name << ": vertices " << memory.floatVertexBytes << " -> " << memory.vertexBytes << " bytes, indices "
+            << memory.fullIndexBytes << " -> " << memory.indexBytes << " bytes, saved " << (full - used) << " bytes ("
+            << (full ? 100 * (full - used) / full : 0) << "%)" << std::endl;
+    }
+
+private:
+    unsigned int indexCount;
+    GLenum indexType;
+    float texCoordScaleOffset[4];
+    MemoryStats memory;
+};
+#endif
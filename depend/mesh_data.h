@@ -0,0 +1,38 @@
+#ifndef MESH_DATA_H
+#define MESH_DATA_H
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+// one corner of a triangle as loaded: no quantization, the layout the loaders and the
+// optimizer work on. position at location 0 and texcoord at location 1 like the
+// hand-written quads of the samples; the normal goes to location 8, above the
+// per-instance attributes of InstancedRenderer (2..7).
+struct MeshVertex
+{
+    float position[3];
+    float texCoord[2];
+    float normal[3];
+};
+
+// indexed triangle list on the CPU
+struct MeshData
+{
+    std::vector<MeshVertex> vertices;
+    std::vector<uint32_t> indices;
+
+    void clear()
+    {
+        vertices.clear();
+        indices.clear();
+    }
+    // 16-bit indices whenever every vertex can be addressed with them
+    bool fitsUnsignedShort() const { return vertices.size() <= 65536; }
+};
+
+const unsigned int MESH_POSITION_LOCATION = 0;
+const unsigned int MESH_TEXCOORD_LOCATION = 1;
+const unsigned int MESH_NORMAL_LOCATION = 8;
+
+#endif
@@ -0,0 +1,778 @@
+#include "mesh_loader.h"
+
+#include <mapped_file.h>
+
+#include <string>
+#include <vector>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cctype>
+#include <cmath>
+#include <algorithm>
+
+#ifdef _WIN32
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#endif
+
+namespace
+{
+// ------------------------------------------------------------------------
+// OBJ
+// ------------------------------------------------------------------------
+const char* skipSpaces(const char* p)
+{
+    while (*p == ' ' || *p == '\t')
+        ++p;
+    return p;
+}
+const char* nextLine(const char* p)
+{
+    while (*p && *p != '\n')
+        ++p;
+    return *p ? p + 1 : p;
+}
+// "v", "v/vt", "v//vn" or "v/vt/vn"; 0 for a missing part, negative indices are relative
+const char* parseCorner(const char* p, long corner[3])
+{
+    corner[0] = corner[1] = corner[2] = 0;
+    char* end;
+    corner[0] = std::strtol(p, &end, 10);
+    p = end;
+    if (*p == '/')
+    {
+        ++p;
+        if (*p != '/')
+        {
+            corner[1] = std::strtol(p, &end, 10);
+            p = end;
+        }
+        if (*p == '/')
+        {
+            corner[2] = std::strtol(p + 1, &end, 10);
+            p = end;
+        }
+    }
+    return p;
+}
+// 1-based or negative OBJ index into count elements, -1 if out of range
+long resolve(long index, size_t count)
+{
+    long resolved = index > 0 ? index - 1 : (long)count + index;
+    return index != 0 && resolved >= 0 && (size_t)resolved < count ? resolved : -1;
+}
+
+bool parseObj(const char* text, MeshData& mesh)
+{
+    std::vector<float> positions, texCoords, normals;
+    std::vector<MeshVertex> polygon;
+    for (const char* p = text; *p; p = nextLine(p))
+    {
+        p = skipSpaces(p);
+        char* end;
+        if (p[0] == 'v' && (p[1] == ' ' || p[1] == '\t'))
+        {
+            for (int k = 0; k < 3; ++k)
+            {
+                positions.push_back(std::strtof(p + 1, &end));
+                p = end - 1;
+            }
+        }
+        else if (p[0] == 'v' && p[1] == 't')
+        {
+            ++p;
+            for (int k = 0; k < 2; ++k)
+            {
+                texCoords.push_back(std::strtof(p + 1, &end));
+                p = end - 1;
+            }
+        }
+        else if (p[0] == 'v' && p[1] == 'n')
+        {
+            ++p;
+            for (int k = 0; k < 3; ++k)
+            {
+                normals.push_back(std::strtof(p + 1, &end));
+                p = end - 1;
+            }
+        }
+        else if (p[0] == 'f' && (p[1] == ' ' || p[1] == '\t'))
+        {
+            polygon.clear();
+            bool hasNormals = true;
+            p = skipSpaces(p + 1);
+            while (*p && *p != '\n' && *p != '\r' && *p != '#')
+            {
+                long corner[3];
+                p = skipSpaces(parseCorner(p, corner));
+                long v = resolve(corner[0], positions.size() / 3);
+                long t = resolve(corner[1], texCoords.size() / 2);
+                long n = resolve(corner[2], normals.size() / 3);
+                if (v < 0)
+                {
+                    std::cout << "ERROR::MESH::OBJ_BAD_INDEX" << std::endl;
+                    return false;
+                }
+                MeshVertex vertex;
+                std::memset(&vertex, 0, sizeof(vertex));
+                std::memcpy(vertex.position, &positions[v * 3], 3 * sizeof(float));
+                if (t >= 0)
+                    std::memcpy(vertex.texCoord, &texCoords[t * 2], 2 * sizeof(float));
+                if (n >= 0)
+                    std::memcpy(vertex.normal, &normals[n * 3], 3 * sizeof(float));
+                else
+                    hasNormals = false;
+                polygon.push_back(vertex);
+            }
+            if (polygon.size() < 3)
+                continue;
+            // corners without vn get the face normal, flat shaded
+            if (!hasNormals)
+            {
+                const float* a = polygon[0].position;
+                const float* b = polygon[1].position;
+                const float* c = polygon[2].position;
+                float n[3] = { (b[1] - a[1]) * (c[2] - a[2]) - (b[2] - a[2]) * (c[1] - a[1]),
+                               (b[2] - a[2]) * (c[0] - a[0]) - (b[0] - a[0]) * (c[2] - a[2]),
+                               (b[0] - a[0]) * (c[1] - a[1]) - (b[1] - a[1]) * (c[0] - a[0]) };
+                float length = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+                for (size_t i = 0; i < polygon.size(); ++i)
+                    for (int k = 0; k < 3; ++k)
+                        polygon[i].normal[k] = length > 0.0f ? n[k] / length : 0.0f;
+            }
+            // fan triangulation
+            uint32_t base = (uint32_t)mesh.vertices.size();
+            mesh.vertices.insert(mesh.vertices.end(), polygon.begin(), polygon.end());
+            for (uint32_t i = 1; i + 1 < polygon.size(); ++i)
+            {
+                mesh.indices.push_back(base);
+                mesh.indices.push_back(base + i);
+                mesh.indices.push_back(base + i + 1);
+            }
+        }
+    }
+    return !mesh.indices.empty();
+}
+
+// ------------------------------------------------------------------------
+// just enough JSON for the glTF scene description
+// ------------------------------------------------------------------------
+struct JsonValue
+{
+    enum Type { NUL, BOOLEAN, NUMBER, STRING, ARRAY, OBJECT };
+    Type type;
+    double number;
+    std::string string;
+    // array elements, or object values with their keys
+    std::vector<JsonValue> items;
+    std::vector<std::string> keys;
+
+    JsonValue() : type(NUL), number(0.0) {}
+
+    const JsonValue* get(const char* key) const
+    {
+        for (size_t i = 0; i < keys.size(); ++i)
+        {
+            if (keys[i] == key)
+                return &items[i];
+        }
+        return NULL;
+    }
+    const JsonValue* at(size_t index) const
+    {
+        return type == ARRAY && index < items.size() ? &items[index] : NULL;
+    }
+    double numberOr(const char* key, double fallback) const
+    {
+        const JsonValue* v = get(key);
+        return v && v->type == NUMBER ? v->number : fallback;
+    }
+};
+
+class JsonParser
+{
+public:
+    JsonParser(const char* begin, const char* end) : p(begin), end(end) {}
+
+    bool parse(JsonValue& out)
+    {
+        return value(out, 0);
+    }
+
+private:
+    const char* p;
+    const char* end;
+    static const int MAX_DEPTH = 64;
+
+    void skip()
+    {
+        while (p < end && (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r'))
+            ++p;
+    }
+    bool literal(const char* word)
+    {
+        size_t length = std::strlen(word);
+        if ((size_t)(end - p) < length || std::memcmp(p, word, length) != 0)
+            return false;
+        p += length;
+        return true;
+    }
+    bool string(std::string& out)
+    {
+        if (p >= end || *p != '"')
+            return false;
+        ++p;
+        out.clear();
+        while (p < end && *p != '"')
+        {
+            char c = *p++;
+            if (c == '\\' && p < end)
+            {
+                char e = *p++;
+                switch (e)
+                {
+                    case 'n': c = '\n'; break;
+                    case 't': c = '\t'; break;
+                    case 'r': c = '\r'; break;
+                    case 'b': c = '\b'; break;
+                    case 'f': c = '\f'; break;
+                    // names we look up are ASCII, other code points only need to be skipped
+                    case 'u': p += std::min<ptrdiff_t>(4, end - p); c = '?'; break;
+                    default: c = e; break;
+                }
+            }
+            out.push_back(c);
+        }
+        if (p >= end)
+            return false;
+        ++p;
+        return true;
+    }
+    bool value(JsonValue& out, int depth)
+    {
+        if (depth > MAX_DEPTH)
+            return false;
+        skip();
+        if (p >= end)
+            return false;
+        if (*p == '{')
+        {
+            out.type = JsonValue::OBJECT;
+            ++p;
+            skip();
+            if (p < end && *p == '}')
+            {
+                ++p;
+                return true;
+            }
+            for (;;)
+            {
+                skip();
+                out.keys.push_back(std::string());
+                if (!string(out.keys.back()))
+                    return false;
+                skip();
+                if (p >= end || *p++ != ':')
+                    return false;
+                out.items.push_back(JsonValue());
+                if (!value(out.items.back(), depth + 1))
+                    return false;
+                skip();
+                if (p < end && *p == ',')
+                {
+                    ++p;
+                    continue;
+                }
+                if (p < end && *p == '}')
+                {
+                    ++p;
+                    return true;
+                }
+                return false;
+            }
+        }
+        if (*p == '[')
+        {
+            out.type = JsonValue::ARRAY;
+            ++p;
+            skip();
+            if (p < end && *p == ']')
+            {
+                ++p;
+                return true;
+            }
+            for (;;)
+            {
+                out.items.push_back(JsonValue());
+                if (!value(out.items.back(), depth + 1))
+                    return false;
+                skip();
+                if (p < end && *p == ',')
+                {
+                    ++p;
+                    continue;
+                }
+                if (p < end && *p == ']')
+                {
+                    ++p;
+                    return true;
+                }
+                return false;
+            }
+        }
+        if (*p == '"')
+        {
+            out.type = JsonValue::STRING;
+            return string(out.string);
+        }
+        if (literal("true") || literal("false"))
+        {
+            out.type = JsonValue::BOOLEAN;
+            out.number = p[-4] == 't' ? 1.0 : 0.0;
+            return true;
+        }
+        if (literal("null"))
+        {
+            out.type = JsonValue::NUL;
+            return true;
+        }
+        // numbers: copy out, the chunk is not zero terminated
+        char buffer[64];
+        size_t length = 0;
+        while (p < end && length + 1 < sizeof(buffer) && (std::isdigit((unsigned char)*p) || *p == '-' || *p == '+' ||
+                                                          *p == '.' || *p == 'e' || *p == 'E'))
+            buffer[length++] = *p++;
+        if (length == 0)
+            return false;
+        buffer[length] = '\0';
+        out.type = JsonValue::NUMBER;
+        out.number = std::strtod(buffer, NULL);
+        return true;
+    }
+};
+
+// ------------------------------------------------------------------------
+// GLB
+// ------------------------------------------------------------------------
+const uint32_t GLB_MAGIC = 0x46546C67;      // "glTF"
+const uint32_t GLB_CHUNK_JSON = 0x4E4F534A;
+const uint32_t GLB_CHUNK_BIN = 0x004E4942;
+const int GL_TF_BYTE = 5120, GL_TF_UNSIGNED_BYTE = 5121, GL_TF_SHORT = 5122, GL_TF_UNSIGNED_SHORT = 5123,
+          GL_TF_UNSIGNED_INT = 5125, GL_TF_FLOAT = 5126;
+
+struct Accessor
+{
+    const unsigned char* data;
+    size_t count;
+    size_t stride;
+    int componentType;
+    int components;
+    bool normalized;
+};
+
+int componentSize(int type)
+{
+    switch (type)
+    {
+        case GL_TF_BYTE: case GL_TF_UNSIGNED_BYTE: return 1;
+        case GL_TF_SHORT: case GL_TF_UNSIGNED_SHORT: return 2;
+        case GL_TF_UNSIGNED_INT: case GL_TF_FLOAT: return 4;
+        default: return 0;
+    }
+}
+int componentCount(const std::string& type)
+{
+    if (type == "SCALAR") return 1;
+    if (type == "VEC2") return 2;
+    if (type == "VEC3") return 3;
+    if (type == "VEC4") return 4;
+    return 0;
+}
+
+// a JSON number used as a count, offset or index: a non-negative integer that fits
+bool toSize(double value, size_t& out)
+{
+    if (!(value >= 0.0 && value < (double)SIZE_MAX) || std::floor(value) != value)
+        return false;
+    out = (size_t)value;
+    return true;
+}
+
+// resolve accessor index into a strided view of the BIN chunk, checking every bound
+bool accessor(const JsonValue& doc, const unsigned char* bin, size_t binSize, double index, Accessor& out)
+{
+    const JsonValue* accessors = doc.get("accessors");
+    const JsonValue* views = doc.get("bufferViews");
+    size_t accessorIndex, viewIndex;
+    if (!accessors || !views || !toSize(index, accessorIndex))
+        return false;
+    const JsonValue* a = accessors->at(accessorIndex);
+    if (!a || a->get("sparse") || !toSize(a->numberOr("bufferView", -1), viewIndex))
+        return false;
+    const JsonValue* view = views->at(viewIndex);
+    const JsonValue* type = a->get("type");
+    if (!view || !type || view->numberOr("buffer", 0) != 0)
+        return false;
+    size_t componentType;
+    if (!toSize(a->numberOr("componentType", 0), componentType) || componentType > (size_t)GL_TF_FLOAT)
+        return false;
+    out.componentType = (int)componentType;
+    out.components = componentCount(type->string);
+    const JsonValue* normalized = a->get("normalized");
+    out.normalized = normalized && normalized->number != 0.0;
+    size_t elementSize = (size_t)componentSize(out.componentType) * out.components;
+    size_t viewOffset, viewLength, offset;
+    if (!toSize(a->numberOr("count", 0), out.count) ||
+        !toSize(view->numberOr("byteStride", (double)elementSize), out.stride) ||
+        !toSize(view->numberOr("byteOffset", 0), viewOffset) || !toSize(view->numberOr("byteLength", 0), viewLength) ||
+        !toSize(a->numberOr("byteOffset", 0), offset))
+        return false;
+    if (elementSize == 0 || out.count == 0 || viewOffset > binSize || viewLength > binSize - viewOffset)
+        return false;
+    // offset + (count - 1) * stride + elementSize <= viewLength, without overflowing
+    if (offset > viewLength || elementSize > viewLength - offset)
+        return false;
+    size_t room = viewLength - offset - elementSize;
+    if (out.count > 1 && out.stride > 0 && out.count - 1 > room / out.stride)
+        return false;
+    out.data = bin + viewOffset + offset;
+    return true;
+}
+// component i of element e as float, normalized integers mapped to [0, 1]
+float component(const Accessor& a, size_t e, int i)
+{
+    const unsigned char* p = a.data + e * a.stride;
+    switch (a.componentType)
+    {
+        case GL_TF_FLOAT: { float f; std::memcpy(&f, p + i * 4, 4); return f; }
+        case GL_TF_UNSIGNED_BYTE: return a.normalized ? p[i] / 255.0f : (float)p[i];
+        case GL_TF_UNSIGNED_SHORT: { uint16_t s; std::memcpy(&s, p + i * 2, 2); return a.normalized ? s / 65535.0f : (float)s; }
+        default: return 0.0f;
+    }
+}
+uint32_t indexAt(const Accessor& a, size_t e)
+{
+    const unsigned char* p = a.data + e * a.stride;
+    switch (a.componentType)
+    {
+        case GL_TF_UNSIGNED_BYTE: return p[0];
+        case GL_TF_UNSIGNED_SHORT: { uint16_t s; std::memcpy(&s, p, 2); return s; }
+        // GL_TF_UNSIGNED_INT, the only other type the indices accessor accepts
+        default: { uint32_t i; std::memcpy(&i, p, 4); return i; }
+    }
+}
+
+bool parseGlb(const unsigned char* data, size_t size, MeshData& mesh)
+{
+    uint32_t header[3];
+    if (size < 20)
+        return false;
+    std::memcpy(header, data, sizeof(header));
+    if (header[0] != GLB_MAGIC || header[1] != 2 || header[2] > size)
+        return false;
+    const char* json = NULL;
+    size_t jsonSize = 0;
+    const unsigned char* bin = NULL;
+    size_t binSize = 0;
+    for (size_t offset = 12; offset + 8 <= header[2];)
+    {
+        uint32_t chunk[2];
+        std::memcpy(chunk, data + offset, sizeof(chunk));
+        offset += 8;
+        if (chunk[0] > header[2] - offset)
+            return false;
+        if (chunk[1] == GLB_CHUNK_JSON && !json)
+        {
+            json = (const char*)data + offset;
+            jsonSize = chunk[0];
+        }
+        else if (chunk[1] == GLB_CHUNK_BIN && !bin)
+        {
+            bin = data + offset;
+            binSize = chunk[0];
+        }
+        // chunks are 4-byte aligned
+        offset += (chunk[0] + 3) & ~3u;
+    }
+    JsonValue doc;
+    if (!json || !JsonParser(json, json + jsonSize).parse(doc))
+    {
+        std::cout << "ERROR::MESH::GLB_BAD_JSON" << std::endl;
+        return false;
+    }
+    const JsonValue* meshes = doc.get("meshes");
+    const JsonValue* first = meshes ? meshes->at(0) : NULL;
+    const JsonValue* primitives = first ? first->get("primitives") : NULL;
+    if (!primitives || primitives->type != JsonValue::ARRAY)
+        return false;
+
+    for (size_t i = 0; i < primitives->items.size(); ++i)
+    {
+        const JsonValue& primitive = primitives->items[i];
+        const JsonValue* attributes = primitive.get("attributes");
+        // triangles only
+        if (!attributes || primitive.numberOr("mode", 4) != 4)
+            continue;
+        Accessor position, texCoord, normal, indices;
+        const JsonValue* positionIndex = attributes->get("POSITION");
+        if (!positionIndex || !accessor(doc, bin, binSize, positionIndex->number, position) ||
+            position.componentType != GL_TF_FLOAT || position.components != 3)
+            continue;
+        const JsonValue* texCoordIndex = attributes->get("TEXCOORD_0");
+        bool hasTexCoord = texCoordIndex && accessor(doc, bin, binSize, texCoordIndex->number, texCoord) &&
+                           texCoord.components == 2 && texCoord.count == position.count;
+        const JsonValue* normalIndex = attributes->get("NORMAL");
+        bool hasNormal = normalIndex && accessor(doc, bin, binSize, normalIndex->number, normal) &&
+                         normal.componentType == GL_TF_FLOAT && normal.count == position.count;
+
+        uint32_t base = (uint32_t)mesh.vertices.size();
+        for (size_t v = 0; v < position.count; ++v)
+        {
+            MeshVertex vertex;
+            std::memset(&vertex, 0, sizeof(vertex));
+            for (int k = 0; k < 3; ++k)
+                vertex.position[k] = component(position, v, k);
+            if (hasTexCoord)
+            {
+                vertex.texCoord[0] = component(texCoord, v, 0);
+                // glTF puts the origin at the top left
+                vertex.texCoord[1] = 1.0f - component(texCoord, v, 1);
+            }
+            if (hasNormal)
+                for (int k = 0; k < 3; ++k)
+                    vertex.normal[k] = component(normal, v, k);
+            mesh.vertices.push_back(vertex);
+        }
+        const JsonValue* indicesIndex = primitive.get("indices");
+        if (indicesIndex)
+        {
+            if (!accessor(doc, bin, binSize, indicesIndex->number, indices) || indices.components != 1 ||
+                (indices.componentType != GL_TF_UNSIGNED_BYTE && indices.componentType != GL_TF_UNSIGNED_SHORT &&
+                 indices.componentType != GL_TF_UNSIGNED_INT))
+                return false;
+            for (size_t e = 0; e < indices.count; ++e)
+            {
+                uint32_t index = indexAt(indices, e);
+                if (index >= position.count)
+                    return false;
+                mesh.indices.push_back(base + index);
+            }
+        }
+        else
+        {
+            for (uint32_t v = 0; v < position.count; ++v)
+                mesh.indices.push_back(base + v);
+        }
+    }
+    return !mesh.indices.empty();
+}
+
+// ------------------------------------------------------------------------
+// cache
+// ------------------------------------------------------------------------
+uint64_t fnv1a(uint64_t hash, const void* data, size_t size)
+{
+    const unsigned char* bytes = (const unsigned char*)data;
+    for (size_t i = 0; i < size; ++i)
+    {
+        hash ^= bytes[i];
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+std::string cachePath(const char* directory, uint64_t key)
+{
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.orimesh", (unsigned long long)key);
+    return std::string(directory) + "/" + name;
+}
+
+bool loadCached(const std::string& path, uint64_t key, MeshData& mesh)
+{
+    MappedFile file;
+    if (!file.open(path.c_str()) || file.size() < sizeof(MeshCacheHeader))
+        return false;
+    MeshCacheHeader header;
+    std::memcpy(&header, file.data(), sizeof(header));
+    return header.key == key && parseCookedMesh(file.data(), file.size(), mesh);
+}
+
+void storeCached(const char* directory, const std::string& path, uint64_t key, const MeshData& mesh)
+{
+#ifdef _WIN32
+    _mkdir(directory);
+#else
+    mkdir(directory, 0755);
+#endif
+    // write to a temporary name first so a crash never leaves a torn entry
+    std::string temporary = path + ".tmp";
+    {
+        std::ofstream file(temporary.c_str(), std::ios::binary | std::ios::trunc);
+        if (!writeCookedMesh(file, mesh, key))
+            return;
+    }
+    std::remove(path.c_str());
+    std::rename(temporary.c_str(), path.c_str());
+}
+
+bool hasExtension(const char* path, const char* extension)
+{
+    size_t length = std::strlen(path), extensionLength = std::strlen(extension);
+    if (length < extensionLength)
+        return false;
+    for (size_t i = 0; i < extensionLength; ++i)
+    {
+        if (std::tolower((unsigned char)path[length - extensionLength + i]) != extension[i])
+            return false;
+    }
+    return true;
+}
+
+bool parse(const char* path, const unsigned char* data, size_t size, MeshData& mesh)
+{
+    mesh.clear();
+    if (hasExtension(path, ".glb"))
+        return parseGlb(data, size, mesh);
+    // strtof needs a terminator the mapping does not have
+    std::string text((const char*)data, size);
+    return parseObj(text.c_str(), mesh);
+}
+
+double elapsedMs(std::chrono::high_resolution_clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+}
+}
+
+// ------------------------------------------------------------------------
+bool parseCookedMesh(const void* data, size_t size, MeshData& mesh)
+{
+    if (size < sizeof(MeshCacheHeader))
+        return false;
+    MeshCacheHeader header;
+    std::memcpy(&header, data, sizeof(header));
+    if (std::memcmp(header.magic, "ORMS", 4) != 0 || header.version != MESH_CACHE_VERSION ||
+        (header.indexSize != 2 && header.indexSize != 4))
+        return false;
+    size_t vertexBytes = (size_t)header.vertexCount * sizeof(MeshVertex);
+    size_t indexBytes = (size_t)header.indexCount * header.indexSize;
+    if (size != sizeof(header) + vertexBytes + indexBytes)
+        return false;
+    const unsigned char* p = (const unsigned char*)data + sizeof(header);
+    mesh.vertices.resize(header.vertexCount);
+    if (vertexBytes)
+        std::memcpy(&mesh.vertices[0], p, vertexBytes);
+    p += vertexBytes;
+    mesh.indices.resize(header.indexCount);
+    for (uint32_t i = 0; i < header.indexCount; ++i)
+    {
+        if (header.indexSize == 2)
+        {
+            uint16_t s;
+            std::memcpy(&s, p + i * 2, 2);
+            mesh.indices[i] = s;
+        }
+        else
+            std::memcpy(&mesh.indices[i], p + i * 4, 4);
+        // a stale or corrupt entry must not make the GPU read past the vertex buffer
+        if (mesh.indices[i] >= header.vertexCount)
+        {
+            mesh.clear();
+            return false;
+        }
+    }
+    return true;
+}
+
+bool writeCookedMesh(std::ostream& out, const MeshData& mesh, uint64_t key)
+{
+    MeshCacheHeader header;
+    std::memcpy(header.magic, "ORMS", 4);
+    header.version = MESH_CACHE_VERSION;
+    header.key = key;
+    header.vertexCount = (uint32_t)mesh.vertices.size();
+    header.indexCount = (uint32_t)mesh.indices.size();
+    header.indexSize = mesh.fitsUnsignedShort() ? 2 : 4;
+    header.reserved = 0;
+    out.write((const char*)&header, sizeof(header));
+    if (!mesh.vertices.empty())
+        out.write((const char*)&mesh.vertices[0], mesh.vertices.size() * sizeof(MeshVertex));
+    if (header.indexSize == 2)
+    {
+        std::vector<uint16_t> shortIndices(mesh.indices.begin(), mesh.indices.end());
+        if (!shortIndices.empty())
+            out.write((const char*)&shortIndices[0], shortIndices.size() * sizeof(uint16_t));
+    }
+    else if (!mesh.indices.empty())
+        out.write((const char*)&mesh.indices[0], mesh.indices.size() * sizeof(uint32_t));
+    return (bool)out;
+}
+
+// ------------------------------------------------------------------------
+bool loadObj(const char* path, MeshData& mesh)
+{
+    MappedFile file;
+    if (!file.open(path))
+    {
+        std::cout << "ERROR::MESH::FILE_NOT_SUCCESFULLY_READ " << path << std::endl;
+        return false;
+    }
+    std::string text((const char*)file.data(), file.size());
+    mesh.clear();
+    return parseObj(text.c_str(), mesh);
+}
+
+bool loadGlb(const char* path, MeshData& mesh)
+{
+    MappedFile file;
+    if (!file.open(path))
+    {
+        std::cout << "ERROR::MESH::FILE_NOT_SUCCESFULLY_READ " << path << std::endl;
+        return false;
+    }
+    mesh.clear();
+    return parseGlb(file.data(), file.size(), mesh);
+}
+
+bool loadMesh(const char* path, MeshData& mesh, const char* cacheDirectory, MeshOptimizeStats* stats)
+{
+    std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+    if (stats)
+        std::memset(stats, 0, sizeof(*stats));
+    MappedFile file;
+    if (!file.open(path))
+    {
+        std::cout << "ERROR::MESH::FILE_NOT_SUCCESFULLY_READ " << path << std::endl;
+        return false;
+    }
+    uint64_t key = fnv1a(14695981039346656037ull, &MESH_CACHE_VERSION, sizeof(MESH_CACHE_VERSION));
+    key = fnv1a(key, file.data(), file.size());
+    std::string cached = cacheDirectory ? cachePath(cacheDirectory, key) : std::string();
+    if (cacheDirectory && loadCached(cached, key, mesh))
+    {
+        std::cout << "MESH::CACHE::HIT " << path << " " << elapsedMs(start) << " ms" << std::endl;
+        return true;
+    }
+
+    if (!parse(path, file.data(), file.size(), mesh))
+    {
+        std::cout << "ERROR::MESH::NOT_SUCCESFULLY_PARSED " << path << std::endl;
+        return false;
+    }
+    MeshOptimizeStats s;
+    optimizeMesh(mesh, &s);
+    if (cacheDirectory)
+        storeCached(cacheDirectory, cached, key, mesh);
+    std::cout << "MESH::CACHE::MISS " << path << " " << elapsedMs(start) << " ms: " << s.inputVertices << " -> "
+              << s.outputVertices << " vertices, " << s.triangles << " triangles, ACMR " << s.acmrBefore << " -> "
+              << s.acmrAfter << ", " << s.clusters << " overdraw clusters" << std::endl;
+    if (stats)
+        *stats = s;
+    return true;
+}
@@ -0,0 +1,56 @@
+#ifndef MESH_LOADER_H
+#define MESH_LOADER_H
+
+#include <mesh_data.h>
+#include <mesh_optimizer.h>
+
+#include <cstdint>
+#include <cstddef>
+#include <ostream>
+
+// mesh import: Wavefront OBJ and binary glTF (.glb) into a MeshData, then the passes of
+// mesh_optimizer.h. loadMesh() keeps the optimized result in a cache directory keyed by
+// a hash of the source file, so only the first load parses and optimizes:
+//
+//     MeshData data;
+//     if (loadMesh("../res/torus.obj", data, "mesh_cache"))
+//         mesh.upload(data);                 // 16-bit indices when they fit
+//
+// supported: OBJ v/vt/vn/f with polygons (fan triangulated) and negative indices;
+// GLB with TEXCOORD_0 and NORMAL, float or normalized unsigned texcoords, all indexed
+// or non-indexed triangle primitives of the first mesh. node transforms, materials,
+// sparse accessors and external buffers are ignored. texcoords are flipped to
+// OpenGL's bottom-left origin for glTF, OBJ already uses it.
+
+const uint32_t MESH_CACHE_VERSION = 1;
+
+// <cache dir>/<key>.orimesh, little endian:
+//     MeshCacheHeader
+//     MeshVertex[vertexCount]
+//     uint16_t or uint32_t [indexCount], indexSize bytes each
+struct MeshCacheHeader
+{
+    char magic[4];              // "ORMS"
+    uint32_t version;
+    // FNV-1a of the source file bytes and MESH_CACHE_VERSION
+    uint64_t key;
+    uint32_t vertexCount;
+    uint32_t indexCount;
+    uint32_t indexSize;
+    uint32_t reserved;
+};
+
+// the .orimesh layout in memory, e.g. an entry of an asset archive (asset_archive.h);
+// the key is not checked
+bool parseCookedMesh(const void* data, size_t size, MeshData& mesh);
+bool writeCookedMesh(std::ostream& out, const MeshData& mesh, uint64_t key = 0);
+
+// unoptimized, one vertex per face corner
+bool loadObj(const char* path, MeshData& mesh);
+bool loadGlb(const char* path, MeshData& mesh);
+
+// by extension (.obj / .glb), optimized. cacheDirectory may be NULL to always import;
+// stats, if given, is filled on import and zeroed on a cache hit
+bool loadMesh(const char* path, MeshData& mesh, const char* cacheDirectory = NULL, MeshOptimizeStats* stats = NULL);
+
+#endif
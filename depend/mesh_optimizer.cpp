@@ -0,0 +1,430 @@
+#include "mesh_optimizer.h"
+
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace
+{
+// ------------------------------------------------------------------------
+// vertex welding: open addressing over the vertex bytes, -0.0 folded into 0.0 first
+// ------------------------------------------------------------------------
+uint64_t hashVertex(const MeshVertex& v)
+{
+    uint64_t hash = 14695981039346656037ull;
+    const unsigned char* bytes = (const unsigned char*)&v;
+    for (size_t i = 0; i < sizeof(MeshVertex); ++i)
+    {
+        hash ^= bytes[i];
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+MeshVertex canonical(const MeshVertex& v)
+{
+    MeshVertex c = v;
+    float* f = (float*)&c;
+    for (size_t i = 0; i < sizeof(MeshVertex) / sizeof(float); ++i)
+    {
+        if (f[i] == 0.0f)
+            f[i] = 0.0f;
+    }
+    return c;
+}
+
+// ------------------------------------------------------------------------
+// Forsyth scoring, the constants of the original article
+// ------------------------------------------------------------------------
+const int FORSYTH_CACHE_SIZE = 32;
+const float CACHE_DECAY_POWER = 1.5f;
+const float LAST_TRIANGLE_SCORE = 0.75f;
+const float VALENCE_BOOST_SCALE = 2.0f;
+const float VALENCE_BOOST_POWER = 0.5f;
+const int MAX_VALENCE = 64;
+
+struct ScoreTable
+{
+    float cache[FORSYTH_CACHE_SIZE];
+    float valence[MAX_VALENCE];
+
+    ScoreTable()
+    {
+        for (int i = 0; i < FORSYTH_CACHE_SIZE; ++i)
+        {
+            if (i < 3)
+                cache[i] = LAST_TRIANGLE_SCORE;
+            else
+                cache[i] = std::pow(1.0f - (float)(i - 3) / (FORSYTH_CACHE_SIZE - 3), CACHE_DECAY_POWER);
+        }
+        valence[0] = 0.0f;
+        for (int i = 1; i < MAX_VALENCE; ++i)
+            valence[i] = VALENCE_BOOST_SCALE * std::pow((float)i, -VALENCE_BOOST_POWER);
+    }
+};
+
+float vertexScore(const ScoreTable& table, int cachePosition, unsigned int remaining)
+{
+    // no triangles left to draw with it, never pick it again
+    if (remaining == 0)
+        return -1.0f;
+    float score = cachePosition >= 0 ? table.cache[cachePosition] : 0.0f;
+    return score + table.valence[std::min<unsigned int>(remaining, MAX_VALENCE - 1)];
+}
+
+// ------------------------------------------------------------------------
+// geometry helpers for the overdraw pass
+// ------------------------------------------------------------------------
+void triangleGeometry(const MeshVertex* vertices, const uint32_t* tri, float centroid[3], float normal[3], float& area)
+{
+    const float* a = vertices[tri[0]].position;
+    const float* b = vertices[tri[1]].position;
+    const float* c = vertices[tri[2]].position;
+    float e1[3] = { b[0] - a[0], b[1] - a[1], b[2] - a[2] };
+    float e2[3] = { c[0] - a[0], c[1] - a[1], c[2] - a[2] };
+    normal[0] = e1[1] * e2[2] - e1[2] * e2[1];
+    normal[1] = e1[2] * e2[0] - e1[0] * e2[2];
+    normal[2] = e1[0] * e2[1] - e1[1] * e2[0];
+    area = 0.5f * std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+    for (int k = 0; k < 3; ++k)
+        centroid[k] = (a[k] + b[k] + c[k]) / 3.0f;
+}
+
+// FIFO post-transform cache as GPUs model it, used for ACMR and cluster splitting
+class FifoCache
+{
+public:
+    FifoCache(size_t vertexCount, unsigned int size) : stamps(vertexCount, 0), size(size), time(size + 1) {}
+    // true if v had to be transformed
+    bool touch(uint32_t v)
+    {
+        if (time - stamps[v] > size)
+        {
+            stamps[v] = time++;
+            return true;
+        }
+        return false;
+    }
+    // empty the cache without clearing the stamps
+    void reset() { time += size + 1; }
+
+private:
+    std::vector<unsigned int> stamps;
+    unsigned int size;
+    unsigned int time;
+};
+}
+
+// ------------------------------------------------------------------------
+size_t weldVertices(MeshData& mesh)
+{
+    size_t count = mesh.vertices.size();
+    size_t tableSize = 1;
+    while (tableSize < count * 2)
+        tableSize <<= 1;
+    const uint32_t EMPTY = 0xFFFFFFFFu;
+    std::vector<uint32_t> table(tableSize, EMPTY);
+    std::vector<uint32_t> remap(count);
+    std::vector<MeshVertex> unique;
+    unique.reserve(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        MeshVertex v = canonical(mesh.vertices[i]);
+        size_t slot = (size_t)hashVertex(v) & (tableSize - 1);
+        while (table[slot] != EMPTY && std::memcmp(&unique[table[slot]], &v, sizeof(MeshVertex)) != 0)
+            slot = (slot + 1) & (tableSize - 1);
+        if (table[slot] == EMPTY)
+        {
+            table[slot] = (uint32_t)unique.size();
+            unique.push_back(v);
+        }
+        remap[i] = table[slot];
+    }
+    for (size_t i = 0; i < mesh.indices.size(); ++i)
+        mesh.indices[i] = remap[mesh.indices[i]];
+    mesh.vertices.swap(unique);
+    return mesh.vertices.size();
+}
+
+// Tom Forsyth, "Linear-Speed Vertex Cache Optimisation": greedily emit the triangle with
+// the best score, where vertices score for being recently used and for having few
+// triangles left (so lone triangles are not left behind)
+// ------------------------------------------------------------------------
+void optimizeVertexCache(uint32_t* indices, size_t indexCount, size_t vertexCount)
+{
+    static const ScoreTable table;
+    size_t triangleCount = indexCount / 3;
+    if (triangleCount == 0)
+        return;
+
+    // vertex -> triangles adjacency in one flat array
+    std::vector<unsigned int> remaining(vertexCount, 0);
+    for (size_t i = 0; i < triangleCount * 3; ++i)
+        ++remaining[indices[i]];
+    std::vector<unsigned int> firstTriangle(vertexCount + 1, 0);
+    for (size_t v = 0; v < vertexCount; ++v)
+        firstTriangle[v + 1] = firstTriangle[v] + remaining[v];
+    std::vector<unsigned int> adjacency(triangleCount * 3);
+    {
+        std::vector<unsigned int> fill(firstTriangle.begin(), firstTriangle.end() - 1);
+        for (size_t t = 0; t < triangleCount; ++t)
+            for (int k = 0; k < 3; ++k)
+                adjacency[fill[indices[t * 3 + k]]++] = (unsigned int)t;
+    }
+
+    std::vector<float> vertexScores(vertexCount);
+    for (size_t v = 0; v < vertexCount; ++v)
+        vertexScores[v] = vertexScore(table, -1, remaining[v]);
+    std::vector<bool> emitted(triangleCount, false);
+
+    std::vector<uint32_t> output;
+    output.reserve(triangleCount * 3);
+    // FORSYTH_CACHE_SIZE entries plus room for the 3 pushed before trimming
+    std::vector<uint32_t> cache, next;
+    cache.reserve(FORSYTH_CACHE_SIZE + 3);
+    next.reserve(FORSYTH_CACHE_SIZE + 3);
+    size_t scanCursor = 0;
+    long best = -1;
+
+    for (size_t emittedCount = 0; emittedCount < triangleCount; ++emittedCount)
+    {
+        if (best < 0)
+        {
+            // nothing in the cache has triangles left: restart at the next triangle not
+            // emitted yet (a cursor is enough, triangles are never un-emitted)
+            while (emitted[scanCursor])
+                ++scanCursor;
+            best = (long)scanCursor;
+        }
+        size_t t = (size_t)best;
+        emitted[t] = true;
+        const uint32_t* tri = &indices[t * 3];
+        output.insert(output.end(), tri, tri + 3);
+
+        // the triangle's vertices go to the front of the LRU cache
+        next.clear();
+        for (int k = 0; k < 3; ++k)
+        {
+            uint32_t v = tri[k];
+            next.push_back(v);
+            // remove t from v's remaining triangles
+            unsigned int* begin = &adjacency[firstTriangle[v]];
+            unsigned int* end = begin + remaining[v];
+            std::iter_swap(std::find(begin, end, (unsigned int)t), end - 1);
+            --remaining[v];
+        }
+        for (size_t i = 0; i < cache.size(); ++i)
+        {
+            if (cache[i] != tri[0] && cache[i] != tri[1] && cache[i] != tri[2])
+                next.push_back(cache[i]);
+        }
+        cache.swap(next);
+
+        // rescore every vertex that is in or just fell out of the cache, and their triangles
+        best = -1;
+        float bestScore = -1.0f;
+        for (size_t i = 0; i < cache.size(); ++i)
+        {
+            uint32_t v = cache[i];
+            int position = i < (size_t)FORSYTH_CACHE_SIZE ? (int)i : -1;
+            vertexScores[v] = vertexScore(table, position, remaining[v]);
+        }
+        for (size_t i = 0; i < cache.size(); ++i)
+        {
+            uint32_t v = cache[i];
+            for (unsigned int a = 0; a < remaining[v]; ++a)
+            {
+                unsigned int u = adjacency[firstTriangle[v] + a];
+                const uint32_t* ut = &indices[u * 3];
+                float score = vertexScores[ut[0]] + vertexScores[ut[1]] + vertexScores[ut[2]];
+                if (score > bestScore)
+                {
+                    bestScore = score;
+                    best = (long)u;
+                }
+            }
+        }
+        if (cache.size() > (size_t)FORSYTH_CACHE_SIZE)
+            cache.resize(FORSYTH_CACHE_SIZE);
+    }
+    std::memcpy(indices, &output[0], output.size() * sizeof(uint32_t));
+}
+
+// the cache-ordered list is cut where the FIFO simulation starts cold anyway (a
+// triangle with 3 misses) and, inside those runs, wherever the run so far is already
+// within threshold of the run's ACMR. the clusters are then sorted by how far out of
+// the mesh they face, so outer surfaces are drawn first and occlude the inner ones.
+// ------------------------------------------------------------------------
+size_t optimizeOverdraw(uint32_t* indices, size_t indexCount, const MeshVertex* vertices, size_t vertexCount,
+                        float threshold)
+{
+    size_t triangleCount = indexCount / 3;
+    if (triangleCount == 0)
+        return 0;
+    const unsigned int CACHE_SIZE = 16;
+
+    // hard boundaries
+    std::vector<size_t> hard;
+    {
+        FifoCache cache(vertexCount, CACHE_SIZE);
+        for (size_t t = 0; t < triangleCount; ++t)
+        {
+            int misses = cache.touch(indices[t * 3]) + cache.touch(indices[t * 3 + 1]) + cache.touch(indices[t * 3 + 2]);
+            if (t == 0 || misses == 3)
+                hard.push_back(t);
+        }
+        hard.push_back(triangleCount);
+    }
+
+    // soft boundaries: a cluster restarts cold after reordering, so only cut where the
+    // cluster so far has not lost more than threshold against the whole run
+    std::vector<size_t> clusters;
+    FifoCache cache(vertexCount, CACHE_SIZE);
+    for (size_t h = 0; h + 1 < hard.size(); ++h)
+    {
+        size_t begin = hard[h], end = hard[h + 1];
+        cache.reset();
+        size_t runMisses = 0;
+        for (size_t t = begin; t < end; ++t)
+            runMisses += cache.touch(indices[t * 3]) + cache.touch(indices[t * 3 + 1]) + cache.touch(indices[t * 3 + 2]);
+        float target = threshold * (float)runMisses / (float)(end - begin);
+
+        clusters.push_back(begin);
+        cache.reset();
+        size_t misses = 0, start = begin;
+        for (size_t t = begin; t < end; ++t)
+        {
+            misses += cache.touch(indices[t * 3]) + cache.touch(indices[t * 3 + 1]) + cache.touch(indices[t * 3 + 2]);
+            size_t length = t + 1 - start;
+            // short clusters are never worth it, their cold start dominates
+            if (length >= 32 && t + 1 < end && (float)misses / (float)length <= target)
+            {
+                clusters.push_back(t + 1);
+                cache.reset();
+                misses = 0;
+                start = t + 1;
+            }
+        }
+    }
+    clusters.push_back(triangleCount);
+    size_t clusterCount = clusters.size() - 1;
+
+    // area weighted centroid and normal per cluster, and of the whole mesh
+    float meshCentroid[3] = { 0.0f, 0.0f, 0.0f };
+    float meshArea = 0.0f;
+    std::vector<float> centroids(clusterCount * 3), normals(clusterCount * 3);
+    for (size_t c = 0; c < clusterCount; ++c)
+    {
+        float* centroid = &centroids[c * 3];
+        float* normal = &normals[c * 3];
+        float area = 0.0f;
+        for (size_t t = clusters[c]; t < clusters[c + 1]; ++t)
+        {
+            float tc[3], tn[3], ta;
+            triangleGeometry(vertices, &indices[t * 3], tc, tn, ta);
+            for (int k = 0; k < 3; ++k)
+            {
+                centroid[k] += tc[k] * ta;
+                // the cross product is already area weighted
+                normal[k] += tn[k];
+            }
+            area += ta;
+        }
+        for (int k = 0; k < 3; ++k)
+            meshCentroid[k] += centroid[k];
+        meshArea += area;
+        float inverse = area > 0.0f ? 1.0f / area : 0.0f;
+        float length = std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+        float inverseLength = length > 0.0f ? 1.0f / length : 0.0f;
+        for (int k = 0; k < 3; ++k)
+        {
+            centroid[k] *= inverse;
+            normal[k] *= inverseLength;
+        }
+    }
+    if (meshArea > 0.0f)
+        for (int k = 0; k < 3; ++k)
+            meshCentroid[k] /= meshArea;
+
+    // key: dot(cluster centroid - mesh centroid, cluster normal), larger faces further out
+    std::vector<std::pair<float, size_t> > order(clusterCount);
+    for (size_t c = 0; c < clusterCount; ++c)
+    {
+        const float* centroid = &centroids[c * 3];
+        const float* n = &normals[c * 3];
+        float key = (centroid[0] - meshCentroid[0]) * n[0] + (centroid[1] - meshCentroid[1]) * n[1] +
+                    (centroid[2] - meshCentroid[2]) * n[2];
+        // descending key, ties in the original order
+        order[c] = std::make_pair(-key, c);
+    }
+    std::stable_sort(order.begin(), order.end());
+
+    std::vector<uint32_t> output;
+    output.reserve(triangleCount * 3);
+    for (size_t i = 0; i < clusterCount; ++i)
+    {
+        size_t c = order[i].second;
+        output.insert(output.end(), indices + clusters[c] * 3, indices + clusters[c + 1] * 3);
+    }
+    std::memcpy(indices, &output[0], output.size() * sizeof(uint32_t));
+    return clusterCount;
+}
+
+// ------------------------------------------------------------------------
+void optimizeVertexFetch(MeshData& mesh)
+{
+    const uint32_t UNUSED = 0xFFFFFFFFu;
+    std::vector<uint32_t> remap(mesh.vertices.size(), UNUSED);
+    std::vector<MeshVertex> ordered;
+    ordered.reserve(mesh.vertices.size());
+    for (size_t i = 0; i < mesh.indices.size(); ++i)
+    {
+        uint32_t& index = mesh.indices[i];
+        if (remap[index] == UNUSED)
+        {
+            remap[index] = (uint32_t)ordered.size();
+            ordered.push_back(mesh.vertices[index]);
+        }
+        index = remap[index];
+    }
+    // vertices no triangle references are dropped
+    mesh.vertices.swap(ordered);
+}
+
+// ------------------------------------------------------------------------
+float averageCacheMissRatio(const uint32_t* indices, size_t indexCount, size_t vertexCount, unsigned int cacheSize)
+{
+    size_t triangleCount = indexCount / 3;
+    if (triangleCount == 0)
+        return 0.0f;
+    FifoCache cache(vertexCount, cacheSize);
+    size_t misses = 0;
+    for (size_t i = 0; i < triangleCount * 3; ++i)
+        misses += cache.touch(indices[i]);
+    return (float)misses / (float)triangleCount;
+}
+
+// ------------------------------------------------------------------------
+void optimizeMesh(MeshData& mesh, MeshOptimizeStats* stats)
+{
+    MeshOptimizeStats s;
+    std::memset(&s, 0, sizeof(s));
+    s.inputVertices = mesh.vertices.size();
+    s.triangles = mesh.indices.size() / 3;
+    // drop a trailing partial triangle, everything below works on whole triangles
+    mesh.indices.resize(s.triangles * 3);
+
+    weldVertices(mesh);
+    if (!mesh.indices.empty())
+    {
+        s.acmrBefore = averageCacheMissRatio(&mesh.indices[0], mesh.indices.size(), mesh.vertices.size());
+        optimizeVertexCache(&mesh.indices[0], mesh.indices.size(), mesh.vertices.size());
+        s.clusters = optimizeOverdraw(&mesh.indices[0], mesh.indices.size(), &mesh.vertices[0], mesh.vertices.size());
+        optimizeVertexFetch(mesh);
+        s.acmrAfter = averageCacheMissRatio(&mesh.indices[0], mesh.indices.size(), mesh.vertices.size());
+    }
+    s.outputVertices = mesh.vertices.size();
+    if (stats)
+        *stats = s;
+}
@@ -0,0 +1,43 @@
+#ifndef MESH_OPTIMIZER_H
+#define MESH_OPTIMIZER_H
+
+#include <mesh_data.h>
+
+#include <cstddef>
+#include <cstdint>
+
+// offline-quality passes over an indexed triangle list, run once at import:
+//     weldVertices         merge bit-identical corners, so shared vertices are shaded once
+//     optimizeVertexCache  Forsyth's linear-speed reordering for the post-transform cache
+//     optimizeOverdraw     split the cache-ordered list into clusters and draw the ones
+//                          facing out of the mesh first (Sander et al., "Fast Triangle
+//                          Reordering for Vertex Locality and Reduced Overdraw")
+//     optimizeVertexFetch  renumber vertices in first-use order for linear fetches
+// optimizeMesh() runs them in that order.
+
+struct MeshOptimizeStats
+{
+    size_t inputVertices;
+    size_t outputVertices;
+    size_t triangles;
+    // average cache miss ratio, transformed vertices per triangle with a 16 entry FIFO:
+    // 3 is the worst case, ~0.6-0.7 is typical for optimized regular meshes
+    float acmrBefore;
+    float acmrAfter;
+    // clusters the overdraw pass sorted
+    size_t clusters;
+};
+
+// returns the number of unique vertices, the index list is rewritten to them
+size_t weldVertices(MeshData& mesh);
+void optimizeVertexCache(uint32_t* indices, size_t indexCount, size_t vertexCount);
+// threshold: how much worse than the input's ACMR a cluster may get by splitting,
+// 1.05 keeps the vertex cache gains almost intact. returns the cluster count
+size_t optimizeOverdraw(uint32_t* indices, size_t indexCount, const MeshVertex* vertices, size_t vertexCount,
+                        float threshold = 1.05f);
+void optimizeVertexFetch(MeshData& mesh);
+float averageCacheMissRatio(const uint32_t* indices, size_t indexCount, size_t vertexCount, unsigned int cacheSize = 16);
+
+void optimizeMesh(MeshData& mesh, MeshOptimizeStats* stats = NULL);
+
+#endif
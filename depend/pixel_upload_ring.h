@@ -0,0 +1,249 @@
+#ifndef PIXEL_UPLOAD_RING_H
+#define PIXEL_UPLOAD_RING_H
+
+#include <glad/glad.h>
+
+#include <gl_ext.h>
+
+#include <deque>
+#include <mutex>
+#include <cstring>
+#include <cstdint>
+
+// a GL_PIXEL_UNPACK_BUFFER used as a ring of staging memory for texture uploads.
+// glTexImage2D sourced from a PBO offset returns without copying: the transfer runs
+// on the GPU's timeline and a fence per region tells us when the bytes may be reused.
+//
+// with glBufferStorage (GL 4.4 / ARB_buffer_storage) the whole buffer is mapped once,
+// persistent and coherent, so any thread can acquire a region and write pixels into
+// it; the decoder threads of TextureLoader do exactly that. without it the GL thread
+// maps each region with GL_MAP_UNSYNCHRONIZED_BIT (the fences already guarantee the
+// GPU is done with it) and copies into it itself.
+class PixelUploadRing
+{
+public:
+    struct Region
+    {
+        size_t offset;
+        size_t size;
+        // only valid for persistent rings before upload(), NULL otherwise
+        unsigned char* ptr;
+        unsigned long sequence;
+
+        Region() : offset(0), size(0), ptr(NULL), sequence(0) {}
+    };
+
+    struct Stats
+    {
+        unsigned long regions;
+        unsigned long bytes;
+        // acquisitions that failed because the GPU still owned the space
+        unsigned long full;
+    };
+
+    static const size_t ALIGNMENT = 64;
+
+    unsigned int PBO;
+
+    // GL thread. capacity is rounded up to ALIGNMENT
+    // ------------------------------------------------------------------------
+    explicit PixelUploadRing(size_t capacity)
+        : PBO(0), capacity(align(capacity)), mapped(NULL), head(0), nextSequence(0), frontSequence(0)
+    {
+        std::memset(&stats, 0, sizeof(stats));
+        glGenBuffers(1, &PBO);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, PBO);
+        if (glExt().bufferStorage)
+        {
+            GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+            glExt().BufferStorage(GL_PIXEL_UNPACK_BUFFER, (GLsizeiptr)this->capacity, NULL, flags);
+            mapped = (unsigned char*)glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, (GLsizeiptr)this->capacity, flags);
+        }
+        if (!mapped)
+            glBufferData(GL_PIXEL_UNPACK_BUFFER, (GLsizeiptr)this->capacity, NULL, GL_STREAM_DRAW);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    }
+    // GL thread, with no region left in flight
+    // ------------------------------------------------------------------------
+    void release()
+    {
+        for (size_t i = 0; i < inFlight.size(); ++i)
+        {
+            if (inFlight[i].fence)
+                glDeleteSync(inFlight[i].fence);
+        }
+        inFlight.clear();
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, PBO);
+        if (mapped)
+            glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        glDeleteBuffers(1, &PBO);
+        PBO = 0;
+        mapped = NULL;
+    }
+
+    // true when workers can write into acquired regions directly
+    bool persistent() const { return mapped != NULL; }
+    size_t size() const { return capacity; }
+
+    // reserve size contiguous bytes. thread safe; fails instead of waiting when the
+    // GPU still holds the space (or size exceeds the ring), callers then use the
+    // old direct upload path
+    // ------------------------------------------------------------------------
+    bool tryAcquire(size_t size, Region& region)
+    {
+        size_t bytes = align(size);
+        std::lock_guard<std::mutex> lock(mutex);
+        size_t offset;
+        if (!findSpace(bytes, offset))
+        {
+            ++stats.full;
+            return false;
+        }
+        head = offset + bytes;
+        InFlight entry;
+        entry.begin = offset;
+        entry.end = head;
+        entry.fence = NULL;
+        entry.finished = false;
+        inFlight.push_back(entry);
+
+        region.offset = offset;
+        region.size = size;
+        region.ptr = mapped ? mapped + offset : NULL;
+        region.sequence = nextSequence++;
+        ++stats.regions;
+        stats.bytes += size;
+        return true;
+    }
+    // GL thread: copy pixels into a region of a non-persistent ring
+    // ------------------------------------------------------------------------
+    void write(const Region& region, const void* pixels)
+    {
+        if (mapped)
+        {
+            std::memcpy(mapped + region.offset, pixels, region.size);
+            return;
+        }
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, PBO);
+        void* ptr = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, (GLintptr)region.offset, (GLsizeiptr)region.size,
+                                     GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT | GL_MAP_INVALIDATE_RANGE_BIT);
+        if (ptr)
+        {
+            std::memcpy(ptr, pixels, region.size);
+            glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+        }
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    }
+    // GL thread: glTexImage2D level 0 of the texture bound to GL_TEXTURE_2D from the
+    // region, then fence it so the space is recycled once the GPU consumed it
+    // ------------------------------------------------------------------------
+    void upload(const Region& region, GLint internalFormat, int width, int height, GLenum format, GLenum type)
+    {
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, PBO);
+        glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, width, height, 0, format, type, (const void*)(uintptr_t)region.offset);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        GLsync fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        std::lock_guard<std::mutex> lock(mutex);
+        InFlight& entry = inFlight[region.sequence - frontSequence];
+        entry.fence = fence;
+        entry.finished = true;
+    }
+    // any thread: give a region back without uploading from it
+    // ------------------------------------------------------------------------
+    void discard(const Region& region)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        inFlight[region.sequence - frontSequence].finished = true;
+    }
+    // GL thread, once per frame: recycle regions whose fences have signalled.
+    // regions are freed in acquisition order, like any ring.
+    // ------------------------------------------------------------------------
+    void retire()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        while (!inFlight.empty())
+        {
+            InFlight& front = inFlight.front();
+            if (!front.finished)
+                break;
+            if (front.fence)
+            {
+                GLenum result = glClientWaitSync(front.fence, 0, 0);
+                if (result != GL_ALREADY_SIGNALED && result != GL_CONDITION_SATISFIED)
+                    break;
+                glDeleteSync(front.fence);
+            }
+            inFlight.pop_front();
+            ++frontSequence;
+        }
+        if (inFlight.empty())
+            head = 0;
+    }
+
+    Stats statistics() const
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return stats;
+    }
+
+private:
+    struct InFlight
+    {
+        size_t begin, end;
+        GLsync fence;
+        // uploaded (fence set) or discarded
+        bool finished;
+    };
+
+    size_t capacity;
+    unsigned char* mapped;
+    mutable std::mutex mutex;
+    std::deque<InFlight> inFlight;
+    size_t head;
+    unsigned long nextSequence;
+    unsigned long frontSequence;
+    Stats stats;
+
+    static size_t align(size_t size)
+    {
+        return (size + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+    }
+    // free space is [head, capacity) + [0, tail) when head >= tail, [head, tail) otherwise
+    bool findSpace(size_t bytes, size_t& offset) const
+    {
+        if (bytes == 0 || bytes > capacity)
+            return false;
+        if (inFlight.empty())
+        {
+            offset = 0;
+            return true;
+        }
+        size_t tail = inFlight.front().begin;
+        if (head >= tail)
+        {
+            if (head + bytes <= capacity)
+            {
+                offset = head;
+                return true;
+            }
+            // wrap, never let head catch up with tail exactly
+            if (bytes < tail)
+            {
+                offset = 0;
+                return true;
+            }
+            return false;
+        }
+        if (head + bytes < tail)
+        {
+            offset = head;
+            return true;
+        }
+        return false;
+    }
+
+    PixelUploadRing(const PixelUploadRing&);
+    PixelUploadRing& operator=(const PixelUploadRing&);
+};
+#endif
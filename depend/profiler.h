@@ -0,0 +1,531 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <glad/glad.h>
+
+#include <vector>
+#include <string>
+#include <chrono>
+#include <cstring>
+#include <cstdint>
+#include <cstdio>
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+
+// s as a quoted JSON string: quotes, backslashes and control characters escaped, so
+// names and driver strings (GL_RENDERER, ...) cannot break the document
+// ------------------------------------------------------------------------
+inline void writeJsonString(std::ostream& out, const char* s)
+{
+    out << '"';
+    for (; s && *s; ++s)
+    {
+        unsigned char c = (unsigned char)*s;
+        if (c == '"' || c == '\\')
+            out << '\\' << (char)c;
+        else if (c == '\n')
+            out << "\\n";
+        else if (c == '\t')
+            out << "\\t";
+        else if (c < 0x20)
+        {
+            char escaped[8];
+            std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+            out << escaped;
+        }
+        else
+            out << (char)c;
+    }
+    out << '"';
+}
+
+// CPU + GPU frame profiler for the render loops.
+//
+//     Profiler profiler;
+//     while (...) {
+//         profiler.beginFrame();
+//         { ProfileScope scope(profiler, "draw"); glDrawElements(...); }
+//         profiler.drawOverlay(width, height);
+//         profiler.endFrame();
+//         glfwSwapBuffers(window);
+//     }
+//
+// every scope records steady_clock times and, when GPU timing is on, a pair of
+// glQueryCounter(GL_TIMESTAMP) queries. timestamps are used instead of GL_TIME_ELAPSED
+// because elapsed queries cannot nest, and the frame itself is the outer scope.
+// query results are read FRAMES_IN_FLIGHT frames later, when the GPU is long done,
+// so the readback never stalls; a frame whose results are still not there is dropped.
+//
+// counter() records one value per frame next to the scopes, e.g. resident texture
+// memory; counters are printed with the scopes and written as trace counter tracks.
+class Profiler
+{
+public:
+    static const int FRAMES_IN_FLIGHT = 3;
+    // frames kept per scope for the histogram and the overlay
+    static const int HISTORY = 240;
+
+    struct ScopeHistory
+    {
+        const char* name;
+        float cpuMs[HISTORY];
+        float gpuMs[HISTORY];
+        // samples written so far, the newest is at (count - 1) % HISTORY
+        unsigned int count;
+    };
+
+    struct CounterHistory
+    {
+        const char* name;
+        float values[HISTORY];
+        unsigned int count;
+        // the frame the newest value was recorded in
+        uint64_t frame;
+    };
+
+    explicit Profiler(bool gpuTiming = true)
+        : gpuTiming(gpuTiming), enabled(true), tracing(false), frameIndex(0), droppedFrames(0), maxTraceEvents(1 << 20)
+    {
+        for (int i = 0; i < FRAMES_IN_FLIGHT; ++i)
+        {
+            slots[i].pending = false;
+            slots[i].queryCount = 0;
+        }
+        epoch = std::chrono::steady_clock::now();
+        if (gpuTiming)
+        {
+            // line the GPU clock up with ours once, drift over a session is negligible
+            GLint64 gpuNow = 0;
+            glGetInteger64v(GL_TIMESTAMP, &gpuNow);
+            gpuToCpuNs = cpuNowNs() - (int64_t)gpuNow;
+        }
+        else
+            gpuToCpuNs = 0;
+        intern("frame");
+    }
+
+    // switch everything off, scopes become two branches
+    void setEnabled(bool on) { enabled = on; }
+    bool isEnabled() const { return enabled; }
+    // collect Chrome trace events (chrome://tracing, ui.perfetto.dev) until writeChromeTrace
+    void setTracing(bool on) { tracing = on; }
+
+    // ------------------------------------------------------------------------
+    void beginFrame()
+    {
+        if (!enabled)
+            return;
+        FrameSlot& slot = slots[frameIndex % FRAMES_IN_FLIGHT];
+        if (slot.pending)
+            resolve(slot);
+        slot.frame = frameIndex;
+        slot.events.clear();
+        slot.queryCount = 0;
+        open.clear();
+        begin("frame");
+    }
+    void endFrame()
+    {
+        if (!enabled)
+            return;
+        // close whatever was left open, the frame scope last
+        while (!open.empty())
+            end(open.back());
+        slots[frameIndex % FRAMES_IN_FLIGHT].pending = true;
+        ++frameIndex;
+    }
+
+    // name must outlive the profiler, string literals are what this is meant for
+    // ------------------------------------------------------------------------
+    int begin(const char* name)
+    {
+        if (!enabled)
+            return -1;
+        FrameSlot& slot = slots[frameIndex % FRAMES_IN_FLIGHT];
+        Event event;
+        event.name = intern(name);
+        event.depth = (int)open.size();
+        event.cpuBegin = cpuNowNs();
+        event.cpuEnd = event.cpuBegin;
+        event.queryBegin = event.queryEnd = -1;
+        if (gpuTiming)
+        {
+            event.queryBegin = nextQuery(slot);
+            glQueryCounter(slot.queries[event.queryBegin], GL_TIMESTAMP);
+        }
+        slot.events.push_back(event);
+        int index = (int)slot.events.size() - 1;
+        open.push_back(index);
+        return index;
+    }
+    void end(int index)
+    {
+        if (!enabled || index < 0)
+            return;
+        FrameSlot& slot = slots[frameIndex % FRAMES_IN_FLIGHT];
+        Event& event = slot.events[index];
+        event.cpuEnd = cpuNowNs();
+        if (gpuTiming)
+        {
+            event.queryEnd = nextQuery(slot);
+            glQueryCounter(slot.queries[event.queryEnd], GL_TIMESTAMP);
+        }
+        // scopes are strictly nested, but tolerate an out of order end
+        std::vector<int>::iterator it = std::find(open.begin(), open.end(), index);
+        if (it != open.end())
+            open.erase(it);
+    }
+
+    // name must outlive the profiler like the scope names; a second call in the same
+    // frame replaces the value
+    // ------------------------------------------------------------------------
+    void counter(const char* name, float value)
+    {
+        if (!enabled)
+            return;
+        int index = internCounter(name);
+        CounterHistory& c = counterHistory[index];
+        if (c.count > 0 && c.frame == frameIndex)
+            c.values[(c.count - 1) % HISTORY] = value;
+        else
+        {
+            c.values[c.count % HISTORY] = value;
+            ++c.count;
+            c.frame = frameIndex;
+        }
+        if (tracing && trace.size() + counterTrace.size() < maxTraceEvents)
+        {
+            CounterEvent e = { index, cpuNowNs(), value };
+            counterTrace.push_back(e);
+        }
+    }
+
+    // rolling statistics
+    // ------------------------------------------------------------------------
+    const std::vector<ScopeHistory>& scopes() const { return history; }
+    const std::vector<CounterHistory>& counters() const { return counterHistory; }
+    const ScopeHistory* scope(const char* name) const
+    {
+        for (size_t i = 0; i < history.size(); ++i)
+        {
+            if (std::strcmp(history[i].name, name) == 0)
+                return &history[i];
+        }
+        return NULL;
+    }
+    // p in [0, 1] over the retained history, 0 if the scope was never resolved
+    static float percentile(const ScopeHistory& h, float p, bool gpu)
+    {
+        unsigned int n = std::min(h.count, (unsigned int)HISTORY);
+        if (n == 0)
+            return 0.0f;
+        std::vector<float> sorted(gpu ? h.gpuMs : h.cpuMs, (gpu ? h.gpuMs : h.cpuMs) + n);
+        std::sort(sorted.begin(), sorted.end());
+        size_t k = (size_t)(p * (n - 1) + 0.5f);
+        return sorted[std::min(k, (size_t)n - 1)];
+    }
+    // one line per scope plus a bucketed histogram of the frame times
+    // ------------------------------------------------------------------------
+    void printHistogram(std::ostream& out) const
+    {
+        char line[160];
+        out << "profiler: " << frameIndex << " frames, " << droppedFrames << " dropped" << std::endl;
+        for (size_t i = 0; i < history.size(); ++i)
+        {
+            const ScopeHistory& h = history[i];
+            std::snprintf(line, sizeof(line), "  %-20s cpu p50 %7.3f p99 %7.3f   gpu p50 %7.3f p99 %7.3f ms",
+                          h.name, percentile(h, 0.5f, false), percentile(h, 0.99f, false),
+                          percentile(h, 0.5f, true), percentile(h, 0.99f, true));
+            out << line << std::endl;
+        }
+        for (size_t i = 0; i < counterHistory.size(); ++i)
+        {
+            const CounterHistory& c = counterHistory[i];
+            unsigned int n = std::min(c.count, (unsigned int)HISTORY);
+            if (n == 0)
+                continue;
+            float lo = c.values[0], hi = c.values[0];
+            for (unsigned int k = 1; k < n; ++k)
+            {
+                lo = std::min(lo, c.values[k]);
+                hi = std::max(hi, c.values[k]);
+            }
+            std::snprintf(line, sizeof(line), "  %-20s last %10.3f   min %10.3f max %10.3f", c.name,
+                          c.values[(c.count - 1) % HISTORY], lo, hi);
+            out << line << std::endl;
+        }
+        const ScopeHistory& frame = history[0];
+        unsigned int n = std::min(frame.count, (unsigned int)HISTORY);
+        // 2 ms buckets, the last one collects everything above
+        const int BUCKETS = 12;
+        int cpu[BUCKETS] = {0}, gpu[BUCKETS] = {0};
+        for (unsigned int i = 0; i < n; ++i)
+        {
+            ++cpu[std::min((int)(frame.cpuMs[i] / 2.0f), BUCKETS - 1)];
+            ++gpu[std::min((int)(frame.gpuMs[i] / 2.0f), BUCKETS - 1)];
+        }
+        for (int b = 0; b < BUCKETS; ++b)
+        {
+            std::snprintf(line, sizeof(line), "  %2d%s ms  cpu %-30.*s gpu %.*s", b * 2, b == BUCKETS - 1 ? "+" : " ",
+                          bar(cpu[b], n), "##############################", bar(gpu[b], n), "##############################");
+            out << line << std::endl;
+        }
+    }
+
+    // write everything collected while tracing was on, returns false if the file failed
+    // ------------------------------------------------------------------------
+    bool writeChromeTrace(const char* path) const
+    {
+        std::ofstream file(path, std::ios::trunc);
+        if (!file)
+            return false;
+        file << "{\"traceEvents\":[\n";
+        file << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,\"args\":{\"name\":\"CPU\"}},\n";
+        file << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":2,\"args\":{\"name\":\"GPU\"}}";
+        char line[256];
+        for (size_t i = 0; i < trace.size(); ++i)
+        {
+            const TraceEvent& e = trace[i];
+            file << ",\n{\"name\":";
+            writeJsonString(file, history[e.name].name);
+            std::snprintf(line, sizeof(line), ",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",
+                          e.gpu ? 2 : 1, e.beginNs / 1000.0, (e.endNs - e.beginNs) / 1000.0);
+            file << line;
+        }
+        for (size_t i = 0; i < counterTrace.size(); ++i)
+        {
+            const CounterEvent& e = counterTrace[i];
+            file << ",\n{\"name\":";
+            writeJsonString(file, counterHistory[e.counter].name);
+            std::snprintf(line, sizeof(line), ",\"ph\":\"C\",\"pid\":1,\"ts\":%.3f,\"args\":{\"value\":%g}}",
+                          e.ns / 1000.0, e.value);
+            file << line;
+        }
+        file << "\n]}\n";
+        return (bool)file;
+    }
+
+    // frame time bars in the bottom left corner, CPU in orange and GPU in blue, one
+    // pair per frame, with the 16.6 ms mark in grey. drawn with scissored clears so it
+    // needs no shader or buffer and leaves no state behind except the viewport scissor
+    // ------------------------------------------------------------------------
+    void drawOverlay(int framebufferWidth, int framebufferHeight)
+    {
+        if (!enabled || history[0].count == 0)
+            return;
+        int scope = begin("overlay");
+        const float MS_TO_PIXELS = 4.0f;
+        const int BAR = 2, FRAMES = std::min(120, framebufferWidth / (2 * BAR + 1));
+        float clearColor[4];
+        glGetFloatv(GL_COLOR_CLEAR_VALUE, clearColor);
+        glEnable(GL_SCISSOR_TEST);
+
+        fillRect(0, 0, FRAMES * (2 * BAR + 1), (int)(33.3f * MS_TO_PIXELS), 0.0f, 0.0f, 0.0f);
+        const ScopeHistory& frame = history[0];
+        unsigned int n = std::min(frame.count, (unsigned int)FRAMES);
+        for (unsigned int i = 0; i < n; ++i)
+        {
+            // oldest on the left
+            unsigned int sample = (frame.count - n + i) % HISTORY;
+            int x = (int)i * (2 * BAR + 1);
+            fillRect(x, 0, BAR, barHeight(frame.cpuMs[sample], MS_TO_PIXELS, framebufferHeight), 1.0f, 0.6f, 0.1f);
+            fillRect(x + BAR, 0, BAR, barHeight(frame.gpuMs[sample], MS_TO_PIXELS, framebufferHeight), 0.2f, 0.5f, 1.0f);
+        }
+        fillRect(0, (int)(16.6f * MS_TO_PIXELS), FRAMES * (2 * BAR + 1), 1, 0.6f, 0.6f, 0.6f);
+
+        glDisable(GL_SCISSOR_TEST);
+        glClearColor(clearColor[0], clearColor[1], clearColor[2], clearColor[3]);
+        end(scope);
+    }
+
+    // release the query objects, needs the context
+    // ------------------------------------------------------------------------
+    void release()
+    {
+        for (int i = 0; i < FRAMES_IN_FLIGHT; ++i)
+        {
+            if (!slots[i].queries.empty())
+                glDeleteQueries((GLsizei)slots[i].queries.size(), &slots[i].queries[0]);
+            slots[i].queries.clear();
+            slots[i].pending = false;
+        }
+    }
+
+    uint64_t frames() const { return frameIndex; }
+    uint64_t dropped() const { return droppedFrames; }
+
+private:
+    struct Event
+    {
+        int name;
+        int depth;
+        int64_t cpuBegin, cpuEnd;
+        int queryBegin, queryEnd;
+    };
+    struct FrameSlot
+    {
+        uint64_t frame;
+        bool pending;
+        std::vector<Event> events;
+        std::vector<unsigned int> queries;
+        int queryCount;
+    };
+    struct TraceEvent
+    {
+        int name;
+        bool gpu;
+        int64_t beginNs, endNs;
+    };
+    struct CounterEvent
+    {
+        int counter;
+        int64_t ns;
+        float value;
+    };
+
+    bool gpuTiming, enabled, tracing;
+    uint64_t frameIndex, droppedFrames;
+    size_t maxTraceEvents;
+    std::chrono::steady_clock::time_point epoch;
+    int64_t gpuToCpuNs;
+    FrameSlot slots[FRAMES_IN_FLIGHT];
+    std::vector<int> open;
+    std::vector<ScopeHistory> history;
+    std::vector<TraceEvent> trace;
+    std::vector<CounterHistory> counterHistory;
+    std::vector<CounterEvent> counterTrace;
+
+    int64_t cpuNowNs() const
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - epoch).count();
+    }
+    int intern(const char* name)
+    {
+        for (size_t i = 0; i < history.size(); ++i)
+        {
+            if (history[i].name == name || std::strcmp(history[i].name, name) == 0)
+                return (int)i;
+        }
+        ScopeHistory h;
+        std::memset(&h, 0, sizeof(h));
+        h.name = name;
+        history.push_back(h);
+        return (int)history.size() - 1;
+    }
+    int internCounter(const char* name)
+    {
+        for (size_t i = 0; i < counterHistory.size(); ++i)
+        {
+            if (counterHistory[i].name == name || std::strcmp(counterHistory[i].name, name) == 0)
+                return (int)i;
+        }
+        CounterHistory c;
+        std::memset(&c, 0, sizeof(c));
+        c.name = name;
+        counterHistory.push_back(c);
+        return (int)counterHistory.size() - 1;
+    }
+    int nextQuery(FrameSlot& slot)
+    {
+        if (slot.queryCount == (int)slot.queries.size())
+        {
+            // grow in chunks so the steady state never allocates
+            size_t old = slot.queries.size();
+            slot.queries.resize(old + 16);
+            glGenQueries(16, &slot.queries[old]);
+        }
+        return slot.queryCount++;
+    }
+    void resolve(FrameSlot& slot)
+    {
+        slot.pending = false;
+        if (slot.events.empty())
+            return;
+        if (gpuTiming && slot.queryCount > 0)
+        {
+            // the last query written that frame, if it is there all the others are as well
+            GLint available = 0;
+            glGetQueryObjectiv(slot.queries[slot.queryCount - 1], GL_QUERY_RESULT_AVAILABLE, &available);
+            if (!available)
+            {
+                ++droppedFrames;
+                return;
+            }
+        }
+        // a scope that ran several times this frame is summed into one sample
+        std::vector<float> cpu(history.size(), 0.0f), gpu(history.size(), 0.0f);
+        std::vector<bool> seen(history.size(), false);
+        for (size_t i = 0; i < slot.events.size(); ++i)
+        {
+            const Event& e = slot.events[i];
+            cpu[e.name] += (e.cpuEnd - e.cpuBegin) / 1e6f;
+            seen[e.name] = true;
+            int64_t gpuBegin = 0, gpuEnd = 0;
+            if (gpuTiming && e.queryEnd >= 0)
+            {
+                GLuint64 t0 = 0, t1 = 0;
+                glGetQueryObjectui64v(slot.queries[e.queryBegin], GL_QUERY_RESULT, &t0);
+                glGetQueryObjectui64v(slot.queries[e.queryEnd], GL_QUERY_RESULT, &t1);
+                gpuBegin = (int64_t)t0 + gpuToCpuNs;
+                gpuEnd = (int64_t)t1 + gpuToCpuNs;
+                gpu[e.name] += (gpuEnd - gpuBegin) / 1e6f;
+            }
+            if (tracing && trace.size() + 2 <= maxTraceEvents)
+            {
+                TraceEvent t = { e.name, false, e.cpuBegin, e.cpuEnd };
+                trace.push_back(t);
+                if (gpuTiming && e.queryEnd >= 0)
+                {
+                    TraceEvent g = { e.name, true, gpuBegin, gpuEnd };
+                    trace.push_back(g);
+                }
+            }
+        }
+        for (size_t i = 0; i < history.size(); ++i)
+        {
+            if (!seen[i])
+                continue;
+            ScopeHistory& h = history[i];
+            h.cpuMs[h.count % HISTORY] = cpu[i];
+            h.gpuMs[h.count % HISTORY] = gpu[i];
+            ++h.count;
+        }
+    }
+    static int bar(int count, unsigned int total)
+    {
+        return total ? (int)((count * 30 + total - 1) / total) : 0;
+    }
+    static int barHeight(float ms, float scale, int limit)
+    {
+        return std::max(1, std::min((int)(ms * scale), limit));
+    }
+    static void fillRect(int x, int y, int w, int h, float r, float g, float b)
+    {
+        glScissor(x, y, w, h);
+        glClearColor(r, g, b, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT);
+    }
+};
+
+// times the enclosing block
+// ------------------------------------------------------------------------
+class ProfileScope
+{
+public:
+    ProfileScope(Profiler& profiler, const char* name)
+        : profiler(profiler), index(profiler.begin(name))
+    {}
+    ~ProfileScope()
+    {
+        profiler.end(index);
+    }
+
+private:
+    Profiler& profiler;
+    int index;
+
+    ProfileScope(const ProfileScope&);
+    ProfileScope& operator=(const ProfileScope&);
+};
+#endif
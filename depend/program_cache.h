@@ -0,0 +1,188 @@
+#ifndef PROGRAM_CACHE_H
+#define PROGRAM_CACHE_H
+
+#include <glad/glad.h>
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <iostream>
+#include <cstring>
+#include <cstdio>
+#include <cstdint>
+
+#include <string_ref.h>
+
+#ifdef _WIN32
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#endif
+
+// on-disk cache of linked programs (glGetProgramBinary / glProgramBinary, core since 4.1).
+// an entry is keyed by a hash of both sources plus GL_VENDOR, GL_RENDERER and GL_VERSION,
+// so a driver update simply misses and recompiles. a stale or rejected binary is
+// detected by the link status after glProgramBinary and also falls back to compiling.
+// drivers without any binary format (GL_NUM_PROGRAM_BINARY_FORMATS == 0) disable it.
+class ProgramCache
+{
+public:
+    struct Stats
+    {
+        unsigned int hits;
+        unsigned int misses;
+        double hitMs;
+        double missMs;
+    };
+
+    // needs a current context
+    // ------------------------------------------------------------------------
+    explicit ProgramCache(const std::string& directory)
+        : directory(directory), available(false)
+    {
+        std::memset(&stats, 0, sizeof(stats));
+        int formats = 0;
+        glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+        available = formats > 0;
+        driver = glString(GL_VENDOR) + "\n" + glString(GL_RENDERER) + "\n" + glString(GL_VERSION);
+        if (available)
+            makeDirectory(directory);
+        else
+            std::cout << "SHADER::PROGRAM_CACHE::DISABLED driver exposes no program binary formats" << std::endl;
+    }
+
+    bool enabled() const { return available; }
+
+    // ------------------------------------------------------------------------
+    uint64_t key(StringRef vertexCode, StringRef fragmentCode) const
+    {
+        uint64_t hash = 14695981039346656037ull;
+        hash = fnv1a(hash, driver.data(), driver.size() + 1);
+        hash = fnv1a(hash, vertexCode.data, vertexCode.length);
+        // the separator keeps ("ab", "c") and ("a", "bc") apart
+        hash = fnv1a(hash, "\0", 1);
+        hash = fnv1a(hash, fragmentCode.data, fragmentCode.length);
+        return hash;
+    }
+
+    // try to restore program from the cache, true if it is linked and usable
+    // ------------------------------------------------------------------------
+    bool load(uint64_t key, unsigned int program)
+    {
+        if (!available)
+            return false;
+        std::ifstream file(path(key).c_str(), std::ios::binary);
+        if (!file)
+            return false;
+        FileHeader header;
+        if (!file.read((char*)&header, sizeof(header)) || std::memcmp(header.magic, "ORPB", 4) != 0 || header.key != key)
+            return false;
+        std::vector<char> binary(header.length);
+        if (header.length == 0 || !file.read(&binary[0], header.length))
+            return false;
+        glProgramBinary(program, header.format, &binary[0], (GLsizei)header.length);
+        int success = 0;
+        glGetProgramiv(program, GL_LINK_STATUS, &success);
+        return success != 0;
+    }
+    // write a freshly linked program, it must have been linked with
+    // GL_PROGRAM_BINARY_RETRIEVABLE_HINT set
+    // ------------------------------------------------------------------------
+    void store(uint64_t key, unsigned int program)
+    {
+        if (!available)
+            return;
+        int length = 0;
+        glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+        if (length <= 0)
+            return;
+        std::vector<char> binary(length);
+        FileHeader header;
+        std::memcpy(header.magic, "ORPB", 4);
+        header.key = key;
+        GLenum format = 0;
+        GLsizei written = 0;
+        glGetProgramBinary(program, length, &written, &format, &binary[0]);
+        if (written <= 0)
+            return;
+        header.format = format;
+        header.length = (uint32_t)written;
+        // write to a temporary name first so a crash never leaves a torn entry
+        std::string target = path(key), temporary = target + ".tmp";
+        {
+            std::ofstream file(temporary.c_str(), std::ios::binary | std::ios::trunc);
+            file.write((const char*)&header, sizeof(header));
+            file.write(&binary[0], written);
+            if (!file)
+                return;
+        }
+        std::remove(target.c_str());
+        std::rename(temporary.c_str(), target.c_str());
+    }
+
+    // bookkeeping for the timing log, called by Shader
+    // ------------------------------------------------------------------------
+    void recordHit(double ms)
+    {
+        ++stats.hits;
+        stats.hitMs += ms;
+    }
+    void recordMiss(double ms)
+    {
+        ++stats.misses;
+        stats.missMs += ms;
+    }
+    const Stats& statistics() const { return stats; }
+    void printStats(std::ostream& out) const
+    {
+        out << "program cache: " << stats.hits << " hits (" << stats.hitMs << " ms), "
+            << stats.misses << " misses (" << stats.missMs << " ms)" << std::endl;
+    }
+
+private:
+    struct FileHeader
+    {
+        char magic[4];
+        uint32_t format;
+        uint64_t key;
+        uint32_t length;
+        uint32_t reserved;
+
+        FileHeader() : format(0), key(0), length(0), reserved(0) { std::memset(magic, 0, 4); }
+    };
+
+    std::string directory;
+    std::string driver;
+    bool available;
+    Stats stats;
+
+    std::string path(uint64_t key) const
+    {
+        char name[32];
+        std::snprintf(name, sizeof(name), "%016llx.bin", (unsigned long long)key);
+        return directory + "/" + name;
+    }
+    static uint64_t fnv1a(uint64_t hash, const char* data, size_t size)
+    {
+        for (size_t i = 0; i < size; ++i)
+        {
+            hash ^= (unsigned char)data[i];
+            hash *= 1099511628211ull;
+        }
+        return hash;
+    }
+    static std::string glString(GLenum name)
+    {
+        const char* value = (const char*)glGetString(name);
+        return value ? value : "";
+    }
+    static void makeDirectory(const std::string& directory)
+    {
+#ifdef _WIN32
+        _mkdir(directory.c_str());
+#else
+        mkdir(directory.c_str(), 0755);
+#endif
+    }
+};
+#endif
@@ -0,0 +1,320 @@
+#ifndef RENDER_QUEUE_H
+#define RENDER_QUEUE_H
+
+#include <glad/glad.h>
+
+#include <gl_state.h>
+
+#include <vector>
+#include <algorithm>
+#include <cstring>
+#include <cstdint>
+#include <iostream>
+
+// records draws instead of issuing them. submit() sorts the frame's items by a 64-bit
+// key, program -> texture set -> VAO -> depth, merges neighbours that draw adjacent
+// index ranges with identical state, and replays the result through a GLStateCache so
+// every program, texture and VAO is bound once per run of equal items.
+//
+//     queue.begin(shader.ID, VAO, 6);
+//     queue.texture(0, GL_TEXTURE_2D, texture1);
+//     queue.uniformMat4(shader.location(transformLoc), glm::value_ptr(transform));
+//     queue.depth(z);
+//     ...
+//     queue.submit(glState);      // also clears the queue for the next frame
+//
+// items and uniform values live in flat arrays that are cleared, not freed, per
+// frame, so after the first frames recording allocates nothing.
+class RenderQueue
+{
+public:
+    static const int MAX_TEXTURES = 4;
+
+    struct Stats
+    {
+        unsigned long items;
+        unsigned long draws;
+        // items folded into the previous draw
+        unsigned long merged;
+    };
+
+    RenderQueue()
+    {
+        std::memset(&stats, 0, sizeof(stats));
+    }
+
+    // start a new item, the calls below fill it in
+    // ------------------------------------------------------------------------
+    void begin(unsigned int program, unsigned int vao, unsigned int indexCount,
+               GLenum indexType = GL_UNSIGNED_INT, size_t indexOffset = 0, GLenum mode = GL_TRIANGLES)
+    {
+        DrawItem item;
+        std::memset(&item, 0, sizeof(item));
+        item.program = program;
+        item.vao = vao;
+        item.mode = mode;
+        item.indexType = indexType;
+        item.indexCount = indexCount;
+        item.indexOffset = indexOffset;
+        item.instanceCount = 1;
+        item.firstUniform = (unsigned int)uniforms.size();
+        item.uniformBlock.binding = NO_BLOCK;
+        items.push_back(item);
+    }
+    void texture(unsigned int unit, GLenum target, unsigned int texture)
+    {
+        DrawItem& item = items.back();
+        if (item.textureCount == MAX_TEXTURES)
+        {
+            std::cout << "ERROR::RENDER_QUEUE::TOO_MANY_TEXTURES" << std::endl;
+            return;
+        }
+        TextureBinding& binding = item.textures[item.textureCount++];
+        binding.unit = unit;
+        binding.target = target;
+        binding.texture = texture;
+    }
+    void instances(unsigned int count) { items.back().instanceCount = count; }
+    // 0 is nearest; used for the lowest bits of the key, so it only orders items whose
+    // state is identical anyway and never costs a state change
+    void depth(float value) { items.back().depth = value; }
+    // a glBindBufferRange(GL_UNIFORM_BUFFER) for this item, e.g. its ObjectBlock
+    void uniformBlock(unsigned int binding, unsigned int buffer, size_t offset, size_t size)
+    {
+        UniformBlockRange& block = items.back().uniformBlock;
+        block.binding = binding;
+        block.buffer = buffer;
+        block.offset = offset;
+        block.size = size;
+    }
+
+    // uniform values are copied, locations come from Shader::location()
+    // ------------------------------------------------------------------------
+    void uniformInt(int location, int value)
+    {
+        UniformValue& u = addUniform(location, GL_INT);
+        u.i = value;
+    }
+    void uniformFloat(int location, float value)
+    {
+        UniformValue& u = addUniform(location, GL_FLOAT);
+        u.f[0] = value;
+    }
+    void uniformVec4(int location, float x, float y, float z, float w)
+    {
+        UniformValue& u = addUniform(location, GL_FLOAT_VEC4);
+        u.f[0] = x;
+        u.f[1] = y;
+        u.f[2] = z;
+        u.f[3] = w;
+    }
+    void uniformMat4(int location, const float* value)
+    {
+        UniformValue& u = addUniform(location, GL_FLOAT_MAT4);
+        std::memcpy(u.f, value, 16 * sizeof(float));
+    }
+
+    // sort, merge and issue everything recorded since the last submit
+    // ------------------------------------------------------------------------
+    void submit(GLStateCache& state)
+    {
+        buildKeys();
+        std::sort(order.begin(), order.end());
+
+        stats.items += items.size();
+        size_t i = 0;
+        while (i < order.size())
+        {
+            const DrawItem& first = items[order[i].index];
+            unsigned int count = first.indexCount;
+            // fold following items that continue the same index range with the same state
+            size_t j = i + 1;
+            while (j < order.size() && mergeable(items[order[j - 1].index], items[order[j].index]))
+            {
+                count += items[order[j].index].indexCount;
+                ++j;
+            }
+            stats.merged += j - i - 1;
+            issue(first, count, state);
+            i = j;
+        }
+
+        items.clear();
+        uniforms.clear();
+        order.clear();
+        textureSets.clear();
+    }
+
+    size_t size() const { return items.size(); }
+    const Stats& statistics() const { return stats; }
+    void printStats(std::ostream& out) const
+    {
+        out << "render queue: " << stats.items << " items, " << stats.draws << " draws, "
+            << stats.merged << " merged" << std::endl;
+    }
+
+private:
+    static const unsigned int NO_BLOCK = 0xFFFFFFFFu;
+
+    struct TextureBinding
+    {
+        unsigned int unit;
+        GLenum target;
+        unsigned int texture;
+    };
+    struct UniformBlockRange
+    {
+        unsigned int binding;
+        unsigned int buffer;
+        size_t offset, size;
+    };
+    struct UniformValue
+    {
+        int location;
+        GLenum type;
+        int i;
+        float f[16];
+    };
+    struct DrawItem
+    {
+        unsigned int program, vao;
+        GLenum mode, indexType;
+        unsigned int indexCount, instanceCount;
+        size_t indexOffset;
+        float depth;
+        TextureBinding textures[MAX_TEXTURES];
+        unsigned int textureCount;
+        UniformBlockRange uniformBlock;
+        unsigned int firstUniform, uniformCount;
+    };
+    struct SortEntry
+    {
+        uint64_t key;
+        // recording order breaks ties, so equal keys replay deterministically
+        unsigned int index;
+        bool operator<(const SortEntry& other) const
+        {
+            return key != other.key ? key < other.key : index < other.index;
+        }
+    };
+
+    std::vector<DrawItem> items;
+    std::vector<UniformValue> uniforms;
+    std::vector<SortEntry> order;
+    // distinct texture sets of this frame, an item's set id is its position here
+    std::vector<unsigned int> textureSets;
+    Stats stats;
+
+    UniformValue& addUniform(int location, GLenum type)
+    {
+        UniformValue u;
+        // zeroed so sameState() can compare whole values
+        std::memset(&u, 0, sizeof(u));
+        u.location = location;
+        u.type = type;
+        uniforms.push_back(u);
+        ++items.back().uniformCount;
+        return uniforms.back();
+    }
+
+    // 16 bits program | 16 bits texture set | 16 bits VAO | 16 bits depth
+    // ------------------------------------------------------------------------
+    void buildKeys()
+    {
+        order.resize(items.size());
+        for (size_t i = 0; i < items.size(); ++i)
+        {
+            const DrawItem& item = items[i];
+            float d = std::min(std::max(item.depth, 0.0f), 1.0f);
+            uint64_t key = (uint64_t)(item.program & 0xFFFF) << 48;
+            key |= (uint64_t)(textureSet(item) & 0xFFFF) << 32;
+            key |= (uint64_t)(item.vao & 0xFFFF) << 16;
+            key |= (uint64_t)(d * 65535.0f);
+            order[i].key = key;
+            order[i].index = (unsigned int)i;
+        }
+    }
+    // intern the item's bindings; the set is stored as MAX_TEXTURES * 3 words
+    unsigned int textureSet(const DrawItem& item)
+    {
+        const size_t WORDS = MAX_TEXTURES * 3;
+        unsigned int set[WORDS];
+        std::memset(set, 0, sizeof(set));
+        for (unsigned int t = 0; t < item.textureCount; ++t)
+        {
+            set[t * 3 + 0] = item.textures[t].unit + 1;
+            set[t * 3 + 1] = item.textures[t].target;
+            set[t * 3 + 2] = item.textures[t].texture;
+        }
+        for (size_t s = 0; s < textureSets.size(); s += WORDS)
+        {
+            if (std::memcmp(&textureSets[s], set, sizeof(set)) == 0)
+                return (unsigned int)(s / WORDS);
+        }
+        textureSets.insert(textureSets.end(), set, set + WORDS);
+        return (unsigned int)(textureSets.size() / WORDS - 1);
+    }
+
+    bool sameState(const DrawItem& a, const DrawItem& b) const
+    {
+        if (a.program != b.program || a.vao != b.vao || a.mode != b.mode || a.indexType != b.indexType)
+            return false;
+        if (a.textureCount != b.textureCount ||
+            std::memcmp(a.textures, b.textures, a.textureCount * sizeof(TextureBinding)) != 0)
+            return false;
+        if (a.uniformBlock.binding != b.uniformBlock.binding ||
+            (a.uniformBlock.binding != NO_BLOCK &&
+             (a.uniformBlock.buffer != b.uniformBlock.buffer || a.uniformBlock.offset != b.uniformBlock.offset ||
+              a.uniformBlock.size != b.uniformBlock.size)))
+            return false;
+        if (a.uniformCount != b.uniformCount)
+            return false;
+        for (unsigned int u = 0; u < a.uniformCount; ++u)
+        {
+            const UniformValue& ua = uniforms[a.firstUniform + u];
+            const UniformValue& ub = uniforms[b.firstUniform + u];
+            if (ua.location != ub.location || ua.type != ub.type || ua.i != ub.i ||
+                std::memcmp(ua.f, ub.f, sizeof(ua.f)) != 0)
+                return false;
+        }
+        return true;
+    }
+    // b continues a's index range with the same state: one draw covers both
+    bool mergeable(const DrawItem& a, const DrawItem& b) const
+    {
+        if (a.instanceCount != 1 || b.instanceCount != 1 || a.mode != GL_TRIANGLES)
+            return false;
+        size_t indexSize = a.indexType == GL_UNSIGNED_SHORT ? 2 : a.indexType == GL_UNSIGNED_BYTE ? 1 : 4;
+        return b.indexOffset == a.indexOffset + a.indexCount * indexSize && sameState(a, b);
+    }
+
+    void issue(const DrawItem& item, unsigned int indexCount, GLStateCache& state)
+    {
+        state.useProgram(item.program);
+        for (unsigned int t = 0; t < item.textureCount; ++t)
+            state.bindTextureUnit(item.textures[t].unit, item.textures[t].target, item.textures[t].texture);
+        state.bindVertexArray(item.vao);
+        if (item.uniformBlock.binding != NO_BLOCK)
+            state.bindUniformRange(item.uniformBlock.binding, item.uniformBlock.buffer,
+                                   (GLintptr)item.uniformBlock.offset, (GLsizeiptr)item.uniformBlock.size);
+        for (unsigned int u = 0; u < item.uniformCount; ++u)
+        {
+            const UniformValue& v = uniforms[item.firstUniform + u];
+            switch (v.type)
+            {
+                case GL_INT:        glUniform1i(v.location, v.i); break;
+                case GL_FLOAT:      glUniform1f(v.location, v.f[0]); break;
+                case GL_FLOAT_VEC4: glUniform4f(v.location, v.f[0], v.f[1], v.f[2], v.f[3]); break;
+                case GL_FLOAT_MAT4: glUniformMatrix4fv(v.location, 1, GL_FALSE, v.f); break;
+                default: break;
+            }
+        }
+        const void* offset = (const void*)(uintptr_t)item.indexOffset;
+        if (item.instanceCount == 1)
+            glDrawElements(item.mode, (GLsizei)indexCount, item.indexType, offset);
+        else
+            glDrawElementsInstanced(item.mode, (GLsizei)indexCount, item.indexType, offset, (GLsizei)item.instanceCount);
+        ++stats.draws;
+    }
+};
+#endif
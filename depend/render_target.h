@@ -0,0 +1,261 @@
+#ifndef RENDER_TARGET_H
+#define RENDER_TARGET_H
+
+#include <glad/glad.h>
+
+#include <gl_state.h>
+
+#include <cmath>
+#include <algorithm>
+#include <iostream>
+
+// an offscreen color (+ depth/stencil) target that the scene is drawn into at a fraction
+// of the window's framebuffer size, optionally multisampled, and then scaled up into the
+// default framebuffer with glBlitFramebuffer. on high-DPI displays this trades pixels for
+// fill rate without touching the draw code.
+//
+//     RenderTarget scene(4);                      // 4x MSAA
+//     while (...)
+//     {
+//         scene.setScale(resolution.scale());
+//         scene.begin(glState, framebufferWidth, framebufferHeight);
+//         glClear(...); draw...;
+//         scene.present(framebufferWidth, framebufferHeight);
+//         // overlays at full resolution into the default framebuffer
+//
+// the attachments are allocated for the window size times maxScale and only reallocated
+// when the window size changes, so changing the scale every frame costs nothing: the
+// scene is drawn into the lower left width() x height() of them. with MSAA the samples
+// are first resolved into the single-sample texture at the same size (a multisample
+// blit cannot scale, and the default framebuffer's format is unknown), then that is
+// scaled to the window with GL_LINEAR. colorTexture() holds the resolved image for
+// post-processing; sample it with uv * uvScale().
+class RenderTarget
+{
+public:
+    struct Stats
+    {
+        unsigned int reallocations;
+        unsigned long frames;
+        // frames drawn below the window resolution
+        unsigned long scaledFrames;
+    };
+
+    // samples 0 or 1 for no MSAA, clamped to GL_MAX_SAMPLES
+    // ------------------------------------------------------------------------
+    explicit RenderTarget(int samples = 0, bool depth = true, float maxScale = 1.0f)
+        : samples(samples), depth(depth), currentScale(maxScale), maxScale(maxScale), windowWidth(0), windowHeight(0),
+          allocatedWidth(0), allocatedHeight(0), drawWidth(0), drawHeight(0), resolveFBO(0), resolveColor(0),
+          resolveDepth(0), msaaFBO(0), msaaColor(0), msaaDepth(0)
+    {
+        stats.reallocations = 0;
+        stats.frames = stats.scaledFrames = 0;
+        int maxSamples = 0;
+        glGetIntegerv(GL_MAX_SAMPLES, &maxSamples);
+        if (this->samples > maxSamples)
+            this->samples = maxSamples;
+        if (this->samples < 2)
+            this->samples = 0;
+    }
+    // must run while the context is still alive
+    // ------------------------------------------------------------------------
+    void release()
+    {
+        glDeleteFramebuffers(1, &resolveFBO);
+        glDeleteTextures(1, &resolveColor);
+        glDeleteRenderbuffers(1, &resolveDepth);
+        glDeleteFramebuffers(1, &msaaFBO);
+        glDeleteRenderbuffers(1, &msaaColor);
+        glDeleteRenderbuffers(1, &msaaDepth);
+        resolveFBO = resolveColor = resolveDepth = 0;
+        msaaFBO = msaaColor = msaaDepth = 0;
+        allocatedWidth = allocatedHeight = 0;
+    }
+
+    // fraction of the window resolution per axis, (0, maxScale]
+    void setScale(float scale) { currentScale = std::min(std::max(scale, 0.05f), maxScale); }
+    float scale() const { return currentScale; }
+
+    // bind the target and set the viewport to the scaled size; (re)allocates the
+    // attachments on the first call and after a window resize. the color texture is
+    // bound through state on whatever unit is active, so the cache stays in sync
+    // ------------------------------------------------------------------------
+    void begin(GLStateCache& state, int framebufferWidth, int framebufferHeight)
+    {
+        if (framebufferWidth != windowWidth || framebufferHeight != windowHeight || !resolveFBO)
+            allocate(state, framebufferWidth, framebufferHeight);
+        drawWidth = std::min(std::max((int)(framebufferWidth * currentScale + 0.5f), 1), allocatedWidth);
+        drawHeight = std::min(std::max((int)(framebufferHeight * currentScale + 0.5f), 1), allocatedHeight);
+        glBindFramebuffer(GL_FRAMEBUFFER, samples ? msaaFBO : resolveFBO);
+        glViewport(0, 0, drawWidth, drawHeight);
+    }
+    // resolve, scale into the default framebuffer and leave that bound with a
+    // full-window viewport
+    // ------------------------------------------------------------------------
+    void present(int framebufferWidth, int framebufferHeight)
+    {
+        if (samples)
+        {
+            glBindFramebuffer(GL_READ_FRAMEBUFFER, msaaFBO);
+            glBindFramebuffer(GL_DRAW_FRAMEBUFFER, resolveFBO);
+            glBlitFramebuffer(0, 0, drawWidth, drawHeight, 0, 0, drawWidth, drawHeight, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+        }
+        bool scaled = drawWidth != framebufferWidth || drawHeight != framebufferHeight;
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, resolveFBO);
+        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+        glBlitFramebuffer(0, 0, drawWidth, drawHeight, 0, 0, framebufferWidth, framebufferHeight, GL_COLOR_BUFFER_BIT,
+                          scaled ? GL_LINEAR : GL_NEAREST);
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        glViewport(0, 0, framebufferWidth, framebufferHeight);
+        ++stats.frames;
+        if (scaled)
+            ++stats.scaledFrames;
+    }
+
+    // the size drawn this frame
+    int width() const { return drawWidth; }
+    int height() const { return drawHeight; }
+    int sampleCount() const { return samples; }
+    unsigned int colorTexture() const { return resolveColor; }
+    // the drawn part of colorTexture()
+    float uvScaleX() const { return allocatedWidth ? (float)drawWidth / allocatedWidth : 1.0f; }
+    float uvScaleY() const { return allocatedHeight ? (float)drawHeight / allocatedHeight : 1.0f; }
+    const Stats& statistics() const { return stats; }
+
+private:
+    int samples;
+    bool depth;
+    float currentScale, maxScale;
+    int windowWidth, windowHeight;
+    int allocatedWidth, allocatedHeight;
+    int drawWidth, drawHeight;
+    // single sample: the scene target without MSAA, the resolve target with it
+    unsigned int resolveFBO, resolveColor, resolveDepth;
+    unsigned int msaaFBO, msaaColor, msaaDepth;
+    Stats stats;
+
+    // ------------------------------------------------------------------------
+    void allocate(GLStateCache& state, int framebufferWidth, int framebufferHeight)
+    {
+        release();
+        windowWidth = framebufferWidth;
+        windowHeight = framebufferHeight;
+        allocatedWidth = std::max((int)std::ceil(framebufferWidth * maxScale), 1);
+        allocatedHeight = std::max((int)std::ceil(framebufferHeight * maxScale), 1);
+        ++stats.reallocations;
+
+        glGenFramebuffers(1, &resolveFBO);
+        glBindFramebuffer(GL_FRAMEBUFFER, resolveFBO);
+        glGenTextures(1, &resolveColor);
+        state.bindTexture(GL_TEXTURE_2D, resolveColor);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, allocatedWidth, allocatedHeight, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+        state.bindTexture(GL_TEXTURE_2D, 0);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, resolveColor, 0);
+        // the resolve target only receives color
+        if (depth && !samples)
+        {
+            glGenRenderbuffers(1, &resolveDepth);
+            glBindRenderbuffer(GL_RENDERBUFFER, resolveDepth);
+            glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, allocatedWidth, allocatedHeight);
+            glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, resolveDepth);
+        }
+        checkComplete("RESOLVE");
+
+        if (samples)
+        {
+            glGenFramebuffers(1, &msaaFBO);
+            glBindFramebuffer(GL_FRAMEBUFFER, msaaFBO);
+            glGenRenderbuffers(1, &msaaColor);
+            glBindRenderbuffer(GL_RENDERBUFFER, msaaColor);
+            glRenderbufferStorageMultisample(GL_RENDERBUFFER, samples, GL_RGBA8, allocatedWidth, allocatedHeight);
+            glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, msaaColor);
+            if (depth)
+            {
+                glGenRenderbuffers(1, &msaaDepth);
+                glBindRenderbuffer(GL_RENDERBUFFER, msaaDepth);
+                glRenderbufferStorageMultisample(GL_RENDERBUFFER, samples, GL_DEPTH24_STENCIL8, allocatedWidth, allocatedHeight);
+                glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, msaaDepth);
+            }
+            checkComplete("MSAA");
+        }
+        glBindRenderbuffer(GL_RENDERBUFFER, 0);
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    }
+    void checkComplete(const char* which) const
+    {
+        GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+        if (status != GL_FRAMEBUFFER_COMPLETE)
+            std::cout << "ERROR::RENDER_TARGET::" << which << "_FRAMEBUFFER_INCOMPLETE 0x" << std::hex << status << std::dec
+                      << std::endl;
+    }
+
+    RenderTarget(const RenderTarget&);
+    RenderTarget& operator=(const RenderTarget&);
+};
+
+// picks the render scale from measured GPU frame times so the frame stays within a
+// budget. the cost of a fill-rate bound frame grows with the pixel count, i.e. with
+// scale squared, so an over-budget frame scales down by sqrt(budget / time) at once;
+// under 80% of the budget the scale creeps back up by STEP. the times are smoothed and
+// after a change the next SETTLE_FRAMES results are ignored, they were measured before
+// the change reached the GPU (Profiler reads its queries FRAMES_IN_FLIGHT frames late).
+//
+//     const Profiler::ScopeHistory* frame = profiler.scope("frame");
+//     if (frame->count != lastCount)          // a new GPU time was resolved
+//         scene.setScale(resolution.update(frame->gpuMs[(frame->count - 1) % Profiler::HISTORY]));
+class DynamicResolution
+{
+public:
+    static const int SETTLE_FRAMES = 4;
+    // scales are multiples of STEP, so small jitter in the times does not change them
+    static constexpr float STEP = 1.0f / 32.0f;
+
+    explicit DynamicResolution(float budgetMs = 14.0f, float minScale = 0.5f, float maxScale = 1.0f)
+        : budgetMs(budgetMs), minScale(minScale), maxScale(maxScale), current(maxScale), smoothedMs(0.0f), cooldown(0)
+    {}
+
+    // the GPU time of one finished frame, returns the scale to render at from now on
+    // ------------------------------------------------------------------------
+    float update(float gpuMs)
+    {
+        if (gpuMs <= 0.0f)
+            return current;
+        smoothedMs = smoothedMs == 0.0f ? gpuMs : smoothedMs + 0.25f * (gpuMs - smoothedMs);
+        if (cooldown > 0)
+        {
+            --cooldown;
+            return current;
+        }
+        float next = current;
+        if (smoothedMs > budgetMs)
+            next = std::min(current * std::sqrt(budgetMs / smoothedMs), current - STEP);
+        else if (smoothedMs < 0.8f * budgetMs)
+            next = current + STEP;
+        next = std::floor(next / STEP + 0.5f) * STEP;
+        next = std::min(std::max(next, minScale), maxScale);
+        if (next != current)
+        {
+            current = next;
+            cooldown = SETTLE_FRAMES;
+            // the old times belong to the old resolution
+            smoothedMs = 0.0f;
+        }
+        return current;
+    }
+
+    float scale() const { return current; }
+    float smoothedGpuMs() const { return smoothedMs; }
+    void setBudget(float ms) { budgetMs = ms; }
+
+private:
+    float budgetMs;
+    float minScale, maxScale;
+    float current;
+    float smoothedMs;
+    int cooldown;
+};
+#endif
@@ -0,0 +1,225 @@
+#ifndef RENDER_THREAD_H
+#define RENDER_THREAD_H
+
+#include <GLFW/glfw3.h>
+
+#include <spsc_queue.h>
+
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <vector>
+#include <algorithm>
+#include <functional>
+#include <iostream>
+
+// runs GL submission and glfwSwapBuffers on a thread of its own, so a spike in
+// simulation on the main thread no longer stalls the frame that is being drawn.
+//
+// there are PacketCount frame packets. the main thread takes a free one, fills it
+// (transforms, draw list, ...) and submits it; from then on it is immutable and the
+// render thread draws it, swaps, and hands it back. both hand-offs are SPSC queues,
+// so the main thread runs at most PacketCount - 1 frames ahead of the one on screen.
+//
+//     RenderThread<Packet> renderer(window, render);   // context is moved over
+//     while (...) {
+//         glfwPollEvents();                            // events stay on the main thread
+//         Packet* packet = renderer.acquire();
+//         simulate(*packet);
+//         renderer.submit(packet);
+//     }
+//     renderer.stop();                                 // context comes back
+//
+// the render callback runs with the context current on the render thread; GL objects
+// are best created before the thread starts and deleted after stop().
+template <typename Packet, size_t PacketCount = 2>
+class RenderThread
+{
+public:
+    typedef std::function<void(const Packet&)> RenderFunction;
+
+    // frame pacing, in milliseconds
+    struct Stats
+    {
+        unsigned long frames;
+        // main thread blocked in acquire() because the render thread was behind
+        double mainBlockedMs;
+        // render thread idle because no packet was ready
+        double renderStarvedMs;
+        // submit() to start of render, the queueing latency
+        double latencyP50, latencyP99;
+        // time between consecutive swaps
+        double intervalP50, intervalP99;
+    };
+
+    // release the context on the calling thread and start the render thread with it
+    // ------------------------------------------------------------------------
+    RenderThread(GLFWwindow* window, RenderFunction render)
+        : window(window), render(render), running(true), frames(0), mainBlockedNs(0), renderStarvedNs(0)
+    {
+        for (size_t i = 0; i < PacketCount; ++i)
+        {
+            slots[i].submitted = Clock::time_point();
+            freeSlots.push(&slots[i]);
+        }
+        latencies.reserve(HISTORY);
+        intervals.reserve(HISTORY);
+        glfwMakeContextCurrent(NULL);
+        thread = std::thread(&RenderThread::run, this);
+    }
+    ~RenderThread()
+    {
+        stop();
+    }
+
+    // main thread: a packet to fill, waits while every packet is queued or drawn
+    // ------------------------------------------------------------------------
+    Packet* acquire()
+    {
+        Slot* slot = NULL;
+        if (!freeSlots.pop(slot))
+        {
+            Clock::time_point start = Clock::now();
+            while (!freeSlots.pop(slot))
+                std::this_thread::yield();
+            mainBlockedNs += nanosecondsSince(start);
+        }
+        return &slot->packet;
+    }
+    // main thread: hand a filled packet from acquire() to the render thread
+    // ------------------------------------------------------------------------
+    void submit(Packet* packet)
+    {
+        Slot* slot = slotOf(packet);
+        slot->submitted = Clock::now();
+        // never fails, there are only PacketCount slots and the queue holds them all
+        readySlots.push(slot);
+    }
+
+    // main thread: draw what is queued, join, and make the context current here again
+    // ------------------------------------------------------------------------
+    void stop()
+    {
+        if (!thread.joinable())
+            return;
+        running.store(false, std::memory_order_release);
+        thread.join();
+        glfwMakeContextCurrent(window);
+    }
+
+    // after stop()
+    // ------------------------------------------------------------------------
+    Stats statistics() const
+    {
+        Stats stats;
+        stats.frames = frames;
+        stats.mainBlockedMs = mainBlockedNs / 1e6;
+        stats.renderStarvedMs = renderStarvedNs / 1e6;
+        stats.latencyP50 = percentile(latencies, 0.5);
+        stats.latencyP99 = percentile(latencies, 0.99);
+        stats.intervalP50 = percentile(intervals, 0.5);
+        stats.intervalP99 = percentile(intervals, 0.99);
+        return stats;
+    }
+    void printStats(std::ostream& out) const
+    {
+        Stats s = statistics();
+        out << "render thread: " << s.frames << " frames, main blocked " << s.mainBlockedMs << " ms, render starved "
+            << s.renderStarvedMs << " ms" << std::endl;
+        out << "  latency p50 " << s.latencyP50 << " ms, p99 " << s.latencyP99 << " ms; frame interval p50 "
+            << s.intervalP50 << " ms, p99 " << s.intervalP99 << " ms" << std::endl;
+    }
+
+private:
+    typedef std::chrono::steady_clock Clock;
+    // samples kept for the percentiles
+    static const size_t HISTORY = 1024;
+
+    struct Slot
+    {
+        Packet packet;
+        Clock::time_point submitted;
+    };
+
+    GLFWwindow* window;
+    RenderFunction render;
+    Slot slots[PacketCount];
+    // render -> main and main -> render, each can hold all PacketCount slots
+    SpscQueue<Slot*, spscCapacityFor(PacketCount)> freeSlots;
+    SpscQueue<Slot*, spscCapacityFor(PacketCount)> readySlots;
+    std::thread thread;
+    std::atomic<bool> running;
+
+    // written by the render thread, read after join
+    unsigned long frames;
+    long long mainBlockedNs;
+    long long renderStarvedNs;
+    std::vector<double> latencies, intervals;
+
+    Slot* slotOf(Packet* packet)
+    {
+        for (size_t i = 0; i < PacketCount; ++i)
+        {
+            if (&slots[i].packet == packet)
+                return &slots[i];
+        }
+        return NULL;
+    }
+    static long long nanosecondsSince(Clock::time_point start)
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+    }
+    static void record(std::vector<double>& samples, double value, unsigned long index)
+    {
+        if (samples.size() < HISTORY)
+            samples.push_back(value);
+        else
+            samples[index % HISTORY] = value;
+    }
+    static double percentile(std::vector<double> samples, double p)
+    {
+        if (samples.empty())
+            return 0.0;
+        std::sort(samples.begin(), samples.end());
+        size_t k = (size_t)(p * (samples.size() - 1) + 0.5);
+        return samples[std::min(k, samples.size() - 1)];
+    }
+
+    void run()
+    {
+        glfwMakeContextCurrent(window);
+        Clock::time_point lastSwap = Clock::now();
+        for (;;)
+        {
+            Slot* slot = NULL;
+            if (!readySlots.pop(slot))
+            {
+                // drain whatever was submitted before stop()
+                if (!running.load(std::memory_order_acquire) && readySlots.empty())
+                    break;
+                Clock::time_point start = Clock::now();
+                while (!readySlots.pop(slot) && running.load(std::memory_order_acquire))
+                    std::this_thread::yield();
+                renderStarvedNs += nanosecondsSince(start);
+                if (!slot)
+                    continue;
+            }
+            Clock::time_point begin = Clock::now();
+            record(latencies, std::chrono::duration<double, std::milli>(begin - slot->submitted).count(), frames);
+
+            render(slot->packet);
+            glfwSwapBuffers(window);
+
+            Clock::time_point now = Clock::now();
+            record(intervals, std::chrono::duration<double, std::milli>(now - lastSwap).count(), frames);
+            lastSwap = now;
+            ++frames;
+            freeSlots.push(slot);
+        }
+        glfwMakeContextCurrent(NULL);
+    }
+
+    RenderThread(const RenderThread&);
+    RenderThread& operator=(const RenderThread&);
+};
+#endif
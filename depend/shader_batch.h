@@ -0,0 +1,86 @@
+#ifndef SHADER_BATCH_H
+#define SHADER_BATCH_H
+
+#include <glad/glad.h>
+
+#include <shader_s.h>
+#include <gl_ext.h>
+
+#include <deque>
+#include <chrono>
+#include <iostream>
+
+// builds many programs at once: add() submits the compile and link of every program
+// right away and only get() reads status and logs, so with GL_KHR_parallel_shader_compile
+// all of them compile concurrently on the driver's threads while the application does
+// other work (loading textures, ...). without the extension it still defers every
+// status query to the end, which lets drivers with a threaded compiler overlap the work.
+class ShaderBatch
+{
+public:
+    explicit ShaderBatch(ProgramCache* cache = NULL)
+        : cache(cache), waitMs(0.0)
+    {
+        // let the driver pick as many compiler threads as it wants
+        if (glExt().parallelShaderCompile)
+            glExt().MaxShaderCompilerThreads(0xFFFFFFFFu);
+    }
+
+    // read both files and submit, returns the index for get()
+    // ------------------------------------------------------------------------
+    int add(const char* vertexPath, const char* fragmentPath)
+    {
+        std::string vertexCode, fragmentCode;
+        if (!Shader::readFile(vertexPath, vertexCode) || !Shader::readFile(fragmentPath, fragmentCode))
+            std::cout << "ERROR::SHADER::FILE_NOT_SUCCESFULLY_READ " << vertexPath << " " << fragmentPath << std::endl;
+        return addSource(vertexCode, fragmentCode);
+    }
+    int addSource(const std::string& vertexCode, const std::string& fragmentCode)
+    {
+        shaders.push_back(Shader());
+        shaders.back().submit(vertexCode, fragmentCode, cache);
+        return (int)shaders.size() - 1;
+    }
+
+    // non-blocking poll, e.g. to draw with a fallback until a program is done
+    // ------------------------------------------------------------------------
+    bool ready(int index) const { return shaders[index].ready(); }
+    int readyCount() const
+    {
+        int count = 0;
+        for (size_t i = 0; i < shaders.size(); ++i)
+            count += shaders[i].ready() ? 1 : 0;
+        return count;
+    }
+
+    // the finished program, blocks only if the driver has not completed it yet.
+    // references stay valid while more programs are added
+    // ------------------------------------------------------------------------
+    Shader& get(int index)
+    {
+        Shader& shader = shaders[index];
+        if (shader.pending())
+        {
+            std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+            shader.finish();
+            waitMs += std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+        }
+        return shader;
+    }
+    void finishAll()
+    {
+        for (size_t i = 0; i < shaders.size(); ++i)
+            get((int)i);
+    }
+
+    int size() const { return (int)shaders.size(); }
+    // time spent blocked in get(), near zero when the compiles really overlapped
+    double blockedMs() const { return waitMs; }
+
+private:
+    ProgramCache* cache;
+    // a deque so get() references survive add()
+    std::deque<Shader> shaders;
+    double waitMs;
+};
+#endif
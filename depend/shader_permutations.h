@@ -0,0 +1,179 @@
+#ifndef SHADER_PERMUTATIONS_H
+#define SHADER_PERMUTATIONS_H
+
+#include <glad/glad.h>
+
+#include <shader_s.h>
+#include <program_cache.h>
+
+#include <map>
+#include <string>
+#include <cstdint>
+#include <iostream>
+
+// one vertex/fragment source pair with #ifdef'd features, built per feature mask on
+// demand. the variant for a mask gets "#define <NAME> 1" for every set bit right after
+// the #version line (followed by #line 2, so compile errors keep the file's line
+// numbers), is compiled once and cached; the ProgramCache key covers the defines, so
+// every variant also gets its own binary on disk. Features is a struct like
+// BasicShaderFeatures below: constexpr bits, COUNT, name(bit) and valid(mask).
+//
+//     ShaderPermutations<BasicShaderFeatures> basic(vsPath, fsPath, &programCache);
+//     Shader& textured = basic.get<BasicShaderFeatures::TEXTURE | BasicShaderFeatures::TRANSFORM>();
+//
+// get<Mask>() rejects masks that are not valid() at compile time; get(mask) is the
+// runtime form for masks that are only known at run time.
+template<typename Features>
+class ShaderPermutations
+{
+public:
+    ShaderPermutations(const char* vertexPath, const char* fragmentPath, ProgramCache* cache = NULL)
+        : vertexPath(vertexPath), fragmentPath(fragmentPath), cache(cache)
+    {
+        if (!Shader::readFile(vertexPath, vertexCode) || !Shader::readFile(fragmentPath, fragmentCode))
+            std::cout << "ERROR::SHADER::FILE_NOT_SUCCESFULLY_READ " << vertexPath << " " << fragmentPath << std::endl;
+    }
+
+    // the variant, built now if it was not requested before
+    // ------------------------------------------------------------------------
+    template<uint32_t Mask>
+    Shader& get()
+    {
+        static_assert(Features::valid(Mask), "invalid shader feature mask");
+        return get(Mask);
+    }
+    Shader& get(uint32_t mask)
+    {
+        Shader& shader = prepare(mask);
+        if (shader.pending())
+            shader.finish();
+        return shader;
+    }
+    // submit the variant's compile without waiting for it (see Shader::submit), so a
+    // number of variants can compile in parallel before their first get()
+    // ------------------------------------------------------------------------
+    template<uint32_t Mask>
+    void prefetch()
+    {
+        static_assert(Features::valid(Mask), "invalid shader feature mask");
+        prepare(Mask);
+    }
+    Shader& prepare(uint32_t mask)
+    {
+        typename std::map<uint32_t, Shader>::iterator found = variants.find(mask);
+        if (found != variants.end())
+            return found->second;
+        Shader& shader = variants[mask];
+        if (!Features::valid(mask))
+        {
+            // an empty program, draws with it do nothing
+            std::cout << "ERROR::SHADER::INVALID_FEATURE_MASK " << mask << " for " << vertexPath << std::endl;
+            return shader;
+        }
+        std::string defines = definesFor(mask);
+        shader.submit(inject(vertexCode, defines), inject(fragmentCode, defines), cache);
+        return shader;
+    }
+
+    size_t variantCount() const { return variants.size(); }
+
+    // the "#define" lines for mask, e.g. "#define TEXTURE 1\n#define TRANSFORM 1\n"
+    // ------------------------------------------------------------------------
+    static std::string definesFor(uint32_t mask)
+    {
+        std::string defines;
+        for (int bit = 0; bit < Features::COUNT; ++bit)
+        {
+            if (mask & (1u << bit))
+            {
+                defines += "#define ";
+                defines += Features::name(bit);
+                defines += " 1\n";
+            }
+        }
+        return defines;
+    }
+    // GLSL wants #version first, so the defines go on the line after it
+    // ------------------------------------------------------------------------
+    static std::string inject(const std::string& source, const std::string& defines)
+    {
+        if (defines.empty())
+            return source;
+        size_t version = source.find("#version");
+        size_t insert = 0;
+        int line = 1;
+        if (version != std::string::npos)
+        {
+            size_t end = source.find('\n', version);
+            insert = end == std::string::npos ? source.size() : end + 1;
+            for (size_t i = 0; i < insert; ++i)
+                line += source[i] == '\n' ? 1 : 0;
+        }
+        bool terminate = insert > 0 && source[insert - 1] != '\n';
+        std::string lineDirective = "#line " + std::to_string(line + (terminate ? 1 : 0)) + "\n";
+        std::string result;
+        result.reserve(source.size() + defines.size() + lineDirective.size() + 1);
+        result.append(source, 0, insert);
+        if (terminate)
+            result += '\n';
+        result += defines;
+        result += lineDirective;
+        result.append(source, insert, std::string::npos);
+        return result;
+    }
+
+    // must run while the context is still alive
+    // ------------------------------------------------------------------------
+    void release()
+    {
+        for (typename std::map<uint32_t, Shader>::iterator it = variants.begin(); it != variants.end(); ++it)
+        {
+            if (it->second.pending())
+                it->second.finish();
+            if (it->second.ID)
+                glDeleteProgram(it->second.ID);
+            it->second.ID = 0;
+        }
+        variants.clear();
+    }
+
+private:
+    std::string vertexPath, fragmentPath;
+    std::string vertexCode, fragmentCode;
+    ProgramCache* cache;
+    // std::map keeps references from get() valid while more variants are added
+    std::map<uint32_t, Shader> variants;
+
+    ShaderPermutations(const ShaderPermutations&);
+    ShaderPermutations& operator=(const ShaderPermutations&);
+};
+
+// features of 1_base/helper/basic.vs / basic.fs, which cover what the per-sample pairs
+// of 3_shader, 4_textures and 5_transformations do:
+//     VERTEX_COLOR  vec3 aColor at location 1 (moves aTexCoord to 2), multiplies the color
+//     TEXTURE       samples texture1 with aTexCoord
+//     TEXTURE2      mixes in 20% of texture2, needs TEXTURE
+//     TRANSFORM     gl_Position = transform * position
+//     FLIP_Y        TexCoord.y = 1 - aTexCoord.y, needs TEXTURE
+// ------------------------------------------------------------------------
+struct BasicShaderFeatures
+{
+    static constexpr uint32_t VERTEX_COLOR = 1u << 0;
+    static constexpr uint32_t TEXTURE = 1u << 1;
+    static constexpr uint32_t TEXTURE2 = 1u << 2;
+    static constexpr uint32_t TRANSFORM = 1u << 3;
+    static constexpr uint32_t FLIP_Y = 1u << 4;
+    static constexpr int COUNT = 5;
+
+    static constexpr bool valid(uint32_t mask)
+    {
+        return mask < (1u << COUNT) && (!(mask & TEXTURE2) || (mask & TEXTURE)) && (!(mask & FLIP_Y) || (mask & TEXTURE)) &&
+               (mask & (VERTEX_COLOR | TEXTURE)) != 0;
+    }
+    static const char* name(int bit)
+    {
+        static const char* const names[COUNT] = { "VERTEX_COLOR", "TEXTURE", "TEXTURE2", "TRANSFORM", "FLIP_Y" };
+        return names[bit];
+    }
+};
+#endif
@@ -0,0 +1,146 @@
+#ifndef SHADER_RELOADER_H
+#define SHADER_RELOADER_H
+
+#include <glad/glad.h>
+
+#include <shader_s.h>
+#include <gl_state.h>
+#include <file_watcher.h>
+
+#include <deque>
+#include <string>
+#include <vector>
+#include <functional>
+#include <iostream>
+
+// recompiles shaders whose source files were edited while the program runs. update()
+// at the top of a frame polls the FileWatcher, submits the rebuild of every changed
+// shader to a second Shader and, on a later frame once the driver reports the link as
+// complete (GL_KHR_parallel_shader_compile; without it the swap happens in the same
+// update and may block for the compile), swaps it in with Shader::adopt(). draws keep
+// using the old program until then, and for good if the new one fails to compile.
+//
+//     ShaderReloader reloader(&glState);
+//     reloader.add(ourShader, vsPath, fsPath, [](Shader& s) { s.use(); s.setInt("texture1", 0); });
+//     while (...)
+//     {
+//         reloader.update();                   // frame boundary, before any draw
+//         glState.useProgram(ourShader.ID);    // the ID may change in update()
+//
+// uniform values live in the program object, so the callback must set again what was
+// set once outside the loop; UniformHandles survive the swap.
+class ShaderReloader
+{
+public:
+    typedef std::function<void(Shader&)> ReloadFunction;
+
+    struct Stats
+    {
+        unsigned int reloads;
+        unsigned int failures;
+    };
+
+    // state, if given, is told about every deleted program
+    explicit ShaderReloader(GLStateCache* state = NULL) : state(state)
+    {
+        stats.reloads = stats.failures = 0;
+    }
+
+    // ------------------------------------------------------------------------
+    void add(Shader& shader, const std::string& vertexPath, const std::string& fragmentPath,
+             ReloadFunction onReload = ReloadFunction())
+    {
+        entries.push_back(Entry());
+        Entry& entry = entries.back();
+        entry.shader = &shader;
+        entry.vertexPath = vertexPath;
+        entry.fragmentPath = fragmentPath;
+        entry.onReload = onReload;
+        watcher.watch(vertexPath);
+        watcher.watch(fragmentPath);
+    }
+
+    // ------------------------------------------------------------------------
+    void update()
+    {
+        watcher.poll(changed);
+        for (size_t c = 0; c < changed.size(); ++c)
+        {
+            for (size_t i = 0; i < entries.size(); ++i)
+            {
+                if (entries[i].vertexPath == changed[c] || entries[i].fragmentPath == changed[c])
+                    submit(entries[i]);
+            }
+        }
+        for (size_t i = 0; i < entries.size(); ++i)
+        {
+            Entry& entry = entries[i];
+            if (entry.next.pending() && entry.next.ready())
+                swap(entry);
+        }
+    }
+
+    const char* backend() const { return watcher.backend(); }
+    const Stats& statistics() const { return stats; }
+
+private:
+    struct Entry
+    {
+        Shader* shader;
+        std::string vertexPath, fragmentPath;
+        ReloadFunction onReload;
+        // the rebuild in flight
+        Shader next;
+    };
+
+    FileWatcher watcher;
+    std::deque<Entry> entries;
+    std::vector<std::string> changed;
+    GLStateCache* state;
+    Stats stats;
+
+    // ------------------------------------------------------------------------
+    void submit(Entry& entry)
+    {
+        std::string vertexCode, fragmentCode;
+        if (!Shader::readFile(entry.vertexPath.c_str(), vertexCode) || !Shader::readFile(entry.fragmentPath.c_str(), fragmentCode))
+        {
+            std::cout << "ERROR::SHADER::RELOAD::FILE_NOT_SUCCESFULLY_READ " << entry.vertexPath << " " << entry.fragmentPath
+                      << std::endl;
+            return;
+        }
+        // a second edit before the first rebuild finished replaces it
+        discard(entry.next);
+        entry.next.submit(vertexCode, fragmentCode);
+    }
+    void swap(Entry& entry)
+    {
+        if (!entry.next.finish())
+        {
+            ++stats.failures;
+            std::cout << "ERROR::SHADER::RELOAD::FAILED keeping the previous program of " << entry.vertexPath << std::endl;
+            discard(entry.next);
+            return;
+        }
+        unsigned int previous = entry.shader->ID;
+        entry.shader->adopt(entry.next);
+        if (state && previous)
+            state->onDeleteProgram(previous);
+        ++stats.reloads;
+        std::cout << "SHADER::RELOAD " << entry.vertexPath << " " << entry.fragmentPath << std::endl;
+        if (entry.onReload)
+            entry.onReload(*entry.shader);
+    }
+    void discard(Shader& shader)
+    {
+        if (shader.pending())
+            shader.finish();
+        if (shader.ID)
+            glDeleteProgram(shader.ID);
+        shader.ID = 0;
+    }
+
+    ShaderReloader(const ShaderReloader&);
+    ShaderReloader& operator=(const ShaderReloader&);
+};
+#endif
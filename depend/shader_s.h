@@ -4,97 +4,394 @@
 #include <glad/glad.h>
 
 #include <string>
+#include <vector>
+#include <cstring>
+#include <cstdio>
 #include <fstream>
-#include <sstream>
 #include <iostream>
+#include <chrono>
+
+#include <gl_ext.h>
+#include <program_cache.h>
+#include <uniform_block.h>
+#include <string_ref.h>
+
+// handle returned by Shader::uniform(); it indexes the shader's uniform table so the
+// hot-loop setters are a plain array read. The default handle maps to location -1,
+// which glUniform* silently ignores.
+// ------------------------------------------------------------------------
+struct UniformHandle
+{
+    int index;
+    UniformHandle() : index(0) {}
+    explicit UniformHandle(int i) : index(i) {}
+    bool valid() const { return index != 0; }
+};
 
 class Shader
 {
 public:
     unsigned int ID;
+    Shader() : ID(0), pendingVertex(0), pendingFragment(0), pendingCache(NULL), pendingKey(0), submitMs(0.0) {}
     // constructor generates the 3_shader on the fly
+    // with a ProgramCache the linked program is restored from disk when the sources
+    // and the driver did not change, and compiled + stored otherwise
     // ------------------------------------------------------------------------
-    Shader(const char* vertexPath, const char* fragmentPath)
+    Shader(const char* vertexPath, const char* fragmentPath, ProgramCache* cache = NULL)
+        : ID(0), pendingVertex(0), pendingFragment(0), pendingCache(NULL), pendingKey(0), submitMs(0.0)
     {
         // 1. 从文件路径中获取顶点/片段着色器
         std::string vertexCode;
         std::string fragmentCode;
-        std::ifstream vShaderFile;
-        std::ifstream fShaderFile;
-        // 保证ifstream对象可以抛出异常：
-        vShaderFile.exceptions (std::ifstream::failbit | std::ifstream::badbit);
-        fShaderFile.exceptions (std::ifstream::failbit | std::ifstream::badbit);
-        try
-        {
-            // 打开文件
-            vShaderFile.open(vertexPath);
-            fShaderFile.open(fragmentPath);
-            std::stringstream vShaderStream, fShaderStream;
-            // 读取文件的缓冲内容到数据流中
-            vShaderStream << vShaderFile.rdbuf();
-            fShaderStream << fShaderFile.rdbuf();
-            // 关闭文件处理器
-            vShaderFile.close();
-            fShaderFile.close();
-            // 转换数据流到string
-            vertexCode   = vShaderStream.str();
-            fragmentCode = fShaderStream.str();
-        }
-        catch(std::ifstream::failure e)
-        {
+        if (!readFile(vertexPath, vertexCode) || !readFile(fragmentPath, fragmentCode))
             std::cout << "ERROR::SHADER::FILE_NOT_SUCCESFULLY_READ" << std::endl;
+        build(vertexCode, fragmentCode, cache);
+    }
+    // compile and link from source strings, replacing any previous program. the sources
+    // need not be zero terminated, e.g. spans of a memory-mapped asset archive
+    // ------------------------------------------------------------------------
+    bool build(StringRef vertexCode, StringRef fragmentCode, ProgramCache* cache = NULL)
+    {
+        submit(vertexCode, fragmentCode, cache);
+        return finish();
+    }
+    // a compute program (GL 4.3, check glExt().computeShader first), compiled and linked
+    // right away without the program cache
+    // ------------------------------------------------------------------------
+    bool buildCompute(const std::string& computeCode)
+    {
+        if (pending())
+            finish();
+        if (ID != 0)
+            glDeleteProgram(ID);
+        const char* cShaderCode = computeCode.c_str();
+        unsigned int compute = glCreateShader(GL_COMPUTE_SHADER);
+        glShaderSource(compute, 1, &cShaderCode, NULL);
+        glCompileShader(compute);
+        ID = glCreateProgram();
+        glAttachShader(ID, compute);
+        glLinkProgram(ID);
+        bool ok = checkCompileErrors(compute, "COMPUTE");
+        ok = checkCompileErrors(ID, "PROGRAM") && ok;
+        glDetachShader(ID, compute);
+        glDeleteShader(compute);
+        buildUniformTable();
+        return ok;
+    }
+    // start compiling and linking without asking for any status, which would make the
+    // driver finish on this thread. with GL_KHR_parallel_shader_compile the work runs
+    // on the driver's compiler threads; call finish() (or use()) once the program is needed.
+    // ------------------------------------------------------------------------
+    void submit(StringRef vertexCode, StringRef fragmentCode, ProgramCache* cache = NULL)
+    {
+        if (pending())
+            finish();
+        if (ID != 0)
+            glDeleteProgram(ID);
+        std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+        ID = glCreateProgram();
+        pendingCache = cache && cache->enabled() ? cache : NULL;
+        if (pendingCache)
+        {
+            pendingKey = pendingCache->key(vertexCode, fragmentCode);
+            if (pendingCache->load(pendingKey, ID))
+            {
+                double ms = elapsedMs(start);
+                pendingCache->recordHit(ms);
+                pendingCache = NULL;
+                std::cout << "SHADER::PROGRAM_CACHE::HIT " << ms << " ms" << std::endl;
+                buildUniformTable();
+                return;
+            }
         }
-        const char* vShaderCode = vertexCode.c_str();
-        const char* fShaderCode = fragmentCode.c_str();
+        // explicit lengths, the driver does not look for a terminator
+        GLint vertexLength = (GLint)vertexCode.length;
+        GLint fragmentLength = (GLint)fragmentCode.length;
         // 2. 编译着色器
-        unsigned int vertex, fragment;
         // 顶点着色器
-        vertex = glCreateShader(GL_VERTEX_SHADER);
-        glShaderSource(vertex, 1, &vShaderCode, NULL);
-        glCompileShader(vertex);
-        checkCompileErrors(vertex, "VERTEX");
+        pendingVertex = glCreateShader(GL_VERTEX_SHADER);
+        glShaderSource(pendingVertex, 1, &vertexCode.data, &vertexLength);
+        glCompileShader(pendingVertex);
         // 片段着色器
-        fragment = glCreateShader(GL_FRAGMENT_SHADER);
-        glShaderSource(fragment, 1, &fShaderCode, NULL);
-        glCompileShader(fragment);
-        checkCompileErrors(fragment, "FRAGMENT");
+        pendingFragment = glCreateShader(GL_FRAGMENT_SHADER);
+        glShaderSource(pendingFragment, 1, &fragmentCode.data, &fragmentLength);
+        glCompileShader(pendingFragment);
         // 3 着色器程序
-        ID = glCreateProgram();
-        glAttachShader(ID, vertex);
-        glAttachShader(ID, fragment);
+        glAttachShader(ID, pendingVertex);
+        glAttachShader(ID, pendingFragment);
+        if (pendingCache)
+            glProgramParameteri(ID, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
         glLinkProgram(ID);
-        checkCompileErrors(ID, "PROGRAM");
+        submitMs = elapsedMs(start);
+    }
+    // true while a submitted program has not been finished
+    bool pending() const { return pendingVertex != 0; }
+    // non-blocking: has the driver completed the link? always true without
+    // GL_KHR_parallel_shader_compile, where finish() may have to wait instead
+    // ------------------------------------------------------------------------
+    bool ready() const
+    {
+        if (!pending() || !glExt().parallelShaderCompile)
+            return true;
+        int done = 0;
+        glGetProgramiv(ID, GL_COMPLETION_STATUS_KHR, &done);
+        return done != 0;
+    }
+    // read the compile/link status and logs, blocking if the driver is still busy,
+    // then enumerate the uniforms. returns false if the program failed to build
+    // ------------------------------------------------------------------------
+    bool finish()
+    {
+        if (!pending())
+        {
+            int success = 0;
+            if (ID != 0)
+                glGetProgramiv(ID, GL_LINK_STATUS, &success);
+            return success != 0;
+        }
+        std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+        bool ok = checkCompileErrors(pendingVertex, "VERTEX");
+        ok = checkCompileErrors(pendingFragment, "FRAGMENT") && ok;
+        ok = checkCompileErrors(ID, "PROGRAM") && ok;
         // delete the shaders as they're linked into our program now and no longer necessary
-        glDeleteShader(vertex);
-        glDeleteShader(fragment);
+        glDetachShader(ID, pendingVertex);
+        glDetachShader(ID, pendingFragment);
+        glDeleteShader(pendingVertex);
+        glDeleteShader(pendingFragment);
+        pendingVertex = pendingFragment = 0;
+        if (pendingCache)
+        {
+            if (ok)
+                pendingCache->store(pendingKey, ID);
+            // time spent in our own calls, not the wall time between submit and finish
+            double ms = submitMs + elapsedMs(start);
+            pendingCache->recordMiss(ms);
+            pendingCache = NULL;
+            std::cout << "SHADER::PROGRAM_CACHE::MISS " << ms << " ms" << std::endl;
+        }
+        // 4. 链接后一次性枚举所有active uniform，之后不再调用glGetUniformLocation
+        buildUniformTable();
+        return ok;
+    }
+    // take over the finished program of built, a rebuild of this shader, and delete the
+    // current one. handles from uniform() stay valid: a name keeps its table index, and
+    // names the new program lacks map to location -1
+    // ------------------------------------------------------------------------
+    void adopt(Shader& built)
+    {
+        if (built.pending())
+            built.finish();
+        if (pending())
+            finish();
+        if (ID != 0)
+            glDeleteProgram(ID);
+        ID = built.ID;
+        built.ID = 0;
+        buildUniformTable(true);
+    }
+    // read a whole text file, false if it could not be opened
+    // ------------------------------------------------------------------------
+    static bool readFile(const char* path, std::string& out)
+    {
+        std::ifstream file;
+        // 保证ifstream对象可以抛出异常：
+        file.exceptions(std::ifstream::failbit | std::ifstream::badbit);
+        try
+        {
+            // read straight into the string, sized once, instead of through a stringstream
+            file.open(path, std::ios::in | std::ios::binary);
+            file.seekg(0, std::ios::end);
+            out.resize((size_t)file.tellg());
+            file.seekg(0, std::ios::beg);
+            if (!out.empty())
+                file.read(&out[0], (std::streamsize)out.size());
+            file.close();
+        }
+        catch(std::ifstream::failure& e)
+        {
+            return false;
+        }
+        return true;
     }
     // activate the 3_shader
     // ------------------------------------------------------------------------
     void use()
     {
+        if (pending())
+            finish();
         glUseProgram(ID);
     }
+    // look up a uniform once (outside the render loop) and keep the handle.
+    // takes literals, std::string or FrameArena names without building a std::string
+    // ------------------------------------------------------------------------
+    UniformHandle uniform(StringRef name) const
+    {
+        if (pending())
+            std::cout << "ERROR::SHADER::UNIFORM_BEFORE_FINISH " << name << std::endl;
+        // "arr[0]" is reported by the driver but stored as "arr"
+        StringRef base = name.endsWith("[0]") ? name.prefix(name.length - 3) : name;
+        for (size_t i = 1; i < uniformNames.size(); ++i)
+        {
+            if (uniformNames[i] == name || uniformNames[i] == base)
+                return UniformHandle((int)i);
+        }
+        return UniformHandle();
+    }
+    int location(UniformHandle handle) const
+    {
+        return uniformLocations[handle.index];
+    }
     // utility uniform functions
     // ------------------------------------------------------------------------
-    void setBool(const std::string &name, bool value) const
+    void setBool(UniformHandle handle, bool value) const
+    {
+        glUniform1i(uniformLocations[handle.index], (int)value);
+    }
+    void setBool(StringRef name, bool value) const
+    {
+        setBool(uniform(name), value);
+    }
+    // ------------------------------------------------------------------------
+    void setInt(UniformHandle handle, int value) const
+    {
+        glUniform1i(uniformLocations[handle.index], value);
+    }
+    void setInt(StringRef name, int value) const
+    {
+        setInt(uniform(name), value);
+    }
+    // ------------------------------------------------------------------------
+    void setFloat(UniformHandle handle, float value) const
+    {
+        glUniform1f(uniformLocations[handle.index], value);
+    }
+    void setFloat(StringRef name, float value) const
+    {
+        setFloat(uniform(name), value);
+    }
+    // ------------------------------------------------------------------------
+    void setVec4(UniformHandle handle, float x, float y, float z, float w) const
+    {
+        glUniform4f(uniformLocations[handle.index], x, y, z, w);
+    }
+    void setVec4(StringRef name, float x, float y, float z, float w) const
     {
-        glUniform1i(glGetUniformLocation(ID, name.c_str()), (int)value);
+        setVec4(uniform(name), x, y, z, w);
     }
     // ------------------------------------------------------------------------
-    void setInt(const std::string &name, int value) const
+    void setMat4(UniformHandle handle, const float* value) const
+    {
+        glUniformMatrix4fv(uniformLocations[handle.index], 1, GL_FALSE, value);
+    }
+    void setMat4(StringRef name, const float* value) const
     {
-        glUniform1i(glGetUniformLocation(ID, name.c_str()), value);
+        setMat4(uniform(name), value);
     }
+    // attach a uniform block to a binding point, false if the program has no such block.
+    // the blocks of uniform_block.h are bound automatically after every link
     // ------------------------------------------------------------------------
-    void setFloat(const std::string &name, float value) const
+    bool bindUniformBlock(const char* name, unsigned int binding) const
     {
-        glUniform1f(glGetUniformLocation(ID, name.c_str()), value);
+        unsigned int index = glGetUniformBlockIndex(ID, name);
+        if (index == GL_INVALID_INDEX)
+            return false;
+        glUniformBlockBinding(ID, index, binding);
+        return true;
     }
 
 private:
+    // slot 0 is the "not found" entry with location -1
+    std::vector<std::string> uniformNames;
+    std::vector<int> uniformLocations;
+    // stages of a submitted program until finish() reads their status
+    unsigned int pendingVertex, pendingFragment;
+    ProgramCache* pendingCache;
+    uint64_t pendingKey;
+    double submitMs;
+
+    // enumerate the program's active uniforms into a flat name/location table.
+    // keepIndices leaves known names at their slots and appends new ones
+    // ------------------------------------------------------------------------
+    void buildUniformTable(bool keepIndices = false)
+    {
+        if (!keepIndices || uniformNames.empty())
+            uniformNames.assign(1, std::string());
+        uniformLocations.assign(uniformNames.size(), -1);
+
+        int count = 0, maxLength = 0;
+        glGetProgramiv(ID, GL_ACTIVE_UNIFORMS, &count);
+        glGetProgramiv(ID, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+        std::vector<char> name(maxLength > 0 ? maxLength : 1);
+        for (int i = 0; i < count; ++i)
+        {
+            GLsizei length = 0;
+            GLint size = 0;
+            GLenum type = 0;
+            glGetActiveUniform(ID, (GLuint)i, (GLsizei)name.size(), &length, &size, &type, &name[0]);
+            int location = glGetUniformLocation(ID, &name[0]);
+            // uniforms living in a uniform block have no location
+            if (location < 0)
+                continue;
+            bool array = length > 3 && std::strcmp(&name[0] + length - 3, "[0]") == 0;
+            if (array)
+                length -= 3;
+            std::string baseName(&name[0], length);
+            setUniformSlot(baseName, location);
+            // only element 0 is enumerated: give every other element its own entry,
+            // so "lights[3]" or an arena-built "arr[" + i + "]" resolve like before
+            for (GLint element = 1; array && element < size; ++element)
+            {
+                char suffix[16];
+                std::snprintf(suffix, sizeof(suffix), "[%d]", (int)element);
+                std::string elementName = baseName + suffix;
+                setUniformSlot(elementName, glGetUniformLocation(ID, elementName.c_str()));
+            }
+        }
+        bindSharedBlocks();
+    }
+    // the slot of name, appended if the table does not have it yet
+    // ------------------------------------------------------------------------
+    void setUniformSlot(const std::string& name, int location)
+    {
+        size_t slot = 1;
+        while (slot < uniformNames.size() && uniformNames[slot] != name)
+            ++slot;
+        if (slot == uniformNames.size())
+        {
+            uniformNames.push_back(name);
+            uniformLocations.push_back(location);
+        }
+        else
+            uniformLocations[slot] = location;
+    }
+    // bind the shared std140 blocks and check the GLSL side against the C++ mirror
+    // ------------------------------------------------------------------------
+    void bindSharedBlocks() const
+    {
+        int count = 0;
+        const UniformBlockInfo* blocks = uniformBlocks(count);
+        for (int i = 0; i < count; ++i)
+        {
+            unsigned int index = glGetUniformBlockIndex(ID, blocks[i].name);
+            if (index == GL_INVALID_INDEX)
+                continue;
+            glUniformBlockBinding(ID, index, blocks[i].binding);
+            int size = 0;
+            glGetActiveUniformBlockiv(ID, index, GL_UNIFORM_BLOCK_DATA_SIZE, &size);
+            if ((size_t)size != blocks[i].size)
+                std::cout << "ERROR::SHADER::UNIFORM_BLOCK_SIZE_MISMATCH " << blocks[i].name << ": GLSL " << size
+                          << " bytes, C++ " << blocks[i].size << " bytes" << std::endl;
+        }
+    }
+
+    static double elapsedMs(std::chrono::high_resolution_clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+    }
+
     // utility function for checking 3_shader compilation/linking errors.
     // ------------------------------------------------------------------------
-    void checkCompileErrors(unsigned int shader, std::string type)
+    bool checkCompileErrors(unsigned int shader, std::string type)
     {
         int success;
         char infoLog[1024];
@@ -116,6 +413,7 @@ private:
                 std::cout << "ERROR::PROGRAM_LINKING_ERROR of type: " << type << "\n" << infoLog << "\n -- --------------------------------------------------- -- " << std::endl;
             }
         }
+        return success != 0;
     }
 };
 #endif
\ No newline at end of file
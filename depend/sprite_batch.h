@@ -0,0 +1,258 @@
+#ifndef SPRITE_BATCH_H
+#define SPRITE_BATCH_H
+
+#include <glad/glad.h>
+
+#include <gl_state.h>
+#include <stream_ring.h>
+
+#include <vector>
+#include <cstring>
+#include <cstdint>
+#include <iostream>
+
+// one corner of a sprite quad: position, texture coordinate and an RGBA8 tint,
+// 20 bytes where the textured quad vertex of 1_texture.cpp takes 8 * sizeof(float):
+// the tint is packed into 4 bytes instead of three floats.
+//     layout (location = 0) in vec2 aPos;
+//     layout (location = 1) in vec4 aColor;      // normalized
+//     layout (location = 2) in vec2 aTexCoord;
+struct SpriteVertex
+{
+    float x, y;
+    float u, v;
+    uint32_t color;
+};
+
+// draws tens of thousands of textured 2D quads in a few draw calls. draw() only appends
+// four vertices to a CPU staging array; the batch is flushed, i.e. copied into the
+// StreamRing and drawn with one glDrawElementsBaseVertex, when the texture or program
+// changes, when the staging array is full, and at end(). every flush reuses the same
+// static index buffer (0 1 3, 1 2 3 for each quad), so no index is ever streamed.
+//
+// submitting sorted by texture keeps the batches few; frameStats() says how many it
+// took and why they were cut.
+//
+//     batch.begin(glState, spriteShader.ID);
+//     batch.draw(atlas, x, y, w, h);
+//     batch.draw(icons, x, y, w, h, u0, v0, u1, v1, SpriteBatch::rgba(255, 255, 255, 128));
+//     batch.end();
+//     ring.endFrame();              // after the last draw that reads the ring
+class SpriteBatch
+{
+public:
+    // 4 vertices each, the last index of a full batch still fits into 16 bits
+    static const unsigned int MAX_QUADS = 16384;
+
+    struct Stats
+    {
+        unsigned int quads;
+        // draw calls
+        unsigned int batches;
+        // why batches were cut: texture or program switch, full staging array
+        unsigned int textureFlushes;
+        unsigned int programFlushes;
+        unsigned int capacityFlushes;
+        // quads lost because the ring's frame segment was full
+        unsigned int dropped;
+    };
+
+    // ring must outlive the batch, its frame segment needs room for a frame's worth of
+    // vertices (20 bytes each, plus up to 20 bytes of alignment per flush).
+    // leaves the batch's VAO bound.
+    // ------------------------------------------------------------------------
+    explicit SpriteBatch(StreamRing& ring, unsigned int maxQuads = MAX_QUADS)
+        : VAO(0), EBO(0), ring(ring), state(NULL), program(0), texture(0), quadCount(0), frames(0),
+          maxQuads(maxQuads > MAX_QUADS || maxQuads == 0 ? MAX_QUADS : maxQuads)
+    {
+        std::memset(&frame, 0, sizeof(frame));
+        std::memset(&total, 0, sizeof(total));
+        staging.resize((size_t)this->maxQuads * 4);
+
+        std::vector<unsigned short> indices((size_t)this->maxQuads * 6);
+        for (unsigned int q = 0; q < this->maxQuads; ++q)
+        {
+            unsigned short base = (unsigned short)(q * 4);
+            unsigned short* quad = &indices[(size_t)q * 6];
+            quad[0] = base + 0;
+            quad[1] = base + 1;
+            quad[2] = base + 3;
+            quad[3] = base + 1;
+            quad[4] = base + 2;
+            quad[5] = base + 3;
+        }
+
+        glGenVertexArrays(1, &VAO);
+        glGenBuffers(1, &EBO);
+        glBindVertexArray(VAO);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned short), &indices[0], GL_STATIC_DRAW);
+        // the attributes point at the start of the ring, every flush selects its
+        // vertices with the base vertex of the draw
+        glBindBuffer(GL_ARRAY_BUFFER, ring.buffer());
+        glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(SpriteVertex), (void*)0);
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(1, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(SpriteVertex), (void*)(4 * sizeof(float)));
+        glEnableVertexAttribArray(1);
+        glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(SpriteVertex), (void*)(2 * sizeof(float)));
+        glEnableVertexAttribArray(2);
+    }
+    // must run while the context is still alive
+    // ------------------------------------------------------------------------
+    void release(GLStateCache* cache = NULL)
+    {
+        if (cache)
+            cache->onDeleteVertexArray(VAO);
+        glDeleteVertexArrays(1, &VAO);
+        glDeleteBuffers(1, &EBO);
+        VAO = EBO = 0;
+    }
+
+    // after ring.beginFrame(). program is used for the batches until setProgram()
+    // ------------------------------------------------------------------------
+    void begin(GLStateCache& cache, unsigned int spriteProgram)
+    {
+        state = &cache;
+        program = spriteProgram;
+        texture = 0;
+        quadCount = 0;
+        std::memset(&frame, 0, sizeof(frame));
+    }
+    // switch to another program (e.g. a text shader), flushes if it differs
+    // ------------------------------------------------------------------------
+    void setProgram(unsigned int spriteProgram)
+    {
+        if (spriteProgram == program)
+            return;
+        if (quadCount)
+        {
+            ++frame.programFlushes;
+            flush();
+        }
+        program = spriteProgram;
+    }
+
+    // an axis aligned quad from (x, y) to (x + w, y + h), in whatever space the
+    // program's projection expects, showing the uv rect (u0, v0) - (u1, v1) of tex
+    // ------------------------------------------------------------------------
+    void draw(unsigned int tex, float x, float y, float w, float h,
+              float u0 = 0.0f, float v0 = 0.0f, float u1 = 1.0f, float v1 = 1.0f, uint32_t color = 0xFFFFFFFFu)
+    {
+        SpriteVertex* quad = reserveQuad(tex);
+        // top right, bottom right, bottom left, top left, like the static indices expect
+        setVertex(quad[0], x + w, y + h, u1, v1, color);
+        setVertex(quad[1], x + w, y, u1, v0, color);
+        setVertex(quad[2], x, y, u0, v0, color);
+        setVertex(quad[3], x, y + h, u0, v1, color);
+    }
+    // any four corners in the same order, for rotated or skewed sprites
+    // ------------------------------------------------------------------------
+    void draw(unsigned int tex, const SpriteVertex corners[4])
+    {
+        SpriteVertex* quad = reserveQuad(tex);
+        std::memcpy(quad, corners, 4 * sizeof(SpriteVertex));
+    }
+
+    // draw what is left
+    // ------------------------------------------------------------------------
+    void end()
+    {
+        if (quadCount)
+            flush();
+        total.quads += frame.quads;
+        total.batches += frame.batches;
+        total.textureFlushes += frame.textureFlushes;
+        total.programFlushes += frame.programFlushes;
+        total.capacityFlushes += frame.capacityFlushes;
+        total.dropped += frame.dropped;
+        ++frames;
+        state = NULL;
+    }
+
+    // the frame between the last begin() and end()
+    const Stats& frameStats() const { return frame; }
+    const Stats& totalStats() const { return total; }
+    void printStats(std::ostream& out) const
+    {
+        double n = frames ? (double)frames : 1.0;
+        out << "sprite batch: " << frames << " frames, per frame " << total.quads / n << " quads in " << total.batches / n
+            << " batches (flushes on texture " << total.textureFlushes / n << ", program " << total.programFlushes / n
+            << ", capacity " << total.capacityFlushes / n << "), " << total.dropped << " quads dropped" << std::endl;
+    }
+
+    // pack a tint for draw()
+    static uint32_t rgba(unsigned char r, unsigned char g, unsigned char b, unsigned char a = 255)
+    {
+        // little endian: r is the first byte read by the normalized ubyte4 attribute
+        return (uint32_t)r | ((uint32_t)g << 8) | ((uint32_t)b << 16) | ((uint32_t)a << 24);
+    }
+
+private:
+    unsigned int VAO, EBO;
+    StreamRing& ring;
+    GLStateCache* state;
+    unsigned int program;
+    unsigned int texture;
+    std::vector<SpriteVertex> staging;
+    unsigned int quadCount;
+    unsigned long frames;
+    unsigned int maxQuads;
+    Stats frame;
+    Stats total;
+
+    // four vertices to fill in, flushing first if tex breaks the batch or it is full
+    SpriteVertex* reserveQuad(unsigned int tex)
+    {
+        if (quadCount && tex != texture)
+        {
+            ++frame.textureFlushes;
+            flush();
+        }
+        else if (quadCount == maxQuads)
+        {
+            ++frame.capacityFlushes;
+            flush();
+        }
+        texture = tex;
+        ++frame.quads;
+        return &staging[(size_t)quadCount++ * 4];
+    }
+    static void setVertex(SpriteVertex& vertex, float x, float y, float u, float v, uint32_t color)
+    {
+        vertex.x = x;
+        vertex.y = y;
+        vertex.u = u;
+        vertex.v = v;
+        vertex.color = color;
+    }
+
+    // ------------------------------------------------------------------------
+    void flush()
+    {
+        size_t bytes = (size_t)quadCount * 4 * sizeof(SpriteVertex);
+        // over-allocate by one vertex so the copy can start on a multiple of the stride,
+        // the base vertex is then a whole number
+        StreamRing::Allocation allocation = ring.allocate(bytes + sizeof(SpriteVertex), 4);
+        if (!allocation.valid())
+        {
+            frame.dropped += quadCount;
+            quadCount = 0;
+            return;
+        }
+        size_t skip = (sizeof(SpriteVertex) - allocation.offset % sizeof(SpriteVertex)) % sizeof(SpriteVertex);
+        std::memcpy(allocation.ptr + skip, &staging[0], bytes);
+        ring.flush();
+
+        GLint baseVertex = (GLint)((allocation.offset + skip) / sizeof(SpriteVertex));
+        state->useProgram(program);
+        state->bindTextureUnit(0, GL_TEXTURE_2D, texture);
+        state->bindVertexArray(VAO);
+        glDrawElementsBaseVertex(GL_TRIANGLES, (GLsizei)(quadCount * 6), GL_UNSIGNED_SHORT, (void*)0, baseVertex);
+        ++frame.batches;
+        quadCount = 0;
+    }
+
+    SpriteBatch(const SpriteBatch&);
+    SpriteBatch& operator=(const SpriteBatch&);
+};
+#endif
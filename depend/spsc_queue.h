@@ -0,0 +1,64 @@
+#ifndef SPSC_QUEUE_H
+#define SPSC_QUEUE_H
+
+#include <atomic>
+#include <cstddef>
+
+// bounded lock-free queue for exactly one producer thread and one consumer thread.
+// head is only written by the consumer and tail only by the producer; each side
+// publishes with a release store and reads the other side with an acquire load, so
+// the element written before push() is visible after the matching pop().
+// Capacity must be a power of two, one slot stays empty to tell full from empty.
+// the smallest power of two capacity that holds count elements at once
+constexpr size_t spscCapacityFor(size_t count, size_t capacity = 2)
+{
+    return capacity > count ? capacity : spscCapacityFor(count, capacity * 2);
+}
+
+template <typename T, size_t Capacity>
+class SpscQueue
+{
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "SpscQueue capacity must be a power of two");
+
+public:
+    SpscQueue() : head(0), tail(0) {}
+
+    // producer: false if full
+    // ------------------------------------------------------------------------
+    bool push(const T& value)
+    {
+        size_t t = tail.load(std::memory_order_relaxed);
+        size_t next = (t + 1) & (Capacity - 1);
+        if (next == head.load(std::memory_order_acquire))
+            return false;
+        slots[t] = value;
+        tail.store(next, std::memory_order_release);
+        return true;
+    }
+    // consumer: false if empty
+    // ------------------------------------------------------------------------
+    bool pop(T& value)
+    {
+        size_t h = head.load(std::memory_order_relaxed);
+        if (h == tail.load(std::memory_order_acquire))
+            return false;
+        value = slots[h];
+        head.store((h + 1) & (Capacity - 1), std::memory_order_release);
+        return true;
+    }
+    // approximate from any thread, exact from either end
+    bool empty() const
+    {
+        return head.load(std::memory_order_acquire) == tail.load(std::memory_order_acquire);
+    }
+
+private:
+    // producer and consumer indices on their own cache lines
+    alignas(64) std::atomic<size_t> head;
+    alignas(64) std::atomic<size_t> tail;
+    alignas(64) T slots[Capacity];
+
+    SpscQueue(const SpscQueue&);
+    SpscQueue& operator=(const SpscQueue&);
+};
+#endif
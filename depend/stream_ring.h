@@ -0,0 +1,221 @@
+#ifndef STREAM_RING_H
+#define STREAM_RING_H
+
+#include <glad/glad.h>
+
+#include <gl_ext.h>
+
+#include <vector>
+#include <cstring>
+#include <cstdint>
+
+// per-frame streaming memory for dynamic vertices, indices and uniform blocks.
+// one buffer is split into FRAME_COUNT segments; a frame sub-allocates linearly from
+// its segment, endFrame() fences it and the segment is reused FRAME_COUNT frames later,
+// after its fence signalled. so writing dynamic data is a memcpy into mapped memory
+// and never a glBufferData reallocation.
+//
+// with glBufferStorage the buffer is mapped once, persistent and coherent, and
+// allocations point straight into it. without it (GL 4.1, macOS) allocations point
+// into a CPU copy of the segment and flush() writes everything allocated since the
+// last flush with one unsynchronized map: call it before the draws that read the data.
+//
+//     ring.beginFrame();
+//     StreamRing::Allocation a = ring.allocate(bytes);
+//     memcpy(a.ptr, vertices, bytes);
+//     ring.flush();
+//     glBindBuffer(GL_ARRAY_BUFFER, ring.buffer());
+//     glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, stride, (void*)a.offset);
+//     ...
+//     ring.endFrame();
+class StreamRing
+{
+public:
+    static const int FRAME_COUNT = 3;
+
+    struct Allocation
+    {
+        // write here, NULL if the frame's segment is full
+        unsigned char* ptr;
+        // offset into buffer(), for attribute pointers, index offsets or glBindBufferRange
+        size_t offset;
+        size_t size;
+
+        Allocation() : ptr(NULL), offset(0), size(0) {}
+        bool valid() const { return ptr != NULL; }
+    };
+
+    struct Stats
+    {
+        unsigned long frames;
+        unsigned long allocations;
+        unsigned long bytes;
+        // allocations that did not fit into the frame's segment
+        unsigned long overflows;
+        // beginFrame() calls that had to wait for the GPU to release a segment
+        unsigned long stalls;
+    };
+
+    // GL thread. capacity of each frame's segment
+    // ------------------------------------------------------------------------
+    explicit StreamRing(size_t bytesPerFrame)
+        : ID(0), segmentSize(align(bytesPerFrame, 256)), mapped(NULL), frame(0), head(0), flushed(0), inFrame(false)
+    {
+        std::memset(&stats, 0, sizeof(stats));
+        for (int i = 0; i < FRAME_COUNT; ++i)
+            fences[i] = NULL;
+        size_t capacity = segmentSize * FRAME_COUNT;
+        glGenBuffers(1, &ID);
+        // the copy target leaves the array/element bindings of the current VAO alone
+        glBindBuffer(GL_COPY_WRITE_BUFFER, ID);
+        if (glExt().bufferStorage)
+        {
+            GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+            glExt().BufferStorage(GL_COPY_WRITE_BUFFER, (GLsizeiptr)capacity, NULL, flags);
+            mapped = (unsigned char*)glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, (GLsizeiptr)capacity, flags);
+        }
+        if (!mapped)
+        {
+            glBufferData(GL_COPY_WRITE_BUFFER, (GLsizeiptr)capacity, NULL, GL_STREAM_DRAW);
+            shadow.resize(segmentSize);
+        }
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    }
+    // GL thread
+    // ------------------------------------------------------------------------
+    void release()
+    {
+        for (int i = 0; i < FRAME_COUNT; ++i)
+        {
+            if (fences[i])
+                glDeleteSync(fences[i]);
+            fences[i] = NULL;
+        }
+        glBindBuffer(GL_COPY_WRITE_BUFFER, ID);
+        if (mapped)
+            glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+        glDeleteBuffers(1, &ID);
+        ID = 0;
+        mapped = NULL;
+    }
+
+    // wait (rarely) until the GPU is done with the segment from FRAME_COUNT frames ago
+    // ------------------------------------------------------------------------
+    void beginFrame()
+    {
+        int segment = (int)(frame % FRAME_COUNT);
+        if (fences[segment])
+        {
+            // a zero timeout poll first so a stall can be counted
+            GLenum result = glClientWaitSync(fences[segment], 0, 0);
+            if (result == GL_TIMEOUT_EXPIRED)
+            {
+                ++stats.stalls;
+                do
+                    result = glClientWaitSync(fences[segment], GL_SYNC_FLUSH_COMMANDS_BIT, 1000000);
+                while (result == GL_TIMEOUT_EXPIRED);
+            }
+            glDeleteSync(fences[segment]);
+            fences[segment] = NULL;
+        }
+        head = flushed = 0;
+        inFrame = true;
+    }
+    // fence everything this frame's draws read, after the last of them
+    // ------------------------------------------------------------------------
+    void endFrame()
+    {
+        if (!inFrame)
+            return;
+        flush();
+        int segment = (int)(frame % FRAME_COUNT);
+        fences[segment] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        ++frame;
+        ++stats.frames;
+        inFrame = false;
+    }
+
+    // alignment must be a power of two; use uniformAlignment() for uniform blocks
+    // ------------------------------------------------------------------------
+    Allocation allocate(size_t size, size_t alignment = 16)
+    {
+        Allocation allocation;
+        size_t offset = align(head, alignment);
+        if (!inFrame || size == 0 || offset + size > segmentSize)
+        {
+            ++stats.overflows;
+            return allocation;
+        }
+        head = offset + size;
+        size_t base = segmentBase();
+        allocation.offset = base + offset;
+        allocation.size = size;
+        allocation.ptr = mapped ? mapped + base + offset : &shadow[offset];
+        ++stats.allocations;
+        stats.bytes += size;
+        return allocation;
+    }
+    // allocate and copy in one go
+    Allocation push(const void* data, size_t size, size_t alignment = 16)
+    {
+        Allocation allocation = allocate(size, alignment);
+        if (allocation.valid())
+            std::memcpy(allocation.ptr, data, size);
+        return allocation;
+    }
+    // non-persistent rings: make the allocations since the last flush visible to the
+    // GPU. the segment is fenced, so the map never has to synchronize
+    // ------------------------------------------------------------------------
+    void flush()
+    {
+        if (mapped || head == flushed)
+            return;
+        glBindBuffer(GL_COPY_WRITE_BUFFER, ID);
+        void* ptr = glMapBufferRange(GL_COPY_WRITE_BUFFER, (GLintptr)(segmentBase() + flushed), (GLsizeiptr)(head - flushed),
+                                     GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT | GL_MAP_INVALIDATE_RANGE_BIT);
+        if (ptr)
+        {
+            std::memcpy(ptr, &shadow[flushed], head - flushed);
+            glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+        }
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+        flushed = head;
+    }
+
+    unsigned int buffer() const { return ID; }
+    bool persistent() const { return mapped != NULL; }
+    size_t frameCapacity() const { return segmentSize; }
+    size_t frameUsed() const { return head; }
+    const Stats& statistics() const { return stats; }
+
+    // GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, for glBindBufferRange offsets
+    // ------------------------------------------------------------------------
+    static size_t uniformAlignment()
+    {
+        int alignment = 0;
+        glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+        return alignment > 0 ? (size_t)alignment : 256;
+    }
+
+private:
+    unsigned int ID;
+    size_t segmentSize;
+    unsigned char* mapped;
+    std::vector<unsigned char> shadow;
+    GLsync fences[FRAME_COUNT];
+    unsigned long frame;
+    size_t head, flushed;
+    bool inFrame;
+    Stats stats;
+
+    size_t segmentBase() const { return (size_t)(frame % FRAME_COUNT) * segmentSize; }
+    static size_t align(size_t value, size_t alignment)
+    {
+        return (value + alignment - 1) & ~(alignment - 1);
+    }
+
+    StreamRing(const StreamRing&);
+    StreamRing& operator=(const StreamRing&);
+};
+#endif
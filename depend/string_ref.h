@@ -0,0 +1,43 @@
+#ifndef STRING_REF_H
+#define STRING_REF_H
+
+#include <string>
+#include <cstring>
+#include <cstddef>
+#include <ostream>
+
+// non-owning view of characters, like C++17 std::string_view. converts implicitly from
+// string literals, const char* and std::string, so APIs that take names (uniform names,
+// scope names, ...) accept all of them without constructing a temporary std::string.
+// data is not necessarily zero terminated.
+struct StringRef
+{
+    const char* data;
+    size_t length;
+
+    StringRef() : data(""), length(0) {}
+    StringRef(const char* s) : data(s), length(std::strlen(s)) {}
+    StringRef(const char* s, size_t n) : data(s), length(n) {}
+    StringRef(const std::string& s) : data(s.data()), length(s.size()) {}
+
+    bool empty() const { return length == 0; }
+    bool operator==(StringRef other) const
+    {
+        return length == other.length && std::memcmp(data, other.data, length) == 0;
+    }
+    bool operator!=(StringRef other) const { return !(*this == other); }
+    bool endsWith(StringRef suffix) const
+    {
+        return length >= suffix.length && std::memcmp(data + length - suffix.length, suffix.data, suffix.length) == 0;
+    }
+    // the first n characters
+    StringRef prefix(size_t n) const { return StringRef(data, n < length ? n : length); }
+};
+
+inline bool operator==(const std::string& a, StringRef b) { return StringRef(a) == b; }
+
+inline std::ostream& operator<<(std::ostream& out, StringRef s)
+{
+    return out.write(s.data, (std::streamsize)s.length);
+}
+#endif
@@ -0,0 +1,180 @@
+#ifndef TEXTURE_ARRAY_PACKER_H
+#define TEXTURE_ARRAY_PACKER_H
+
+#include <glad/glad.h>
+#include <stb_image.h>
+
+#include <vector>
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+// where a packed image ended up: uv = uvRect.xy + texCoord * uvRect.zw on array layer `layer`.
+// the layout matches the per-instance sprite attributes of InstancedRenderer.
+struct SpriteRegion
+{
+    float uvRect[4];
+    float layer;
+};
+
+// packs many small RGBA images into the layers of one GL_TEXTURE_2D_ARRAY with a shelf
+// packer, so a whole scene of sprites samples one texture object: one bind, one draw.
+// every image gets a border of duplicated edge texels so bilinear filtering and the
+// first mips do not bleed in the neighbours.
+class TextureArrayPacker
+{
+public:
+    unsigned int ID;
+
+    TextureArrayPacker(int layerWidth = 1024, int layerHeight = 1024, int padding = 2)
+        : ID(0), layerWidth(layerWidth), layerHeight(layerHeight), padding(padding), layers(0)
+    {}
+
+    // copy RGBA8 pixels (bottom row first, like a flipped stbi_load), returns the image index
+    // ------------------------------------------------------------------------
+    int add(const unsigned char* rgba, int width, int height)
+    {
+        Image image;
+        image.width = width;
+        image.height = height;
+        image.pixels.assign(rgba, rgba + (size_t)width * height * 4);
+        images.push_back(image);
+        regions.push_back(SpriteRegion());
+        return (int)images.size() - 1;
+    }
+    // returns -1 if the file could not be decoded
+    // ------------------------------------------------------------------------
+    int addFile(const char* path)
+    {
+        stbi_set_flip_vertically_on_load(true);
+        int width, height, channels;
+        unsigned char* data = stbi_load(path, &width, &height, &channels, 4);
+        if (!data)
+        {
+            std::cout << "Failed to load texture " << path << std::endl;
+            return -1;
+        }
+        int index = add(data, width, height);
+        stbi_image_free(data);
+        return index;
+    }
+
+    // pack everything added so far and create the array texture, returns its name.
+    // images that do not fit into one layer are skipped and keep an empty region.
+    // ------------------------------------------------------------------------
+    unsigned int build(bool mipmaps = true)
+    {
+        // tallest first keeps the shelves tight
+        std::vector<int> order(images.size());
+        for (size_t i = 0; i < order.size(); ++i)
+            order[i] = (int)i;
+        std::sort(order.begin(), order.end(), TallerFirst(images));
+
+        std::vector<std::vector<unsigned char> > layerPixels;
+        int layer = -1, shelfX = 0, shelfY = 0, shelfHeight = 0;
+        for (size_t k = 0; k < order.size(); ++k)
+        {
+            const Image& image = images[order[k]];
+            int w = image.width + 2 * padding, h = image.height + 2 * padding;
+            if (w > layerWidth || h > layerHeight)
+            {
+                std::cout << "ERROR::TEXTURE_ARRAY_PACKER::IMAGE_TOO_LARGE " << image.width << "x" << image.height << std::endl;
+                continue;
+            }
+            if (layer >= 0 && shelfX + w > layerWidth)
+            {
+                // next shelf
+                shelfY += shelfHeight;
+                shelfX = 0;
+                shelfHeight = 0;
+            }
+            if (layer < 0 || shelfY + h > layerHeight)
+            {
+                // next layer
+                ++layer;
+                layerPixels.push_back(std::vector<unsigned char>((size_t)layerWidth * layerHeight * 4, 0));
+                shelfX = shelfY = shelfHeight = 0;
+            }
+            blit(image, layerPixels[layer], shelfX + padding, shelfY + padding);
+            SpriteRegion& region = regions[order[k]];
+            region.uvRect[0] = (float)(shelfX + padding) / layerWidth;
+            region.uvRect[1] = (float)(shelfY + padding) / layerHeight;
+            region.uvRect[2] = (float)image.width / layerWidth;
+            region.uvRect[3] = (float)image.height / layerHeight;
+            region.layer = (float)layer;
+            shelfX += w;
+            shelfHeight = std::max(shelfHeight, h);
+        }
+        layers = (int)layerPixels.size();
+        if (layers == 0)
+            return 0;
+
+        std::vector<unsigned char> all;
+        all.reserve((size_t)layerWidth * layerHeight * 4 * layers);
+        for (int i = 0; i < layers; ++i)
+            all.insert(all.end(), layerPixels[i].begin(), layerPixels[i].end());
+
+        glGenTextures(1, &ID);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, ID);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, mipmaps ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_RGBA8, layerWidth, layerHeight, layers, 0, GL_RGBA, GL_UNSIGNED_BYTE, &all[0]);
+        if (mipmaps)
+            glGenerateMipmap(GL_TEXTURE_2D_ARRAY);
+        return ID;
+    }
+    // de-allocate the array texture
+    // ------------------------------------------------------------------------
+    void release()
+    {
+        glDeleteTextures(1, &ID);
+        ID = 0;
+    }
+
+    const SpriteRegion& region(int index) const { return regions[index]; }
+    const std::vector<SpriteRegion>& allRegions() const { return regions; }
+    int imageCount() const { return (int)images.size(); }
+    int layerCount() const { return layers; }
+
+private:
+    struct Image
+    {
+        int width, height;
+        std::vector<unsigned char> pixels;
+    };
+    struct TallerFirst
+    {
+        const std::vector<Image>& images;
+        explicit TallerFirst(const std::vector<Image>& images) : images(images) {}
+        bool operator()(int a, int b) const
+        {
+            if (images[a].height != images[b].height)
+                return images[a].height > images[b].height;
+            return a < b;
+        }
+    };
+
+    int layerWidth, layerHeight, padding;
+    int layers;
+    std::vector<Image> images;
+    std::vector<SpriteRegion> regions;
+
+    // copy the image to (x, y) and extrude its edge texels into the padding
+    void blit(const Image& image, std::vector<unsigned char>& layer, int x, int y) const
+    {
+        for (int row = -padding; row < image.height + padding; ++row)
+        {
+            int srcRow = std::min(std::max(row, 0), image.height - 1);
+            for (int col = -padding; col < image.width + padding; ++col)
+            {
+                int srcCol = std::min(std::max(col, 0), image.width - 1);
+                const unsigned char* src = &image.pixels[((size_t)srcRow * image.width + srcCol) * 4];
+                unsigned char* dst = &layer[((size_t)(y + row) * layerWidth + (x + col)) * 4];
+                std::memcpy(dst, src, 4);
+            }
+        }
+    }
+};
+#endif
@@ -0,0 +1,285 @@
+#ifndef TEXTURE_LOADER_H
+#define TEXTURE_LOADER_H
+
+#include <glad/glad.h>
+#include <stb_image.h>
+
+#include <pixel_upload_ring.h>
+
+#include <string>
+#include <deque>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <cstring>
+
+// decodes images with stb_image on a pool of worker threads and uploads them on the
+// GL thread. load() returns a texture name immediately (holding a 1x1 placeholder),
+// update() is called once per frame and uploads finished decodes until its time
+// budget is spent, so the render loop starts right away and decoding uses every core.
+//
+// workers hand results back through a lock-free stack (push with CAS, the GL thread
+// takes the whole list with one exchange), the GL thread never blocks on a worker.
+//
+// with a PixelUploadRing the pixels go through a PBO: on a persistent ring the worker
+// copies its decode straight into mapped memory and the GL thread only issues
+// glTexImage2D from a buffer offset, which returns without the driver's copy.
+class TextureLoader
+{
+public:
+    struct Options
+    {
+        bool flipVertically;
+        bool generateMipmaps;
+        GLenum wrap;
+        GLenum minFilter;
+        GLenum magFilter;
+
+        Options()
+            : flipVertically(true), generateMipmaps(true), wrap(GL_REPEAT),
+              minFilter(GL_LINEAR_MIPMAP_LINEAR), magFilter(GL_LINEAR)
+        {}
+    };
+
+    // threadCount 0 uses every core but one, the GL thread keeps its own.
+    // ring is optional and must outlive the loader
+    // ------------------------------------------------------------------------
+    explicit TextureLoader(unsigned int threadCount = 0, PixelUploadRing* ring = NULL)
+        : ring(ring), completed(NULL), requested(0), uploaded(0), stopping(false)
+    {
+        if (threadCount == 0)
+        {
+            unsigned int cores = std::thread::hardware_concurrency();
+            threadCount = cores > 1 ? cores - 1 : 1;
+        }
+        for (unsigned int i = 0; i < threadCount; ++i)
+            workers.push_back(std::thread(&TextureLoader::workerMain, this));
+    }
+    ~TextureLoader()
+    {
+        shutdown();
+    }
+    // joins the workers and frees pixels that were never uploaded. no GL calls,
+    // the texture objects belong to the caller. call it before releasing the ring:
+    // workers may still be writing into it and unfinished jobs hand their regions
+    // back to it. safe to call more than once, the destructor calls it too.
+    // ------------------------------------------------------------------------
+    void shutdown()
+    {
+        {
+            std::lock_guard<std::mutex> lock(jobMutex);
+            stopping = true;
+        }
+        jobAvailable.notify_all();
+        for (size_t i = 0; i < workers.size(); ++i)
+            workers[i].join();
+        workers.clear();
+        for (size_t i = 0; i < jobs.size(); ++i)
+            delete jobs[i];
+        jobs.clear();
+        collectCompleted();
+        for (size_t i = 0; i < ready.size(); ++i)
+            freeJob(ready[i]);
+        ready.clear();
+    }
+
+    // GL thread: create the texture object and queue the file for decoding
+    // ------------------------------------------------------------------------
+    unsigned int load(const char* path, const Options& options = Options())
+    {
+        unsigned int texture;
+        glGenTextures(1, &texture);
+        glBindTexture(GL_TEXTURE_2D, texture);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, options.wrap);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, options.wrap);
+        // the placeholder has no mips, sample it without until the real image arrives
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, options.magFilter);
+        const unsigned char placeholder[4] = {255, 255, 255, 255};
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, placeholder);
+
+        Job* job = new Job();
+        job->path = path;
+        job->texture = texture;
+        job->options = options;
+        ++requested;
+        {
+            std::lock_guard<std::mutex> lock(jobMutex);
+            jobs.push_back(job);
+        }
+        jobAvailable.notify_one();
+        return texture;
+    }
+
+    // GL thread, once per frame: upload decoded images until budgetMs is used up.
+    // at least one image is uploaded per call so progress never stalls. returns
+    // the number of textures uploaded; texture bindings of the active unit change.
+    // ------------------------------------------------------------------------
+    unsigned int update(double budgetMs)
+    {
+        if (ring)
+            ring->retire();
+        collectCompleted();
+        if (ready.empty())
+            return 0;
+
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        unsigned int count = 0;
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        while (!ready.empty())
+        {
+            Job* job = ready.front();
+            ready.pop_front();
+            upload(job);
+            freeJob(job);
+            ++count;
+            double elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+            if (elapsed >= budgetMs)
+                break;
+        }
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        uploaded += count;
+        return count;
+    }
+    // GL thread: block until every requested texture is uploaded (loading screens, benchmarks)
+    // ------------------------------------------------------------------------
+    void finish()
+    {
+        while (pending() > 0)
+        {
+            if (update(1e9) == 0)
+                std::this_thread::yield();
+        }
+    }
+
+    // requested but not uploaded yet
+    unsigned int pending() const { return requested - uploaded; }
+    unsigned int uploadedCount() const { return uploaded; }
+    unsigned int threadCount() const { return (unsigned int)workers.size(); }
+
+private:
+    struct Job
+    {
+        std::string path;
+        unsigned int texture;
+        Options options;
+        unsigned char* pixels;
+        int width, height, channels;
+        // staging space in the ring, the pixels were already copied there
+        bool staged;
+        PixelUploadRing::Region region;
+        Job* next;
+
+        Job() : texture(0), pixels(NULL), width(0), height(0), channels(0), staged(false), next(NULL) {}
+    };
+
+    PixelUploadRing* ring;
+    std::vector<std::thread> workers;
+    // decode queue, only touched under jobMutex
+    std::deque<Job*> jobs;
+    std::mutex jobMutex;
+    std::condition_variable jobAvailable;
+    // completion stack, workers push, the GL thread takes everything at once
+    std::atomic<Job*> completed;
+    // GL thread only
+    std::deque<Job*> ready;
+    unsigned int requested;
+    unsigned int uploaded;
+    bool stopping;
+
+    void workerMain()
+    {
+        for (;;)
+        {
+            Job* job;
+            {
+                std::unique_lock<std::mutex> lock(jobMutex);
+                while (jobs.empty() && !stopping)
+                    jobAvailable.wait(lock);
+                if (stopping)
+                    return;
+                job = jobs.front();
+                jobs.pop_front();
+            }
+            // the flip flag is per thread, so workers may use different settings
+            stbi_set_flip_vertically_on_load_thread(job->options.flipVertically ? 1 : 0);
+            job->pixels = stbi_load(job->path.c_str(), &job->width, &job->height, &job->channels, 0);
+            if (!job->pixels)
+                std::cout << "Failed to load texture " << job->path << ": " << stbi_failure_reason() << std::endl;
+            else if (ring && ring->persistent() && ring->tryAcquire(imageSize(job), job->region))
+            {
+                std::memcpy(job->region.ptr, job->pixels, job->region.size);
+                stbi_image_free(job->pixels);
+                job->pixels = NULL;
+                job->staged = true;
+            }
+            pushCompleted(job);
+        }
+    }
+    void pushCompleted(Job* job)
+    {
+        Job* head = completed.load(std::memory_order_relaxed);
+        do
+        {
+            job->next = head;
+        } while (!completed.compare_exchange_weak(head, job, std::memory_order_release, std::memory_order_relaxed));
+    }
+    // move everything the workers finished into the GL thread's FIFO, oldest first
+    void collectCompleted()
+    {
+        Job* list = completed.exchange(NULL, std::memory_order_acquire);
+        size_t insertAt = ready.size();
+        for (; list; list = list->next)
+            ready.insert(ready.begin() + insertAt, list);
+    }
+    void upload(Job* job)
+    {
+        if (!job->pixels && !job->staged)
+            return;
+        GLenum format = GL_RGBA;
+        switch (job->channels)
+        {
+            case 1: format = GL_RED; break;
+            case 2: format = GL_RG; break;
+            case 3: format = GL_RGB; break;
+            default: break;
+        }
+        glBindTexture(GL_TEXTURE_2D, job->texture);
+        // non-persistent ring: stage on this thread, the PBO upload still avoids the driver copy
+        if (!job->staged && ring && !ring->persistent() && ring->tryAcquire(imageSize(job), job->region))
+        {
+            ring->write(job->region, job->pixels);
+            job->staged = true;
+        }
+        if (job->staged)
+        {
+            ring->upload(job->region, format, job->width, job->height, format, GL_UNSIGNED_BYTE);
+            job->staged = false;
+        }
+        else
+            glTexImage2D(GL_TEXTURE_2D, 0, format, job->width, job->height, 0, format, GL_UNSIGNED_BYTE, job->pixels);
+        if (job->options.generateMipmaps)
+            glGenerateMipmap(GL_TEXTURE_2D);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, job->options.minFilter);
+    }
+    static size_t imageSize(const Job* job)
+    {
+        return (size_t)job->width * job->height * job->channels;
+    }
+    void freeJob(Job* job)
+    {
+        if (job->staged)
+            ring->discard(job->region);
+        if (job->pixels)
+            stbi_image_free(job->pixels);
+        delete job;
+    }
+
+    TextureLoader(const TextureLoader&);
+    TextureLoader& operator=(const TextureLoader&);
+};
+#endif
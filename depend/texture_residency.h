@@ -0,0 +1,361 @@
+#ifndef TEXTURE_RESIDENCY_H
+#define TEXTURE_RESIDENCY_H
+
+#include <glad/glad.h>
+
+#include <gl_ext.h>
+#include <gl_state.h>
+#include <cooked_texture.h>
+#include <profiler.h>
+
+#include <vector>
+#include <cstring>
+#include <cstdint>
+#include <iostream>
+
+// owns the textures of a content set and keeps their GPU memory under a budget.
+//
+//     TextureResidency textures(64 << 20);                         // 64 MB of texels
+//     TextureResidency::Handle wall = textures.add(file.data(), file.size());
+//     ...
+//     glState.bindTextureUnit(0, GL_TEXTURE_2D, textures.use(wall));   // marks it used
+//     ...
+//     textures.update(glState);                                    // once per frame
+//     textures.report(profiler);
+//
+// streamed textures come from cooked textures (.oritex, a MappedFile or an asset archive
+// entry) whose bytes stay mapped as the backing store. add() uploads only the mip tail,
+// the levels of at most TAIL_SIZE texels, so every texture can be drawn right away.
+// update() then streams the next larger level into the textures used since the last
+// update, the blurriest first, up to uploadBudget bytes per frame, and moves
+// GL_TEXTURE_BASE_LEVEL down as levels arrive. when a level does not fit the budget the
+// largest resident level of the least recently used texture is dropped: the base level
+// moves up and the level is respecified as 0x0, which lets the driver free it while
+// the texture name, and anything holding it, stays valid.
+//
+// textures made elsewhere, e.g. stbi_load + glGenerateMipmap, can be handed over with
+// track(): they count against the budget with their whole mip chain but are not
+// streamed or evicted. everything is deleted by release().
+class TextureResidency
+{
+public:
+    typedef uint32_t Handle;
+    static const Handle INVALID = 0xFFFFFFFFu;
+    // levels of at most this many texels per side stay resident
+    static const uint32_t TAIL_SIZE = 32;
+
+    struct Stats
+    {
+        size_t textures;
+        size_t fullyResident;
+        uint64_t residentBytes;
+        uint64_t budgetBytes;
+        // of the last update()
+        unsigned long streamedLevels;
+        unsigned long evictedLevels;
+        uint64_t streamedBytes;
+        uint64_t evictedBytes;
+        // a used texture was missing levels and nothing older could be evicted for them
+        bool overBudget;
+        // since construction
+        unsigned long totalStreamedLevels;
+        unsigned long totalEvictedLevels;
+    };
+
+    explicit TextureResidency(uint64_t budgetBytes, uint64_t uploadBudget = 4u << 20)
+        : budget(budgetBytes), uploadBudget(uploadBudget), resident(0), frame(1)
+    {
+        std::memset(&stats, 0, sizeof(stats));
+    }
+
+    // GPU bytes of a w x h texture, with the whole chain glGenerateMipmap would build
+    // ------------------------------------------------------------------------
+    static uint64_t textureBytes(uint32_t width, uint32_t height, uint32_t bytesPerTexel, bool mipmapped)
+    {
+        uint64_t bytes = 0;
+        while (true)
+        {
+            bytes += (uint64_t)width * height * bytesPerTexel;
+            if (!mipmapped || (width == 1 && height == 1))
+                return bytes;
+            width = width > 1 ? width / 2 : 1;
+            height = height > 1 ? height / 2 : 1;
+        }
+    }
+
+    // a cooked texture, the bytes must stay valid until release(). returns INVALID if
+    // they are not a cooked texture or its format is not supported. pass the state
+    // cache once one exists, the texture is bound through it on unit 0; without one
+    // the bind goes to the active unit directly
+    // ------------------------------------------------------------------------
+    Handle add(const void* data, size_t size, GLenum wrap = GL_REPEAT, GLStateCache* state = NULL)
+    {
+        Entry entry;
+        if (!entry.source.parse(data, size))
+        {
+            std::cout << "ERROR::TEXTURE_RESIDENCY::NOT_A_COOKED_TEXTURE" << std::endl;
+            return INVALID;
+        }
+        const CookedTextureHeader& h = *entry.source.header;
+        if (entry.source.compressed() && !glExt().textureCompressionS3TC)
+        {
+            std::cout << "ERROR::TEXTURE_RESIDENCY::S3TC_NOT_SUPPORTED" << std::endl;
+            return INVALID;
+        }
+        // the tail starts at the first level that is small enough, or is the last level
+        entry.tail = h.mipCount - 1;
+        for (uint32_t i = 0; i < h.mipCount; ++i)
+        {
+            if (entry.source.levels[i].width <= TAIL_SIZE && entry.source.levels[i].height <= TAIL_SIZE)
+            {
+                entry.tail = i;
+                break;
+            }
+        }
+        entry.base = entry.tail;
+        entry.bytes = 0;
+        entry.lastUse = 0;
+        glGenTextures(1, &entry.texture);
+        if (state)
+            bindForEdit(*state, entry.texture);
+        else
+            glBindTexture(GL_TEXTURE_2D, entry.texture);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, wrap);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, wrap);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, h.mipCount > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, (GLint)h.mipCount - 1);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        for (uint32_t i = entry.tail; i < h.mipCount; ++i)
+        {
+            uploadLevel(entry, i);
+            entry.bytes += entry.source.levels[i].size;
+        }
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, (GLint)entry.base);
+        resident += entry.bytes;
+        entries.push_back(entry);
+        return (Handle)entries.size() - 1;
+    }
+
+    // take ownership of a texture created elsewhere, accounted with textureBytes()
+    // ------------------------------------------------------------------------
+    Handle track(unsigned int texture, uint32_t width, uint32_t height, uint32_t bytesPerTexel, bool mipmapped)
+    {
+        Entry entry;
+        entry.texture = texture;
+        entry.base = entry.tail = 0;
+        entry.bytes = textureBytes(width, height, bytesPerTexel, mipmapped);
+        entry.lastUse = 0;
+        resident += entry.bytes;
+        entries.push_back(entry);
+        return (Handle)entries.size() - 1;
+    }
+
+    // the GL name to bind for drawing, marks the texture as used this frame
+    // ------------------------------------------------------------------------
+    unsigned int use(Handle handle)
+    {
+        Entry& entry = entries[handle];
+        entry.lastUse = frame;
+        return entry.texture;
+    }
+    void bind(GLStateCache& state, unsigned int unit, Handle handle)
+    {
+        state.bindTextureUnit(unit, GL_TEXTURE_2D, use(handle));
+    }
+
+    // stream levels into what was used since the last update and evict for them, then
+    // start the next frame. the textures are edited on unit 0 through the state cache,
+    // which is left as the active unit
+    // ------------------------------------------------------------------------
+    void update(GLStateCache& state)
+    {
+        stats.streamedLevels = stats.evictedLevels = 0;
+        stats.streamedBytes = stats.evictedBytes = 0;
+        stats.overBudget = false;
+        // a lowered budget: shed what was not used this frame
+        while (resident > budget && evictOne(state, frame))
+        {
+        }
+
+        bool unpackSet = false;
+        uint64_t uploaded = 0;
+        while (uploaded < uploadBudget)
+        {
+            Entry* next = nextToStream();
+            if (!next)
+                break;
+            uint32_t level = next->base - 1;
+            uint64_t bytes = next->source.levels[level].size;
+            // only textures used less recently than this one make room for it
+            while (resident + bytes > budget && evictOne(state, next->lastUse))
+            {
+            }
+            if (resident + bytes > budget)
+            {
+                stats.overBudget = true;
+                break;
+            }
+            bindForEdit(state, next->texture);
+            if (!unpackSet)
+            {
+                glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+                unpackSet = true;
+            }
+            /// 先上传更大的一级，再把基础级别往下移，采样器从不会看到缺失的级别
+            uploadLevel(*next, level);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, (GLint)level);
+            next->base = level;
+            next->bytes += bytes;
+            resident += bytes;
+            uploaded += bytes;
+            ++stats.streamedLevels;
+            stats.streamedBytes += bytes;
+        }
+        if (unpackSet)
+            glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        stats.totalStreamedLevels += stats.streamedLevels;
+        stats.totalEvictedLevels += stats.evictedLevels;
+        stats.textures = entries.size();
+        stats.fullyResident = 0;
+        for (size_t i = 0; i < entries.size(); ++i)
+            stats.fullyResident += entries[i].base == 0 ? 1 : 0;
+        stats.residentBytes = resident;
+        stats.budgetBytes = budget;
+        ++frame;
+    }
+
+    void setBudget(uint64_t bytes) { budget = bytes; }
+    uint64_t budgetBytes() const { return budget; }
+    uint64_t residentBytes() const { return resident; }
+    uint64_t residentBytes(Handle handle) const { return entries[handle].bytes; }
+    // the largest resident level, 0 when the texture is complete
+    uint32_t residentLevel(Handle handle) const { return entries[handle].base; }
+    size_t size() const { return entries.size(); }
+    const Stats& statistics() const { return stats; }
+
+    // the residency of the last update() as profiler counters
+    // ------------------------------------------------------------------------
+    void report(Profiler& profiler) const
+    {
+        profiler.counter("texture resident MB", (float)(stats.residentBytes / (1024.0 * 1024.0)));
+        profiler.counter("texture complete", (float)stats.fullyResident);
+        profiler.counter("texture streamed KB", (float)(stats.streamedBytes / 1024.0));
+        profiler.counter("texture evicted KB", (float)(stats.evictedBytes / 1024.0));
+    }
+    void printStats(std::ostream& out) const
+    {
+        out << "texture residency: " << entries.size() << " textures, " << stats.fullyResident << " complete, "
+            << (resident >> 10) << " / " << (budget >> 10) << " KB resident, " << stats.totalStreamedLevels
+            << " levels streamed, " << stats.totalEvictedLevels << " evicted" << std::endl;
+    }
+
+    // delete every texture, streamed and tracked, needs the context
+    // ------------------------------------------------------------------------
+    void release(GLStateCache* state = NULL)
+    {
+        for (size_t i = 0; i < entries.size(); ++i)
+        {
+            if (state)
+                state->onDeleteTexture(entries[i].texture);
+            glDeleteTextures(1, &entries[i].texture);
+        }
+        entries.clear();
+        resident = 0;
+    }
+
+private:
+    struct Entry
+    {
+        unsigned int texture;
+        // empty for tracked textures
+        CookedTextureView source;
+        // the largest resident level, and the first level that is never evicted
+        uint32_t base;
+        uint32_t tail;
+        uint64_t bytes;
+        uint64_t lastUse;
+    };
+
+    std::vector<Entry> entries;
+    uint64_t budget;
+    uint64_t uploadBudget;
+    uint64_t resident;
+    // use() stamps this, update() advances it
+    uint64_t frame;
+    Stats stats;
+
+    // the glTex* calls that follow act on the active unit: select unit 0 explicitly,
+    // bindTextureUnit skips glActiveTexture when the texture is already bound there
+    static void bindForEdit(GLStateCache& state, unsigned int texture)
+    {
+        state.activeTexture(GL_TEXTURE0);
+        state.bindTexture(GL_TEXTURE_2D, texture);
+    }
+    void uploadLevel(const Entry& entry, uint32_t i)
+    {
+        const CookedTextureHeader& h = *entry.source.header;
+        const CookedTextureLevel& level = entry.source.levels[i];
+        const unsigned char* pixels = entry.source.base + level.offset;
+        if (entry.source.compressed())
+            glCompressedTexImage2D(GL_TEXTURE_2D, (GLint)i, h.internalFormat, level.width, level.height, 0,
+                                   (GLsizei)level.size, pixels);
+        else
+            glTexImage2D(GL_TEXTURE_2D, (GLint)i, (GLint)h.internalFormat, level.width, level.height, 0,
+                         h.format, h.type, pixels);
+    }
+
+    // of the textures used since the last update and missing levels, the one with the
+    // least detail, so everything on screen sharpens evenly
+    Entry* nextToStream()
+    {
+        Entry* best = NULL;
+        for (size_t i = 0; i < entries.size(); ++i)
+        {
+            Entry& entry = entries[i];
+            if (entry.lastUse != frame || entry.base == 0 || !entry.source.header)
+                continue;
+            if (!best || entry.base > best->base)
+                best = &entry;
+        }
+        return best;
+    }
+
+    // drop the largest level of the least recently used texture last used before
+    // usedBefore that still has levels above its tail. false if there is none
+    bool evictOne(GLStateCache& state, uint64_t usedBefore)
+    {
+        Entry* victim = NULL;
+        for (size_t i = 0; i < entries.size(); ++i)
+        {
+            Entry& entry = entries[i];
+            if (entry.lastUse >= usedBefore || entry.base >= entry.tail || !entry.source.header)
+                continue;
+            // the oldest, and of those the most detailed
+            if (!victim || entry.lastUse < victim->lastUse ||
+                (entry.lastUse == victim->lastUse && entry.base < victim->base))
+                victim = &entry;
+        }
+        if (!victim)
+            return false;
+        uint32_t level = victim->base;
+        uint64_t bytes = victim->source.levels[level].size;
+        const CookedTextureHeader& h = *victim->source.header;
+        bindForEdit(state, victim->texture);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, (GLint)level + 1);
+        // levels below the base are not part of the completeness check, 0x0 frees them
+        glTexImage2D(GL_TEXTURE_2D, (GLint)level, (GLint)h.internalFormat, 0, 0, 0,
+                     h.format ? h.format : GL_RGBA, h.type ? h.type : GL_UNSIGNED_BYTE, NULL);
+        victim->base = level + 1;
+        victim->bytes -= bytes;
+        resident -= bytes;
+        ++stats.evictedLevels;
+        stats.evictedBytes += bytes;
+        return true;
+    }
+
+    TextureResidency(const TextureResidency&);
+    TextureResidency& operator=(const TextureResidency&);
+};
+#endif
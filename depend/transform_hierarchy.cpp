@@ -0,0 +1,265 @@
+#include "transform_hierarchy.h"
+#include "batch_transform.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+// out = a * b, column-major, out must not alias a or b
+inline void multiply(const float* a, const float* b, float* out)
+{
+    for (int column = 0; column < 4; ++column)
+    {
+        const float* bc = b + column * 4;
+        for (int row = 0; row < 4; ++row)
+            out[column * 4 + row] = a[row] * bc[0] + a[4 + row] * bc[1] + a[8 + row] * bc[2] + a[12 + row] * bc[3];
+    }
+}
+
+template<typename T>
+void permute(std::vector<T>& values, const std::vector<uint32_t>& order)
+{
+    std::vector<T> sorted(values.size());
+    for (size_t i = 0; i < order.size(); ++i)
+        sorted[i] = values[order[i]];
+    values.swap(sorted);
+}
+}
+
+const TransformHierarchy::Node TransformHierarchy::ROOT;
+
+// ------------------------------------------------------------------------
+TransformHierarchy::TransformHierarchy() : topologyChanged(false)
+{
+    std::memset(&stats, 0, sizeof(stats));
+}
+
+TransformHierarchy::Node TransformHierarchy::add(Node parentNode, float px, float py, float pz, float a, float scale)
+{
+    // appended at the end, after its parent; update() restores the depth-first order
+    Node node = (Node)nodeIndex.size();
+    uint32_t i = (uint32_t)parent.size();
+    nodeIndex.push_back(i);
+    indexNode.push_back(node);
+    parent.push_back(parentNode == ROOT ? ROOT : nodeIndex[parentNode]);
+    subtreeEnd.push_back(i + 1);
+    x.push_back(px);
+    y.push_back(py);
+    z.push_back(pz);
+    angle.push_back(a);
+    scaleX.push_back(scale);
+    scaleY.push_back(scale);
+    scaleZ.push_back(scale);
+    localMatrices.resize(localMatrices.size() + 16);
+    worldMatrices.resize(worldMatrices.size() + 16);
+    dirty.push_back(0);
+    topologyChanged = true;
+    return node;
+}
+
+void TransformHierarchy::setPosition(Node node, float px, float py, float pz)
+{
+    uint32_t i = nodeIndex[node];
+    x[i] = px;
+    y[i] = py;
+    z[i] = pz;
+    markDirty(i);
+}
+
+void TransformHierarchy::setAngle(Node node, float a)
+{
+    uint32_t i = nodeIndex[node];
+    angle[i] = a;
+    markDirty(i);
+}
+
+void TransformHierarchy::setScale(Node node, float sx, float sy, float sz)
+{
+    uint32_t i = nodeIndex[node];
+    scaleX[i] = sx;
+    scaleY[i] = sy;
+    scaleZ[i] = sz;
+    markDirty(i);
+}
+
+void TransformHierarchy::markDirty(uint32_t i)
+{
+    if (dirty[i])
+        return;
+    dirty[i] = 1;
+    dirtyList.push_back(i);
+}
+
+// ------------------------------------------------------------------------
+void TransformHierarchy::update()
+{
+    std::memset(&stats, 0, sizeof(stats));
+    ranges.clear();
+    if (parent.empty())
+        return;
+    if (topologyChanged)
+    {
+        reorder();
+        // every local, every world
+        dirtyList.resize(parent.size());
+        for (uint32_t i = 0; i < (uint32_t)parent.size(); ++i)
+        {
+            dirty[i] = 1;
+            dirtyList[i] = i;
+        }
+        stats.reordered = true;
+        topologyChanged = false;
+    }
+    if (dirtyList.empty())
+        return;
+
+    rebuildLocals();
+
+    // parents first; a dirty node inside a subtree already recomputed is covered
+    std::sort(dirtyList.begin(), dirtyList.end());
+    uint32_t covered = 0;
+    for (size_t k = 0; k < dirtyList.size(); ++k)
+    {
+        uint32_t i = dirtyList[k];
+        dirty[i] = 0;
+        if (i < covered)
+            continue;
+        recompute(i, subtreeEnd[i]);
+        if (!ranges.empty() && ranges.back().first + ranges.back().count == i)
+            ranges.back().count += subtreeEnd[i] - i;
+        else
+        {
+            Range range = { i, subtreeEnd[i] - i };
+            ranges.push_back(range);
+        }
+        covered = subtreeEnd[i];
+    }
+    dirtyList.clear();
+    stats.ranges = ranges.size();
+}
+
+// gather the dirty nodes' inputs into contiguous arrays, one batch build, scatter back
+// ------------------------------------------------------------------------
+void TransformHierarchy::rebuildLocals()
+{
+    size_t n = dirtyList.size();
+    scratch.resize(n * (7 + 16));
+    float* in = &scratch[0];
+    float* out = in + n * 7;
+    for (size_t k = 0; k < n; ++k)
+    {
+        uint32_t i = dirtyList[k];
+        in[k] = x[i];
+        in[n + k] = y[i];
+        in[2 * n + k] = z[i];
+        in[3 * n + k] = angle[i];
+        in[4 * n + k] = scaleX[i];
+        in[5 * n + k] = scaleY[i];
+        in[6 * n + k] = scaleZ[i];
+    }
+    TransformBatchInput batch;
+    batch.x = in;
+    batch.y = in + n;
+    batch.z = in + 2 * n;
+    batch.angle = in + 3 * n;
+    batch.scaleX = in + 4 * n;
+    batch.scaleY = in + 5 * n;
+    batch.scaleZ = in + 6 * n;
+    buildTransforms(batch, n, out);
+    for (size_t k = 0; k < n; ++k)
+        std::memcpy(&localMatrices[(size_t)dirtyList[k] * 16], out + k * 16, 16 * sizeof(float));
+    stats.localsRebuilt = n;
+}
+
+// worlds of [first, end), a subtree in depth-first order: parents are done before children
+// ------------------------------------------------------------------------
+void TransformHierarchy::recompute(uint32_t first, uint32_t end)
+{
+    for (uint32_t i = first; i < end; ++i)
+    {
+        float* world = &worldMatrices[(size_t)i * 16];
+        const float* local = &localMatrices[(size_t)i * 16];
+        if (parent[i] == ROOT)
+            std::memcpy(world, local, 16 * sizeof(float));
+        else
+            multiply(&worldMatrices[(size_t)parent[i] * 16], local, world);
+    }
+    stats.worldsRecomputed += end - first;
+}
+
+// depth-first preorder, children in the order they were added
+// ------------------------------------------------------------------------
+void TransformHierarchy::reorder()
+{
+    uint32_t n = (uint32_t)parent.size();
+    // children as linked lists through firstChild / nextSibling, in insertion order
+    std::vector<uint32_t> firstChild(n, ROOT), lastChild(n, ROOT), nextSibling(n, ROOT);
+    std::vector<uint32_t> roots;
+    for (uint32_t i = 0; i < n; ++i)
+    {
+        uint32_t p = parent[i];
+        if (p == ROOT)
+        {
+            roots.push_back(i);
+            continue;
+        }
+        if (firstChild[p] == ROOT)
+            firstChild[p] = i;
+        else
+            nextSibling[lastChild[p]] = i;
+        lastChild[p] = i;
+    }
+
+    std::vector<uint32_t> order;
+    order.reserve(n);
+    std::vector<uint32_t> stack;
+    for (size_t r = roots.size(); r-- > 0;)
+        stack.push_back(roots[r]);
+    while (!stack.empty())
+    {
+        uint32_t i = stack.back();
+        stack.pop_back();
+        order.push_back(i);
+        // push the children reversed so the first one is visited first
+        size_t mark = stack.size();
+        for (uint32_t c = firstChild[i]; c != ROOT; c = nextSibling[c])
+            stack.push_back(c);
+        std::reverse(stack.begin() + mark, stack.end());
+    }
+
+    std::vector<uint32_t> newIndex(n);
+    for (uint32_t k = 0; k < n; ++k)
+        newIndex[order[k]] = k;
+    for (uint32_t i = 0; i < n; ++i)
+        parent[i] = parent[i] == ROOT ? ROOT : newIndex[parent[i]];
+    permute(parent, order);
+    permute(x, order);
+    permute(y, order);
+    permute(z, order);
+    permute(angle, order);
+    permute(scaleX, order);
+    permute(scaleY, order);
+    permute(scaleZ, order);
+    permute(indexNode, order);
+    for (uint32_t k = 0; k < n; ++k)
+        nodeIndex[indexNode[k]] = k;
+
+    // a subtree ends where the next node with a parent outside it starts; walking
+    // backwards every node extends its parent's end to its own
+    for (uint32_t k = 0; k < n; ++k)
+        subtreeEnd[k] = k + 1;
+    for (uint32_t k = n; k-- > 0;)
+    {
+        if (parent[k] != ROOT)
+            subtreeEnd[parent[k]] = std::max(subtreeEnd[parent[k]], subtreeEnd[k]);
+    }
+}
+
+// ------------------------------------------------------------------------
+void TransformHierarchy::printStats(std::ostream& out) const
+{
+    out << "transform hierarchy: " << size() << " nodes, last update rebuilt " << stats.localsRebuilt << " locals, "
+        << stats.worldsRecomputed << " worlds in " << stats.ranges << " ranges" << (stats.reordered ? " (reordered)" : "")
+        << std::endl;
+}
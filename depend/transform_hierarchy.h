@@ -0,0 +1,96 @@
+#ifndef TRANSFORM_HIERARCHY_H
+#define TRANSFORM_HIERARCHY_H
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+
+// a scene graph of transforms kept as flat SoA arrays in depth-first order, so every
+// parent comes before its children and every subtree is one contiguous range.
+//
+//     TransformHierarchy::Node sun = scene.add(TransformHierarchy::ROOT, 0, 0, 0);
+//     TransformHierarchy::Node planet = scene.add(sun, 0.5f, 0, 0, 0, 0.3f);
+//     ...
+//     scene.setAngle(sun, time);            // marks sun dirty
+//     scene.update();                       // only sun and its subtree are recomputed
+//     for (each range in scene.dirtyRanges())
+//         quads.updateInstances(range.first, scene.worlds() + range.first, range.count);
+//
+// nodes are local translate * rotateZ * scale, like the transformation samples. update()
+// gathers the dirty nodes' locals and rebuilds them with the SIMD batch builder, then
+// recomputes world = parent world * local over the subtree of every dirty node in
+// order. nodes that did not change and have no changed ancestor are not touched, and
+// dirtyRanges() lists the merged index ranges whose world matrix changed, i.e. what
+// has to go to the GPU.
+//
+// the handle from add() stays valid; index(node) is the node's slot in worlds() (and in
+// the instance buffer), it changes when nodes are added after an update().
+class TransformHierarchy
+{
+public:
+    typedef uint32_t Node;
+    static const Node ROOT = 0xFFFFFFFFu;
+
+    struct Range
+    {
+        uint32_t first;
+        uint32_t count;
+    };
+
+    // of the last update()
+    struct Stats
+    {
+        unsigned long localsRebuilt;
+        unsigned long worldsRecomputed;
+        unsigned long ranges;
+        // the topology changed, everything was recomputed in the new order
+        bool reordered;
+    };
+
+    TransformHierarchy();
+
+    // parent must already exist, or be ROOT
+    // ------------------------------------------------------------------------
+    Node add(Node parent, float x, float y, float z, float angle = 0.0f, float scale = 1.0f);
+    void setPosition(Node node, float x, float y, float z);
+    void setAngle(Node node, float angle);
+    void setScale(Node node, float x, float y, float z);
+
+    // recompute what changed since the last update()
+    void update();
+
+    size_t size() const { return parent.size(); }
+    uint32_t index(Node node) const { return nodeIndex[node]; }
+    // column-major mat4 per index, 16 floats each, glm::mat4 layout
+    const float* worlds() const { return worldMatrices.empty() ? NULL : &worldMatrices[0]; }
+    const float* world(Node node) const { return &worldMatrices[(size_t)nodeIndex[node] * 16]; }
+    const std::vector<Range>& dirtyRanges() const { return ranges; }
+    const Stats& statistics() const { return stats; }
+    void printStats(std::ostream& out) const;
+
+private:
+    // per index, depth-first order
+    std::vector<uint32_t> parent;
+    std::vector<uint32_t> subtreeEnd;
+    std::vector<float> x, y, z, angle, scaleX, scaleY, scaleZ;
+    std::vector<float> localMatrices;
+    std::vector<float> worldMatrices;
+    std::vector<uint8_t> dirty;
+    std::vector<uint32_t> dirtyList;
+    // handle <-> index
+    std::vector<uint32_t> nodeIndex;
+    std::vector<Node> indexNode;
+    bool topologyChanged;
+    std::vector<Range> ranges;
+    Stats stats;
+    // gathered inputs of the dirty locals
+    std::vector<float> scratch;
+
+    void markDirty(uint32_t i);
+    void reorder();
+    void rebuildLocals();
+    void recompute(uint32_t first, uint32_t end);
+};
+
+#endif
@@ -0,0 +1,107 @@
+#ifndef UNIFORM_BLOCK_H
+#define UNIFORM_BLOCK_H
+
+#include <glad/glad.h>
+
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <cstdint>
+
+// std140 uniform blocks shared by all programs. every block has a fixed binding point,
+// Shader binds the blocks it finds to them after each link, so data bound once per
+// frame with glBindBufferRange is seen by every program without per-program uploads.
+//
+// the C++ structs mirror the GLSL declarations byte for byte. std140 aligns vec4 and
+// mat4 (and vec3!) to 16 bytes and the whole block to 16, so members are declared with
+// alignas and the offsets are checked against the std140 rules at compile time with
+// STD140_OFFSET; Shader also compares the block size the driver reports with sizeof.
+// avoid vec3 in blocks: GLSL packs a following float into its padding, C++ does not.
+
+// a member's byte offset must match its std140 offset
+#define STD140_OFFSET(block, member, offset) \
+    static_assert(offsetof(block, member) == (offset), #block "." #member " is not at std140 offset " #offset)
+#define STD140_SIZE(block, size) \
+    static_assert(sizeof(block) == (size) && sizeof(block) % 16 == 0, #block " does not match its std140 size " #size)
+
+enum UniformBlockBinding
+{
+    FRAME_BLOCK_BINDING = 0,
+    OBJECT_BLOCK_BINDING = 1,
+    TEXTURE_HANDLE_BLOCK_BINDING = 2,
+};
+
+// once per frame, for every program:
+//     layout (std140) uniform FrameBlock
+//     {
+//         mat4 view;
+//         mat4 projection;
+//         vec4 time;          // x: seconds, y: delta seconds, z: frame index
+//     };
+struct FrameBlock
+{
+    alignas(16) glm::mat4 view;
+    alignas(16) glm::mat4 projection;
+    alignas(16) glm::vec4 time;
+};
+STD140_OFFSET(FrameBlock, view, 0);
+STD140_OFFSET(FrameBlock, projection, 64);
+STD140_OFFSET(FrameBlock, time, 128);
+STD140_SIZE(FrameBlock, 144);
+
+// once per object, uploaded for all objects in bulk and selected with glBindBufferRange:
+//     layout (std140) uniform ObjectBlock
+//     {
+//         mat4 model;
+//         vec4 color;
+//     };
+struct ObjectBlock
+{
+    alignas(16) glm::mat4 model;
+    alignas(16) glm::vec4 color;
+};
+STD140_OFFSET(ObjectBlock, model, 0);
+STD140_OFFSET(ObjectBlock, color, 64);
+STD140_SIZE(ObjectBlock, 80);
+
+// resident bindless texture handles (BindlessTextureSet), two per uvec4 because std140
+// pads every array element to 16 bytes; 16 KB is the smallest GL_MAX_UNIFORM_BLOCK_SIZE:
+//     layout (std140) uniform TextureHandleBlock
+//     {
+//         uvec4 handles[1024];   // handle i is handles[i / 2].xy or .zw
+//     };
+const unsigned int TEXTURE_HANDLE_CAPACITY = 2048;
+struct TextureHandleBlock
+{
+    alignas(16) uint64_t handles[TEXTURE_HANDLE_CAPACITY];
+};
+STD140_OFFSET(TextureHandleBlock, handles, 0);
+STD140_SIZE(TextureHandleBlock, 16384);
+
+// the name, binding and C++ size of a shared block, used by Shader after linking
+struct UniformBlockInfo
+{
+    const char* name;
+    unsigned int binding;
+    size_t size;
+};
+
+inline const UniformBlockInfo* uniformBlocks(int& count)
+{
+    static const UniformBlockInfo blocks[] = {
+            { "FrameBlock", FRAME_BLOCK_BINDING, sizeof(FrameBlock) },
+            { "ObjectBlock", OBJECT_BLOCK_BINDING, sizeof(ObjectBlock) },
+            { "TextureHandleBlock", TEXTURE_HANDLE_BLOCK_BINDING, sizeof(TextureHandleBlock) },
+    };
+    count = (int)(sizeof(blocks) / sizeof(blocks[0]));
+    return blocks;
+}
+
+// distance between consecutive blocks of an array uploaded in one go: glBindBufferRange
+// offsets must be multiples of GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT
+// ------------------------------------------------------------------------
+inline size_t uniformBlockStride(size_t blockSize, size_t offsetAlignment)
+{
+    return (blockSize + offsetAlignment - 1) / offsetAlignment * offsetAlignment;
+}
+#endif
@@ -0,0 +1,290 @@
+#ifndef VERTEX_LAYOUT_H
+#define VERTEX_LAYOUT_H
+
+#include <glad/glad.h>
+
+#include <mesh_data.h>
+
+#include <vector>
+#include <cstring>
+#include <cstdint>
+#include <cmath>
+#include <algorithm>
+
+// describes how MeshVertex attributes are stored in a vertex buffer, packs MeshData into
+// that layout and points the attributes of the bound VAO at it. the compact layout
+// quantizes to the narrowest format the vertex shader can still read without changes
+// to its inputs:
+//     position  GL_HALF_FLOAT x4 (w = 1)      8 bytes instead of 12
+//     texcoord  GL_UNSIGNED_SHORT x2, norm.   4 bytes instead of 8
+//     normal    GL_INT_2_10_10_10_REV, norm.  4 bytes instead of 12
+// 16 bytes per vertex instead of 32. unorm texcoords only cover [0, 1], so they are
+// remapped to the mesh's texcoord bounds; the shader undoes that with
+//     TexCoord = aTexCoord * texCoordTransform.xy + texCoordTransform.zw;
+// Mesh::texCoordTransform() holds the values, (1, 1, 0, 0) for float texcoords.
+// half positions keep 11 significant bits, plenty for meshes of about unit size.
+
+enum VertexSemantic
+{
+    SEMANTIC_POSITION = 0,
+    SEMANTIC_TEXCOORD,
+    SEMANTIC_NORMAL,
+};
+
+enum VertexFormat
+{
+    FORMAT_FLOAT2 = 0,
+    FORMAT_FLOAT3,
+    FORMAT_HALF4,
+    FORMAT_UNORM16X2,
+    FORMAT_SNORM_2_10_10_10,
+};
+
+struct VertexAttribute
+{
+    VertexSemantic semantic;
+    VertexFormat format;
+    unsigned int location;
+    unsigned int offset;
+};
+
+class VertexLayout
+{
+public:
+    static const int MAX_ATTRIBUTES = 8;
+
+    VertexLayout() : attributeCount(0), vertexStride(0) {}
+
+    // append an attribute, offsets follow in the order of the calls
+    // ------------------------------------------------------------------------
+    VertexLayout& add(VertexSemantic semantic, VertexFormat format, unsigned int location)
+    {
+        if (attributeCount == MAX_ATTRIBUTES)
+            return *this;
+        VertexAttribute& a = attributes[attributeCount++];
+        a.semantic = semantic;
+        a.format = format;
+        a.location = location;
+        a.offset = vertexStride;
+        vertexStride += formatSize(format);
+        return *this;
+    }
+
+    // the MeshVertex layout, all floats
+    static VertexLayout floats()
+    {
+        VertexLayout layout;
+        layout.add(SEMANTIC_POSITION, FORMAT_FLOAT3, MESH_POSITION_LOCATION)
+              .add(SEMANTIC_TEXCOORD, FORMAT_FLOAT2, MESH_TEXCOORD_LOCATION)
+              .add(SEMANTIC_NORMAL, FORMAT_FLOAT3, MESH_NORMAL_LOCATION);
+        return layout;
+    }
+    // every attribute quantized, see the table at the top
+    static VertexLayout compact()
+    {
+        VertexLayout layout;
+        layout.add(SEMANTIC_POSITION, FORMAT_HALF4, MESH_POSITION_LOCATION)
+              .add(SEMANTIC_TEXCOORD, FORMAT_UNORM16X2, MESH_TEXCOORD_LOCATION)
+              .add(SEMANTIC_NORMAL, FORMAT_SNORM_2_10_10_10, MESH_NORMAL_LOCATION);
+        return layout;
+    }
+
+    unsigned int stride() const { return vertexStride; }
+    int size() const { return attributeCount; }
+    const VertexAttribute& attribute(int i) const { return attributes[i]; }
+
+    // configure the attributes for the VAO and GL_ARRAY_BUFFER currently bound
+    // ------------------------------------------------------------------------
+    void apply() const
+    {
+        for (int i = 0; i < attributeCount; ++i)
+        {
+            const VertexAttribute& a = attributes[i];
+            glVertexAttribPointer(a.location, formatComponents(a.format), formatType(a.format),
+                                  formatNormalized(a.format), (GLsizei)vertexStride, (void*)(uintptr_t)a.offset);
+            glEnableVertexAttribArray(a.location);
+        }
+    }
+
+    // write mesh.vertices in this layout into out. texCoordTransform receives the
+    // dequantization scale (xy) and offset (zw) for the texcoords
+    // ------------------------------------------------------------------------
+    void pack(const MeshData& mesh, std::vector<unsigned char>& out, float texCoordTransform[4]) const
+    {
+        float minUV[2] = { 0.0f, 0.0f }, maxUV[2] = { 1.0f, 1.0f };
+        texCoordBounds(mesh, minUV, maxUV);
+        float scale[2] = { maxUV[0] - minUV[0], maxUV[1] - minUV[1] };
+        bool quantizedUV = false;
+        for (int i = 0; i < attributeCount; ++i)
+            quantizedUV = quantizedUV || (attributes[i].semantic == SEMANTIC_TEXCOORD && attributes[i].format == FORMAT_UNORM16X2);
+        if (quantizedUV)
+        {
+            texCoordTransform[0] = scale[0];
+            texCoordTransform[1] = scale[1];
+            texCoordTransform[2] = minUV[0];
+            texCoordTransform[3] = minUV[1];
+        }
+        else
+        {
+            texCoordTransform[0] = texCoordTransform[1] = 1.0f;
+            texCoordTransform[2] = texCoordTransform[3] = 0.0f;
+        }
+
+        out.assign(mesh.vertices.size() * vertexStride, 0);
+        for (size_t v = 0; v < mesh.vertices.size(); ++v)
+        {
+            const MeshVertex& vertex = mesh.vertices[v];
+            unsigned char* base = &out[v * vertexStride];
+            for (int i = 0; i < attributeCount; ++i)
+            {
+                const VertexAttribute& a = attributes[i];
+                const float* source = a.semantic == SEMANTIC_POSITION ? vertex.position
+                                    : a.semantic == SEMANTIC_TEXCOORD ? vertex.texCoord : vertex.normal;
+                float value[4] = { source[0], source[1], a.semantic == SEMANTIC_TEXCOORD ? 0.0f : source[2], 1.0f };
+                if (a.format == FORMAT_UNORM16X2)
+                {
+                    for (int k = 0; k < 2; ++k)
+                        value[k] = scale[k] > 0.0f ? (value[k] - minUV[k]) / scale[k] : 0.0f;
+                }
+                write(a.format, value, base + a.offset);
+            }
+        }
+    }
+
+    // ------------------------------------------------------------------------
+    static unsigned int formatSize(VertexFormat format)
+    {
+        switch (format)
+        {
+            case FORMAT_FLOAT2: return 8;
+            case FORMAT_FLOAT3: return 12;
+            case FORMAT_HALF4: return 8;
+            case FORMAT_UNORM16X2: return 4;
+            case FORMAT_SNORM_2_10_10_10: return 4;
+        }
+        return 0;
+    }
+    static GLint formatComponents(VertexFormat format)
+    {
+        switch (format)
+        {
+            case FORMAT_FLOAT2: case FORMAT_UNORM16X2: return 2;
+            case FORMAT_FLOAT3: return 3;
+            // a packed format must be read with size 4; as a vec3 input w is dropped
+            case FORMAT_HALF4: case FORMAT_SNORM_2_10_10_10: return 4;
+        }
+        return 0;
+    }
+    static GLenum formatType(VertexFormat format)
+    {
+        switch (format)
+        {
+            case FORMAT_FLOAT2: case FORMAT_FLOAT3: return GL_FLOAT;
+            case FORMAT_HALF4: return GL_HALF_FLOAT;
+            case FORMAT_UNORM16X2: return GL_UNSIGNED_SHORT;
+            case FORMAT_SNORM_2_10_10_10: return GL_INT_2_10_10_10_REV;
+        }
+        return GL_FLOAT;
+    }
+    static GLboolean formatNormalized(VertexFormat format)
+    {
+        return format == FORMAT_UNORM16X2 || format == FORMAT_SNORM_2_10_10_10 ? GL_TRUE : GL_FALSE;
+    }
+
+    // IEEE 754 binary16, round to nearest even, overflow to infinity
+    // ------------------------------------------------------------------------
+    static uint16_t toHalf(float value)
+    {
+        uint32_t bits;
+        std::memcpy(&bits, &value, 4);
+        uint32_t sign = (bits >> 16) & 0x8000u;
+        uint32_t magnitude = bits & 0x7FFFFFFFu;
+        if (magnitude >= 0x7F800000u)
+            // inf stays inf, NaN stays a quiet NaN
+            return (uint16_t)(sign | 0x7C00u | (magnitude > 0x7F800000u ? 0x200u : 0u));
+        if (magnitude >= 0x477FF000u)
+            // rounds to more than 65504
+            return (uint16_t)(sign | 0x7C00u);
+        if (magnitude < 0x38800000u)
+        {
+            // subnormal half: shift the implicit-one mantissa into place, rounding
+            if (magnitude < 0x33000000u)
+                return (uint16_t)sign;
+            uint32_t exponent = magnitude >> 23;
+            uint32_t mantissa = (magnitude & 0x7FFFFFu) | 0x800000u;
+            uint32_t shift = 126 - exponent;
+            uint32_t half = mantissa >> shift;
+            uint32_t remainder = mantissa & ((1u << shift) - 1);
+            uint32_t halfway = 1u << (shift - 1);
+            if (remainder > halfway || (remainder == halfway && (half & 1)))
+                ++half;
+            return (uint16_t)(sign | half);
+        }
+        uint32_t half = (magnitude - 0x38000000u) >> 13;
+        uint32_t remainder = magnitude & 0x1FFFu;
+        if (remainder > 0x1000u || (remainder == 0x1000u && (half & 1)))
+            ++half;
+        return (uint16_t)(sign | half);
+    }
+
+private:
+    VertexAttribute attributes[MAX_ATTRIBUTES];
+    int attributeCount;
+    unsigned int vertexStride;
+
+    static void texCoordBounds(const MeshData& mesh, float minUV[2], float maxUV[2])
+    {
+        if (mesh.vertices.empty())
+            return;
+        for (int k = 0; k < 2; ++k)
+            minUV[k] = maxUV[k] = mesh.vertices[0].texCoord[k];
+        for (size_t v = 1; v < mesh.vertices.size(); ++v)
+        {
+            for (int k = 0; k < 2; ++k)
+            {
+                minUV[k] = std::min(minUV[k], mesh.vertices[v].texCoord[k]);
+                maxUV[k] = std::max(maxUV[k], mesh.vertices[v].texCoord[k]);
+            }
+        }
+    }
+    static int32_t snorm10(float value)
+    {
+        float clamped = std::min(std::max(value, -1.0f), 1.0f);
+        return (int32_t)std::floor(clamped * 511.0f + 0.5f);
+    }
+    static void write(VertexFormat format, const float value[4], unsigned char* out)
+    {
+        switch (format)
+        {
+            case FORMAT_FLOAT2:
+                std::memcpy(out, value, 8);
+                break;
+            case FORMAT_FLOAT3:
+                std::memcpy(out, value, 12);
+                break;
+            case FORMAT_HALF4:
+            {
+                uint16_t h[4] = { toHalf(value[0]), toHalf(value[1]), toHalf(value[2]), toHalf(value[3]) };
+                std::memcpy(out, h, 8);
+                break;
+            }
+            case FORMAT_UNORM16X2:
+            {
+                uint16_t u[2];
+                for (int k = 0; k < 2; ++k)
+                    u[k] = (uint16_t)std::floor(std::min(std::max(value[k], 0.0f), 1.0f) * 65535.0f + 0.5f);
+                std::memcpy(out, u, 4);
+                break;
+            }
+            case FORMAT_SNORM_2_10_10_10:
+            {
+                // x in the lowest bits, w (2 bits) unused and 0
+                uint32_t packed = ((uint32_t)snorm10(value[0]) & 0x3FFu) | (((uint32_t)snorm10(value[1]) & 0x3FFu) << 10) |
+                                  (((uint32_t)snorm10(value[2]) & 0x3FFu) << 20);
+                std::memcpy(out, &packed, 4);
+                break;
+            }
+        }
+    }
+};
+#endif
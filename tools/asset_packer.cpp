@@ -0,0 +1,190 @@
+#include <asset_archive.h>
+#include <mesh_loader.h>
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <string>
+#include <cstring>
+#include <cctype>
+#include <algorithm>
+
+// offline asset packer: writes the files given on the command line into one .oripack
+// archive (asset_archive.h). the type of an entry comes from the extension of its
+// source; OBJ / GLB meshes are imported and optimized here and stored as .orimesh, so
+// the samples only copy vertices and indices out of the mapping
+//
+//     asset_packer <output.oripack> <name>=<path> ...
+// ---------------------------------------------------------------------------------------
+
+struct Asset
+{
+    std::string name;
+    uint32_t type;
+    std::vector<char> bytes;
+};
+
+static bool hasExtension(const std::string& path, const char* extension)
+{
+    size_t length = std::strlen(extension);
+    if (path.size() < length)
+        return false;
+    for (size_t i = 0; i < length; ++i)
+    {
+        if (std::tolower((unsigned char)path[path.size() - length + i]) != extension[i])
+            return false;
+    }
+    return true;
+}
+
+static uint32_t typeOf(const std::string& path)
+{
+    if (hasExtension(path, ".oritex"))
+        return ASSET_COOKED_TEXTURE;
+    if (hasExtension(path, ".png") || hasExtension(path, ".jpg") || hasExtension(path, ".jpeg") ||
+        hasExtension(path, ".bmp") || hasExtension(path, ".tga"))
+        return ASSET_IMAGE;
+    if (hasExtension(path, ".vs") || hasExtension(path, ".fs") || hasExtension(path, ".comp") ||
+        hasExtension(path, ".glsl"))
+        return ASSET_SHADER;
+    if (hasExtension(path, ".obj") || hasExtension(path, ".glb") || hasExtension(path, ".orimesh"))
+        return ASSET_MESH;
+    return ASSET_RAW;
+}
+
+static bool readAsset(const std::string& path, Asset& asset)
+{
+    asset.type = typeOf(path);
+    if (asset.type == ASSET_MESH && !hasExtension(path, ".orimesh"))
+    {
+        /// 在打包时导入并优化网格，运行时只需要从映射里拷贝顶点和索引
+        MeshData mesh;
+        if (!loadMesh(path.c_str(), mesh))
+            return false;
+        std::ostringstream out(std::ios::binary);
+        writeCookedMesh(out, mesh);
+        std::string cooked = out.str();
+        asset.bytes.assign(cooked.begin(), cooked.end());
+        return true;
+    }
+    std::ifstream file(path.c_str(), std::ios::binary);
+    if (!file)
+        return false;
+    file.seekg(0, std::ios::end);
+    asset.bytes.resize((size_t)file.tellg());
+    file.seekg(0, std::ios::beg);
+    if (!asset.bytes.empty())
+        file.read(&asset.bytes[0], (std::streamsize)asset.bytes.size());
+    return (bool)file;
+}
+
+static bool byName(const Asset& a, const Asset& b)
+{
+    // byte-wise, the order AssetArchive::find searches in
+    return a.name < b.name;
+}
+
+static uint64_t align(uint64_t offset)
+{
+    return (offset + ASSET_ARCHIVE_ALIGNMENT - 1) & ~(uint64_t)(ASSET_ARCHIVE_ALIGNMENT - 1);
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 3)
+    {
+        std::cout << "usage: asset_packer <output.oripack> <name>=<path> ..." << std::endl;
+        return 1;
+    }
+    const char* output = argv[1];
+    std::vector<Asset> assets;
+    for (int i = 2; i < argc; ++i)
+    {
+        std::string argument = argv[i];
+        size_t separator = argument.find('=');
+        if (separator == std::string::npos || separator == 0)
+        {
+            std::cout << "ERROR::ASSET_PACKER::EXPECTED_NAME=PATH " << argument << std::endl;
+            return 1;
+        }
+        assets.push_back(Asset());
+        assets.back().name = argument.substr(0, separator);
+        std::string path = argument.substr(separator + 1);
+        if (!readAsset(path, assets.back()))
+        {
+            std::cout << "ERROR::ASSET_PACKER::FILE_NOT_SUCCESFULLY_READ " << path << std::endl;
+            return 1;
+        }
+    }
+    std::sort(assets.begin(), assets.end(), byName);
+    for (size_t i = 1; i < assets.size(); ++i)
+    {
+        if (assets[i].name == assets[i - 1].name)
+        {
+            std::cout << "ERROR::ASSET_PACKER::DUPLICATE_NAME " << assets[i].name << std::endl;
+            return 1;
+        }
+    }
+
+    // table of contents, names, then the blobs
+    std::vector<AssetArchiveEntry> entries(assets.size());
+    std::string names;
+    for (size_t i = 0; i < assets.size(); ++i)
+    {
+        std::memset(&entries[i], 0, sizeof(AssetArchiveEntry));
+        entries[i].nameOffset = (uint32_t)names.size();
+        entries[i].nameLength = (uint32_t)assets[i].name.size();
+        entries[i].type = assets[i].type;
+        names += assets[i].name;
+    }
+    AssetArchiveHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, "ORPK", 4);
+    header.version = ASSET_ARCHIVE_VERSION;
+    header.entryCount = (uint32_t)entries.size();
+    header.namesOffset = sizeof(AssetArchiveHeader) + entries.size() * sizeof(AssetArchiveEntry);
+    header.namesSize = (uint32_t)names.size();
+    uint64_t offset = header.namesOffset + names.size();
+    for (size_t i = 0; i < assets.size(); ++i)
+    {
+        offset = align(offset);
+        entries[i].offset = offset;
+        entries[i].size = assets[i].bytes.size();
+        // the zero byte after every blob
+        offset += assets[i].bytes.size() + 1;
+    }
+    offset = align(offset);
+
+    std::ofstream file(output, std::ios::binary | std::ios::trunc);
+    if (!file)
+    {
+        std::cout << "ERROR::ASSET_PACKER::CANNOT_WRITE " << output << std::endl;
+        return 1;
+    }
+    file.write((const char*)&header, sizeof(header));
+    if (!entries.empty())
+        file.write((const char*)&entries[0], (std::streamsize)(entries.size() * sizeof(AssetArchiveEntry)));
+    file.write(names.data(), (std::streamsize)names.size());
+    static const char zeros[ASSET_ARCHIVE_ALIGNMENT] = {0};
+    for (size_t i = 0; i < assets.size(); ++i)
+    {
+        std::streamoff position = file.tellp();
+        file.write(zeros, (std::streamsize)(entries[i].offset - (uint64_t)position));
+        if (!assets[i].bytes.empty())
+            file.write(&assets[i].bytes[0], (std::streamsize)assets[i].bytes.size());
+    }
+    std::streamoff end = file.tellp();
+    file.write(zeros, (std::streamsize)(offset - (uint64_t)end));
+    if (!file)
+    {
+        std::cout << "ERROR::ASSET_PACKER::CANNOT_WRITE " << output << std::endl;
+        return 1;
+    }
+    static const char* typeNames[] = {"raw", "cooked texture", "image", "shader", "mesh"};
+    for (size_t i = 0; i < assets.size(); ++i)
+        std::cout << "  " << assets[i].name << ": " << typeNames[assets[i].type] << ", " << entries[i].size
+                  << " bytes at " << entries[i].offset << std::endl;
+    std::cout << output << ": " << assets.size() << " assets, " << offset << " bytes" << std::endl;
+    return 0;
+}
@@ -0,0 +1,313 @@
+#include <glad/glad.h>
+#include <stb_image.h>
+
+#include <cooked_texture.h>
+
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <string>
+#include <cstring>
+#include <cstdlib>
+#include <algorithm>
+
+// offline texture cooker: decode once with stb_image, flip for OpenGL, build the mip
+// chain, optionally BC1/BC3 compress, and write an .oritex container (cooked_texture.h)
+//
+//     texture_cooker [--bc] [--no-flip] [--no-mips] <input image> <output.oritex>
+// ---------------------------------------------------------------------------------------
+
+struct Image
+{
+    int width, height, channels;
+    std::vector<unsigned char> pixels;
+};
+
+// 2x2 box filter, odd sizes clamp the last row/column
+// ---------------------------------------------------------------------------------------
+static Image downsample(const Image& src)
+{
+    Image dst;
+    dst.width = src.width > 1 ? src.width / 2 : 1;
+    dst.height = src.height > 1 ? src.height / 2 : 1;
+    dst.channels = src.channels;
+    dst.pixels.resize((size_t)dst.width * dst.height * dst.channels);
+    for (int y = 0; y < dst.height; ++y)
+    {
+        int y0 = y * 2 < src.height ? y * 2 : src.height - 1;
+        int y1 = y * 2 + 1 < src.height ? y * 2 + 1 : src.height - 1;
+        for (int x = 0; x < dst.width; ++x)
+        {
+            int x0 = x * 2 < src.width ? x * 2 : src.width - 1;
+            int x1 = x * 2 + 1 < src.width ? x * 2 + 1 : src.width - 1;
+            for (int c = 0; c < src.channels; ++c)
+            {
+                int sum = src.pixels[((size_t)y0 * src.width + x0) * src.channels + c]
+                        + src.pixels[((size_t)y0 * src.width + x1) * src.channels + c]
+                        + src.pixels[((size_t)y1 * src.width + x0) * src.channels + c]
+                        + src.pixels[((size_t)y1 * src.width + x1) * src.channels + c];
+                dst.pixels[((size_t)y * dst.width + x) * dst.channels + c] = (unsigned char)((sum + 2) / 4);
+            }
+        }
+    }
+    return dst;
+}
+
+// BC1 color block: bounding box endpoints (diagonal picked by the sign of the
+// channel covariances), inset a little, nearest of the 4 palette entries per texel
+// ---------------------------------------------------------------------------------------
+static uint16_t to565(const int rgb[3])
+{
+    return (uint16_t)((((rgb[0] * 31 + 127) / 255) << 11) | (((rgb[1] * 63 + 127) / 255) << 5) | ((rgb[2] * 31 + 127) / 255));
+}
+static void from565(uint16_t c, int rgb[3])
+{
+    int r = (c >> 11) & 31, g = (c >> 5) & 63, b = c & 31;
+    rgb[0] = (r << 3) | (r >> 2);
+    rgb[1] = (g << 2) | (g >> 4);
+    rgb[2] = (b << 3) | (b >> 2);
+}
+static void encodeColorBlock(const unsigned char block[16][4], unsigned char* out)
+{
+    int lo[3] = {255, 255, 255}, hi[3] = {0, 0, 0};
+    int mean[3] = {0, 0, 0};
+    for (int i = 0; i < 16; ++i)
+    {
+        for (int c = 0; c < 3; ++c)
+        {
+            lo[c] = block[i][c] < lo[c] ? block[i][c] : lo[c];
+            hi[c] = block[i][c] > hi[c] ? block[i][c] : hi[c];
+            mean[c] += block[i][c];
+        }
+    }
+    for (int c = 0; c < 3; ++c)
+        mean[c] /= 16;
+    // red and blue against green decide which bounding box diagonal follows the colors
+    int covRG = 0, covBG = 0;
+    for (int i = 0; i < 16; ++i)
+    {
+        covRG += (block[i][0] - mean[0]) * (block[i][1] - mean[1]);
+        covBG += (block[i][2] - mean[2]) * (block[i][1] - mean[1]);
+    }
+    if (covRG < 0)
+        std::swap(lo[0], hi[0]);
+    if (covBG < 0)
+        std::swap(lo[2], hi[2]);
+    for (int c = 0; c < 3; ++c)
+    {
+        int inset = (hi[c] - lo[c]) / 16;
+        hi[c] -= inset;
+        lo[c] += inset;
+    }
+
+    uint16_t c0 = to565(hi), c1 = to565(lo);
+    // c0 > c1 selects the opaque 4 color mode
+    if (c0 < c1)
+        std::swap(c0, c1);
+    unsigned int indices = 0;
+    if (c0 != c1)
+    {
+        int palette[4][3];
+        from565(c0, palette[0]);
+        from565(c1, palette[1]);
+        for (int c = 0; c < 3; ++c)
+        {
+            palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+            palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+        }
+        for (int i = 0; i < 16; ++i)
+        {
+            int best = 0, bestError = 1 << 30;
+            for (int p = 0; p < 4; ++p)
+            {
+                int dr = block[i][0] - palette[p][0], dg = block[i][1] - palette[p][1], db = block[i][2] - palette[p][2];
+                int error = dr * dr + dg * dg + db * db;
+                if (error < bestError)
+                {
+                    bestError = error;
+                    best = p;
+                }
+            }
+            indices |= (unsigned int)best << (2 * i);
+        }
+    }
+    out[0] = (unsigned char)(c0 & 0xFF);
+    out[1] = (unsigned char)(c0 >> 8);
+    out[2] = (unsigned char)(c1 & 0xFF);
+    out[3] = (unsigned char)(c1 >> 8);
+    for (int i = 0; i < 4; ++i)
+        out[4 + i] = (unsigned char)(indices >> (8 * i));
+}
+// BC3 alpha block: min/max endpoints, 8 entry palette, 3 bit indices
+// ---------------------------------------------------------------------------------------
+static void encodeAlphaBlock(const unsigned char block[16][4], unsigned char* out)
+{
+    int a0 = 0, a1 = 255;
+    for (int i = 0; i < 16; ++i)
+    {
+        a0 = block[i][3] > a0 ? block[i][3] : a0;
+        a1 = block[i][3] < a1 ? block[i][3] : a1;
+    }
+    uint64_t indices = 0;
+    if (a0 != a1)
+    {
+        int palette[8];
+        palette[0] = a0;
+        palette[1] = a1;
+        for (int p = 1; p < 7; ++p)
+            palette[p + 1] = ((7 - p) * a0 + p * a1) / 7;
+        for (int i = 0; i < 16; ++i)
+        {
+            int best = 0, bestError = 256;
+            for (int p = 0; p < 8; ++p)
+            {
+                int error = std::abs(block[i][3] - palette[p]);
+                if (error < bestError)
+                {
+                    bestError = error;
+                    best = p;
+                }
+            }
+            indices |= (uint64_t)best << (3 * i);
+        }
+    }
+    out[0] = (unsigned char)a0;
+    out[1] = (unsigned char)a1;
+    for (int i = 0; i < 6; ++i)
+        out[2 + i] = (unsigned char)(indices >> (8 * i));
+}
+// RGBA image -> BC1 (alpha ignored) or BC3 blocks, edges clamp
+// ---------------------------------------------------------------------------------------
+static std::vector<unsigned char> compress(const Image& image, bool alpha)
+{
+    int blocksX = (image.width + 3) / 4, blocksY = (image.height + 3) / 4;
+    size_t blockSize = alpha ? 16 : 8;
+    std::vector<unsigned char> out((size_t)blocksX * blocksY * blockSize);
+    unsigned char block[16][4];
+    for (int by = 0; by < blocksY; ++by)
+    {
+        for (int bx = 0; bx < blocksX; ++bx)
+        {
+            for (int i = 0; i < 16; ++i)
+            {
+                int x = bx * 4 + i % 4, y = by * 4 + i / 4;
+                x = x < image.width ? x : image.width - 1;
+                y = y < image.height ? y : image.height - 1;
+                std::memcpy(block[i], &image.pixels[((size_t)y * image.width + x) * 4], 4);
+            }
+            unsigned char* dst = &out[((size_t)by * blocksX + bx) * blockSize];
+            if (alpha)
+            {
+                encodeAlphaBlock(block, dst);
+                dst += 8;
+            }
+            encodeColorBlock(block, dst);
+        }
+    }
+    return out;
+}
+
+int main(int argc, char** argv)
+{
+    bool bc = false, flip = true, mips = true;
+    const char* input = NULL;
+    const char* output = NULL;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "--bc") == 0)
+            bc = true;
+        else if (std::strcmp(argv[i], "--no-flip") == 0)
+            flip = false;
+        else if (std::strcmp(argv[i], "--no-mips") == 0)
+            mips = false;
+        else if (!input)
+            input = argv[i];
+        else
+            output = argv[i];
+    }
+    if (!input || !output)
+    {
+        std::cout << "usage: texture_cooker [--bc] [--no-flip] [--no-mips] <input image> <output.oritex>" << std::endl;
+        return 1;
+    }
+
+    /// 在烘焙时翻转一次，运行时不再需要stbi_set_flip_vertically_on_load
+    stbi_set_flip_vertically_on_load(flip);
+    int width, height, channels;
+    int info = stbi_info(input, &width, &height, &channels);
+    // BC works on RGBA texels, uncompressed output keeps the source channel count
+    unsigned char* data = info ? stbi_load(input, &width, &height, &channels, bc ? 4 : 0) : NULL;
+    if (!data)
+    {
+        std::cout << "Failed to load texture " << input << ": " << stbi_failure_reason() << std::endl;
+        return 1;
+    }
+    bool alpha = channels == 2 || channels == 4;
+    Image image;
+    image.width = width;
+    image.height = height;
+    image.channels = bc ? 4 : channels;
+    image.pixels.assign(data, data + (size_t)width * height * image.channels);
+    stbi_image_free(data);
+
+    std::vector<Image> chain(1, image);
+    while (mips && (chain.back().width > 1 || chain.back().height > 1))
+        chain.push_back(downsample(chain.back()));
+
+    CookedTextureHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, "ORTX", 4);
+    header.version = COOKED_TEXTURE_VERSION;
+    header.width = (uint32_t)width;
+    header.height = (uint32_t)height;
+    header.mipCount = (uint32_t)chain.size();
+    header.flags = flip ? COOKED_TEXTURE_FLIPPED : 0;
+    if (bc)
+        header.internalFormat = alpha ? GL_COMPRESSED_RGBA_S3TC_DXT5_EXT : GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+    else
+    {
+        static const GLenum internalFormats[4] = {GL_R8, GL_RG8, GL_RGB8, GL_RGBA8};
+        static const GLenum formats[4] = {GL_RED, GL_RG, GL_RGB, GL_RGBA};
+        header.internalFormat = internalFormats[image.channels - 1];
+        header.format = formats[image.channels - 1];
+        header.type = GL_UNSIGNED_BYTE;
+    }
+
+    std::vector<std::vector<unsigned char> > payloads(chain.size());
+    std::vector<CookedTextureLevel> levels(chain.size());
+    uint64_t offset = sizeof(CookedTextureHeader) + chain.size() * sizeof(CookedTextureLevel);
+    for (size_t i = 0; i < chain.size(); ++i)
+    {
+        payloads[i] = bc ? compress(chain[i], alpha) : chain[i].pixels;
+        offset = (offset + COOKED_TEXTURE_ALIGNMENT - 1) & ~(uint64_t)(COOKED_TEXTURE_ALIGNMENT - 1);
+        levels[i].width = (uint32_t)chain[i].width;
+        levels[i].height = (uint32_t)chain[i].height;
+        levels[i].offset = offset;
+        levels[i].size = payloads[i].size();
+        offset += payloads[i].size();
+    }
+
+    std::ofstream file(output, std::ios::binary);
+    if (!file)
+    {
+        std::cout << "ERROR::TEXTURE_COOKER::CANNOT_WRITE " << output << std::endl;
+        return 1;
+    }
+    file.write((const char*)&header, sizeof(header));
+    file.write((const char*)&levels[0], (std::streamsize)(levels.size() * sizeof(CookedTextureLevel)));
+    for (size_t i = 0; i < chain.size(); ++i)
+    {
+        static const char zeros[COOKED_TEXTURE_ALIGNMENT] = {0};
+        std::streamoff position = file.tellp();
+        file.write(zeros, (std::streamsize)(levels[i].offset - (uint64_t)position));
+        file.write((const char*)&payloads[i][0], (std::streamsize)payloads[i].size());
+    }
+    if (!file)
+    {
+        std::cout << "ERROR::TEXTURE_COOKER::CANNOT_WRITE " << output << std::endl;
+        return 1;
+    }
+    std::cout << input << " -> " << output << ": " << width << "x" << height << ", " << chain.size() << " levels, "
+              << (bc ? (alpha ? "BC3" : "BC1") : "uncompressed") << ", " << offset << " bytes" << std::endl;
+    return 0;
+}